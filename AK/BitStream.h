@@ -39,19 +39,19 @@ public:
     {
     }
 
+    // NOTE: Reading bytes discards any bits of a partially consumed byte, so the stream is always byte aligned afterwards.
     size_t read(Bytes bytes) override
     {
         if (has_any_error())
             return 0;
 
-        size_t nread = 0;
-        if (bytes.size() >= 1) {
-            if (m_next_byte.has_value()) {
-                bytes[0] = m_next_byte.value();
-                m_next_byte.clear();
+        align_to_byte_boundary();
 
-                ++nread;
-            }
+        size_t nread = 0;
+        while (nread < bytes.size() && m_bit_count > 0) {
+            bytes[nread++] = static_cast<u8>(m_bit_buffer);
+            m_bit_buffer >>= 8;
+            m_bit_count -= 8;
         }
 
         return nread + m_stream.read(bytes.slice(nread));
@@ -67,44 +67,61 @@ public:
         return true;
     }
 
-    bool unreliable_eof() const override { return !m_next_byte.has_value() && m_stream.unreliable_eof(); }
+    bool unreliable_eof() const override { return m_bit_count == 0 && m_stream.unreliable_eof(); }
 
     bool discard_or_error(size_t count) override
     {
-        if (count >= 1) {
-            if (m_next_byte.has_value()) {
-                m_next_byte.clear();
-                --count;
-            }
+        align_to_byte_boundary();
+
+        while (count > 0 && m_bit_count > 0) {
+            m_bit_buffer >>= 8;
+            m_bit_count -= 8;
+            --count;
         }
 
         return m_stream.discard_or_error(count);
     }
 
+    // Returns the next count bits without consuming them. If the underlying stream ends early the missing
+    // bits are returned as zeros, callers have to check the amount of bits that were actually consumed.
+    u32 peek_bits(size_t count)
+    {
+        VERIFY(count <= max_bits_per_read);
+
+        if (m_bit_count < count)
+            refill(count);
+
+        return static_cast<u32>(m_bit_buffer & ((1ull << count) - 1));
+    }
+
+    void discard_previously_peeked_bits(size_t count)
+    {
+        if (count > m_bit_count) {
+            set_fatal_error();
+            return;
+        }
+
+        m_bit_buffer >>= count;
+        m_bit_count -= count;
+    }
+
     u32 read_bits(size_t count)
     {
-        u32 result = 0;
+        VERIFY(count <= max_bits_per_read);
 
-        size_t nread = 0;
-        while (nread < count) {
-            if (m_stream.has_any_error()) {
+        if (m_bit_count < count) {
+            refill(count);
+
+            if (m_bit_count < count) {
                 set_fatal_error();
                 return 0;
             }
-
-            if (m_next_byte.has_value()) {
-                const auto bit = (m_next_byte.value() >> m_bit_offset) & 1;
-                result |= bit << nread;
-                ++nread;
-
-                if (m_bit_offset++ == 7)
-                    m_next_byte.clear();
-            } else {
-                m_stream >> m_next_byte;
-                m_bit_offset = 0;
-            }
         }
 
+        const auto result = static_cast<u32>(m_bit_buffer & ((1ull << count) - 1));
+        m_bit_buffer >>= count;
+        m_bit_count -= count;
+
         return result;
     }
 
@@ -112,8 +129,9 @@ public:
 
     void align_to_byte_boundary()
     {
-        if (m_next_byte.has_value())
-            m_next_byte.clear();
+        const auto misaligned_bits = m_bit_count % 8;
+        m_bit_buffer >>= misaligned_bits;
+        m_bit_count -= misaligned_bits;
     }
 
     bool handle_any_error() override
@@ -122,9 +140,28 @@ public:
         return Stream::handle_any_error() || handled_errors;
     }
 
+    static constexpr size_t max_bits_per_read = 32;
+
 private:
-    Optional<u8> m_next_byte;
-    size_t m_bit_offset { 0 };
+    // We only ever pull in as many bytes as are needed to satisfy the current request, this ensures that
+    // whoever owns the underlying stream can keep on reading it once we're done with the bit stream.
+    void refill(size_t count)
+    {
+        if (m_stream.has_any_error())
+            return;
+
+        u8 bytes[sizeof(m_bit_buffer)];
+        const auto nneeded = (count - m_bit_count + 7) / 8;
+        const auto nread = m_stream.read({ bytes, nneeded });
+
+        for (size_t idx = 0; idx < nread; ++idx) {
+            m_bit_buffer |= static_cast<u64>(bytes[idx]) << m_bit_count;
+            m_bit_count += 8;
+        }
+    }
+
+    u64 m_bit_buffer { 0 };
+    size_t m_bit_count { 0 };
     InputStream& m_stream;
 };
 
@@ -89,6 +89,32 @@ public:
         return nread;
     }
 
+    // Appends count bytes that are copied from seekback bytes ago, the source may overlap with the bytes
+    // that are being written (e.g. a seekback of one repeats the last byte count times).
+    size_t copy_from_seekback(size_t seekback, size_t count)
+    {
+        if (seekback == 0 || seekback > Capacity || seekback > m_total_written || count > Capacity - m_queue.size()) {
+            set_recoverable_error();
+            return 0;
+        }
+
+        size_t ncopied = 0;
+        while (ncopied < count) {
+            const auto read_index = (m_total_written - seekback) % Capacity;
+            const auto write_index = (m_queue.head_index() + m_queue.size()) % Capacity;
+
+            // Limiting each chunk to seekback bytes ensures that every source byte has been written before it is copied.
+            const auto nchunk = min(min(count - ncopied, seekback), min(Capacity - read_index, Capacity - write_index));
+            __builtin_memmove(m_queue.m_storage + write_index, m_queue.m_storage + read_index, nchunk);
+
+            m_queue.m_size += nchunk;
+            m_total_written += nchunk;
+            ncopied += nchunk;
+        }
+
+        return ncopied;
+    }
+
     bool read_or_error(Bytes bytes) override
     {
         if (m_queue.size() < bytes.size()) {
@@ -0,0 +1,484 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/Assertions.h>
+#include <AK/Optional.h>
+#include <AK/StdLibExtras.h>
+
+namespace AK {
+
+// An ordered map from unique keys to values, kept balanced so that lookups, insertions and
+// removals are O(log n). Besides exact lookups it can find the closest key on either side of
+// a given one, which is what interval-like users (address ranges, for example) need.
+template<typename K, typename V>
+class RedBlackTree {
+private:
+    enum class Color : bool {
+        Red,
+        Black,
+    };
+
+    struct Node {
+        Node(K key, V value)
+            : key(move(key))
+            , value(move(value))
+        {
+        }
+
+        Node* parent { nullptr };
+        Node* left { nullptr };
+        Node* right { nullptr };
+        Color color { Color::Red };
+        K key;
+        V value;
+    };
+
+public:
+    template<typename TreeType, typename ElementType>
+    class Iterator {
+    public:
+        bool operator==(const Iterator& other) const { return m_node == other.m_node; }
+        bool operator!=(const Iterator& other) const { return m_node != other.m_node; }
+        Iterator& operator++()
+        {
+            m_node = successor(m_node);
+            return *this;
+        }
+        ElementType& operator*() { return m_node->value; }
+        ElementType* operator->() { return &m_node->value; }
+        const K& key() const { return m_node->key; }
+        bool is_end() const { return !m_node; }
+
+    private:
+        friend TreeType;
+        explicit Iterator(Node* node)
+            : m_node(node)
+        {
+        }
+
+        Node* m_node { nullptr };
+    };
+
+    using ConstIteratorType = Iterator<const RedBlackTree, const V>;
+    using IteratorType = Iterator<RedBlackTree, V>;
+
+    RedBlackTree() = default;
+
+    RedBlackTree(const RedBlackTree& other)
+        : m_root(clone_subtree(other.m_root, nullptr))
+        , m_size(other.m_size)
+    {
+    }
+
+    RedBlackTree(RedBlackTree&& other)
+        : m_root(exchange(other.m_root, nullptr))
+        , m_size(exchange(other.m_size, 0))
+    {
+    }
+
+    ~RedBlackTree() { clear(); }
+
+    RedBlackTree& operator=(const RedBlackTree& other)
+    {
+        if (this != &other) {
+            clear();
+            m_root = clone_subtree(other.m_root, nullptr);
+            m_size = other.m_size;
+        }
+        return *this;
+    }
+
+    RedBlackTree& operator=(RedBlackTree&& other)
+    {
+        if (this != &other) {
+            clear();
+            m_root = exchange(other.m_root, nullptr);
+            m_size = exchange(other.m_size, 0);
+        }
+        return *this;
+    }
+
+    bool is_empty() const { return m_size == 0; }
+    size_t size() const { return m_size; }
+
+    void clear()
+    {
+        delete_subtree(m_root);
+        m_root = nullptr;
+        m_size = 0;
+    }
+
+    // The key must not be in the tree yet.
+    V& insert(K key, V value)
+    {
+        Node* parent = nullptr;
+        Node** link = &m_root;
+        while (*link) {
+            parent = *link;
+            if (key < parent->key) {
+                link = &parent->left;
+            } else {
+                VERIFY(parent->key < key);
+                link = &parent->right;
+            }
+        }
+        auto* node = new Node(move(key), move(value));
+        node->parent = parent;
+        *link = node;
+        ++m_size;
+        fix_after_insertion(node);
+        return node->value;
+    }
+
+    bool contains(const K& key) const { return find_node(key); }
+
+    V* find(const K& key)
+    {
+        auto* node = find_node(key);
+        return node ? &node->value : nullptr;
+    }
+    const V* find(const K& key) const { return const_cast<RedBlackTree*>(this)->find(key); }
+
+    V* find_largest_not_above(const K& key)
+    {
+        auto* node = find_largest_node_not_above(key);
+        return node ? &node->value : nullptr;
+    }
+    const V* find_largest_not_above(const K& key) const { return const_cast<RedBlackTree*>(this)->find_largest_not_above(key); }
+
+    V* find_smallest_not_below(const K& key)
+    {
+        auto* node = find_smallest_node_not_below(key);
+        return node ? &node->value : nullptr;
+    }
+    const V* find_smallest_not_below(const K& key) const { return const_cast<RedBlackTree*>(this)->find_smallest_not_below(key); }
+
+    IteratorType find_largest_not_above_iterator(const K& key) { return IteratorType(find_largest_node_not_above(key)); }
+    IteratorType find_smallest_not_below_iterator(const K& key) { return IteratorType(find_smallest_node_not_below(key)); }
+
+    bool remove(const K& key)
+    {
+        auto* node = find_node(key);
+        if (!node)
+            return false;
+        delete remove_node(node);
+        return true;
+    }
+
+    Optional<V> take(const K& key)
+    {
+        auto* node = find_node(key);
+        if (!node)
+            return {};
+        remove_node(node);
+        auto value = move(node->value);
+        delete node;
+        return value;
+    }
+
+    IteratorType begin() { return IteratorType(minimum(m_root)); }
+    IteratorType end() { return IteratorType(nullptr); }
+    ConstIteratorType begin() const { return ConstIteratorType(minimum(m_root)); }
+    ConstIteratorType end() const { return ConstIteratorType(nullptr); }
+
+private:
+    static bool is_red(const Node* node) { return node && node->color == Color::Red; }
+    static bool is_black(const Node* node) { return !is_red(node); }
+
+    static Node* minimum(Node* node)
+    {
+        if (!node)
+            return nullptr;
+        while (node->left)
+            node = node->left;
+        return node;
+    }
+
+    static Node* successor(Node* node)
+    {
+        if (node->right)
+            return minimum(node->right);
+        while (node->parent && node == node->parent->right)
+            node = node->parent;
+        return node->parent;
+    }
+
+    static Node* clone_subtree(const Node* node, Node* parent)
+    {
+        if (!node)
+            return nullptr;
+        auto* clone = new Node(node->key, node->value);
+        clone->parent = parent;
+        clone->color = node->color;
+        clone->left = clone_subtree(node->left, clone);
+        clone->right = clone_subtree(node->right, clone);
+        return clone;
+    }
+
+    static void delete_subtree(Node* node)
+    {
+        if (!node)
+            return;
+        delete_subtree(node->left);
+        delete_subtree(node->right);
+        delete node;
+    }
+
+    Node* find_node(const K& key) const
+    {
+        auto* node = m_root;
+        while (node) {
+            if (key < node->key)
+                node = node->left;
+            else if (node->key < key)
+                node = node->right;
+            else
+                return node;
+        }
+        return nullptr;
+    }
+
+    Node* find_largest_node_not_above(const K& key) const
+    {
+        Node* candidate = nullptr;
+        auto* node = m_root;
+        while (node) {
+            if (key < node->key) {
+                node = node->left;
+            } else if (node->key < key) {
+                candidate = node;
+                node = node->right;
+            } else {
+                return node;
+            }
+        }
+        return candidate;
+    }
+
+    Node* find_smallest_node_not_below(const K& key) const
+    {
+        Node* candidate = nullptr;
+        auto* node = m_root;
+        while (node) {
+            if (key < node->key) {
+                candidate = node;
+                node = node->left;
+            } else if (node->key < key) {
+                node = node->right;
+            } else {
+                return node;
+            }
+        }
+        return candidate;
+    }
+
+    void rotate_left(Node* node)
+    {
+        auto* pivot = node->right;
+        node->right = pivot->left;
+        if (pivot->left)
+            pivot->left->parent = node;
+        replace_in_parent(node, pivot);
+        pivot->left = node;
+        node->parent = pivot;
+    }
+
+    void rotate_right(Node* node)
+    {
+        auto* pivot = node->left;
+        node->left = pivot->right;
+        if (pivot->right)
+            pivot->right->parent = node;
+        replace_in_parent(node, pivot);
+        pivot->right = node;
+        node->parent = pivot;
+    }
+
+    // Puts the subtree rooted at replacement where the one rooted at node used to be.
+    void replace_in_parent(Node* node, Node* replacement)
+    {
+        if (!node->parent)
+            m_root = replacement;
+        else if (node == node->parent->left)
+            node->parent->left = replacement;
+        else
+            node->parent->right = replacement;
+        if (replacement)
+            replacement->parent = node->parent;
+    }
+
+    void fix_after_insertion(Node* node)
+    {
+        while (is_red(node->parent)) {
+            auto* parent = node->parent;
+            // The root is black, so a red parent always has a parent of its own.
+            auto* grandparent = parent->parent;
+            if (parent == grandparent->left) {
+                auto* uncle = grandparent->right;
+                if (is_red(uncle)) {
+                    parent->color = Color::Black;
+                    uncle->color = Color::Black;
+                    grandparent->color = Color::Red;
+                    node = grandparent;
+                    continue;
+                }
+                if (node == parent->right) {
+                    rotate_left(parent);
+                    node = parent;
+                    parent = node->parent;
+                }
+                parent->color = Color::Black;
+                grandparent->color = Color::Red;
+                rotate_right(grandparent);
+            } else {
+                auto* uncle = grandparent->left;
+                if (is_red(uncle)) {
+                    parent->color = Color::Black;
+                    uncle->color = Color::Black;
+                    grandparent->color = Color::Red;
+                    node = grandparent;
+                    continue;
+                }
+                if (node == parent->left) {
+                    rotate_right(parent);
+                    node = parent;
+                    parent = node->parent;
+                }
+                parent->color = Color::Black;
+                grandparent->color = Color::Red;
+                rotate_left(grandparent);
+            }
+        }
+        m_root->color = Color::Black;
+    }
+
+    // Unlinks the node from the tree and returns it, without deleting it.
+    Node* remove_node(Node* node)
+    {
+        Node* child;
+        Node* child_parent;
+        auto removed_color = node->color;
+        if (!node->left) {
+            child = node->right;
+            child_parent = node->parent;
+            replace_in_parent(node, node->right);
+        } else if (!node->right) {
+            child = node->left;
+            child_parent = node->parent;
+            replace_in_parent(node, node->left);
+        } else {
+            // Move the node's successor into its place.
+            auto* next = minimum(node->right);
+            removed_color = next->color;
+            child = next->right;
+            if (next->parent == node) {
+                child_parent = next;
+            } else {
+                child_parent = next->parent;
+                replace_in_parent(next, next->right);
+                next->right = node->right;
+                next->right->parent = next;
+            }
+            replace_in_parent(node, next);
+            next->left = node->left;
+            next->left->parent = next;
+            next->color = node->color;
+        }
+        --m_size;
+        if (removed_color == Color::Black)
+            fix_after_removal(child, child_parent);
+        node->parent = node->left = node->right = nullptr;
+        return node;
+    }
+
+    void fix_after_removal(Node* node, Node* parent)
+    {
+        while (node != m_root && is_black(node)) {
+            if (node == parent->left) {
+                auto* sibling = parent->right;
+                if (is_red(sibling)) {
+                    sibling->color = Color::Black;
+                    parent->color = Color::Red;
+                    rotate_left(parent);
+                    sibling = parent->right;
+                }
+                if (is_black(sibling->left) && is_black(sibling->right)) {
+                    sibling->color = Color::Red;
+                    node = parent;
+                    parent = node->parent;
+                    continue;
+                }
+                if (is_black(sibling->right)) {
+                    sibling->left->color = Color::Black;
+                    sibling->color = Color::Red;
+                    rotate_right(sibling);
+                    sibling = parent->right;
+                }
+                sibling->color = parent->color;
+                parent->color = Color::Black;
+                sibling->right->color = Color::Black;
+                rotate_left(parent);
+                node = m_root;
+            } else {
+                auto* sibling = parent->left;
+                if (is_red(sibling)) {
+                    sibling->color = Color::Black;
+                    parent->color = Color::Red;
+                    rotate_right(parent);
+                    sibling = parent->left;
+                }
+                if (is_black(sibling->left) && is_black(sibling->right)) {
+                    sibling->color = Color::Red;
+                    node = parent;
+                    parent = node->parent;
+                    continue;
+                }
+                if (is_black(sibling->left)) {
+                    sibling->right->color = Color::Black;
+                    sibling->color = Color::Red;
+                    rotate_left(sibling);
+                    sibling = parent->left;
+                }
+                sibling->color = parent->color;
+                parent->color = Color::Black;
+                sibling->left->color = Color::Black;
+                rotate_right(parent);
+                node = m_root;
+            }
+        }
+        if (node)
+            node->color = Color::Black;
+    }
+
+    Node* m_root { nullptr };
+    size_t m_size { 0 };
+};
+
+}
+
+using AK::RedBlackTree;
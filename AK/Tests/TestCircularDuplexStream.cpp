@@ -82,4 +82,33 @@ TEST_CASE(overwritting_is_well_defined)
     EXPECT(stream.eof());
 }
 
+TEST_CASE(copy_from_seekback_wraps_and_overlaps)
+{
+    constexpr size_t capacity = 32;
+
+    CircularDuplexStream<capacity> stream;
+
+    for (size_t idx = 0; idx < 28; ++idx)
+        stream << static_cast<u8>(idx);
+
+    Array<u8, 28> discarded;
+    stream >> discarded;
+
+    // Copies "24 25 26 27" repeatedly, which wraps around the end of the underlying storage.
+    EXPECT_EQ(stream.copy_from_seekback(4, 10), 10u);
+    EXPECT(!stream.has_any_error());
+
+    for (size_t idx = 0; idx < 10; ++idx) {
+        u8 byte = 0;
+        stream >> byte;
+
+        EXPECT_EQ(byte, 24 + idx % 4);
+    }
+
+    EXPECT(stream.eof());
+
+    EXPECT_EQ(stream.copy_from_seekback(capacity + 1, 1), 0u);
+    EXPECT(stream.handle_any_error());
+}
+
 TEST_MAIN(CircularDuplexStream)
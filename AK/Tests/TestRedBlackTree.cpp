@@ -0,0 +1,154 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <AK/TestSuite.h>
+
+#include <AK/RedBlackTree.h>
+#include <AK/String.h>
+#include <AK/Vector.h>
+
+TEST_CASE(construct)
+{
+    RedBlackTree<int, int> empty;
+    EXPECT(empty.is_empty());
+    EXPECT_EQ(empty.size(), 0u);
+    EXPECT(empty.begin() == empty.end());
+}
+
+TEST_CASE(insert_and_find)
+{
+    RedBlackTree<int, String> tree;
+    tree.insert(20, "twenty");
+    tree.insert(10, "ten");
+    tree.insert(30, "thirty");
+    EXPECT_EQ(tree.size(), 3u);
+    EXPECT_EQ(*tree.find(10), "ten");
+    EXPECT_EQ(*tree.find(20), "twenty");
+    EXPECT_EQ(*tree.find(30), "thirty");
+    EXPECT(!tree.find(15));
+    EXPECT(tree.contains(30));
+    EXPECT(!tree.contains(40));
+}
+
+TEST_CASE(closest_keys)
+{
+    RedBlackTree<int, int> tree;
+    for (int i = 10; i <= 100; i += 10)
+        tree.insert(i, i);
+    EXPECT_EQ(*tree.find_largest_not_above(10), 10);
+    EXPECT_EQ(*tree.find_largest_not_above(55), 50);
+    EXPECT_EQ(*tree.find_largest_not_above(1000), 100);
+    EXPECT(!tree.find_largest_not_above(9));
+    EXPECT_EQ(*tree.find_smallest_not_below(100), 100);
+    EXPECT_EQ(*tree.find_smallest_not_below(55), 60);
+    EXPECT_EQ(*tree.find_smallest_not_below(0), 10);
+    EXPECT(!tree.find_smallest_not_below(101));
+
+    auto it = tree.find_largest_not_above_iterator(35);
+    EXPECT_EQ(it.key(), 30);
+    ++it;
+    EXPECT_EQ(it.key(), 40);
+    EXPECT(tree.find_smallest_not_below_iterator(101).is_end());
+}
+
+TEST_CASE(iterates_in_order)
+{
+    RedBlackTree<int, int> tree;
+    int keys[] = { 5, 3, 8, 1, 4, 7, 9, 2, 6, 0 };
+    for (auto key : keys)
+        tree.insert(key, key * 10);
+    int expected = 0;
+    for (auto& value : tree) {
+        EXPECT_EQ(value, expected * 10);
+        ++expected;
+    }
+    EXPECT_EQ(expected, 10);
+}
+
+TEST_CASE(remove_and_take)
+{
+    RedBlackTree<int, String> tree;
+    tree.insert(1, "one");
+    tree.insert(2, "two");
+    tree.insert(3, "three");
+    EXPECT(tree.remove(2));
+    EXPECT(!tree.remove(2));
+    EXPECT_EQ(tree.size(), 2u);
+    EXPECT(!tree.find(2));
+
+    auto taken = tree.take(3);
+    EXPECT(taken.has_value());
+    EXPECT_EQ(taken.value(), "three");
+    EXPECT(!tree.take(3).has_value());
+    EXPECT_EQ(tree.size(), 1u);
+    EXPECT_EQ(tree.begin().key(), 1);
+}
+
+TEST_CASE(copy_and_move)
+{
+    RedBlackTree<int, int> tree;
+    for (int i = 0; i < 100; ++i)
+        tree.insert(i, i);
+
+    auto copy = tree;
+    EXPECT_EQ(copy.size(), 100u);
+    copy.remove(50);
+    EXPECT(tree.contains(50));
+    EXPECT(!copy.contains(50));
+
+    auto moved = move(tree);
+    EXPECT(tree.is_empty());
+    EXPECT_EQ(moved.size(), 100u);
+    EXPECT_EQ(*moved.find(99), 99);
+}
+
+TEST_CASE(many_insertions_and_removals)
+{
+    constexpr int count = 10000;
+    RedBlackTree<int, int> tree;
+    // Insert in a scrambled order so that every rebalancing case gets exercised.
+    for (int i = 0; i < count; ++i) {
+        int key = (i * 7919) % count;
+        tree.insert(key, key);
+    }
+    EXPECT_EQ(tree.size(), static_cast<size_t>(count));
+
+    for (int i = 0; i < count; i += 2)
+        EXPECT(tree.remove(i));
+    EXPECT_EQ(tree.size(), static_cast<size_t>(count / 2));
+
+    int expected = 1;
+    for (auto it = tree.begin(); it != tree.end(); ++it) {
+        EXPECT_EQ(it.key(), expected);
+        EXPECT_EQ(*it, expected);
+        expected += 2;
+    }
+    EXPECT_EQ(expected, count + 1);
+    EXPECT_EQ(*tree.find_largest_not_above(100), 99);
+    EXPECT_EQ(*tree.find_smallest_not_below(100), 101);
+}
+
+TEST_MAIN(RedBlackTree)
@@ -37,6 +37,7 @@ constexpr int syscall_vector = 0x82;
 
 extern "C" {
 struct pollfd;
+struct epoll_event;
 struct timeval;
 struct timespec;
 struct sockaddr;
@@ -193,7 +194,10 @@ namespace Kernel {
     S(anon_create)            \
     S(msyscall)               \
     S(readv)                  \
-    S(emuctl)
+    S(emuctl)                 \
+    S(epoll_create1)          \
+    S(epoll_ctl)              \
+    S(epoll_wait)
 
 namespace Syscall {
 
@@ -278,6 +282,21 @@ struct SC_poll_params {
     const u32* sigmask;
 };
 
+struct SC_epoll_ctl_params {
+    int epfd;
+    int op;
+    int fd;
+    struct epoll_event* event;
+};
+
+struct SC_epoll_wait_params {
+    int epfd;
+    struct epoll_event* events;
+    int maxevents;
+    const struct timespec* timeout;
+    const u32* sigmask;
+};
+
 struct SC_clock_nanosleep_params {
     int clock_id;
     int flags;
@@ -62,7 +62,8 @@ void AsyncDeviceRequest::request_finished()
         m_parent_request->sub_request_finished(*this);
 
     // Trigger processing the next request
-    m_device.process_next_queued_request({}, *this);
+    if (!m_is_part_of_another_request)
+        m_device.process_next_queued_request({}, *this);
 
     // Wake anyone who may be waiting
     m_queue.wake_all();
@@ -84,6 +85,14 @@ auto AsyncDeviceRequest::get_request_result() const -> RequestResult
     return m_result;
 }
 
+void AsyncDeviceRequest::start_as_part_of_another_request()
+{
+    ScopedSpinLock lock(m_lock);
+    VERIFY(m_result == Pending);
+    m_result = Started;
+    m_is_part_of_another_request = true;
+}
+
 void AsyncDeviceRequest::add_sub_request(NonnullRefPtr<AsyncDeviceRequest> sub_request)
 {
     // Sub-requests cannot be for the same device
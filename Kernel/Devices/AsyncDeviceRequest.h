@@ -78,6 +78,8 @@ public:
 
     void add_sub_request(NonnullRefPtr<AsyncDeviceRequest>);
 
+    const Process& process() const { return m_process; }
+
     [[nodiscard]] RequestWaitResult wait(Time* = nullptr);
 
     void do_start(ScopedSpinLock<SpinLock<u8>>&& requests_lock)
@@ -90,7 +92,7 @@ public:
         start();
     }
 
-    void complete(RequestResult result);
+    virtual void complete(RequestResult result);
 
     void set_private(void* priv)
     {
@@ -140,6 +142,10 @@ protected:
 
     RequestResult get_request_result() const;
 
+    // For requests that the device carries out as part of another one. They are never started on their own,
+    // and completing them doesn't make the device start its next request.
+    void start_as_part_of_another_request();
+
 private:
     void sub_request_finished(AsyncDeviceRequest&);
     void request_finished();
@@ -160,6 +166,7 @@ private:
 
     AsyncDeviceRequest* m_parent_request { nullptr };
     RequestResult m_result { Pending };
+    bool m_is_part_of_another_request { false };
     NonnullRefPtrVector<AsyncDeviceRequest> m_sub_requests_pending;
     NonnullRefPtrVector<AsyncDeviceRequest> m_sub_requests_complete;
     WaitQueue m_queue;
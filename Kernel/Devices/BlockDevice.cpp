@@ -25,6 +25,7 @@
  */
 
 #include <Kernel/Devices/BlockDevice.h>
+#include <Kernel/Devices/IOScheduler.h>
 
 namespace Kernel {
 
@@ -36,18 +37,86 @@ AsyncBlockDeviceRequest::AsyncBlockDeviceRequest(Device& block_device, RequestTy
     , m_block_count(block_count)
     , m_buffer(buffer)
     , m_buffer_size(buffer_size)
+    , m_total_block_count(block_count)
 {
 }
 
+bool AsyncBlockDeviceRequest::can_merge(const AsyncBlockDeviceRequest& request) const
+{
+    return request.request_type() == m_request_type && request.block_index() == m_block_index + m_total_block_count;
+}
+
+void AsyncBlockDeviceRequest::merge(NonnullRefPtr<AsyncBlockDeviceRequest> request)
+{
+    VERIFY(can_merge(*request));
+    request->start_as_part_of_another_request();
+    m_total_block_count += request->block_count();
+    m_merged_requests.append(move(request));
+}
+
 void AsyncBlockDeviceRequest::start()
 {
     m_block_device.start_request(*this);
 }
 
+void AsyncBlockDeviceRequest::complete(RequestResult result)
+{
+    // The merged requests go first, so that they are done by the time the device moves on to its next request.
+    for (auto& request : m_merged_requests)
+        request.complete(result);
+    AsyncDeviceRequest::complete(result);
+}
+
+BlockDevice::BlockDevice(unsigned major, unsigned minor, size_t block_size)
+    : Device(major, minor)
+    , m_block_size(block_size)
+    , m_io_scheduler(make<FIFOIOScheduler>())
+{
+}
+
 BlockDevice::~BlockDevice()
 {
 }
 
+const char* BlockDevice::io_scheduler_name() const
+{
+    ScopedSpinLock lock(requests_lock());
+    return m_io_scheduler->name();
+}
+
+bool BlockDevice::set_io_scheduler(const StringView& name)
+{
+    auto io_scheduler = IOScheduler::create(name);
+    if (!io_scheduler)
+        return false;
+    ScopedSpinLock lock(requests_lock());
+    while (auto request = m_io_scheduler->take_next_request())
+        io_scheduler->queue_request(request.release_nonnull());
+    m_io_scheduler = move(io_scheduler);
+    return true;
+}
+
+void BlockDevice::queue_request(NonnullRefPtr<AsyncDeviceRequest> request)
+{
+    m_io_scheduler->queue_request(static_ptr_cast<AsyncBlockDeviceRequest>(request));
+}
+
+RefPtr<AsyncDeviceRequest> BlockDevice::take_next_queued_request()
+{
+    auto request = m_io_scheduler->take_next_request();
+    if (!request || !supports_merged_requests())
+        return request;
+
+    // Requests that continue where this one ends can be carried out by the same command.
+    while (request->total_block_count() < max_blocks_per_request()) {
+        auto next_request = m_io_scheduler->take_request_continuing(*request, max_blocks_per_request() - request->total_block_count());
+        if (!next_request)
+            break;
+        request->merge(next_request.release_nonnull());
+    }
+    return request;
+}
+
 bool BlockDevice::read_block(u64 index, UserOrKernelBuffer& buffer)
 {
     auto read_request = make_request<AsyncBlockDeviceRequest>(AsyncBlockDeviceRequest::Read, index, 1, buffer, 512);
@@ -26,11 +26,13 @@
 
 #pragma once
 
+#include <AK/OwnPtr.h>
 #include <Kernel/Devices/Device.h>
 
 namespace Kernel {
 
 class BlockDevice;
+class IOScheduler;
 
 class AsyncBlockDeviceRequest : public AsyncDeviceRequest {
 public:
@@ -48,7 +50,22 @@ public:
     const UserOrKernelBuffer& buffer() const { return m_buffer; }
     size_t buffer_size() const { return m_buffer_size; }
 
+    // Requests for the blocks right after this one can be merged into it, and are then carried out together
+    // with it by a single command. Drivers have to transfer to and from the buffer of every part, in order.
+    bool can_merge(const AsyncBlockDeviceRequest&) const;
+    void merge(NonnullRefPtr<AsyncBlockDeviceRequest>);
+    u32 total_block_count() const { return m_total_block_count; }
+
+    template<typename Callback>
+    void for_each_part(Callback callback)
+    {
+        callback(*this);
+        for (auto& request : m_merged_requests)
+            callback(request);
+    }
+
     virtual void start() override;
+    virtual void complete(RequestResult) override;
     virtual const char* name() const override
     {
         switch (m_request_type) {
@@ -68,6 +85,8 @@ private:
     const u32 m_block_count;
     UserOrKernelBuffer m_buffer;
     const size_t m_buffer_size;
+    NonnullRefPtrVector<AsyncBlockDeviceRequest> m_merged_requests;
+    u32 m_total_block_count { 0 };
 };
 
 class BlockDevice : public Device {
@@ -82,17 +101,26 @@ public:
 
     virtual void start_request(AsyncBlockDeviceRequest&) = 0;
 
+    // The most blocks a single request may transfer.
+    virtual size_t max_blocks_per_request() const { return PAGE_SIZE / block_size(); }
+    // Whether start_request() can carry out requests that other requests have been merged into.
+    virtual bool supports_merged_requests() const { return false; }
+
+    const char* io_scheduler_name() const;
+    bool set_io_scheduler(const StringView& name);
+
 protected:
-    BlockDevice(unsigned major, unsigned minor, size_t block_size = PAGE_SIZE)
-        : Device(major, minor)
-        , m_block_size(block_size)
-    {
-    }
+    BlockDevice(unsigned major, unsigned minor, size_t block_size = PAGE_SIZE);
+
+    // ^Device
+    virtual void queue_request(NonnullRefPtr<AsyncDeviceRequest>) override;
+    virtual RefPtr<AsyncDeviceRequest> take_next_queued_request() override;
 
 private:
     virtual bool is_block_device() const final { return true; }
 
     size_t m_block_size { 0 };
+    OwnPtr<IOScheduler> m_io_scheduler;
 };
 
 }
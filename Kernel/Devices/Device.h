@@ -68,15 +68,16 @@ public:
 
     void process_next_queued_request(Badge<AsyncDeviceRequest>, const AsyncDeviceRequest&);
 
+    // How many queued requests may be started at the same time.
+    virtual size_t max_concurrent_requests() const { return 1; }
+
     template<typename AsyncRequestType, typename... Args>
     NonnullRefPtr<AsyncRequestType> make_request(Args&&... args)
     {
         auto request = adopt(*new AsyncRequestType(*this, forward<Args>(args)...));
         ScopedSpinLock lock(m_requests_lock);
-        bool was_empty = m_requests.is_empty();
-        m_requests.append(request);
-        if (was_empty)
-            request->do_start(move(lock));
+        queue_request(request);
+        start_next_queued_request(move(lock));
         return request;
     }
 
@@ -87,14 +88,24 @@ protected:
 
     static HashMap<u32, Device*>& all_devices();
 
+    // Requests wait in this queue until there is room to start them. These are always called with the requests lock held.
+    virtual void queue_request(NonnullRefPtr<AsyncDeviceRequest>);
+    virtual RefPtr<AsyncDeviceRequest> take_next_queued_request();
+
+    SpinLock<u8>& requests_lock() const { return m_requests_lock; }
+
 private:
     unsigned m_major { 0 };
     unsigned m_minor { 0 };
     uid_t m_uid { 0 };
     gid_t m_gid { 0 };
 
-    SpinLock<u8> m_requests_lock;
-    DoublyLinkedList<RefPtr<AsyncDeviceRequest>> m_requests;
+    void start_next_queued_request(ScopedSpinLock<SpinLock<u8>>&&);
+
+    mutable SpinLock<u8> m_requests_lock;
+    DoublyLinkedList<RefPtr<AsyncDeviceRequest>> m_queued_requests;
+    DoublyLinkedList<RefPtr<AsyncDeviceRequest>> m_started_requests;
+    size_t m_started_requests_count { 0 };
 };
 
 }
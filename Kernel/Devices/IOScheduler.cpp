@@ -0,0 +1,170 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <Kernel/Devices/IOScheduler.h>
+#include <Kernel/Time/TimeManagement.h>
+
+namespace Kernel {
+
+static constexpr Time read_deadline = Time::from_milliseconds(500);
+static constexpr Time write_deadline = Time::from_seconds(5);
+
+OwnPtr<IOScheduler> IOScheduler::create(const StringView& name)
+{
+    if (name == "fifo")
+        return make<FIFOIOScheduler>();
+    if (name == "deadline")
+        return make<DeadlineIOScheduler>();
+    if (name == "fair")
+        return make<FairIOScheduler>();
+    return {};
+}
+
+void FIFOIOScheduler::queue_request(NonnullRefPtr<AsyncBlockDeviceRequest> request)
+{
+    m_requests.append(move(request));
+}
+
+RefPtr<AsyncBlockDeviceRequest> FIFOIOScheduler::take_next_request()
+{
+    if (m_requests.is_empty())
+        return {};
+    return m_requests.take_first();
+}
+
+RefPtr<AsyncBlockDeviceRequest> FIFOIOScheduler::take_request_continuing(const AsyncBlockDeviceRequest& request, size_t max_block_count)
+{
+    if (m_requests.is_empty())
+        return {};
+    auto& next_request = m_requests.first();
+    if (!request.can_merge(next_request) || next_request->block_count() > max_block_count)
+        return {};
+    return m_requests.take_first();
+}
+
+void DeadlineIOScheduler::queue_request(NonnullRefPtr<AsyncBlockDeviceRequest> request)
+{
+    auto deadline = TimeManagement::the().monotonic_time() + (request->request_type() == AsyncBlockDeviceRequest::Read ? read_deadline : write_deadline);
+    size_t index = 0;
+    while (index < m_requests.size() && m_requests[index].request->block_index() <= request->block_index())
+        ++index;
+    m_requests.insert(index, { move(request), deadline });
+}
+
+RefPtr<AsyncBlockDeviceRequest> DeadlineIOScheduler::take_next_request()
+{
+    if (m_requests.is_empty())
+        return {};
+
+    auto now = TimeManagement::the().monotonic_time();
+    Optional<size_t> next_index;
+    for (size_t index = 0; index < m_requests.size(); ++index) {
+        auto& deadline = m_requests[index].deadline;
+        if (deadline <= now && (!next_index.has_value() || deadline < m_requests[next_index.value()].deadline))
+            next_index = index;
+    }
+
+    if (!next_index.has_value()) {
+        // Carry on from where the last request ended, and start over from the lowest block index once we're past the last request.
+        next_index = 0;
+        for (size_t index = 0; index < m_requests.size(); ++index) {
+            if (m_requests[index].request->block_index() >= m_next_block_index) {
+                next_index = index;
+                break;
+            }
+        }
+    }
+
+    auto request = m_requests.take(next_index.value()).request;
+    m_next_block_index = request->block_index() + request->block_count();
+    return request;
+}
+
+RefPtr<AsyncBlockDeviceRequest> DeadlineIOScheduler::take_request_continuing(const AsyncBlockDeviceRequest& request, size_t max_block_count)
+{
+    // This is where the sweep would have gone next anyway.
+    for (size_t index = 0; index < m_requests.size(); ++index) {
+        auto& next_request = m_requests[index].request;
+        if (!request.can_merge(next_request) || next_request->block_count() > max_block_count)
+            continue;
+        auto taken_request = m_requests.take(index).request;
+        m_next_block_index = taken_request->block_index() + taken_request->block_count();
+        return taken_request;
+    }
+    return {};
+}
+
+void FairIOScheduler::queue_request(NonnullRefPtr<AsyncBlockDeviceRequest> request)
+{
+    auto pid = request->process().pid();
+    for (auto& queue : m_queues) {
+        if (queue.pid == pid) {
+            queue.requests.append(move(request));
+            return;
+        }
+    }
+    m_queues.append({ pid, {} });
+    m_queues.last().requests.append(move(request));
+}
+
+RefPtr<AsyncBlockDeviceRequest> FairIOScheduler::take_next_request()
+{
+    if (m_queues.is_empty())
+        return {};
+    if (m_next_queue_index >= m_queues.size())
+        m_next_queue_index = 0;
+
+    auto& queue = m_queues[m_next_queue_index];
+    auto request = queue.requests.take_first();
+    // Once a queue is gone, the one after it moves up to its index and is next in line anyway.
+    if (queue.requests.is_empty())
+        m_queues.remove(m_next_queue_index);
+    else
+        ++m_next_queue_index;
+    return request;
+}
+
+RefPtr<AsyncBlockDeviceRequest> FairIOScheduler::take_request_continuing(const AsyncBlockDeviceRequest& request, size_t max_block_count)
+{
+    // Riding along with a request that is being started anyway doesn't cost any other process its turn,
+    // so the next request of any process will do.
+    for (size_t queue_index = 0; queue_index < m_queues.size(); ++queue_index) {
+        auto& queue = m_queues[queue_index];
+        auto& next_request = queue.requests.first();
+        if (!request.can_merge(next_request) || next_request->block_count() > max_block_count)
+            continue;
+        auto taken_request = queue.requests.take_first();
+        if (queue.requests.is_empty()) {
+            m_queues.remove(queue_index);
+            if (m_next_queue_index > queue_index)
+                --m_next_queue_index;
+        }
+        return taken_request;
+    }
+    return {};
+}
+
+}
@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/OwnPtr.h>
+#include <AK/StringView.h>
+#include <AK/Time.h>
+#include <AK/Vector.h>
+#include <Kernel/Devices/BlockDevice.h>
+
+namespace Kernel {
+
+// An IOScheduler decides in which order the queued requests of a block device are started.
+// It only holds requests that haven't been started yet, and it's only ever called with the
+// request lock of its device held.
+class IOScheduler {
+public:
+    static OwnPtr<IOScheduler> create(const StringView& name);
+
+    virtual ~IOScheduler() = default;
+
+    virtual const char* name() const = 0;
+    virtual void queue_request(NonnullRefPtr<AsyncBlockDeviceRequest>) = 0;
+    virtual RefPtr<AsyncBlockDeviceRequest> take_next_request() = 0;
+    // Takes a queued request of no more than max_block_count blocks that can be merged into the given one,
+    // if there is one that can go now without breaking the order that the scheduler promises.
+    virtual RefPtr<AsyncBlockDeviceRequest> take_request_continuing(const AsyncBlockDeviceRequest&, size_t max_block_count) = 0;
+};
+
+// Starts requests in the order they were made.
+class FIFOIOScheduler final : public IOScheduler {
+public:
+    virtual const char* name() const override { return "fifo"; }
+    virtual void queue_request(NonnullRefPtr<AsyncBlockDeviceRequest>) override;
+    virtual RefPtr<AsyncBlockDeviceRequest> take_next_request() override;
+    virtual RefPtr<AsyncBlockDeviceRequest> take_request_continuing(const AsyncBlockDeviceRequest&, size_t max_block_count) override;
+
+private:
+    Vector<NonnullRefPtr<AsyncBlockDeviceRequest>> m_requests;
+};
+
+// Sweeps across the device in the direction of increasing block indices, so a request that
+// continues where the previous one ended is started right after it. Requests that have been
+// waiting for longer than their deadline go first, so a busy area can't starve the rest.
+class DeadlineIOScheduler final : public IOScheduler {
+public:
+    virtual const char* name() const override { return "deadline"; }
+    virtual void queue_request(NonnullRefPtr<AsyncBlockDeviceRequest>) override;
+    virtual RefPtr<AsyncBlockDeviceRequest> take_next_request() override;
+    virtual RefPtr<AsyncBlockDeviceRequest> take_request_continuing(const AsyncBlockDeviceRequest&, size_t max_block_count) override;
+
+private:
+    struct QueuedRequest {
+        NonnullRefPtr<AsyncBlockDeviceRequest> request;
+        Time deadline;
+    };
+
+    // Sorted by block index.
+    Vector<QueuedRequest> m_requests;
+    u64 m_next_block_index { 0 };
+};
+
+// Takes turns between the processes that have requests queued, so one process making lots of
+// requests can't hold up everyone else. The requests of each process start in the order they were made.
+class FairIOScheduler final : public IOScheduler {
+public:
+    virtual const char* name() const override { return "fair"; }
+    virtual void queue_request(NonnullRefPtr<AsyncBlockDeviceRequest>) override;
+    virtual RefPtr<AsyncBlockDeviceRequest> take_next_request() override;
+    virtual RefPtr<AsyncBlockDeviceRequest> take_request_continuing(const AsyncBlockDeviceRequest&, size_t max_block_count) override;
+
+private:
+    struct ProcessQueue {
+        ProcessID pid;
+        Vector<NonnullRefPtr<AsyncBlockDeviceRequest>> requests;
+    };
+
+    Vector<ProcessQueue> m_queues;
+    size_t m_next_queue_index { 0 };
+};
+
+}
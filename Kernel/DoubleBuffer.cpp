@@ -49,6 +49,33 @@ DoubleBuffer::DoubleBuffer(size_t capacity)
     m_space_for_writing = capacity;
 }
 
+bool DoubleBuffer::try_grow(size_t new_capacity)
+{
+    LOCKER(m_lock);
+    if (new_capacity <= m_capacity)
+        return true;
+    auto new_storage = KBuffer::try_create_with_size(new_capacity * 2, Region::Access::Read | Region::Access::Write, "DoubleBuffer");
+    if (!new_storage)
+        return false;
+
+    // Both halves hold at most the old capacity, so the unread part of the read buffer and the
+    // whole write buffer fit into their new counterparts as they are.
+    size_t unread_size = m_read_buffer->size - m_read_buffer_index;
+    u8* new_read_data = new_storage->data();
+    u8* new_write_data = new_storage->data() + new_capacity;
+    memcpy(new_read_data, m_read_buffer->data + m_read_buffer_index, unread_size);
+    memcpy(new_write_data, m_write_buffer->data, m_write_buffer->size);
+
+    m_read_buffer->data = new_read_data;
+    m_read_buffer->size = unread_size;
+    m_read_buffer_index = 0;
+    m_write_buffer->data = new_write_data;
+    m_storage = move(*new_storage);
+    m_capacity = new_capacity;
+    compute_lockfree_metadata();
+    return true;
+}
+
 void DoubleBuffer::flip()
 {
     if (m_storage.is_null())
@@ -53,6 +53,10 @@ public:
     bool is_empty() const { return m_empty; }
 
     size_t space_for_writing() const { return m_space_for_writing; }
+    size_t capacity() const { return m_capacity; }
+
+    // Moves the buffered data into larger storage. Returns false (and keeps the current storage) if that can't be allocated.
+    [[nodiscard]] bool try_grow(size_t new_capacity);
 
     void set_unblock_callback(Function<void()> callback)
     {
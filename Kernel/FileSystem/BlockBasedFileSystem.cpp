@@ -25,29 +25,51 @@
  */
 
 #include <AK/IntrusiveList.h>
+#include <AK/QuickSort.h>
 #include <Kernel/Debug.h>
 #include <Kernel/FileSystem/BlockBasedFileSystem.h>
 #include <Kernel/Process.h>
+#include <Kernel/Tasks/SyncTask.h>
+#include <Kernel/VM/MemoryManager.h>
 
 namespace Kernel {
 
 struct CacheEntry {
+    enum class List : u8 {
+        Free,
+        Probation,
+        Protected,
+        Dirty,
+    };
+
     IntrusiveListNode list_node;
     BlockBasedFS::BlockIndex block_index { 0 };
     u8* data { nullptr };
     bool has_data { false };
+    // Set for blocks brought in by a clustered read that haven't been asked for yet.
+    // Their first access doesn't count as a re-reference, so read-ahead can't flood the protected list.
+    bool is_prefetched { false };
+    List list { List::Free };
 };
 
+// The cache uses a 2Q-style replacement policy: Blocks that are accessed for the first time enter the probation
+// list, and are only promoted to the protected list once they are accessed again. Eviction prefers the probation
+// list, so a single large sequential read (e.g. a `cat` of a big file) can't push out hot filesystem metadata.
+// The cache is made up of segments, it grows while there is plenty of free memory and shrinks under pressure.
 class DiskCache {
 public:
+    static constexpr size_t entries_per_segment = 1024;
+    static constexpr size_t min_segment_count = 1;
+    static constexpr size_t max_segment_count = 64;
+    static constexpr size_t max_cluster_size = 64 * KiB;
+
     explicit DiskCache(BlockBasedFS& fs)
         : m_fs(fs)
-        , m_cached_block_data(KBuffer::create_with_size(m_entry_count * m_fs.block_size()))
-        , m_entries(KBuffer::create_with_size(m_entry_count * sizeof(CacheEntry)))
+        , m_cluster_buffer(KBuffer::create_with_size(max(max_cluster_size, fs.block_size()), Region::Access::Read | Region::Access::Write, "DiskCache cluster"))
     {
-        for (size_t i = 0; i < m_entry_count; ++i) {
-            entries()[i].data = m_cached_block_data.data() + i * m_fs.block_size();
-            m_clean_list.append(entries()[i]);
+        for (size_t i = 0; i < min_segment_count; ++i) {
+            // We need at least one segment to be able to operate at all.
+            VERIFY(try_grow());
         }
     }
 
@@ -59,19 +81,23 @@ public:
     void mark_all_clean()
     {
         while (auto* entry = m_dirty_list.first())
-            m_clean_list.prepend(*entry);
+            move_to_list(*entry, CacheEntry::List::Probation);
         m_dirty = false;
     }
 
     void mark_dirty(CacheEntry& entry)
     {
-        m_dirty_list.prepend(entry);
+        move_to_list(entry, CacheEntry::List::Dirty);
         m_dirty = true;
+
+        // Start writing back in the background well before we run out of clean entries.
+        if (m_dirty_count > entry_count() / 2)
+            SyncTask::request_sync();
     }
 
     void mark_clean(CacheEntry& entry)
     {
-        m_clean_list.prepend(entry);
+        move_to_list(entry, CacheEntry::List::Probation);
     }
 
     CacheEntry& get(BlockBasedFS::BlockIndex block_index) const
@@ -79,32 +105,124 @@ public:
         if (auto it = m_hash.find(block_index); it != m_hash.end()) {
             auto& entry = const_cast<CacheEntry&>(*it->value);
             VERIFY(entry.block_index == block_index);
+            ++m_hit_count;
+            if (entry.list != CacheEntry::List::Dirty) {
+                if (entry.is_prefetched) {
+                    entry.is_prefetched = false;
+                    move_to_list(entry, CacheEntry::List::Probation);
+                } else {
+                    move_to_list(entry, CacheEntry::List::Protected);
+                }
+            }
             return entry;
         }
 
-        if (m_clean_list.is_empty()) {
+        auto* new_entry = take_entry_for_reuse();
+        if (!new_entry) {
             // Not a single clean entry! Flush writes and try again.
             // NOTE: We want to make sure we only call FileBackedFS flush here,
             //       not some FileBackedFS subclass flush!
+            ++m_forced_flush_count;
             m_fs.flush_writes_impl();
             return get(block_index);
         }
 
-        VERIFY(m_clean_list.last());
-        auto& new_entry = *m_clean_list.last();
-        m_clean_list.prepend(new_entry);
+        ++m_miss_count;
+        move_to_list(*new_entry, CacheEntry::List::Probation);
+        m_hash.set(block_index, new_entry);
+
+        new_entry->block_index = block_index;
+        new_entry->has_data = false;
+        new_entry->is_prefetched = false;
+
+        return *new_entry;
+    }
+
+    bool has_data_for(BlockBasedFS::BlockIndex block_index) const
+    {
+        auto it = m_hash.find(block_index);
+        return it != m_hash.end() && it->value->has_data;
+    }
+
+    // Returns an entry to store a block that was read as part of a cluster, without counting it as an access.
+    // Unlike get(), this never forces a flush: If there's no clean entry to spare we simply don't cache the block.
+    CacheEntry* get_for_prefetch(BlockBasedFS::BlockIndex block_index) const
+    {
+        if (auto it = m_hash.find(block_index); it != m_hash.end()) {
+            auto* entry = it->value;
+            return entry->has_data ? nullptr : entry;
+        }
+
+        auto* new_entry = take_entry_for_reuse();
+        if (!new_entry)
+            return nullptr;
 
-        m_hash.remove(new_entry.block_index);
-        m_hash.set(block_index, &new_entry);
+        move_to_list(*new_entry, CacheEntry::List::Probation);
+        m_hash.set(block_index, new_entry);
 
-        new_entry.block_index = block_index;
-        new_entry.has_data = false;
+        new_entry->block_index = block_index;
+        new_entry->has_data = false;
+        new_entry->is_prefetched = true;
 
         return new_entry;
     }
 
-    const CacheEntry* entries() const { return (const CacheEntry*)m_entries.data(); }
-    CacheEntry* entries() { return (CacheEntry*)m_entries.data(); }
+    size_t blocks_per_cluster() const { return m_cluster_buffer.size() / m_fs.block_size(); }
+    u8* cluster_buffer() const { return m_cluster_buffer.data(); }
+
+    void did_clustered_read(size_t block_count) const
+    {
+        ++m_clustered_read_count;
+        m_clustered_block_count += block_count;
+    }
+
+    void did_clustered_write(size_t block_count) const
+    {
+        ++m_clustered_write_count;
+        m_clustered_block_count += block_count;
+    }
+
+    // Gives back whole segments (starting with the most recently added one) while the system is low on memory.
+    // This is meant to be called right after flushing all writes, segments that contain dirty entries are kept.
+    void shrink_if_under_memory_pressure()
+    {
+        while (m_segments.size() > min_segment_count && MM.is_low_on_user_physical_pages()) {
+            auto& last_segment = m_segments.last();
+            for (size_t i = 0; i < entries_per_segment; ++i) {
+                if (last_segment.entries()[i].list == CacheEntry::List::Dirty)
+                    return;
+            }
+
+            auto segment = m_segments.take_last();
+            for (size_t i = 0; i < entries_per_segment; ++i) {
+                auto& entry = segment.entries()[i];
+                if (entry.list != CacheEntry::List::Free)
+                    m_hash.remove(entry.block_index);
+                remove_from_list(entry);
+            }
+            ++m_shrink_count;
+        }
+    }
+
+    BlockBasedFS::CacheStatistics statistics() const
+    {
+        BlockBasedFS::CacheStatistics statistics;
+        statistics.entry_count = entry_count();
+        statistics.free_count = m_free_count;
+        statistics.probation_count = m_probation_count;
+        statistics.protected_count = m_protected_count;
+        statistics.dirty_count = m_dirty_count;
+        statistics.hit_count = m_hit_count;
+        statistics.miss_count = m_miss_count;
+        statistics.eviction_count = m_eviction_count;
+        statistics.forced_flush_count = m_forced_flush_count;
+        statistics.grow_count = m_grow_count;
+        statistics.shrink_count = m_shrink_count;
+        statistics.clustered_read_count = m_clustered_read_count;
+        statistics.clustered_write_count = m_clustered_write_count;
+        statistics.clustered_block_count = m_clustered_block_count;
+        return statistics;
+    }
 
     template<typename Callback>
     void for_each_dirty_entry(Callback callback)
@@ -114,13 +232,131 @@ public:
     }
 
 private:
+    struct Segment {
+        NonnullOwnPtr<KBuffer> block_data;
+        NonnullOwnPtr<KBuffer> entry_data;
+
+        CacheEntry* entries() { return (CacheEntry*)entry_data->data(); }
+    };
+
+    size_t entry_count() const { return m_segments.size() * entries_per_segment; }
+
+    bool try_grow() const
+    {
+        if (m_segments.size() >= max_segment_count)
+            return false;
+
+        auto block_data = KBuffer::try_create_with_size(entries_per_segment * m_fs.block_size(), Region::Access::Read | Region::Access::Write, "DiskCache");
+        if (!block_data)
+            return false;
+        auto entry_data = KBuffer::try_create_with_size(entries_per_segment * sizeof(CacheEntry), Region::Access::Read | Region::Access::Write, "DiskCache entries");
+        if (!entry_data)
+            return false;
+
+        m_segments.append({ block_data.release_nonnull(), entry_data.release_nonnull() });
+        auto& segment = m_segments.last();
+        for (size_t i = 0; i < entries_per_segment; ++i) {
+            auto& entry = segment.entries()[i];
+            entry.data = segment.block_data->data() + i * m_fs.block_size();
+            entry.list = CacheEntry::List::Free;
+            m_free_list.append(entry);
+            ++m_free_count;
+        }
+        ++m_grow_count;
+        return true;
+    }
+
+    CacheEntry* take_entry_for_reuse() const
+    {
+        if (auto* entry = m_free_list.first())
+            return entry;
+
+        if (MM.has_plenty_of_free_user_physical_pages() && try_grow())
+            return m_free_list.first();
+
+        // Keep roughly a quarter of the clean entries on probation, anything beyond that was only used once
+        // and is the first to go. If the probation list is too short we evict the least recently used protected entry.
+        CacheEntry* victim = nullptr;
+        if (m_probation_count > 0 && (m_probation_count * 4 >= m_probation_count + m_protected_count || m_protected_count == 0))
+            victim = m_probation_list.last();
+        else
+            victim = m_protected_list.last();
+
+        if (!victim)
+            return nullptr;
+
+        ++m_eviction_count;
+        m_hash.remove(victim->block_index);
+        return victim;
+    }
+
+    void remove_from_list(CacheEntry& entry) const
+    {
+        switch (entry.list) {
+        case CacheEntry::List::Free:
+            m_free_list.remove(entry);
+            --m_free_count;
+            break;
+        case CacheEntry::List::Probation:
+            m_probation_list.remove(entry);
+            --m_probation_count;
+            break;
+        case CacheEntry::List::Protected:
+            m_protected_list.remove(entry);
+            --m_protected_count;
+            break;
+        case CacheEntry::List::Dirty:
+            m_dirty_list.remove(entry);
+            --m_dirty_count;
+            break;
+        }
+    }
+
+    void move_to_list(CacheEntry& entry, CacheEntry::List list) const
+    {
+        remove_from_list(entry);
+        entry.list = list;
+        switch (list) {
+        case CacheEntry::List::Free:
+            m_free_list.prepend(entry);
+            ++m_free_count;
+            break;
+        case CacheEntry::List::Probation:
+            m_probation_list.prepend(entry);
+            ++m_probation_count;
+            break;
+        case CacheEntry::List::Protected:
+            m_protected_list.prepend(entry);
+            ++m_protected_count;
+            break;
+        case CacheEntry::List::Dirty:
+            m_dirty_list.prepend(entry);
+            ++m_dirty_count;
+            break;
+        }
+    }
+
     BlockBasedFS& m_fs;
-    size_t m_entry_count { 10000 };
+    mutable KBuffer m_cluster_buffer;
+    mutable Vector<Segment> m_segments;
     mutable HashMap<BlockBasedFS::BlockIndex, CacheEntry*> m_hash;
-    mutable IntrusiveList<CacheEntry, &CacheEntry::list_node> m_clean_list;
+    mutable IntrusiveList<CacheEntry, &CacheEntry::list_node> m_free_list;
+    mutable IntrusiveList<CacheEntry, &CacheEntry::list_node> m_probation_list;
+    mutable IntrusiveList<CacheEntry, &CacheEntry::list_node> m_protected_list;
     mutable IntrusiveList<CacheEntry, &CacheEntry::list_node> m_dirty_list;
-    KBuffer m_cached_block_data;
-    KBuffer m_entries;
+    mutable size_t m_free_count { 0 };
+    mutable size_t m_probation_count { 0 };
+    mutable size_t m_protected_count { 0 };
+    mutable size_t m_dirty_count { 0 };
+    mutable u64 m_hit_count { 0 };
+    mutable u64 m_miss_count { 0 };
+    mutable u64 m_eviction_count { 0 };
+    mutable u64 m_forced_flush_count { 0 };
+    mutable u64 m_grow_count { 0 };
+    u64 m_shrink_count { 0 };
+    mutable u64 m_clustered_read_count { 0 };
+    mutable u64 m_clustered_write_count { 0 };
+    mutable u64 m_clustered_block_count { 0 };
     bool m_dirty { false };
 };
 
@@ -196,25 +432,50 @@ bool BlockBasedFS::raw_write(BlockIndex index, const UserOrKernelBuffer& buffer)
 bool BlockBasedFS::raw_read_blocks(BlockIndex index, size_t count, UserOrKernelBuffer& buffer)
 {
     LOCKER(m_lock);
-    auto current = buffer;
-    for (unsigned block = index.value(); block < (index.value() + count); block++) {
-        if (!raw_read(BlockIndex { block }, current))
-            return false;
-        current = current.offset(logical_block_size());
-    }
-    return true;
+    return !read_from_device(index.value() * m_logical_block_size, buffer, count * m_logical_block_size).is_error();
 }
 
 bool BlockBasedFS::raw_write_blocks(BlockIndex index, size_t count, const UserOrKernelBuffer& buffer)
 {
     LOCKER(m_lock);
-    auto current = buffer;
-    for (unsigned block = index.value(); block < (index.value() + count); block++) {
-        if (!raw_write(block, current))
-            return false;
-        current = current.offset(logical_block_size());
+    return !write_to_device(index.value() * m_logical_block_size, buffer, count * m_logical_block_size).is_error();
+}
+
+// The underlying device may transfer less than we asked for in one go (storage devices stop at
+// the most their driver can take in a single request), so keep going until the whole range has been transferred.
+KResult BlockBasedFS::read_from_device(u64 offset, UserOrKernelBuffer& buffer, size_t size) const
+{
+    auto seek_result = file_description().seek(offset, SEEK_SET);
+    if (seek_result.is_error())
+        return seek_result.error();
+    size_t nread_total = 0;
+    while (nread_total < size) {
+        auto chunk = buffer.offset(nread_total);
+        auto nread = file_description().read(chunk, size - nread_total);
+        if (nread.is_error())
+            return nread.error();
+        if (nread.value() == 0)
+            return EIO;
+        nread_total += nread.value();
     }
-    return true;
+    return KSuccess;
+}
+
+KResult BlockBasedFS::write_to_device(u64 offset, const UserOrKernelBuffer& buffer, size_t size) const
+{
+    auto seek_result = file_description().seek(offset, SEEK_SET);
+    if (seek_result.is_error())
+        return seek_result.error();
+    size_t nwritten_total = 0;
+    while (nwritten_total < size) {
+        auto nwritten = file_description().write(buffer.offset(nwritten_total), size - nwritten_total);
+        if (nwritten.is_error())
+            return nwritten.error();
+        if (nwritten.value() == 0)
+            return EIO;
+        nwritten_total += nwritten.value();
+    }
+    return KSuccess;
 }
 
 KResult BlockBasedFS::write_blocks(BlockIndex index, unsigned count, const UserOrKernelBuffer& data, bool allow_cache)
@@ -276,6 +537,17 @@ KResult BlockBasedFS::read_blocks(BlockIndex index, unsigned count, UserOrKernel
         return EINVAL;
     if (count == 1)
         return read_block(index, &buffer, block_size(), 0, allow_cache);
+
+    if (!allow_cache) {
+        for (unsigned i = 0; i < count; ++i)
+            const_cast<BlockBasedFS*>(this)->flush_specific_block_if_needed(BlockIndex { index.value() + i });
+        return read_from_device(index.value() * block_size(), buffer, count * block_size());
+    }
+
+    auto result = prefetch_blocks(index, count);
+    if (result.is_error())
+        return result;
+
     auto out = buffer;
     for (unsigned i = 0; i < count; ++i) {
         auto result = read_block(BlockIndex { index.value() + i }, &out, block_size(), 0, allow_cache);
@@ -287,6 +559,44 @@ KResult BlockBasedFS::read_blocks(BlockIndex index, unsigned count, UserOrKernel
     return KSuccess;
 }
 
+KResult BlockBasedFS::prefetch_blocks(BlockIndex index, size_t count) const
+{
+    LOCKER(m_lock);
+    VERIFY(m_logical_block_size);
+    auto blocks_per_cluster = cache().blocks_per_cluster();
+    auto* cluster_buffer = cache().cluster_buffer();
+
+    size_t i = 0;
+    while (i < count) {
+        if (cache().has_data_for(BlockIndex { index.value() + i })) {
+            ++i;
+            continue;
+        }
+
+        size_t run_length = 1;
+        while (i + run_length < count && run_length < blocks_per_cluster && !cache().has_data_for(BlockIndex { index.value() + i + run_length }))
+            ++run_length;
+
+        auto cluster_buffer_wrapper = UserOrKernelBuffer::for_kernel_buffer(cluster_buffer);
+        auto result = read_from_device((index.value() + i) * block_size(), cluster_buffer_wrapper, run_length * block_size());
+        if (result.is_error())
+            return result;
+        cache().did_clustered_read(run_length);
+
+        for (size_t j = 0; j < run_length; ++j) {
+            auto* entry = cache().get_for_prefetch(BlockIndex { index.value() + i + j });
+            if (!entry) {
+                // Out of clean entries, whatever is left will be read on demand.
+                return KSuccess;
+            }
+            memcpy(entry->data, cluster_buffer + j * block_size(), block_size());
+            entry->has_data = true;
+        }
+        i += run_length;
+    }
+    return KSuccess;
+}
+
 void BlockBasedFS::flush_specific_block_if_needed(BlockIndex index)
 {
     LOCKER(m_lock);
@@ -315,23 +625,51 @@ void BlockBasedFS::flush_writes_impl()
     LOCKER(m_lock);
     if (!cache().is_dirty())
         return;
-    u32 count = 0;
+
+    Vector<CacheEntry*> dirty_entries;
     cache().for_each_dirty_entry([&](CacheEntry& entry) {
-        u32 base_offset = entry.block_index.value() * block_size();
-        auto seek_result = file_description().seek(base_offset, SEEK_SET);
-        VERIFY(!seek_result.is_error());
-        // FIXME: Should this error path be surfaced somehow?
-        auto entry_data_buffer = UserOrKernelBuffer::for_kernel_buffer(entry.data);
-        [[maybe_unused]] auto rc = file_description().write(entry_data_buffer, block_size());
-        ++count;
+        dirty_entries.append(&entry);
     });
+    quick_sort(dirty_entries, [](auto* a, auto* b) { return a->block_index < b->block_index; });
+
+    // Runs of consecutive dirty blocks are written back with a single device request each.
+    auto blocks_per_cluster = cache().blocks_per_cluster();
+    auto* cluster_buffer = cache().cluster_buffer();
+    for (size_t i = 0; i < dirty_entries.size();) {
+        auto first_block_index = dirty_entries[i]->block_index.value();
+        size_t run_length = 1;
+        while (i + run_length < dirty_entries.size() && run_length < blocks_per_cluster && dirty_entries[i + run_length]->block_index.value() == first_block_index + run_length)
+            ++run_length;
+
+        // FIXME: Should this error path be surfaced somehow?
+        if (run_length == 1) {
+            auto entry_data_buffer = UserOrKernelBuffer::for_kernel_buffer(dirty_entries[i]->data);
+            [[maybe_unused]] auto rc = write_to_device(first_block_index * block_size(), entry_data_buffer, block_size());
+        } else {
+            for (size_t j = 0; j < run_length; ++j)
+                memcpy(cluster_buffer + j * block_size(), dirty_entries[i + j]->data, block_size());
+            auto cluster_buffer_wrapper = UserOrKernelBuffer::for_kernel_buffer(cluster_buffer);
+            [[maybe_unused]] auto rc = write_to_device(first_block_index * block_size(), cluster_buffer_wrapper, run_length * block_size());
+            cache().did_clustered_write(run_length);
+        }
+        i += run_length;
+    }
     cache().mark_all_clean();
-    dbgln("{}: Flushed {} blocks to disk", class_name(), count);
+    dbgln("{}: Flushed {} blocks to disk", class_name(), dirty_entries.size());
 }
 
 void BlockBasedFS::flush_writes()
 {
     flush_writes_impl();
+
+    LOCKER(m_lock);
+    cache().shrink_if_under_memory_pressure();
+}
+
+BlockBasedFS::CacheStatistics BlockBasedFS::cache_statistics() const
+{
+    LOCKER(m_lock);
+    return cache().statistics();
 }
 
 DiskCache& BlockBasedFS::cache() const
@@ -41,12 +41,36 @@ public:
     virtual void flush_writes() override;
     void flush_writes_impl();
 
+    virtual bool is_block_based() const override { return true; }
+
+    struct CacheStatistics {
+        size_t entry_count { 0 };
+        size_t free_count { 0 };
+        size_t probation_count { 0 };
+        size_t protected_count { 0 };
+        size_t dirty_count { 0 };
+        u64 hit_count { 0 };
+        u64 miss_count { 0 };
+        u64 eviction_count { 0 };
+        u64 forced_flush_count { 0 };
+        u64 grow_count { 0 };
+        u64 shrink_count { 0 };
+        u64 clustered_read_count { 0 };
+        u64 clustered_write_count { 0 };
+        u64 clustered_block_count { 0 };
+    };
+    CacheStatistics cache_statistics() const;
+
 protected:
     explicit BlockBasedFS(FileDescription&);
 
     KResult read_block(BlockIndex, UserOrKernelBuffer*, size_t count, size_t offset = 0, bool allow_cache = true) const;
     KResult read_blocks(BlockIndex, unsigned count, UserOrKernelBuffer&, bool allow_cache = true) const;
 
+    // Brings any of the blocks in the range that aren't cached yet into the cache, coalescing
+    // runs of consecutive missing blocks into as few device requests as possible.
+    KResult prefetch_blocks(BlockIndex, size_t count) const;
+
     bool raw_read(BlockIndex, UserOrKernelBuffer&);
     bool raw_write(BlockIndex, const UserOrKernelBuffer&);
 
@@ -60,6 +84,8 @@ protected:
 
 private:
     DiskCache& cache() const;
+    KResult read_from_device(u64 offset, UserOrKernelBuffer&, size_t size) const;
+    KResult write_to_device(u64 offset, const UserOrKernelBuffer&, size_t size) const;
     void flush_specific_block_if_needed(BlockIndex index);
 
     mutable OwnPtr<DiskCache> m_cache;
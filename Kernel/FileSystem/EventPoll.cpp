@@ -0,0 +1,228 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <Kernel/FileSystem/EventPoll.h>
+#include <Kernel/FileSystem/FileDescription.h>
+
+namespace Kernel {
+
+using BlockFlags = Thread::FileBlocker::BlockFlags;
+
+NonnullRefPtr<EventPoll> EventPoll::create()
+{
+    return adopt(*new EventPoll);
+}
+
+EventPoll::EventPoll()
+{
+}
+
+EventPoll::~EventPoll()
+{
+    // The entries unlink themselves from the ready list, so they must go
+    // before the list and its lock do.
+    m_entries.clear();
+}
+
+bool EventPoll::can_read(const FileDescription&, size_t) const
+{
+    ScopedSpinLock lock(m_ready_lock);
+    return !m_ready_list.is_empty();
+}
+
+KResult EventPoll::add(int fd, FileDescription& description, const epoll_event& event)
+{
+    // Watching another EventPoll could create reference cycles, so we don't allow it.
+    if (description.file().is_event_poll())
+        return EINVAL;
+
+    Locker locker(m_lock);
+    if (auto it = m_entries.find(fd); it != m_entries.end()) {
+        if (it->value->m_description.ptr() == &description)
+            return EEXIST;
+        // The fd was closed and reused without being removed from the set.
+        m_entries.remove(it);
+    }
+    add_entry(fd, description, event);
+    return KSuccess;
+}
+
+KResult EventPoll::modify(int fd, FileDescription& description, const epoll_event& event)
+{
+    Locker locker(m_lock);
+    auto it = m_entries.find(fd);
+    if (it == m_entries.end())
+        return ENOENT;
+
+    auto& entry = *it->value;
+    if (entry.m_description.ptr() != &description) {
+        m_entries.remove(it);
+        add_entry(fd, description, event);
+        return KSuccess;
+    }
+
+    {
+        ScopedSpinLock lock(m_ready_lock);
+        entry.m_event = event;
+        entry.m_is_disabled = false;
+    }
+    // Re-arming should report an fd that is already ready, also for edge-triggered entries.
+    if (entry.ready_events() != 0)
+        did_become_ready(entry);
+    return KSuccess;
+}
+
+KResult EventPoll::remove(int fd)
+{
+    Locker locker(m_lock);
+    if (!m_entries.remove(fd))
+        return ENOENT;
+    return KSuccess;
+}
+
+void EventPoll::add_entry(int fd, FileDescription& description, const epoll_event& event)
+{
+    VERIFY(m_lock.is_locked());
+    auto entry = make<Entry>(*this, fd, description, event);
+    auto& entry_ref = *entry;
+    m_entries.set(fd, move(entry));
+
+    // This immediately evaluates the description, so an fd that is already
+    // ready ends up on the ready list right away.
+    bool was_added = description.block_condition().add_blocker(entry_ref, nullptr);
+    VERIFY(was_added);
+}
+
+void EventPoll::did_become_ready(Entry& entry)
+{
+    {
+        ScopedSpinLock lock(m_ready_lock);
+        if (entry.m_is_disabled || entry.m_ready_list_node.is_in_list())
+            return;
+        m_ready_list.append(entry);
+    }
+    evaluate_block_conditions();
+}
+
+void EventPoll::collect_ready_events(Vector<epoll_event>& events, size_t max_events)
+{
+    Locker locker(m_lock);
+
+    Vector<Entry*, 32> entries_to_requeue;
+    Vector<int, 32> orphaned_fds;
+    while (events.size() < max_events) {
+        Entry* entry;
+        {
+            ScopedSpinLock lock(m_ready_lock);
+            entry = m_ready_list.take_first();
+        }
+        if (!entry)
+            break;
+
+        // If we hold the only reference, every fd for this description has
+        // been closed. Drop it now, like closing the last fd would on Linux.
+        if (entry->m_description->ref_count() == 1) {
+            orphaned_fds.append(entry->m_fd);
+            continue;
+        }
+
+        // Readiness may have gone away since the entry was queued.
+        auto ready_events = entry->ready_events();
+        if (ready_events == 0)
+            continue;
+
+        events.append({ ready_events, entry->m_event.data });
+
+        if (entry->m_event.events & EPOLLONESHOT) {
+            ScopedSpinLock lock(m_ready_lock);
+            entry->m_is_disabled = true;
+            if (entry->m_ready_list_node.is_in_list())
+                m_ready_list.remove(*entry);
+        } else if (!(entry->m_event.events & EPOLLET)) {
+            // Level-triggered entries stay on the list for as long as they are ready.
+            entries_to_requeue.append(entry);
+        }
+    }
+
+    {
+        ScopedSpinLock lock(m_ready_lock);
+        for (auto* entry : entries_to_requeue) {
+            if (!entry->m_ready_list_node.is_in_list())
+                m_ready_list.append(*entry);
+        }
+    }
+
+    for (auto fd : orphaned_fds)
+        m_entries.remove(fd);
+}
+
+EventPoll::Entry::Entry(EventPoll& event_poll, int fd, FileDescription& description, const epoll_event& event)
+    : m_event_poll(event_poll)
+    , m_fd(fd)
+    , m_description(description)
+    , m_event(event)
+{
+}
+
+EventPoll::Entry::~Entry()
+{
+    // Once we're off the block condition, unblock() can't race with us anymore.
+    m_description->block_condition().remove_blocker(*this, nullptr);
+
+    ScopedSpinLock lock(m_event_poll.m_ready_lock);
+    if (m_ready_list_node.is_in_list())
+        m_event_poll.m_ready_list.remove(*this);
+}
+
+bool EventPoll::Entry::unblock(bool, void*)
+{
+    if (ready_events() != 0)
+        m_event_poll.did_become_ready(*this);
+
+    // Never let the block condition drop us, we want to hear about every change.
+    return false;
+}
+
+u32 EventPoll::Entry::ready_events() const
+{
+    auto block_flags = BlockFlags::None;
+    if (m_event.events & EPOLLIN)
+        block_flags |= BlockFlags::Read;
+    if (m_event.events & EPOLLOUT)
+        block_flags |= BlockFlags::Write;
+    if (block_flags == BlockFlags::None)
+        return 0;
+
+    auto unblock_flags = m_description->should_unblock(block_flags);
+    u32 ready_events = 0;
+    if (has_flag(unblock_flags, BlockFlags::Read))
+        ready_events |= EPOLLIN;
+    if (has_flag(unblock_flags, BlockFlags::Write))
+        ready_events |= EPOLLOUT;
+    return ready_events;
+}
+
+}
@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/HashMap.h>
+#include <AK/IntrusiveList.h>
+#include <AK/NonnullOwnPtr.h>
+#include <Kernel/FileSystem/File.h>
+#include <Kernel/Lock.h>
+#include <Kernel/Thread.h>
+
+namespace Kernel {
+
+// EventPoll is a persistent interest set of file descriptions, created by
+// epoll_create1(). Every entry stays registered with the block condition of
+// its file, so readiness changes are pushed onto a ready list as they happen.
+// Waiting on an EventPoll only visits the entries on that list, no matter how
+// many descriptions are being watched.
+class EventPoll final : public File {
+public:
+    static NonnullRefPtr<EventPoll> create();
+    virtual ~EventPoll() override;
+
+    KResult add(int fd, FileDescription&, const epoll_event&);
+    KResult modify(int fd, FileDescription&, const epoll_event&);
+    KResult remove(int fd);
+
+    void collect_ready_events(Vector<epoll_event>&, size_t max_events);
+
+    virtual bool is_event_poll() const override { return true; }
+    virtual bool can_read(const FileDescription&, size_t) const override;
+    virtual bool can_write(const FileDescription&, size_t) const override { return false; }
+    virtual KResultOr<size_t> read(FileDescription&, u64, UserOrKernelBuffer&, size_t) override { return EINVAL; }
+    virtual KResultOr<size_t> write(FileDescription&, u64, const UserOrKernelBuffer&, size_t) override { return EINVAL; }
+    virtual String absolute_path(const FileDescription&) const override { return "epoll"; }
+    virtual const char* class_name() const override { return "EventPoll"; }
+
+private:
+    class Entry final : public Thread::FileBlocker {
+    public:
+        Entry(EventPoll&, int fd, FileDescription&, const epoll_event&);
+        virtual ~Entry() override;
+
+        virtual const char* state_string() const override { return "Polling"; }
+        virtual void not_blocking(bool) override { }
+        virtual bool unblock(bool, void*) override;
+
+        u32 ready_events() const;
+
+        EventPoll& m_event_poll;
+        const int m_fd;
+        NonnullRefPtr<FileDescription> m_description;
+        epoll_event m_event;
+        bool m_is_disabled { false };
+        IntrusiveListNode m_ready_list_node;
+    };
+
+    EventPoll();
+
+    void add_entry(int fd, FileDescription&, const epoll_event&);
+    void did_become_ready(Entry&);
+
+    Lock m_lock { "EventPoll" };
+    HashMap<int, NonnullOwnPtr<Entry>> m_entries;
+
+    mutable SpinLock<u8> m_ready_lock;
+    IntrusiveList<Entry, &Entry::m_ready_list_node> m_ready_list;
+};
+
+}
@@ -891,7 +891,13 @@ ssize_t Ext2FSInode::read_bytes(off_t offset, ssize_t count, UserOrKernelBuffer&
 
     dbgln_if(EXT2_VERY_DEBUG, "Ext2FSInode[{}]::read_bytes(): Reading up to {} bytes, {} bytes into inode to {}", identifier(), count, offset, buffer.user_or_kernel_ptr());
 
+    size_t prefetched_block_logical_index_end = first_block_logical_index.value();
+    if (allow_cache)
+        update_read_ahead_size(offset);
+
     for (auto bi = first_block_logical_index; remaining_count && bi <= last_block_logical_index; bi = bi.value() + 1) {
+        if (allow_cache && bi.value() >= prefetched_block_logical_index_end)
+            prefetched_block_logical_index_end = prefetch_blocks_for_read(bi.value(), last_block_logical_index.value());
         auto block_index = m_block_list[bi.value()];
         VERIFY(block_index.value());
         size_t offset_into_block = (bi == first_block_logical_index) ? offset_into_first_block : 0;
@@ -906,9 +912,47 @@ ssize_t Ext2FSInode::read_bytes(off_t offset, ssize_t count, UserOrKernelBuffer&
         nread += num_bytes_to_copy;
     }
 
+    m_next_sequential_read_offset = offset + nread;
     return nread;
 }
 
+// Sequential readers get a growing window of blocks beyond the current request read into the disk cache ahead of time.
+void Ext2FSInode::update_read_ahead_size(off_t offset) const
+{
+    VERIFY(m_lock.is_locked());
+    if (offset == m_next_sequential_read_offset)
+        m_read_ahead_size = clamp(m_read_ahead_size * 2, min_read_ahead_size, max_read_ahead_size);
+    else
+        m_read_ahead_size = 0;
+}
+
+// Together with the read-ahead window, the blocks of a request are prefetched in physically contiguous runs,
+// so a large read doesn't turn into one device request per block. No more than max_read_ahead_size is
+// prefetched at a time, so a huge read doesn't flush the whole disk cache before it gets to use the blocks.
+// Returns the logical index of the block after the last one prefetched.
+size_t Ext2FSInode::prefetch_blocks_for_read(size_t first_block_logical_index, size_t last_block_logical_index) const
+{
+    VERIFY(m_lock.is_locked());
+    size_t end_block_logical_index = min(last_block_logical_index + 1 + m_read_ahead_size / fs().block_size(), m_block_list.size());
+    end_block_logical_index = min(end_block_logical_index, first_block_logical_index + max_read_ahead_size / fs().block_size());
+    size_t run_start = first_block_logical_index;
+    while (run_start < end_block_logical_index) {
+        auto first_block_index = m_block_list[run_start];
+        if (!first_block_index.value()) {
+            ++run_start;
+            continue;
+        }
+        size_t run_length = 1;
+        while (run_start + run_length < end_block_logical_index && m_block_list[run_start + run_length].value() == first_block_index.value() + run_length)
+            ++run_length;
+
+        // Any failure here will surface again when the blocks are actually read.
+        [[maybe_unused]] auto result = fs().prefetch_blocks(first_block_index, run_length);
+        run_start += run_length;
+    }
+    return end_block_logical_index;
+}
+
 KResult Ext2FSInode::resize(u64 new_size)
 {
     auto old_size = size();
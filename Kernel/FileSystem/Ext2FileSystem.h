@@ -91,6 +91,8 @@ private:
     Vector<BlockBasedFS::BlockIndex> compute_block_list_with_meta_blocks() const;
     Vector<BlockBasedFS::BlockIndex> compute_block_list_impl(bool include_block_list_blocks) const;
     Vector<BlockBasedFS::BlockIndex> compute_block_list_impl_internal(const ext2_inode& e2inode, bool include_block_list_blocks) const;
+    void update_read_ahead_size(off_t offset) const;
+    size_t prefetch_blocks_for_read(size_t first_block_logical_index, size_t last_block_logical_index) const;
 
     Ext2FS& fs();
     const Ext2FS& fs() const;
@@ -99,6 +101,12 @@ private:
     mutable Vector<BlockBasedFS::BlockIndex> m_block_list;
     mutable HashMap<String, InodeIndex> m_lookup_cache;
     ext2_inode m_raw_inode;
+
+    static constexpr size_t min_read_ahead_size = 16 * KiB;
+    static constexpr size_t max_read_ahead_size = 128 * KiB;
+    // Protected by m_lock.
+    mutable off_t m_next_sequential_read_offset { 0 };
+    mutable size_t m_read_ahead_size { 0 };
 };
 
 class Ext2FS final : public BlockBasedFS {
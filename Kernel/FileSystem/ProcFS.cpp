@@ -37,6 +37,7 @@
 #include <Kernel/Debug.h>
 #include <Kernel/Devices/BlockDevice.h>
 #include <Kernel/Devices/KeyboardDevice.h>
+#include <Kernel/FileSystem/BlockBasedFileSystem.h>
 #include <Kernel/FileSystem/Custody.h>
 #include <Kernel/FileSystem/FileBackedFileSystem.h>
 #include <Kernel/FileSystem/FileDescription.h>
@@ -50,6 +51,7 @@
 #include <Kernel/Module.h>
 #include <Kernel/Net/LocalSocket.h>
 #include <Kernel/Net/NetworkAdapter.h>
+#include <Kernel/Net/NetworkTask.h>
 #include <Kernel/Net/Routing.h>
 #include <Kernel/Net/TCPSocket.h>
 #include <Kernel/Net/UDPSocket.h>
@@ -84,6 +86,7 @@ enum ProcFileType {
 
     __FI_Root_Start,
     FI_Root_df,
+    FI_Root_diskcache,
     FI_Root_all,
     FI_Root_memstat,
     FI_Root_cpuinfo,
@@ -110,6 +113,7 @@ enum ProcFileType {
     FI_Root_net_tcp,
     FI_Root_net_udp,
     FI_Root_net_local,
+    FI_Root_net_workers,
 
     FI_PID,
 
@@ -321,31 +325,31 @@ static bool procfs$pid_vm(InodeIdentifier identifier, KBufferBuilder& builder)
     {
         ScopedSpinLock lock(process->space().get_lock());
         for (auto& region : process->space().regions()) {
-            if (!region.is_user() && !Process::current()->is_superuser())
+            if (!region->is_user() && !Process::current()->is_superuser())
                 continue;
             auto region_object = array.add_object();
-            region_object.add("readable", region.is_readable());
-            region_object.add("writable", region.is_writable());
-            region_object.add("executable", region.is_executable());
-            region_object.add("stack", region.is_stack());
-            region_object.add("shared", region.is_shared());
-            region_object.add("syscall", region.is_syscall_region());
-            region_object.add("purgeable", region.vmobject().is_anonymous());
-            if (region.vmobject().is_anonymous()) {
-                region_object.add("volatile", static_cast<const AnonymousVMObject&>(region.vmobject()).is_any_volatile());
+            region_object.add("readable", region->is_readable());
+            region_object.add("writable", region->is_writable());
+            region_object.add("executable", region->is_executable());
+            region_object.add("stack", region->is_stack());
+            region_object.add("shared", region->is_shared());
+            region_object.add("syscall", region->is_syscall_region());
+            region_object.add("purgeable", region->vmobject().is_anonymous());
+            if (region->vmobject().is_anonymous()) {
+                region_object.add("volatile", static_cast<const AnonymousVMObject&>(region->vmobject()).is_any_volatile());
             }
-            region_object.add("cacheable", region.is_cacheable());
-            region_object.add("address", region.vaddr().get());
-            region_object.add("size", region.size());
-            region_object.add("amount_resident", region.amount_resident());
-            region_object.add("amount_dirty", region.amount_dirty());
-            region_object.add("cow_pages", region.cow_pages());
-            region_object.add("name", region.name());
-            region_object.add("vmobject", region.vmobject().class_name());
+            region_object.add("cacheable", region->is_cacheable());
+            region_object.add("address", region->vaddr().get());
+            region_object.add("size", region->size());
+            region_object.add("amount_resident", region->amount_resident());
+            region_object.add("amount_dirty", region->amount_dirty());
+            region_object.add("cow_pages", region->cow_pages());
+            region_object.add("name", region->name());
+            region_object.add("vmobject", region->vmobject().class_name());
 
             StringBuilder pagemap_builder;
-            for (size_t i = 0; i < region.page_count(); ++i) {
-                auto* page = region.physical_page(i);
+            for (size_t i = 0; i < region->page_count(); ++i) {
+                auto* page = region->physical_page(i);
                 if (!page)
                     pagemap_builder.append('N');
                 else if (page->is_shared_zero_page() || page->is_lazy_committed_page())
@@ -549,6 +553,13 @@ static bool procfs$net_tcp(InodeIdentifier, KBufferBuilder& builder)
         obj.add("bytes_in", socket.bytes_in());
         obj.add("packets_out", socket.packets_out());
         obj.add("bytes_out", socket.bytes_out());
+        obj.add("retransmissions", socket.retransmissions());
+        obj.add("congestion_control", socket.congestion_control_name());
+        obj.add("congestion_window", socket.congestion_window());
+        obj.add("slow_start_threshold", socket.slow_start_threshold());
+        obj.add("smoothed_rtt_us", socket.smoothed_round_trip_time_us());
+        obj.add("window_scaling", socket.is_window_scaling_enabled());
+        obj.add("sack", socket.is_sack_enabled());
     });
     array.finish();
     return true;
@@ -585,6 +596,21 @@ static bool procfs$net_local(InodeIdentifier, KBufferBuilder& builder)
     return true;
 }
 
+static bool procfs$net_workers(InodeIdentifier, KBufferBuilder& builder)
+{
+    JsonArraySerializer array { builder };
+    NetworkTask::for_each_worker([&array](auto& statistics) {
+        auto obj = array.add_object();
+        obj.add("index", statistics.index);
+        obj.add("affinity", statistics.affinity);
+        obj.add("packets", statistics.packet_count);
+        obj.add("bytes", statistics.byte_count);
+        obj.add("wakeups", statistics.wakeup_count);
+    });
+    array.finish();
+    return true;
+}
+
 static bool procfs$pid_unveil(InodeIdentifier identifier, KBufferBuilder& builder)
 {
     auto process = Process::from_pid(to_pid(identifier));
@@ -700,6 +726,38 @@ static bool procfs$df(InodeIdentifier, KBufferBuilder& builder)
     return true;
 }
 
+static bool procfs$diskcache(InodeIdentifier, KBufferBuilder& builder)
+{
+    // FIXME: This is obviously racy against the VFS mounts changing.
+    JsonArraySerializer array { builder };
+    VFS::the().for_each_mount([&array](auto& mount) {
+        auto& fs = mount.guest_fs();
+        if (!fs.is_block_based())
+            return;
+        auto statistics = static_cast<const BlockBasedFS&>(fs).cache_statistics();
+        auto fs_object = array.add_object();
+        fs_object.add("class_name", fs.class_name());
+        fs_object.add("mount_point", mount.absolute_path());
+        fs_object.add("block_size", static_cast<u64>(fs.block_size()));
+        fs_object.add("entry_count", statistics.entry_count);
+        fs_object.add("free_count", statistics.free_count);
+        fs_object.add("probation_count", statistics.probation_count);
+        fs_object.add("protected_count", statistics.protected_count);
+        fs_object.add("dirty_count", statistics.dirty_count);
+        fs_object.add("hit_count", statistics.hit_count);
+        fs_object.add("miss_count", statistics.miss_count);
+        fs_object.add("eviction_count", statistics.eviction_count);
+        fs_object.add("forced_flush_count", statistics.forced_flush_count);
+        fs_object.add("grow_count", statistics.grow_count);
+        fs_object.add("shrink_count", statistics.shrink_count);
+        fs_object.add("clustered_read_count", statistics.clustered_read_count);
+        fs_object.add("clustered_write_count", statistics.clustered_write_count);
+        fs_object.add("clustered_block_count", statistics.clustered_block_count);
+    });
+    array.finish();
+    return true;
+}
+
 static bool procfs$cpuinfo(InodeIdentifier, KBufferBuilder& builder)
 {
     JsonArraySerializer array { builder };
@@ -758,6 +816,25 @@ static bool procfs$memstat(InodeIdentifier, KBufferBuilder& builder)
         json.add(String::formatted("{}_num_allocated", prefix), num_allocated);
         json.add(String::formatted("{}_num_free", prefix), num_free);
     });
+    {
+        auto caches_array = json.add_array("physical_page_caches");
+        Processor::for_each([&](Processor& processor) {
+            auto& cache = processor.get_mm_data().m_user_physical_page_cache;
+            ScopedSpinLock cache_lock(cache.lock);
+            size_t cached = cache.count;
+            u64 hits = cache.hits;
+            u64 misses = cache.misses;
+            cache_lock.unlock();
+
+            auto cache_object = caches_array.add_object();
+            cache_object.add("processor", processor.get_id());
+            cache_object.add("cached", cached);
+            cache_object.add("hits", hits);
+            cache_object.add("misses", misses);
+            cache_object.add("hit_rate", hits + misses ? hits * 100 / (hits + misses) : 0);
+            return IterationDecision::Continue;
+        });
+    }
     json.finish();
     return true;
 }
@@ -1309,6 +1386,7 @@ KResult ProcFSInode::traverse_as_directory(Function<bool(const FS::DirectoryEntr
         callback({ "tcp", to_identifier(fsid(), PDI_Root_net, 0, FI_Root_net_tcp), 0 });
         callback({ "udp", to_identifier(fsid(), PDI_Root_net, 0, FI_Root_net_udp), 0 });
         callback({ "local", to_identifier(fsid(), PDI_Root_net, 0, FI_Root_net_local), 0 });
+        callback({ "workers", to_identifier(fsid(), PDI_Root_net, 0, FI_Root_net_workers), 0 });
         break;
 
     case FI_PID: {
@@ -1411,6 +1489,8 @@ RefPtr<Inode> ProcFSInode::lookup(StringView name)
             return fs().get_inode(to_identifier(fsid(), PDI_Root, 0, FI_Root_net_udp));
         if (name == "local")
             return fs().get_inode(to_identifier(fsid(), PDI_Root, 0, FI_Root_net_local));
+        if (name == "workers")
+            return fs().get_inode(to_identifier(fsid(), PDI_Root, 0, FI_Root_net_workers));
         return {};
     }
 
@@ -1699,6 +1779,7 @@ ProcFS::ProcFS()
     m_root_inode = adopt(*new ProcFSInode(*this, 1));
     m_entries.resize(FI_MaxStaticFileIndex);
     m_entries[FI_Root_df] = { "df", FI_Root_df, false, procfs$df };
+    m_entries[FI_Root_diskcache] = { "diskcache", FI_Root_diskcache, false, procfs$diskcache };
     m_entries[FI_Root_all] = { "all", FI_Root_all, false, procfs$all };
     m_entries[FI_Root_memstat] = { "memstat", FI_Root_memstat, false, procfs$memstat };
     m_entries[FI_Root_cpuinfo] = { "cpuinfo", FI_Root_cpuinfo, false, procfs$cpuinfo };
@@ -1722,6 +1803,7 @@ ProcFS::ProcFS()
     m_entries[FI_Root_net_tcp] = { "tcp", FI_Root_net_tcp, false, procfs$net_tcp };
     m_entries[FI_Root_net_udp] = { "udp", FI_Root_net_udp, false, procfs$net_udp };
     m_entries[FI_Root_net_local] = { "local", FI_Root_net_local, false, procfs$net_local };
+    m_entries[FI_Root_net_workers] = { "workers", FI_Root_net_workers, false, procfs$net_workers };
 
     m_entries[FI_PID_vm] = { "vm", FI_PID_vm, false, procfs$pid_vm };
     m_entries[FI_PID_stacks] = { "stacks", FI_PID_stacks, false };
@@ -49,6 +49,11 @@ static AK::Singleton<Lockable<HashTable<IPv4Socket*>>> s_table;
 
 using BlockFlags = Thread::FileDescriptionBlocker::BlockFlags;
 
+// Stream sockets start out with a small receive buffer and only grow it as far as the peer actually fills it.
+static constexpr size_t stream_receive_buffer_initial_capacity = 16 * KiB;
+static constexpr size_t stream_receive_buffer_max_capacity = 256 * KiB;
+static constexpr size_t packet_receive_buffer_capacity = 64 * KiB;
+
 Lockable<HashTable<IPv4Socket*>>& IPv4Socket::all_sockets()
 {
     return *s_table;
@@ -67,12 +72,11 @@ KResultOr<NonnullRefPtr<Socket>> IPv4Socket::create(int type, int protocol)
 
 IPv4Socket::IPv4Socket(int type, int protocol)
     : Socket(AF_INET, type, protocol)
+    , m_receive_buffer(type == SOCK_STREAM ? stream_receive_buffer_initial_capacity : packet_receive_buffer_capacity)
+    , m_receive_buffer_max_capacity(type == SOCK_STREAM ? stream_receive_buffer_max_capacity : packet_receive_buffer_capacity)
 {
     dbgln_if(IPV4_SOCKET_DEBUG, "IPv4Socket({}) created with type={}, protocol={}", this, type, protocol);
     m_buffer_mode = type == SOCK_STREAM ? BufferMode::Bytes : BufferMode::Packets;
-    if (m_buffer_mode == BufferMode::Bytes) {
-        m_scratch_buffer = KBuffer::create_with_size(65536);
-    }
     LOCKER(all_sockets().lock());
     all_sockets().resource().set(this);
 }
@@ -262,8 +266,10 @@ KResultOr<size_t> IPv4Socket::receive_byte_buffered(FileDescription& description
 
     VERIFY(!m_receive_buffer.is_empty());
     int nreceived = m_receive_buffer.read(buffer, buffer_length);
-    if (nreceived > 0)
+    if (nreceived > 0) {
         Thread::current()->did_ipv4_socket_read((size_t)nreceived);
+        protocol_did_read_received_data();
+    }
 
     set_can_read(!m_receive_buffer.is_empty());
     return nreceived;
@@ -289,11 +295,11 @@ KResultOr<size_t> IPv4Socket::receive_packet_buffered(FileDescription& descripti
 
             dbgln_if(IPV4_SOCKET_DEBUG, "IPv4Socket({}): recvfrom without blocking {} bytes, packets in queue: {}",
                 this,
-                packet.data.value().size(),
+                packet.data->size(),
                 m_receive_queue.size());
         }
     }
-    if (!packet.data.has_value()) {
+    if (!packet.data) {
         if (protocol_is_disconnected()) {
             dbgln("IPv4Socket({}) is protocol-disconnected, returning 0 in recvfrom!", this);
             return 0;
@@ -318,10 +324,10 @@ KResultOr<size_t> IPv4Socket::receive_packet_buffered(FileDescription& descripti
 
         dbgln_if(IPV4_SOCKET_DEBUG, "IPv4Socket({}): recvfrom with blocking {} bytes, packets in queue: {}",
             this,
-            packet.data.value().size(),
+            packet.data->size(),
             m_receive_queue.size());
     }
-    VERIFY(packet.data.has_value());
+    VERIFY(packet.data);
 
     packet_timestamp = packet.timestamp;
 
@@ -343,13 +349,13 @@ KResultOr<size_t> IPv4Socket::receive_packet_buffered(FileDescription& descripti
     }
 
     if (type() == SOCK_RAW) {
-        size_t bytes_written = min(packet.data.value().size(), buffer_length);
-        if (!buffer.write(packet.data.value().data(), bytes_written))
+        size_t bytes_written = min(packet.data->size(), buffer_length);
+        if (!buffer.write(packet.data->data(), bytes_written))
             return EFAULT;
         return bytes_written;
     }
 
-    return protocol_receive(ReadonlyBytes { packet.data.value().data(), packet.data.value().size() }, buffer, buffer_length, flags);
+    return protocol_receive(packet.data->bytes(), buffer, buffer_length, flags);
 }
 
 KResultOr<size_t> IPv4Socket::recvfrom(FileDescription& description, UserOrKernelBuffer& buffer, size_t buffer_length, int flags, Userspace<sockaddr*> user_addr, Userspace<socklen_t*> user_addr_length, Time& packet_timestamp)
@@ -375,14 +381,14 @@ KResultOr<size_t> IPv4Socket::recvfrom(FileDescription& description, UserOrKerne
     return nreceived;
 }
 
-bool IPv4Socket::did_receive(const IPv4Address& source_address, u16 source_port, KBuffer&& packet, const Time& packet_timestamp)
+bool IPv4Socket::did_receive(const IPv4Address& source_address, u16 source_port, NonnullRefPtr<PacketBuffer> packet, const Time& packet_timestamp)
 {
     LOCKER(lock());
 
     if (is_shut_down_for_reading())
         return false;
 
-    auto packet_size = packet.size();
+    auto packet_size = packet->size();
 
     if (buffer_mode() == BufferMode::Bytes) {
         size_t space_in_receive_buffer = m_receive_buffer.space_for_writing();
@@ -391,11 +397,8 @@ bool IPv4Socket::did_receive(const IPv4Address& source_address, u16 source_port,
             VERIFY(m_can_read);
             return false;
         }
-        auto scratch_buffer = UserOrKernelBuffer::for_kernel_buffer(m_scratch_buffer.value().data());
-        auto nreceived_or_error = protocol_receive(ReadonlyBytes { packet.data(), packet.size() }, scratch_buffer, m_scratch_buffer.value().size(), 0);
-        if (nreceived_or_error.is_error())
-            return false;
-        ssize_t nwritten = m_receive_buffer.write(scratch_buffer, nreceived_or_error.value());
+        auto payload = protocol_payload(packet->bytes());
+        ssize_t nwritten = m_receive_buffer.write(payload.data(), payload.size());
         if (nwritten < 0)
             return false;
         set_can_read(!m_receive_buffer.is_empty());
@@ -423,6 +426,35 @@ bool IPv4Socket::did_receive(const IPv4Address& source_address, u16 source_port,
     return true;
 }
 
+bool IPv4Socket::did_receive_stream_data(ReadonlyBytes data)
+{
+    LOCKER(lock());
+    VERIFY(buffer_mode() == BufferMode::Bytes);
+
+    if (is_shut_down_for_reading())
+        return false;
+
+    if (data.size() > m_receive_buffer.space_for_writing()) {
+        size_t buffered = m_receive_buffer.capacity() - m_receive_buffer.space_for_writing();
+        size_t new_capacity = m_receive_buffer.capacity();
+        while (new_capacity < buffered + data.size() && new_capacity < m_receive_buffer_max_capacity)
+            new_capacity *= 2;
+        new_capacity = min(new_capacity, m_receive_buffer_max_capacity);
+        if (buffered + data.size() > new_capacity || !m_receive_buffer.try_grow(new_capacity)) {
+            dbgln("IPv4Socket({}): did_receive_stream_data refusing {} bytes since buffer is full.", this, data.size());
+            return false;
+        }
+    }
+    ssize_t nwritten = m_receive_buffer.write(data.data(), data.size());
+    if (nwritten < 0)
+        return false;
+    set_can_read(!m_receive_buffer.is_empty());
+    m_bytes_received += data.size();
+
+    dbgln_if(IPV4_SOCKET_DEBUG, "IPv4Socket({}): did_receive_stream_data {} bytes, total_received={}", this, data.size(), m_bytes_received);
+    return true;
+}
+
 String IPv4Socket::absolute_path(const FileDescription&) const
 {
     if (m_role == Role::None)
@@ -33,6 +33,7 @@
 #include <Kernel/Lock.h>
 #include <Kernel/Net/IPv4.h>
 #include <Kernel/Net/IPv4SocketTuple.h>
+#include <Kernel/Net/PacketBuffer.h>
 #include <Kernel/Net/Socket.h>
 
 namespace Kernel {
@@ -63,7 +64,7 @@ public:
 
     virtual int ioctl(FileDescription&, unsigned request, FlatPtr arg) override;
 
-    bool did_receive(const IPv4Address& peer_address, u16 peer_port, KBuffer&&, const Time&);
+    bool did_receive(const IPv4Address& peer_address, u16 peer_port, NonnullRefPtr<PacketBuffer>, const Time&);
 
     const IPv4Address& local_address() const { return m_local_address; }
     u16 local_port() const { return m_local_port; }
@@ -95,13 +96,24 @@ protected:
     virtual KResult protocol_bind() { return KSuccess; }
     virtual KResult protocol_listen() { return KSuccess; }
     virtual KResultOr<size_t> protocol_receive(ReadonlyBytes /* raw_ipv4_packet */, UserOrKernelBuffer&, size_t, int) { return -ENOTIMPL; }
+    // Byte-buffered (stream) sockets append the payload of each received packet straight to their receive buffer.
+    virtual ReadonlyBytes protocol_payload(ReadonlyBytes /* raw_ipv4_packet */) const { VERIFY_NOT_REACHED(); }
     virtual KResultOr<size_t> protocol_send(const UserOrKernelBuffer&, size_t) { return -ENOTIMPL; }
     virtual KResult protocol_connect(FileDescription&, ShouldBlock) { return KSuccess; }
     virtual int protocol_allocate_local_port() { return 0; }
     virtual bool protocol_is_disconnected() const { return false; }
+    // Called with the socket locked whenever the application has read data out of the receive buffer of a byte-buffered socket.
+    virtual void protocol_did_read_received_data() { }
 
     virtual void shut_down_for_reading() override;
 
+    // For byte-buffered sockets that reassemble the stream themselves: appends data to the receive buffer.
+    // Returns false (and appends nothing) if it doesn't fit.
+    bool did_receive_stream_data(ReadonlyBytes);
+    // The receive buffer grows on demand, so these are relative to the size it may grow to rather than the size it has now.
+    size_t receive_buffer_capacity() const { return m_receive_buffer_max_capacity; }
+    size_t receive_buffer_space() const { return m_receive_buffer_max_capacity - (m_receive_buffer.capacity() - m_receive_buffer.space_for_writing()); }
+
     void set_local_address(IPv4Address address) { m_local_address = address; }
     void set_peer_address(IPv4Address address) { m_peer_address = address; }
 
@@ -120,12 +132,13 @@ private:
         IPv4Address peer_address;
         u16 peer_port;
         Time timestamp;
-        Optional<KBuffer> data;
+        RefPtr<PacketBuffer> data;
     };
 
     SinglyLinkedListWithCount<ReceivedPacket> m_receive_queue;
 
     DoubleBuffer m_receive_buffer;
+    size_t m_receive_buffer_max_capacity { 0 };
 
     u16 m_local_port { 0 };
     u16 m_peer_port { 0 };
@@ -137,8 +150,6 @@ private:
     bool m_can_read { false };
 
     BufferMode m_buffer_mode { BufferMode::Packets };
-
-    Optional<KBuffer> m_scratch_buffer;
 };
 
 }
@@ -25,7 +25,11 @@
  */
 
 #include <AK/Singleton.h>
+#include <Kernel/FileSystem/ProcFS.h>
 #include <Kernel/Net/LoopbackAdapter.h>
+#include <Kernel/Random.h>
+#include <Kernel/Time/TimeManagement.h>
+#include <Kernel/TimerQueue.h>
 
 namespace Kernel {
 
@@ -41,6 +45,25 @@ LoopbackAdapter::LoopbackAdapter()
     set_interface_name("loop");
     set_mtu(65536);
     set_mac_address({ 19, 85, 2, 9, 0x55, 0xaa });
+
+    auto parse_setting = [](Lockable<String>& setting, u32& value, u32 limit) {
+        LOCKER(setting.lock());
+        auto parsed_value = setting.resource().view().trim_whitespace().to_uint();
+        if (parsed_value.has_value() && parsed_value.value() <= limit)
+            value = parsed_value.value();
+        else
+            dbgln("LoopbackAdapter: Ignoring invalid setting '{}'", setting.resource());
+        setting.resource() = String::number(value);
+    };
+
+    m_latency_setting.resource() = "0";
+    ProcFS::add_sys_string("loopback_latency_ms", m_latency_setting, [this, parse_setting] {
+        parse_setting(m_latency_setting, m_latency_ms, 10'000);
+    });
+    m_loss_setting.resource() = "0";
+    ProcFS::add_sys_string("loopback_loss_percent", m_loss_setting, [this, parse_setting] {
+        parse_setting(m_loss_setting, m_loss_percent, 100);
+    });
 }
 
 LoopbackAdapter::~LoopbackAdapter()
@@ -50,7 +73,42 @@ LoopbackAdapter::~LoopbackAdapter()
 void LoopbackAdapter::send_raw(ReadonlyBytes payload)
 {
     dbgln("LoopbackAdapter: Sending {} byte(s) to myself.", payload.size());
-    did_receive(payload);
+
+    if (m_loss_percent && get_fast_random<u32>() % 100 < m_loss_percent) {
+        dbgln("LoopbackAdapter: Dropping {} byte(s)", payload.size());
+        return;
+    }
+
+    u32 latency_ms = m_latency_ms;
+    if (!latency_ms) {
+        did_receive(payload);
+        return;
+    }
+
+    // The latency is the same for every packet, so the queue stays sorted by delivery time.
+    auto delivery_time = TimeManagement::the().monotonic_time() + Time::from_milliseconds(latency_ms);
+    DelayedPacket delayed_packet { delivery_time, ByteBuffer::copy(payload.data(), payload.size()) };
+    {
+        ScopedSpinLock lock(m_delayed_packets_lock);
+        m_delayed_packets.append(move(delayed_packet));
+    }
+    if (!TimerQueue::the().add_timer_without_id(CLOCK_MONOTONIC_COARSE, delivery_time, [this] { deliver_delayed_packets(); }))
+        deliver_delayed_packets();
+}
+
+void LoopbackAdapter::deliver_delayed_packets()
+{
+    auto now = TimeManagement::the().monotonic_time();
+    for (;;) {
+        ByteBuffer packet;
+        {
+            ScopedSpinLock lock(m_delayed_packets_lock);
+            if (m_delayed_packets.is_empty() || m_delayed_packets.first().delivery_time > now)
+                return;
+            packet = m_delayed_packets.take_first().packet;
+        }
+        did_receive(packet.bytes());
+    }
 }
 
 }
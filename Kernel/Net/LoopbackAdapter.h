@@ -26,7 +26,12 @@
 
 #pragma once
 
+#include <AK/ByteBuffer.h>
+#include <AK/SinglyLinkedList.h>
+#include <AK/Time.h>
+#include <Kernel/Lock.h>
 #include <Kernel/Net/NetworkAdapter.h>
+#include <Kernel/SpinLock.h>
 
 namespace Kernel {
 
@@ -40,6 +45,24 @@ public:
 
     virtual void send_raw(ReadonlyBytes) override;
     virtual const char* class_name() const override { return "LoopbackAdapter"; }
+
+private:
+    void deliver_delayed_packets();
+
+    // To benchmark and test protocols under less ideal conditions, the loopback adapter can delay packets and
+    // drop a percentage of them. This is configured through /proc/sys/loopback_latency_ms and loopback_loss_percent.
+    Lockable<String> m_latency_setting;
+    Lockable<String> m_loss_setting;
+    u32 m_latency_ms { 0 };
+    u32 m_loss_percent { 0 };
+
+    struct DelayedPacket {
+        Time delivery_time;
+        ByteBuffer packet;
+    };
+
+    SpinLock<u8> m_delayed_packets_lock;
+    SinglyLinkedList<DelayedPacket> m_delayed_packets;
 };
 
 }
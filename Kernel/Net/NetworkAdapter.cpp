@@ -31,8 +31,10 @@
 #include <Kernel/Lock.h>
 #include <Kernel/Net/EtherType.h>
 #include <Kernel/Net/EthernetFrameHeader.h>
+#include <Kernel/Net/IPv4SocketTuple.h>
 #include <Kernel/Net/LoopbackAdapter.h>
 #include <Kernel/Net/NetworkAdapter.h>
+#include <Kernel/Net/UDP.h>
 #include <Kernel/Process.h>
 #include <Kernel/Random.h>
 #include <Kernel/StdLib.h>
@@ -77,6 +79,7 @@ RefPtr<NetworkAdapter> NetworkAdapter::lookup_by_name(const StringView& name)
 
 NetworkAdapter::NetworkAdapter()
 {
+    m_receive_queues.resize(1);
     // FIXME: I wanna lock :(
     all_adapters().resource().set(this);
 }
@@ -172,49 +175,80 @@ KResult NetworkAdapter::send_ipv4_fragmented(const MACAddress& destination_mac,
     return KSuccess;
 }
 
+void NetworkAdapter::set_receive_queue_count(size_t count)
+{
+    VERIFY(count > 0);
+    ScopedSpinLock lock(m_receive_queue_lock);
+    // Packets that are already queued stay where they are, so we only ever add queues.
+    if (count > m_receive_queues.size())
+        m_receive_queues.resize(count);
+}
+
+size_t NetworkAdapter::receive_queue_index_for(ReadonlyBytes frame) const
+{
+    if (m_receive_queues.size() == 1)
+        return 0;
+
+    // Everything that isn't TCP or UDP over IPv4 goes to the first queue.
+    if (frame.size() < sizeof(EthernetFrameHeader) + sizeof(IPv4Packet))
+        return 0;
+    auto& eth = *(const EthernetFrameHeader*)frame.data();
+    if (eth.ether_type() != EtherType::IPv4)
+        return 0;
+    auto& ipv4_packet = *static_cast<const IPv4Packet*>(eth.payload());
+    auto protocol = (IPv4Protocol)ipv4_packet.protocol();
+    if (protocol != IPv4Protocol::TCP && protocol != IPv4Protocol::UDP)
+        return 0;
+
+    // Fragments don't all carry the transport header, so they are only spread by address.
+    u16 destination_port = 0;
+    u16 source_port = 0;
+    if (!ipv4_packet.is_a_fragment() && frame.size() >= sizeof(EthernetFrameHeader) + sizeof(IPv4Packet) + sizeof(UDPPacket)) {
+        // TCP and UDP both start out with the source and destination port.
+        auto& transport_header = *static_cast<const UDPPacket*>(ipv4_packet.payload());
+        source_port = transport_header.source_port();
+        destination_port = transport_header.destination_port();
+    }
+
+    IPv4SocketTuple tuple(ipv4_packet.destination(), destination_port, ipv4_packet.source(), source_port);
+    return Traits<IPv4SocketTuple>::hash(tuple) % m_receive_queues.size();
+}
+
+bool NetworkAdapter::has_queued_packets(size_t receive_queue_index) const
+{
+    ScopedSpinLock lock(m_receive_queue_lock);
+    return receive_queue_index < m_receive_queues.size() && !m_receive_queues[receive_queue_index].is_empty();
+}
+
 void NetworkAdapter::did_receive(ReadonlyBytes payload)
 {
-    InterruptDisabler disabler;
+    // This is the only time the packet data gets copied on its way to the receiving socket.
+    auto packet = PacketBuffer::create_with_bytes(payload);
+    auto timestamp = kgettimeofday();
+
+    ScopedSpinLock lock(m_receive_queue_lock);
     m_packets_in++;
     m_bytes_in += payload.size();
 
-    Optional<KBuffer> buffer;
-
-    if (m_unused_packet_buffers.is_empty()) {
-        buffer = KBuffer::copy(payload.data(), payload.size());
-    } else {
-        buffer = m_unused_packet_buffers.take_first();
-        --m_unused_packet_buffers_count;
-        if (payload.size() <= buffer.value().capacity()) {
-            memcpy(buffer.value().data(), payload.data(), payload.size());
-            buffer.value().set_size(payload.size());
-        } else {
-            buffer = KBuffer::copy(payload.data(), payload.size());
-        }
-    }
-
-    m_packet_queue.append({ buffer.value(), kgettimeofday() });
+    auto receive_queue_index = receive_queue_index_for(payload);
+    m_receive_queues[receive_queue_index].append({ move(packet), timestamp });
+    lock.unlock();
 
     if (on_receive)
-        on_receive();
+        on_receive(receive_queue_index);
 }
 
-size_t NetworkAdapter::dequeue_packet(u8* buffer, size_t buffer_size, Time& packet_timestamp)
+RefPtr<PacketBuffer> NetworkAdapter::dequeue_packet(size_t receive_queue_index, Time& packet_timestamp)
 {
-    InterruptDisabler disabler;
-    if (m_packet_queue.is_empty())
-        return 0;
-    auto packet_with_timestamp = m_packet_queue.take_first();
+    ScopedSpinLock lock(m_receive_queue_lock);
+    if (receive_queue_index >= m_receive_queues.size())
+        return {};
+    auto& receive_queue = m_receive_queues[receive_queue_index];
+    if (receive_queue.is_empty())
+        return {};
+    auto packet_with_timestamp = receive_queue.take_first();
     packet_timestamp = packet_with_timestamp.timestamp;
-    auto packet = move(packet_with_timestamp.packet);
-    size_t packet_size = packet.size();
-    VERIFY(packet_size <= buffer_size);
-    memcpy(buffer, packet.data(), packet_size);
-    if (m_unused_packet_buffers_count < 100) {
-        m_unused_packet_buffers.append(packet);
-        ++m_unused_packet_buffers_count;
-    }
-    return packet_size;
+    return move(packet_with_timestamp.packet);
 }
 
 void NetworkAdapter::set_ipv4_address(const IPv4Address& address)
@@ -31,12 +31,15 @@
 #include <AK/MACAddress.h>
 #include <AK/SinglyLinkedList.h>
 #include <AK/Types.h>
+#include <AK/Vector.h>
 #include <AK/WeakPtr.h>
 #include <AK/Weakable.h>
 #include <Kernel/KBuffer.h>
 #include <Kernel/Net/ARP.h>
 #include <Kernel/Net/ICMP.h>
 #include <Kernel/Net/IPv4.h>
+#include <Kernel/Net/PacketBuffer.h>
+#include <Kernel/SpinLock.h>
 #include <Kernel/UserOrKernelBuffer.h>
 
 namespace Kernel {
@@ -67,9 +70,14 @@ public:
     KResult send_ipv4(const MACAddress&, const IPv4Address&, IPv4Protocol, const UserOrKernelBuffer& payload, size_t payload_size, u8 ttl);
     KResult send_ipv4_fragmented(const MACAddress&, const IPv4Address&, IPv4Protocol, const UserOrKernelBuffer& payload, size_t payload_size, u8 ttl);
 
-    size_t dequeue_packet(u8* buffer, size_t buffer_size, Time& packet_timestamp);
+    // Received packets are spread over a number of receive queues by hashing their flow,
+    // so packets belonging to the same connection always end up in the same queue (and are processed in order).
+    size_t receive_queue_count() const { return m_receive_queues.size(); }
+    void set_receive_queue_count(size_t);
 
-    bool has_queued_packets() const { return !m_packet_queue.is_empty(); }
+    RefPtr<PacketBuffer> dequeue_packet(size_t receive_queue_index, Time& packet_timestamp);
+
+    bool has_queued_packets(size_t receive_queue_index) const;
 
     u32 mtu() const { return m_mtu; }
     void set_mtu(u32 mtu) { m_mtu = mtu; }
@@ -79,7 +87,7 @@ public:
     u32 packets_out() const { return m_packets_out; }
     u32 bytes_out() const { return m_bytes_out; }
 
-    Function<void()> on_receive;
+    Function<void(size_t receive_queue_index)> on_receive;
 
 protected:
     NetworkAdapter();
@@ -95,13 +103,14 @@ private:
     IPv4Address m_ipv4_gateway;
 
     struct PacketWithTimestamp {
-        KBuffer packet;
+        NonnullRefPtr<PacketBuffer> packet;
         Time timestamp;
     };
 
-    SinglyLinkedList<PacketWithTimestamp> m_packet_queue;
-    SinglyLinkedList<KBuffer> m_unused_packet_buffers;
-    size_t m_unused_packet_buffers_count { 0 };
+    size_t receive_queue_index_for(ReadonlyBytes frame) const;
+
+    mutable SpinLock<u8> m_receive_queue_lock;
+    Vector<SinglyLinkedList<PacketWithTimestamp>, 1> m_receive_queues;
     String m_name;
     u32 m_packets_in { 0 };
     u32 m_bytes_in { 0 };
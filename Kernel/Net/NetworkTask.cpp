@@ -24,6 +24,8 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <AK/NonnullOwnPtrVector.h>
+#include <AK/Singleton.h>
 #include <Kernel/Debug.h>
 #include <Kernel/Lock.h>
 #include <Kernel/Net/ARP.h>
@@ -40,28 +42,54 @@
 #include <Kernel/Net/UDP.h>
 #include <Kernel/Net/UDPSocket.h>
 #include <Kernel/Process.h>
+#include <Kernel/Time/TimeManagement.h>
+#include <Kernel/WaitQueue.h>
 
 namespace Kernel {
 
 static void handle_arp(const EthernetFrameHeader&, size_t frame_size);
-static void handle_ipv4(const EthernetFrameHeader&, size_t frame_size, const Time& packet_timestamp);
-static void handle_icmp(const EthernetFrameHeader&, const IPv4Packet&, const Time& packet_timestamp);
-static void handle_udp(const IPv4Packet&, const Time& packet_timestamp);
-static void handle_tcp(const IPv4Packet&, const Time& packet_timestamp);
+static void handle_ipv4(PacketBuffer&, const Time& packet_timestamp);
+static void handle_icmp(const EthernetFrameHeader&, PacketBuffer&, const Time& packet_timestamp);
+static void handle_udp(PacketBuffer&, const Time& packet_timestamp);
+static void handle_tcp(PacketBuffer&);
 
 [[noreturn]] static void NetworkTask_main(void*);
 
+// One receive worker per CPU (up to a limit). Each worker services the matching receive queue of every adapter,
+// and since adapters pick the queue by hashing the flow, unrelated connections are processed in parallel
+// while the packets of any single connection are still handled in order.
+struct ReceiveWorker {
+    size_t index { 0 };
+    u32 affinity { THREAD_AFFINITY_DEFAULT };
+    WaitQueue wait_queue;
+    u64 packet_count { 0 };
+    u64 byte_count { 0 };
+    u64 wakeup_count { 0 };
+};
+
+static constexpr size_t max_receive_worker_count = 16;
+// How often the first worker checks the TCP retransmission timers.
+static constexpr Time retransmission_check_interval = Time::from_milliseconds(100);
+static SpinLock<u8> s_receive_workers_lock;
+static AK::Singleton<NonnullOwnPtrVector<ReceiveWorker>> s_receive_workers;
+
 void NetworkTask::spawn()
 {
-    RefPtr<Thread> thread;
-    Process::create_kernel_process(thread, "NetworkTask", NetworkTask_main, nullptr);
-}
+    TCPSocket::initialize();
+
+    size_t worker_count = min<size_t>(Processor::count(), max_receive_worker_count);
+    {
+        ScopedSpinLock lock(s_receive_workers_lock);
+        for (size_t i = 0; i < worker_count; ++i) {
+            auto worker = make<ReceiveWorker>();
+            worker->index = i;
+            if (worker_count > 1)
+                worker->affinity = 1u << i;
+            s_receive_workers->append(move(worker));
+        }
+    }
 
-void NetworkTask_main(void*)
-{
-    WaitQueue packet_wait_queue;
     u8 octet = 15;
-    int pending_packets = 0;
     NetworkAdapter::for_each([&](auto& adapter) {
         if (String(adapter.class_name()) == "LoopbackAdapter") {
             adapter.set_ipv4_address({ 127, 0, 0, 1 });
@@ -80,42 +108,89 @@ void NetworkTask_main(void*)
             adapter.ipv4_netmask(),
             adapter.ipv4_gateway());
 
-        adapter.on_receive = [&]() {
-            pending_packets++;
-            packet_wait_queue.wake_all();
+        adapter.on_receive = [](size_t receive_queue_index) {
+            auto& workers = *s_receive_workers;
+            workers[receive_queue_index % workers.size()].wait_queue.wake_all();
         };
+        adapter.set_receive_queue_count(worker_count);
     });
 
-    auto dequeue_packet = [&pending_packets](u8* buffer, size_t buffer_size, Time& packet_timestamp) -> size_t {
-        if (pending_packets == 0)
-            return 0;
-        size_t packet_size = 0;
+    RefPtr<Thread> thread;
+    auto& workers = *s_receive_workers;
+    auto process = Process::create_kernel_process(thread, "NetworkTask", NetworkTask_main, &workers[0], workers[0].affinity);
+    VERIFY(process);
+    for (size_t i = 1; i < worker_count; ++i) {
+        auto worker_thread = process->create_kernel_thread(NetworkTask_main, &workers[i], THREAD_PRIORITY_NORMAL, String::formatted("NetworkTask #{}", i), workers[i].affinity, false);
+        VERIFY(worker_thread);
+    }
+    dmesgln("NetworkTask: Started {} receive worker(s)", worker_count);
+}
+
+void NetworkTask::for_each_worker(Function<void(const WorkerStatistics&)> callback)
+{
+    Vector<WorkerStatistics, max_receive_worker_count> all_statistics;
+    {
+        ScopedSpinLock lock(s_receive_workers_lock);
+        for (auto& worker : *s_receive_workers) {
+            WorkerStatistics statistics;
+            statistics.index = worker.index;
+            statistics.affinity = worker.affinity;
+            statistics.packet_count = worker.packet_count;
+            statistics.byte_count = worker.byte_count;
+            statistics.wakeup_count = worker.wakeup_count;
+            all_statistics.append(statistics);
+        }
+    }
+    for (auto& statistics : all_statistics)
+        callback(statistics);
+}
+
+void NetworkTask_main(void* worker_ptr)
+{
+    auto& worker = *static_cast<ReceiveWorker*>(worker_ptr);
+
+    auto dequeue_packet = [&worker](Time& packet_timestamp) -> RefPtr<PacketBuffer> {
+        RefPtr<PacketBuffer> packet;
         NetworkAdapter::for_each([&](auto& adapter) {
-            if (packet_size || !adapter.has_queued_packets())
+            if (packet || !adapter.has_queued_packets(worker.index))
                 return;
-            packet_size = adapter.dequeue_packet(buffer, buffer_size, packet_timestamp);
-            pending_packets--;
-            dbgln_if(NETWORK_TASK_DEBUG, "NetworkTask: Dequeued packet from {} ({} bytes)", adapter.name(), packet_size);
+            packet = adapter.dequeue_packet(worker.index, packet_timestamp);
+            dbgln_if(NETWORK_TASK_DEBUG, "NetworkTask #{}: Dequeued packet from {} ({} bytes)", worker.index, adapter.name(), packet ? packet->size() : 0);
         });
-        return packet_size;
+        return packet;
     };
 
-    size_t buffer_size = 64 * KiB;
-    auto buffer_region = MM.allocate_kernel_region(buffer_size, "Kernel Packet Buffer", Region::Access::Read | Region::Access::Write);
-    auto buffer = (u8*)buffer_region->vaddr().get();
     Time packet_timestamp;
+    Time next_retransmission_check;
 
     for (;;) {
-        size_t packet_size = dequeue_packet(buffer, buffer_size, packet_timestamp);
-        if (!packet_size) {
-            packet_wait_queue.wait_forever("NetworkTask");
+        if (worker.index == 0) {
+            auto now = TimeManagement::the().monotonic_time();
+            if (now >= next_retransmission_check) {
+                next_retransmission_check = now + retransmission_check_interval;
+                TCPSocket::retransmit_timed_out_packets_on_all_sockets();
+            }
+        }
+
+        auto packet = dequeue_packet(packet_timestamp);
+        if (!packet) {
+            if (worker.index == 0) {
+                auto timeout = retransmission_check_interval;
+                [[maybe_unused]] auto result = worker.wait_queue.wait_on(Thread::BlockTimeout(false, &timeout), "NetworkTask");
+            } else {
+                worker.wait_queue.wait_forever("NetworkTask");
+            }
+            ++worker.wakeup_count;
             continue;
         }
+        size_t packet_size = packet->size();
+        ++worker.packet_count;
+        worker.byte_count += packet_size;
         if (packet_size < sizeof(EthernetFrameHeader)) {
             dbgln("NetworkTask: Packet is too small to be an Ethernet packet! ({})", packet_size);
             continue;
         }
-        auto& eth = *(const EthernetFrameHeader*)buffer;
+        auto& eth = *(const EthernetFrameHeader*)packet->data();
         dbgln_if(ETHERNET_DEBUG, "NetworkTask: From {} to {}, ether_type={:#04x}, packet_size={}", eth.source().to_string(), eth.destination().to_string(), eth.ether_type(), packet_size);
 
         switch (eth.ether_type()) {
@@ -123,7 +198,7 @@ void NetworkTask_main(void*)
             handle_arp(eth, packet_size);
             break;
         case EtherType::IPv4:
-            handle_ipv4(eth, packet_size, packet_timestamp);
+            handle_ipv4(*packet, packet_timestamp);
             break;
         case EtherType::IPv6:
             // ignore
@@ -183,8 +258,10 @@ void handle_arp(const EthernetFrameHeader& eth, size_t frame_size)
     }
 }
 
-void handle_ipv4(const EthernetFrameHeader& eth, size_t frame_size, const Time& packet_timestamp)
+void handle_ipv4(PacketBuffer& frame, const Time& packet_timestamp)
 {
+    auto& eth = *(const EthernetFrameHeader*)frame.data();
+    size_t frame_size = frame.size();
     constexpr size_t minimum_ipv4_frame_size = sizeof(EthernetFrameHeader) + sizeof(IPv4Packet);
     if (frame_size < minimum_ipv4_frame_size) {
         dbgln("handle_ipv4: Frame too small ({}, need {})", frame_size, minimum_ipv4_frame_size);
@@ -205,21 +282,27 @@ void handle_ipv4(const EthernetFrameHeader& eth, size_t frame_size, const Time&
 
     dbgln_if(IPV4_DEBUG, "handle_ipv4: source={}, destination={}", packet.source(), packet.destination());
 
-    switch ((IPv4Protocol)packet.protocol()) {
+    // From here on the buffer holds exactly the IPv4 packet. The Ethernet header stays in memory in front of it.
+    auto protocol = (IPv4Protocol)packet.protocol();
+    frame.pull(sizeof(EthernetFrameHeader));
+    frame.trim(packet.length());
+
+    switch (protocol) {
     case IPv4Protocol::ICMP:
-        return handle_icmp(eth, packet, packet_timestamp);
+        return handle_icmp(eth, frame, packet_timestamp);
     case IPv4Protocol::UDP:
-        return handle_udp(packet, packet_timestamp);
+        return handle_udp(frame, packet_timestamp);
     case IPv4Protocol::TCP:
-        return handle_tcp(packet, packet_timestamp);
+        return handle_tcp(frame);
     default:
         dbgln("handle_ipv4: Unhandled protocol {:#02x}", packet.protocol());
         break;
     }
 }
 
-void handle_icmp(const EthernetFrameHeader& eth, const IPv4Packet& ipv4_packet, const Time& packet_timestamp)
+void handle_icmp(const EthernetFrameHeader& eth, PacketBuffer& packet, const Time& packet_timestamp)
 {
+    auto& ipv4_packet = *(const IPv4Packet*)packet.data();
     auto& icmp_header = *static_cast<const ICMPHeader*>(ipv4_packet.payload());
     dbgln_if(ICMP_DEBUG, "handle_icmp: source={}, destination={}, type={:#02x}, code={:#02x}", ipv4_packet.source().to_string(), ipv4_packet.destination().to_string(), icmp_header.type(), icmp_header.code());
 
@@ -234,7 +317,7 @@ void handle_icmp(const EthernetFrameHeader& eth, const IPv4Packet& ipv4_packet,
             }
         }
         for (auto& socket : icmp_sockets)
-            socket.did_receive(ipv4_packet.source(), 0, KBuffer::copy(&ipv4_packet, sizeof(IPv4Packet) + ipv4_packet.payload_size()), packet_timestamp);
+            socket.did_receive(ipv4_packet.source(), 0, packet, packet_timestamp);
     }
 
     auto adapter = NetworkAdapter::from_ipv4_address(ipv4_packet.destination());
@@ -264,8 +347,9 @@ void handle_icmp(const EthernetFrameHeader& eth, const IPv4Packet& ipv4_packet,
     }
 }
 
-void handle_udp(const IPv4Packet& ipv4_packet, const Time& packet_timestamp)
+void handle_udp(PacketBuffer& packet, const Time& packet_timestamp)
 {
+    auto& ipv4_packet = *(const IPv4Packet*)packet.data();
     if (ipv4_packet.payload_size() < sizeof(UDPPacket)) {
         dbgln("handle_udp: Packet too small ({}, need {})", ipv4_packet.payload_size(), sizeof(UDPPacket));
         return;
@@ -291,11 +375,12 @@ void handle_udp(const IPv4Packet& ipv4_packet, const Time& packet_timestamp)
 
     VERIFY(socket->type() == SOCK_DGRAM);
     VERIFY(socket->local_port() == udp_packet.destination_port());
-    socket->did_receive(ipv4_packet.source(), udp_packet.source_port(), KBuffer::copy(&ipv4_packet, sizeof(IPv4Packet) + ipv4_packet.payload_size()), packet_timestamp);
+    socket->did_receive(ipv4_packet.source(), udp_packet.source_port(), packet, packet_timestamp);
 }
 
-void handle_tcp(const IPv4Packet& ipv4_packet, const Time& packet_timestamp)
+void handle_tcp(PacketBuffer& packet)
 {
+    auto& ipv4_packet = *(const IPv4Packet*)packet.data();
     if (ipv4_packet.payload_size() < sizeof(TCPPacket)) {
         dbgln("handle_tcp: IPv4 payload is too small to be a TCP packet ({}, need {})", ipv4_packet.payload_size(), sizeof(TCPPacket));
         return;
@@ -307,6 +392,7 @@ void handle_tcp(const IPv4Packet& ipv4_packet, const Time& packet_timestamp)
     size_t maximum_tcp_header_size = 15 * sizeof(u32);
     if (tcp_packet.header_size() < minimum_tcp_header_size || tcp_packet.header_size() > maximum_tcp_header_size) {
         dbgln("handle_tcp: TCP packet header has invalid size {}", tcp_packet.header_size());
+        return;
     }
 
     if (ipv4_packet.payload_size() < tcp_packet.header_size()) {
@@ -393,6 +479,7 @@ void handle_tcp(const IPv4Packet& ipv4_packet, const Time& packet_timestamp)
             }
             LOCKER(client->lock());
             dbgln_if(TCP_DEBUG, "handle_tcp: created new client socket with tuple {}", client->tuple().to_string());
+            client->process_syn_options(tcp_packet);
             client->set_sequence_number(1000);
             client->set_ack_number(tcp_packet.sequence_number() + payload_size + 1);
             [[maybe_unused]] auto rc2 = client->send_tcp_packet(TCPFlags::SYN | TCPFlags::ACK);
@@ -407,11 +494,13 @@ void handle_tcp(const IPv4Packet& ipv4_packet, const Time& packet_timestamp)
     case TCPSocket::State::SynSent:
         switch (tcp_packet.flags()) {
         case TCPFlags::SYN:
+            socket->process_syn_options(tcp_packet);
             socket->set_ack_number(tcp_packet.sequence_number() + payload_size + 1);
             unused_rc = socket->send_tcp_packet(TCPFlags::ACK);
             socket->set_state(TCPSocket::State::SynReceived);
             return;
         case TCPFlags::ACK | TCPFlags::SYN:
+            socket->process_syn_options(tcp_packet);
             socket->set_ack_number(tcp_packet.sequence_number() + payload_size + 1);
             unused_rc = socket->send_tcp_packet(TCPFlags::ACK);
             socket->set_state(TCPSocket::State::Established);
@@ -489,7 +578,9 @@ void handle_tcp(const IPv4Packet& ipv4_packet, const Time& packet_timestamp)
         switch (tcp_packet.flags()) {
         case TCPFlags::ACK:
             socket->set_ack_number(tcp_packet.sequence_number() + payload_size);
-            socket->set_state(TCPSocket::State::Closed);
+            // Data queued ahead of our FIN may still be getting acknowledged.
+            if (tcp_packet.ack_number() == socket->sequence_number())
+                socket->set_state(TCPSocket::State::Closed);
             return;
         default:
             dbgln("handle_tcp: unexpected flags in LastAck state");
@@ -501,7 +592,9 @@ void handle_tcp(const IPv4Packet& ipv4_packet, const Time& packet_timestamp)
         switch (tcp_packet.flags()) {
         case TCPFlags::ACK:
             socket->set_ack_number(tcp_packet.sequence_number() + payload_size);
-            socket->set_state(TCPSocket::State::FinWait2);
+            // Data queued ahead of our FIN may still be getting acknowledged.
+            if (tcp_packet.ack_number() == socket->sequence_number())
+                socket->set_state(TCPSocket::State::FinWait2);
             return;
         case TCPFlags::FIN:
             socket->set_ack_number(tcp_packet.sequence_number() + payload_size + 1);
@@ -532,7 +625,8 @@ void handle_tcp(const IPv4Packet& ipv4_packet, const Time& packet_timestamp)
         switch (tcp_packet.flags()) {
         case TCPFlags::ACK:
             socket->set_ack_number(tcp_packet.sequence_number() + payload_size);
-            socket->set_state(TCPSocket::State::TimeWait);
+            if (tcp_packet.ack_number() == socket->sequence_number())
+                socket->set_state(TCPSocket::State::TimeWait);
             return;
         default:
             dbgln("handle_tcp: unexpected flags in Closing state");
@@ -540,27 +634,26 @@ void handle_tcp(const IPv4Packet& ipv4_packet, const Time& packet_timestamp)
             socket->set_state(TCPSocket::State::Closed);
             return;
         }
-    case TCPSocket::State::Established:
-        if (tcp_packet.has_fin()) {
-            if (payload_size != 0)
-                socket->did_receive(ipv4_packet.source(), tcp_packet.source_port(), KBuffer::copy(&ipv4_packet, sizeof(IPv4Packet) + ipv4_packet.payload_size()), packet_timestamp);
+    case TCPSocket::State::Established: {
+        bool is_in_order = socket->receive_payload(tcp_packet, packet, payload_size);
 
-            socket->set_ack_number(tcp_packet.sequence_number() + payload_size + 1);
+        if (tcp_packet.has_fin() && is_in_order) {
+            socket->set_ack_number(socket->ack_number() + 1);
             unused_rc = socket->send_tcp_packet(TCPFlags::ACK);
             socket->set_state(TCPSocket::State::CloseWait);
             socket->set_connected(false);
             return;
         }
 
-        socket->set_ack_number(tcp_packet.sequence_number() + payload_size);
-
         dbgln_if(TCP_DEBUG, "Got packet with ack_no={}, seq_no={}, payload_size={}, acking it with new ack_no={}, seq_no={}",
             tcp_packet.ack_number(), tcp_packet.sequence_number(), payload_size, socket->ack_number(), socket->sequence_number());
 
-        if (payload_size) {
-            if (socket->did_receive(ipv4_packet.source(), tcp_packet.source_port(), KBuffer::copy(&ipv4_packet, sizeof(IPv4Packet) + ipv4_packet.payload_size()), packet_timestamp))
-                unused_rc = socket->send_tcp_packet(TCPFlags::ACK);
-        }
+        // Out-of-order and duplicate segments get acknowledged too, since the duplicate acknowledgements
+        // (and the SACK blocks in them) are how the peer finds out about loss.
+        if (payload_size || tcp_packet.has_fin())
+            unused_rc = socket->send_tcp_packet(TCPFlags::ACK);
+        return;
+    }
     }
 }
 
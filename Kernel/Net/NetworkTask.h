@@ -26,9 +26,21 @@
 
 #pragma once
 
+#include <AK/Function.h>
+#include <AK/Types.h>
+
 namespace Kernel {
 class NetworkTask {
 public:
     static void spawn();
+
+    struct WorkerStatistics {
+        size_t index { 0 };
+        u32 affinity { 0 };
+        u64 packet_count { 0 };
+        u64 byte_count { 0 };
+        u64 wakeup_count { 0 };
+    };
+    static void for_each_worker(Function<void(const WorkerStatistics&)>);
 };
 }
@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <AK/Array.h>
+#include <Kernel/Heap/kmalloc.h>
+#include <Kernel/Net/PacketBuffer.h>
+#include <Kernel/SpinLock.h>
+#include <Kernel/StdLib.h>
+
+namespace Kernel {
+
+// Chunks are 2 KiB (enough for a full Ethernet frame) up to 128 KiB (enough for anything the loopback adapter sends).
+static constexpr size_t min_chunk_size = 2 * KiB;
+static constexpr size_t size_class_count = 7;
+static constexpr u8 unpooled_size_class = size_class_count;
+
+// Each size class keeps at most this many bytes worth of free chunks around.
+static constexpr size_t max_free_bytes_per_size_class = 1 * MiB;
+
+class PacketBufferPool {
+public:
+    static constexpr size_t chunk_size(u8 size_class) { return min_chunk_size << size_class; }
+
+    static u8 size_class_for(size_t size)
+    {
+        for (u8 size_class = 0; size_class < size_class_count; ++size_class) {
+            if (size <= chunk_size(size_class))
+                return size_class;
+        }
+        return unpooled_size_class;
+    }
+
+    u8* allocate(u8 size_class)
+    {
+        auto& free_list = m_free_lists[size_class];
+        {
+            ScopedSpinLock lock(m_lock);
+            if (auto* chunk = free_list.head) {
+                free_list.head = chunk->next;
+                --free_list.count;
+                return reinterpret_cast<u8*>(chunk);
+            }
+        }
+        return static_cast<u8*>(kmalloc(chunk_size(size_class)));
+    }
+
+    void deallocate(u8* storage, u8 size_class)
+    {
+        auto& free_list = m_free_lists[size_class];
+        {
+            ScopedSpinLock lock(m_lock);
+            if (free_list.count < max_free_bytes_per_size_class / chunk_size(size_class)) {
+                auto* chunk = reinterpret_cast<FreeChunk*>(storage);
+                chunk->next = free_list.head;
+                free_list.head = chunk;
+                ++free_list.count;
+                return;
+            }
+        }
+        kfree(storage);
+    }
+
+private:
+    struct FreeChunk {
+        FreeChunk* next;
+    };
+
+    struct FreeList {
+        FreeChunk* head { nullptr };
+        size_t count { 0 };
+    };
+
+    SpinLock<u8> m_lock;
+    Array<FreeList, size_class_count> m_free_lists;
+};
+
+static PacketBufferPool s_pool;
+
+NonnullRefPtr<PacketBuffer> PacketBuffer::create_with_bytes(ReadonlyBytes bytes)
+{
+    auto size_class = PacketBufferPool::size_class_for(bytes.size());
+    u8* storage;
+    if (size_class == unpooled_size_class)
+        storage = static_cast<u8*>(kmalloc(bytes.size()));
+    else
+        storage = s_pool.allocate(size_class);
+    memcpy(storage, bytes.data(), bytes.size());
+    return adopt(*new PacketBuffer(storage, size_class, bytes.size()));
+}
+
+PacketBuffer::~PacketBuffer()
+{
+    if (m_size_class == unpooled_size_class)
+        kfree(m_storage);
+    else
+        s_pool.deallocate(m_storage, m_size_class);
+}
+
+}
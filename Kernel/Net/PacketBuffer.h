@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/RefCounted.h>
+#include <AK/RefPtr.h>
+#include <AK/Span.h>
+#include <AK/Types.h>
+#include <Kernel/Heap/SlabAllocator.h>
+
+namespace Kernel {
+
+// A reference-counted buffer holding a single network packet.
+// The packet storage comes from a pool of power-of-two sized chunks, so the receive path doesn't hit the heap
+// for every packet once it has warmed up. A received packet is copied into a PacketBuffer once by the adapter,
+// and that same buffer is then handed by reference all the way to the receiving socket.
+class PacketBuffer : public RefCounted<PacketBuffer> {
+    MAKE_SLAB_ALLOCATED(PacketBuffer)
+public:
+    static NonnullRefPtr<PacketBuffer> create_with_bytes(ReadonlyBytes);
+    ~PacketBuffer();
+
+    u8* data() { return m_storage + m_offset; }
+    const u8* data() const { return m_storage + m_offset; }
+    size_t size() const { return m_size; }
+
+    Bytes bytes() { return { data(), size() }; }
+    ReadonlyBytes bytes() const { return { data(), size() }; }
+
+    // Drops a header that has been dealt with from the front of the packet.
+    void pull(size_t count)
+    {
+        VERIFY(count <= m_size);
+        m_offset += count;
+        m_size -= count;
+    }
+
+    // Drops trailing bytes, e.g. padding that was added to reach the minimum frame size.
+    void trim(size_t size)
+    {
+        VERIFY(size <= m_size);
+        m_size = size;
+    }
+
+private:
+    PacketBuffer(u8* storage, u8 size_class, size_t size)
+        : m_storage(storage)
+        , m_size_class(size_class)
+        , m_size(size)
+    {
+    }
+
+    u8* m_storage { nullptr };
+    u8 m_size_class { 0 };
+    size_t m_offset { 0 };
+    size_t m_size { 0 };
+};
+
+}
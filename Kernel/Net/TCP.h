@@ -41,6 +41,24 @@ struct TCPFlags {
     };
 };
 
+enum class TCPOptionKind : u8 {
+    End = 0,
+    NoOperation = 1,
+    MaximumSegmentSize = 2,
+    WindowScale = 3,
+    SACKPermitted = 4,
+    SACK = 5,
+};
+
+// The segment size to assume when the peer doesn't send an MSS option (RFC 879).
+static constexpr u16 tcp_default_maximum_segment_size = 536;
+// Room left in the header for options, given the 4-bit data offset.
+static constexpr size_t tcp_max_options_size = 40;
+// The largest window scale shift allowed by RFC 7323.
+static constexpr u8 tcp_max_window_scale = 14;
+// A SACK option can hold at most four blocks when no other options (like timestamps) are present.
+static constexpr size_t tcp_max_sack_blocks = 4;
+
 class [[gnu::packed]] TCPPacket {
 public:
     TCPPacket() = default;
@@ -83,6 +101,33 @@ public:
     const void* payload() const { return ((const u8*)this) + header_size(); }
     void* payload() { return ((u8*)this) + header_size(); }
 
+    // Calls callback(kind, data) for every option in the header, with data excluding the kind and length bytes.
+    // Parsing stops at the first malformed option.
+    template<typename Callback>
+    void for_each_option(Callback callback) const
+    {
+        if (header_size() <= sizeof(TCPPacket))
+            return;
+        auto* options = ((const u8*)this) + sizeof(TCPPacket);
+        size_t options_size = header_size() - sizeof(TCPPacket);
+        for (size_t i = 0; i < options_size;) {
+            auto kind = static_cast<TCPOptionKind>(options[i]);
+            if (kind == TCPOptionKind::End)
+                return;
+            if (kind == TCPOptionKind::NoOperation) {
+                ++i;
+                continue;
+            }
+            if (i + 1 >= options_size)
+                return;
+            size_t length = options[i + 1];
+            if (length < 2 || i + length > options_size)
+                return;
+            callback(kind, ReadonlyBytes { options + i + 2, length - 2 });
+            i += length;
+        }
+    }
+
 private:
     NetworkOrdered<u16> m_source_port;
     NetworkOrdered<u16> m_destination_port;
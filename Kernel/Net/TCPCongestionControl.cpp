@@ -0,0 +1,183 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <Kernel/Net/TCPCongestionControl.h>
+
+namespace Kernel {
+
+// Keeps the window arithmetic comfortably inside 32 bits.
+static constexpr u32 max_congestion_window = 1 * GiB;
+
+NonnullOwnPtr<TCPCongestionControl> TCPCongestionControl::create(Algorithm algorithm, u32 maximum_segment_size)
+{
+    switch (algorithm) {
+    case Algorithm::NewReno:
+        return make<NewRenoCongestionControl>(maximum_segment_size);
+    case Algorithm::Cubic:
+        return make<CubicCongestionControl>(maximum_segment_size);
+    }
+    VERIFY_NOT_REACHED();
+}
+
+Optional<TCPCongestionControl::Algorithm> TCPCongestionControl::algorithm_from_name(const StringView& name)
+{
+    if (name == to_string(Algorithm::NewReno))
+        return Algorithm::NewReno;
+    if (name == to_string(Algorithm::Cubic))
+        return Algorithm::Cubic;
+    return {};
+}
+
+TCPCongestionControl::TCPCongestionControl(u32 maximum_segment_size)
+{
+    set_maximum_segment_size(maximum_segment_size);
+}
+
+void TCPCongestionControl::set_maximum_segment_size(u32 maximum_segment_size)
+{
+    VERIFY(maximum_segment_size);
+    m_maximum_segment_size = maximum_segment_size;
+    // RFC 6928 initial window.
+    m_congestion_window = min(10 * maximum_segment_size, max(2 * maximum_segment_size, 14600u));
+}
+
+void TCPCongestionControl::grow_in_slow_start(u32 acknowledged_bytes)
+{
+    // RFC 3465 appropriate byte counting, with a limit of two segments per acknowledgement.
+    m_congestion_window = min(m_congestion_window + min(acknowledged_bytes, 2 * m_maximum_segment_size), max_congestion_window);
+}
+
+void NewRenoCongestionControl::on_ack(u32 acknowledged_bytes, const Time&)
+{
+    if (is_in_slow_start()) {
+        grow_in_slow_start(acknowledged_bytes);
+        return;
+    }
+
+    m_bytes_acknowledged_in_window += acknowledged_bytes;
+    if (m_bytes_acknowledged_in_window >= m_congestion_window) {
+        m_bytes_acknowledged_in_window -= m_congestion_window;
+        m_congestion_window = min(m_congestion_window + m_maximum_segment_size, max_congestion_window);
+    }
+}
+
+void NewRenoCongestionControl::on_congestion_event(u32 bytes_in_flight, const Time&)
+{
+    m_slow_start_threshold = max(bytes_in_flight / 2, 2 * m_maximum_segment_size);
+    m_congestion_window = m_slow_start_threshold;
+    m_bytes_acknowledged_in_window = 0;
+}
+
+void NewRenoCongestionControl::on_retransmission_timeout(u32 bytes_in_flight, const Time&)
+{
+    m_slow_start_threshold = max(bytes_in_flight / 2, 2 * m_maximum_segment_size);
+    m_congestion_window = m_maximum_segment_size;
+    m_bytes_acknowledged_in_window = 0;
+}
+
+static u64 integer_cube_root(u64 value)
+{
+    // (2^21)^3 == 2^63, which is larger than anything we pass in.
+    u64 low = 0;
+    u64 high = 1 << 21;
+    while (low < high) {
+        u64 middle = (low + high + 1) / 2;
+        if (middle * middle * middle <= value)
+            low = middle;
+        else
+            high = middle - 1;
+    }
+    return low;
+}
+
+void CubicCongestionControl::on_ack(u32 acknowledged_bytes, const Time& now)
+{
+    if (is_in_slow_start()) {
+        grow_in_slow_start(acknowledged_bytes);
+        return;
+    }
+
+    if (!m_epoch_start.has_value()) {
+        m_epoch_start = now;
+        m_estimated_window = m_congestion_window;
+        m_estimated_bytes_acknowledged = 0;
+        if (m_congestion_window < m_last_maximum_window) {
+            // K = cbrt((W_max - cwnd) / C) seconds, with C = 0.4 segments/s^3. In milliseconds that's
+            // cbrt(segments * 2.5 * 10^9), which we compute from thousandths of a segment to keep some precision.
+            u64 missing_milli_segments = (u64)(m_last_maximum_window - m_congestion_window) * 1000 / m_maximum_segment_size;
+            m_time_to_maximum_window_ms = integer_cube_root(missing_milli_segments * 2'500'000);
+        } else {
+            m_time_to_maximum_window_ms = 0;
+            m_last_maximum_window = m_congestion_window;
+        }
+    }
+
+    // W(t) = C * (t - K)^3 + W_max. The offset is clamped so that its cube can't overflow.
+    constexpr i64 max_offset_ms = 1 << 20;
+    i64 offset_ms = clamp((now - m_epoch_start.value()).to_milliseconds() - m_time_to_maximum_window_ms, -max_offset_ms, max_offset_ms);
+    i64 cubic_growth = offset_ms * offset_ms * offset_ms / 10'000'000 * 4 * m_maximum_segment_size / 1000;
+    i64 target = clamp((i64)m_last_maximum_window + cubic_growth, (i64)m_congestion_window, (i64)m_congestion_window + m_congestion_window / 2);
+
+    // The NewReno-equivalent window grows by 3 * (1 - beta) / (1 + beta) = 9 / 17 segments per window (beta = 0.7).
+    m_estimated_bytes_acknowledged += acknowledged_bytes;
+    if (m_estimated_bytes_acknowledged >= m_estimated_window) {
+        m_estimated_bytes_acknowledged -= m_estimated_window;
+        m_estimated_window = min(m_estimated_window + m_maximum_segment_size * 9 / 17, max_congestion_window);
+    }
+    if ((i64)m_estimated_window > target)
+        target = m_estimated_window;
+
+    if (target > m_congestion_window) {
+        u64 increase = max<u64>((u64)(target - m_congestion_window) * acknowledged_bytes / m_congestion_window, 1);
+        m_congestion_window = min<u64>(m_congestion_window + increase, max_congestion_window);
+    }
+}
+
+void CubicCongestionControl::reduce_after_loss()
+{
+    m_epoch_start.clear();
+    // Fast convergence: losing before we got back to the previous maximum suggests that a competing flow
+    // has claimed some of the bandwidth, so don't aim as high next time.
+    if (m_congestion_window < m_last_maximum_window)
+        m_last_maximum_window = (u64)m_congestion_window * 17 / 20;
+    else
+        m_last_maximum_window = m_congestion_window;
+    m_slow_start_threshold = max<u32>((u64)m_congestion_window * 7 / 10, 2 * m_maximum_segment_size);
+}
+
+void CubicCongestionControl::on_congestion_event(u32, const Time&)
+{
+    reduce_after_loss();
+    m_congestion_window = m_slow_start_threshold;
+}
+
+void CubicCongestionControl::on_retransmission_timeout(u32, const Time&)
+{
+    reduce_after_loss();
+    m_congestion_window = m_maximum_segment_size;
+}
+
+}
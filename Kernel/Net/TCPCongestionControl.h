@@ -0,0 +1,140 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/NonnullOwnPtr.h>
+#include <AK/NumericLimits.h>
+#include <AK/Optional.h>
+#include <AK/StringView.h>
+#include <AK/Time.h>
+#include <AK/Types.h>
+
+namespace Kernel {
+
+// Decides how much unacknowledged data a TCPSocket may have in flight.
+// The socket reports acknowledgements and loss events, and limits its transmissions to congestion_window().
+// All window sizes are in bytes.
+class TCPCongestionControl {
+public:
+    enum class Algorithm {
+        NewReno,
+        Cubic,
+    };
+
+    static const char* to_string(Algorithm algorithm)
+    {
+        switch (algorithm) {
+        case Algorithm::NewReno:
+            return "newreno";
+        case Algorithm::Cubic:
+            return "cubic";
+        default:
+            return "None";
+        }
+    }
+
+    static NonnullOwnPtr<TCPCongestionControl> create(Algorithm, u32 maximum_segment_size);
+    static Optional<Algorithm> algorithm_from_name(const StringView&);
+
+    virtual ~TCPCongestionControl() = default;
+
+    virtual const char* name() const = 0;
+
+    u32 congestion_window() const { return m_congestion_window; }
+    u32 slow_start_threshold() const { return m_slow_start_threshold; }
+    bool is_in_slow_start() const { return m_congestion_window < m_slow_start_threshold; }
+
+    // Called once the maximum segment size has been negotiated; resets the window to the initial window.
+    void set_maximum_segment_size(u32);
+
+    // New data has been acknowledged outside of loss recovery.
+    virtual void on_ack(u32 acknowledged_bytes, const Time& now) = 0;
+    // Loss was detected through duplicate or selective acknowledgements, and the socket is entering loss recovery.
+    virtual void on_congestion_event(u32 bytes_in_flight, const Time& now) = 0;
+    // Everything up to the recovery point has been acknowledged.
+    virtual void on_recovery_complete() { m_congestion_window = m_slow_start_threshold; }
+    // The retransmission timer expired, so the connection starts over from slow start.
+    virtual void on_retransmission_timeout(u32 bytes_in_flight, const Time& now) = 0;
+
+protected:
+    explicit TCPCongestionControl(u32 maximum_segment_size);
+
+    void grow_in_slow_start(u32 acknowledged_bytes);
+
+    u32 m_maximum_segment_size { 0 };
+    u32 m_congestion_window { 0 };
+    u32 m_slow_start_threshold { NumericLimits<u32>::max() };
+};
+
+// RFC 5681/6582: additive increase by one segment per window, halving on loss.
+class NewRenoCongestionControl final : public TCPCongestionControl {
+public:
+    explicit NewRenoCongestionControl(u32 maximum_segment_size)
+        : TCPCongestionControl(maximum_segment_size)
+    {
+    }
+
+    virtual const char* name() const override { return to_string(Algorithm::NewReno); }
+
+    virtual void on_ack(u32 acknowledged_bytes, const Time& now) override;
+    virtual void on_congestion_event(u32 bytes_in_flight, const Time& now) override;
+    virtual void on_retransmission_timeout(u32 bytes_in_flight, const Time& now) override;
+
+private:
+    u32 m_bytes_acknowledged_in_window { 0 };
+};
+
+// RFC 8312: the window grows as a cubic function of the time since the last loss, centered on the window
+// at which that loss happened. This makes growth independent of the round-trip time, which lets it fill
+// long fat pipes much faster than NewReno. It never grows slower than NewReno would in the same situation.
+class CubicCongestionControl final : public TCPCongestionControl {
+public:
+    explicit CubicCongestionControl(u32 maximum_segment_size)
+        : TCPCongestionControl(maximum_segment_size)
+    {
+    }
+
+    virtual const char* name() const override { return to_string(Algorithm::Cubic); }
+
+    virtual void on_ack(u32 acknowledged_bytes, const Time& now) override;
+    virtual void on_congestion_event(u32 bytes_in_flight, const Time& now) override;
+    virtual void on_retransmission_timeout(u32 bytes_in_flight, const Time& now) override;
+
+private:
+    void reduce_after_loss();
+
+    // Window size just before the last reduction.
+    u32 m_last_maximum_window { 0 };
+    // The NewReno-equivalent window, so we never grow slower than NewReno would.
+    u32 m_estimated_window { 0 };
+    u32 m_estimated_bytes_acknowledged { 0 };
+    // Start of the current congestion avoidance epoch, and the time it takes to grow back to m_last_maximum_window.
+    Optional<Time> m_epoch_start;
+    i64 m_time_to_maximum_window_ms { 0 };
+};
+
+}
@@ -29,15 +29,80 @@
 #include <Kernel/Debug.h>
 #include <Kernel/Devices/RandomDevice.h>
 #include <Kernel/FileSystem/FileDescription.h>
+#include <Kernel/FileSystem/ProcFS.h>
 #include <Kernel/Net/NetworkAdapter.h>
 #include <Kernel/Net/Routing.h>
 #include <Kernel/Net/TCP.h>
 #include <Kernel/Net/TCPSocket.h>
 #include <Kernel/Process.h>
 #include <Kernel/Random.h>
+#include <Kernel/Time/TimeManagement.h>
 
 namespace Kernel {
 
+// RFC 6298, except that the lower bound is 200ms (like most stacks use) rather than a full second.
+static constexpr Time initial_retransmission_timeout = Time::from_seconds(1);
+static constexpr Time min_retransmission_timeout = Time::from_milliseconds(200);
+static constexpr Time max_retransmission_timeout = Time::from_seconds(60);
+static constexpr u32 duplicate_ack_threshold = 3;
+// How much data may be waiting to be sent or acknowledged before writers have to wait.
+static constexpr size_t send_buffer_size = 256 * KiB;
+
+// Tunable through /proc/sys/tcp_*; new connections pick up the current values.
+static TCPCongestionControl::Algorithm s_congestion_control_algorithm { TCPCongestionControl::Algorithm::NewReno };
+static bool s_window_scaling_enabled { true };
+static bool s_sack_enabled { true };
+
+// Sequence numbers wrap around, so they have to be compared by their distance (RFC 793, section 3.3).
+static bool sequence_number_is_before(u32 a, u32 b)
+{
+    return (i32)(a - b) < 0;
+}
+
+static bool sequence_number_is_before_or_equal(u32 a, u32 b)
+{
+    return (i32)(a - b) <= 0;
+}
+
+static u8 window_scale_for_buffer_size(size_t buffer_size)
+{
+    u8 scale = 0;
+    while ((buffer_size >> scale) > NumericLimits<u16>::max() && scale < tcp_max_window_scale)
+        ++scale;
+    return scale;
+}
+
+void TCPSocket::initialize()
+{
+    static Lockable<String>* congestion_control_helper;
+    static Lockable<bool>* window_scaling_helper;
+    static Lockable<bool>* sack_helper;
+
+    if (congestion_control_helper == nullptr) {
+        congestion_control_helper = new Lockable<String>(TCPCongestionControl::to_string(s_congestion_control_algorithm));
+        ProcFS::add_sys_string("tcp_congestion_control", *congestion_control_helper, [] {
+            LOCKER(congestion_control_helper->lock());
+            auto& name = congestion_control_helper->resource();
+            auto algorithm = TCPCongestionControl::algorithm_from_name(name.view().trim_whitespace());
+            if (algorithm.has_value())
+                s_congestion_control_algorithm = algorithm.value();
+            else
+                dbgln("TCPSocket: Unknown congestion control algorithm '{}'", name);
+            name = TCPCongestionControl::to_string(s_congestion_control_algorithm);
+        });
+        window_scaling_helper = new Lockable<bool>();
+        window_scaling_helper->resource() = s_window_scaling_enabled;
+        ProcFS::add_sys_bool("tcp_window_scaling", *window_scaling_helper, [] {
+            s_window_scaling_enabled = window_scaling_helper->resource();
+        });
+        sack_helper = new Lockable<bool>();
+        sack_helper->resource() = s_sack_enabled;
+        ProcFS::add_sys_bool("tcp_sack", *sack_helper, [] {
+            s_sack_enabled = sack_helper->resource();
+        });
+    }
+}
+
 void TCPSocket::for_each(Function<void(const TCPSocket&)> callback)
 {
     LOCKER(sockets_by_tuple().lock(), Lock::Mode::Shared);
@@ -146,7 +211,13 @@ void TCPSocket::release_for_accept(RefPtr<TCPSocket> socket)
 
 TCPSocket::TCPSocket(int protocol)
     : IPv4Socket(SOCK_STREAM, protocol)
+    , m_window_scaling_enabled(s_window_scaling_enabled)
+    , m_sack_enabled(s_sack_enabled)
+    , m_congestion_control(TCPCongestionControl::create(s_congestion_control_algorithm, tcp_default_maximum_segment_size))
+    , m_retransmission_timeout(initial_retransmission_timeout)
 {
+    if (m_window_scaling_enabled)
+        m_receive_window_scale = window_scale_for_buffer_size(receive_buffer_capacity());
 }
 
 TCPSocket::~TCPSocket()
@@ -162,38 +233,165 @@ NonnullRefPtr<TCPSocket> TCPSocket::create(int protocol)
     return adopt(*new TCPSocket(protocol));
 }
 
-KResultOr<size_t> TCPSocket::protocol_receive(ReadonlyBytes raw_ipv4_packet, UserOrKernelBuffer& buffer, size_t buffer_size, [[maybe_unused]] int flags)
+ReadonlyBytes TCPSocket::protocol_payload(ReadonlyBytes raw_ipv4_packet) const
 {
     auto& ipv4_packet = *reinterpret_cast<const IPv4Packet*>(raw_ipv4_packet.data());
     auto& tcp_packet = *static_cast<const TCPPacket*>(ipv4_packet.payload());
     size_t payload_size = raw_ipv4_packet.size() - sizeof(IPv4Packet) - tcp_packet.header_size();
-    dbgln_if(TCP_SOCKET_DEBUG, "payload_size {}, will it fit in {}?", payload_size, buffer_size);
-    VERIFY(buffer_size >= payload_size);
-    if (!buffer.write(tcp_packet.payload(), payload_size))
+    return { static_cast<const u8*>(tcp_packet.payload()), payload_size };
+}
+
+KResultOr<size_t> TCPSocket::protocol_receive(ReadonlyBytes raw_ipv4_packet, UserOrKernelBuffer& buffer, size_t buffer_size, [[maybe_unused]] int flags)
+{
+    auto payload = protocol_payload(raw_ipv4_packet);
+    dbgln_if(TCP_SOCKET_DEBUG, "payload_size {}, will it fit in {}?", payload.size(), buffer_size);
+    VERIFY(buffer_size >= payload.size());
+    if (!buffer.write(payload.data(), payload.size()))
         return EFAULT;
-    return payload_size;
+    return payload.size();
+}
+
+bool TCPSocket::can_write(const FileDescription& description, size_t offset) const
+{
+    return IPv4Socket::can_write(description, offset) && m_not_acked_size < send_buffer_size;
 }
 
 KResultOr<size_t> TCPSocket::protocol_send(const UserOrKernelBuffer& data, size_t data_length)
 {
-    int err = send_tcp_packet(TCPFlags::PUSH | TCPFlags::ACK, &data, data_length);
-    if (err < 0)
-        return KResult((ErrnoCode)-err);
-    return data_length;
+    // Only take as much as fits in the send buffer; the caller blocks (or gets EAGAIN) until acknowledgements make room.
+    if (m_not_acked_size >= send_buffer_size)
+        return EAGAIN;
+    data_length = min(data_length, send_buffer_size - m_not_acked_size);
+
+    // Cut the data into segments the peer can take. How many of them go out right away is up to the send window,
+    // the rest follow as acknowledgements come in.
+    size_t nqueued = 0;
+    while (nqueued < data_length) {
+        size_t segment_size = min<size_t>(data_length - nqueued, m_send_maximum_segment_size);
+        auto segment = data.offset(nqueued);
+        auto packet_or_error = build_tcp_packet(TCPFlags::PUSH | TCPFlags::ACK, &segment, segment_size);
+        if (packet_or_error.is_error()) {
+            if (nqueued == 0)
+                return packet_or_error.error();
+            break;
+        }
+        enqueue_packet(packet_or_error.release_value(), segment_size);
+        nqueued += segment_size;
+    }
+    send_outgoing_packets();
+    return nqueued;
 }
 
-KResult TCPSocket::send_tcp_packet(u16 flags, const UserOrKernelBuffer* payload, size_t payload_size)
+u16 TCPSocket::local_maximum_segment_size() const
+{
+    auto routing_decision = route_to(peer_address(), local_address(), bound_interface());
+    if (routing_decision.is_zero())
+        return tcp_default_maximum_segment_size;
+    size_t mtu = min<size_t>(routing_decision.adapter->mtu(), NumericLimits<u16>::max());
+    return mtu - sizeof(IPv4Packet) - sizeof(TCPPacket);
+}
+
+u16 TCPSocket::advertised_window(bool is_syn) const
+{
+    // Segments that are waiting for a gap to be filled will need room in the receive buffer too.
+    size_t space = receive_buffer_space();
+    space = space > m_out_of_order_bytes ? space - m_out_of_order_bytes : 0;
+    // The window in a SYN is never scaled.
+    if (!is_syn)
+        space >>= m_receive_window_scale;
+    return min<size_t>(space, NumericLimits<u16>::max());
+}
+
+size_t TCPSocket::write_options(u16 flags, u8* options) const
 {
-    const size_t buffer_size = sizeof(TCPPacket) + payload_size;
+    size_t size = 0;
+
+    if (flags & TCPFlags::SYN) {
+        u16 maximum_segment_size = local_maximum_segment_size();
+        options[size++] = (u8)TCPOptionKind::MaximumSegmentSize;
+        options[size++] = 4;
+        options[size++] = maximum_segment_size >> 8;
+        options[size++] = maximum_segment_size & 0xff;
+        if (m_window_scaling_enabled) {
+            options[size++] = (u8)TCPOptionKind::NoOperation;
+            options[size++] = (u8)TCPOptionKind::WindowScale;
+            options[size++] = 3;
+            options[size++] = m_receive_window_scale;
+        }
+        if (m_sack_enabled) {
+            options[size++] = (u8)TCPOptionKind::NoOperation;
+            options[size++] = (u8)TCPOptionKind::NoOperation;
+            options[size++] = (u8)TCPOptionKind::SACKPermitted;
+            options[size++] = 2;
+        }
+        return size;
+    }
+
+    if (!m_sack_enabled || m_out_of_order_segments.is_empty())
+        return 0;
+
+    struct Block {
+        u32 left_edge;
+        u32 right_edge;
+    };
+    Vector<Block, 16> blocks;
+    for (auto& segment : m_out_of_order_segments) {
+        u32 right_edge = segment.sequence_number + segment.payload.size();
+        if (!blocks.is_empty() && sequence_number_is_before_or_equal(segment.sequence_number, blocks.last().right_edge)) {
+            if (sequence_number_is_before(blocks.last().right_edge, right_edge))
+                blocks.last().right_edge = right_edge;
+            continue;
+        }
+        blocks.append({ segment.sequence_number, right_edge });
+    }
+
+    // The block containing the most recently received segment has to come first (RFC 2018).
+    for (size_t i = 1; i < blocks.size(); ++i) {
+        auto& block = blocks[i];
+        if (sequence_number_is_before_or_equal(block.left_edge, m_last_out_of_order_sequence_number) && sequence_number_is_before(m_last_out_of_order_sequence_number, block.right_edge)) {
+            blocks.prepend(blocks.take(i));
+            break;
+        }
+    }
+
+    size_t block_count = min(blocks.size(), tcp_max_sack_blocks);
+    options[size++] = (u8)TCPOptionKind::NoOperation;
+    options[size++] = (u8)TCPOptionKind::NoOperation;
+    options[size++] = (u8)TCPOptionKind::SACK;
+    options[size++] = 2 + block_count * 2 * sizeof(u32);
+    for (size_t i = 0; i < block_count; ++i) {
+        NetworkOrdered<u32> left_edge = blocks[i].left_edge;
+        NetworkOrdered<u32> right_edge = blocks[i].right_edge;
+        memcpy(options + size, &left_edge, sizeof(left_edge));
+        size += sizeof(left_edge);
+        memcpy(options + size, &right_edge, sizeof(right_edge));
+        size += sizeof(right_edge);
+    }
+    return size;
+}
+
+KResultOr<ByteBuffer> TCPSocket::build_tcp_packet(u16 flags, const UserOrKernelBuffer* payload, size_t payload_size) const
+{
+    // Packets carrying data or a FIN may be retransmitted much later, when SACK blocks would be stale,
+    // so only the SYN and pure acknowledgements get options.
+    u8 options[tcp_max_options_size];
+    size_t options_size = 0;
+    if ((flags & TCPFlags::SYN) || (payload_size == 0 && !(flags & TCPFlags::FIN)))
+        options_size = write_options(flags, options);
+    VERIFY(options_size <= tcp_max_options_size && options_size % sizeof(u32) == 0);
+
+    const size_t header_size = sizeof(TCPPacket) + options_size;
+    const size_t buffer_size = header_size + payload_size;
     auto buffer = ByteBuffer::create_zeroed(buffer_size);
     auto& tcp_packet = *(TCPPacket*)(buffer.data());
     VERIFY(local_port());
     tcp_packet.set_source_port(local_port());
     tcp_packet.set_destination_port(peer_port());
-    tcp_packet.set_window_size(1024);
+    tcp_packet.set_window_size(advertised_window(flags & TCPFlags::SYN));
     tcp_packet.set_sequence_number(m_sequence_number);
-    tcp_packet.set_data_offset(sizeof(TCPPacket) / sizeof(u32));
+    tcp_packet.set_data_offset(header_size / sizeof(u32));
     tcp_packet.set_flags(flags);
+    memcpy(buffer.data() + sizeof(TCPPacket), options, options_size);
 
     if (flags & TCPFlags::ACK)
         tcp_packet.set_ack_number(m_ack_number);
@@ -201,17 +399,29 @@ KResult TCPSocket::send_tcp_packet(u16 flags, const UserOrKernelBuffer* payload,
     if (payload && !payload->read(tcp_packet.payload(), payload_size))
         return EFAULT;
 
-    if (flags & TCPFlags::SYN) {
-        ++m_sequence_number;
-    } else {
-        m_sequence_number += payload_size;
-    }
-
     tcp_packet.set_checksum(compute_tcp_checksum(local_address(), peer_address(), tcp_packet, payload_size));
+    return buffer;
+}
 
-    if (tcp_packet.has_syn() || payload_size > 0) {
-        LOCKER(m_not_acked_lock);
-        m_not_acked.append({ m_sequence_number, move(buffer) });
+void TCPSocket::enqueue_packet(ByteBuffer&& buffer, u32 sequence_length)
+{
+    LOCKER(m_not_acked_lock);
+    m_not_acked.append({ m_sequence_number, m_sequence_number + sequence_length, move(buffer) });
+    m_not_acked_size += sequence_length;
+    m_sequence_number += sequence_length;
+}
+
+KResult TCPSocket::send_tcp_packet(u16 flags, const UserOrKernelBuffer* payload, size_t payload_size)
+{
+    auto packet_or_error = build_tcp_packet(flags, payload, payload_size);
+    if (packet_or_error.is_error())
+        return packet_or_error.error();
+
+    // SYNs and FINs take up a sequence number just like data, so they have to go out after whatever
+    // is still queued ahead of them, and get retransmitted until the peer acknowledges them.
+    if ((flags & (TCPFlags::SYN | TCPFlags::FIN)) || payload_size > 0) {
+        u32 sequence_length = payload_size + ((flags & TCPFlags::SYN) ? 1 : 0) + ((flags & TCPFlags::FIN) ? 1 : 0);
+        enqueue_packet(packet_or_error.release_value(), sequence_length);
         send_outgoing_packets();
         return KSuccess;
     }
@@ -219,102 +429,464 @@ KResult TCPSocket::send_tcp_packet(u16 flags, const UserOrKernelBuffer* payload,
     auto routing_decision = route_to(peer_address(), local_address(), bound_interface());
     VERIFY(!routing_decision.is_zero());
 
+    auto buffer = packet_or_error.release_value();
+    m_last_advertised_window = (u32)((TCPPacket*)buffer.data())->window_size() << m_receive_window_scale;
     auto packet_buffer = UserOrKernelBuffer::for_kernel_buffer(buffer.data());
     auto result = routing_decision.adapter->send_ipv4(
         routing_decision.next_hop, peer_address(), IPv4Protocol::TCP,
-        packet_buffer, buffer_size, ttl());
+        packet_buffer, buffer.size(), ttl());
     if (result.is_error())
         return result;
 
     m_packets_out++;
-    m_bytes_out += buffer_size;
+    m_bytes_out += buffer.size();
+    return KSuccess;
+}
+
+size_t TCPSocket::bytes_in_flight() const
+{
+    VERIFY(m_not_acked_lock.is_locked());
+    size_t bytes = 0;
+    for (auto& packet : m_not_acked) {
+        if (packet.tx_counter > 0 && !packet.is_sacked && !packet.is_lost)
+            bytes += packet.ack_number - packet.sequence_number;
+    }
+    return bytes;
+}
+
+KResult TCPSocket::transmit_packet(OutgoingPacket& packet, RoutingDecision& routing_decision)
+{
+    // The acknowledgement number and window may have moved on since the packet was built.
+    auto& tcp_packet = *(TCPPacket*)(packet.buffer.data());
+    if (tcp_packet.has_ack())
+        tcp_packet.set_ack_number(m_ack_number);
+    u16 window = advertised_window(tcp_packet.has_syn());
+    tcp_packet.set_window_size(window);
+    m_last_advertised_window = (u32)window << (tcp_packet.has_syn() ? 0 : m_receive_window_scale);
+    tcp_packet.set_checksum(0);
+    tcp_packet.set_checksum(compute_tcp_checksum(local_address(), peer_address(), tcp_packet, packet.buffer.size() - tcp_packet.header_size()));
+
+    if (packet.tx_counter == 0)
+        m_highest_transmitted_sequence_number = packet.ack_number;
+    else
+        m_retransmissions++;
+    packet.tx_time = TimeManagement::the().monotonic_time();
+    packet.tx_counter++;
+    packet.is_lost = false;
+
+    if constexpr (TCP_SOCKET_DEBUG) {
+        dbgln("Sending TCP packet from {}:{} to {}:{} with ({}{}{}{}) seq_no={}, ack_no={}, tx_counter={}",
+            local_address(), local_port(),
+            peer_address(), peer_port(),
+            (tcp_packet.has_syn() ? "SYN " : ""),
+            (tcp_packet.has_ack() ? "ACK " : ""),
+            (tcp_packet.has_fin() ? "FIN " : ""),
+            (tcp_packet.has_rst() ? "RST " : ""),
+            tcp_packet.sequence_number(),
+            tcp_packet.ack_number(),
+            packet.tx_counter);
+    }
+
+    auto packet_buffer = UserOrKernelBuffer::for_kernel_buffer(packet.buffer.data());
+    auto result = routing_decision.adapter->send_ipv4(
+        routing_decision.next_hop, peer_address(), IPv4Protocol::TCP,
+        packet_buffer, packet.buffer.size(), ttl());
+    if (result.is_error()) {
+        dmesgln("Error ({}) sending TCP packet from {}:{} to {}:{} with ({}{}{}{}) seq_no={}, ack_no={}, tx_counter={}",
+            result.error(),
+            local_address(),
+            local_port(),
+            peer_address(),
+            peer_port(),
+            (tcp_packet.has_syn() ? "SYN " : ""),
+            (tcp_packet.has_ack() ? "ACK " : ""),
+            (tcp_packet.has_fin() ? "FIN " : ""),
+            (tcp_packet.has_rst() ? "RST " : ""),
+            tcp_packet.sequence_number(),
+            tcp_packet.ack_number(),
+            packet.tx_counter);
+        return result;
+    }
+
+    m_packets_out++;
+    m_bytes_out += packet.buffer.size();
     return KSuccess;
 }
 
 void TCPSocket::send_outgoing_packets()
 {
+    LOCKER(m_not_acked_lock);
+    if (m_not_acked.is_empty())
+        return;
+
     auto routing_decision = route_to(peer_address(), local_address(), bound_interface());
     VERIFY(!routing_decision.is_zero());
 
-    auto now = kgettimeofday();
-
-    LOCKER(m_not_acked_lock, Lock::Mode::Shared);
+    // Send new and lost segments, in sequence order, for as long as both the congestion window
+    // and the peer's receive window allow.
+    size_t in_flight = bytes_in_flight();
+    size_t send_window = min(m_congestion_control->congestion_window(), m_send_window);
     for (auto& packet : m_not_acked) {
-        auto diff = now - packet.tx_time;
-        if (diff <= Time::from_nanoseconds(500'000'000))
+        if (packet.is_sacked || (packet.tx_counter > 0 && !packet.is_lost))
             continue;
-        packet.tx_time = now;
-        packet.tx_counter++;
-
-        if constexpr (TCP_SOCKET_DEBUG) {
-            auto& tcp_packet = *(const TCPPacket*)(packet.buffer.data());
-            dbgln("Sending TCP packet from {}:{} to {}:{} with ({}{}{}{}) seq_no={}, ack_no={}, tx_counter={}",
-                local_address(), local_port(),
-                peer_address(), peer_port(),
-                (tcp_packet.has_syn() ? "SYN " : ""),
-                (tcp_packet.has_ack() ? "ACK " : ""),
-                (tcp_packet.has_fin() ? "FIN " : ""),
-                (tcp_packet.has_rst() ? "RST " : ""),
-                tcp_packet.sequence_number(),
-                tcp_packet.ack_number(),
-                packet.tx_counter);
+        size_t length = packet.ack_number - packet.sequence_number;
+        // With nothing in flight, one segment is always allowed so that a closed window gets probed.
+        if (in_flight > 0 && in_flight + length > send_window)
+            break;
+        if (transmit_packet(packet, routing_decision).is_error())
+            break;
+        in_flight += length;
+    }
+}
+
+void TCPSocket::update_round_trip_time(const Time& sample)
+{
+    // RFC 6298, section 2.
+    i64 sample_us = max<i64>(sample.to_microseconds(), 1);
+    if (!m_smoothed_round_trip_time_us) {
+        m_smoothed_round_trip_time_us = sample_us;
+        m_round_trip_time_variance_us = sample_us / 2;
+    } else {
+        i64 deviation_us = m_smoothed_round_trip_time_us - sample_us;
+        if (deviation_us < 0)
+            deviation_us = -deviation_us;
+        m_round_trip_time_variance_us = (3 * m_round_trip_time_variance_us + deviation_us) / 4;
+        m_smoothed_round_trip_time_us = (7 * m_smoothed_round_trip_time_us + sample_us) / 8;
+    }
+    auto timeout = Time::from_microseconds(m_smoothed_round_trip_time_us + 4 * m_round_trip_time_variance_us);
+    m_retransmission_timeout = clamp(timeout, min_retransmission_timeout, max_retransmission_timeout);
+}
+
+void TCPSocket::process_sack_blocks(const TCPPacket& tcp_packet)
+{
+    VERIFY(m_not_acked_lock.is_locked());
+    tcp_packet.for_each_option([&](TCPOptionKind kind, ReadonlyBytes data) {
+        if (kind != TCPOptionKind::SACK)
+            return;
+        for (size_t offset = 0; offset + 2 * sizeof(u32) <= data.size(); offset += 2 * sizeof(u32)) {
+            NetworkOrdered<u32> left_edge;
+            NetworkOrdered<u32> right_edge;
+            memcpy(&left_edge, data.offset(offset), sizeof(left_edge));
+            memcpy(&right_edge, data.offset(offset + sizeof(u32)), sizeof(right_edge));
+            for (auto& packet : m_not_acked) {
+                if (sequence_number_is_before_or_equal(right_edge, packet.sequence_number))
+                    break;
+                if (sequence_number_is_before_or_equal(left_edge, packet.sequence_number) && sequence_number_is_before_or_equal(packet.ack_number, right_edge)) {
+                    packet.is_sacked = true;
+                    packet.is_lost = false;
+                }
+            }
         }
+    });
+}
 
-        auto packet_buffer = UserOrKernelBuffer::for_kernel_buffer(packet.buffer.data());
-        int err = routing_decision.adapter->send_ipv4(
-            routing_decision.next_hop, peer_address(), IPv4Protocol::TCP,
-            packet_buffer, packet.buffer.size(), ttl());
-        if (err < 0) {
-            auto& tcp_packet = *(const TCPPacket*)(packet.buffer.data());
-            dmesgln("Error ({}) sending TCP packet from {}:{} to {}:{} with ({}{}{}{}) seq_no={}, ack_no={}, tx_counter={}",
-                err,
-                local_address(),
-                local_port(),
-                peer_address(),
-                peer_port(),
-                (tcp_packet.has_syn() ? "SYN " : ""),
-                (tcp_packet.has_ack() ? "ACK " : ""),
-                (tcp_packet.has_fin() ? "FIN " : ""),
-                (tcp_packet.has_rst() ? "RST " : ""),
-                tcp_packet.sequence_number(),
-                tcp_packet.ack_number(),
-                packet.tx_counter);
-        } else {
-            m_packets_out++;
-            m_bytes_out += packet.buffer.size();
+void TCPSocket::mark_lost_packets()
+{
+    VERIFY(m_not_acked_lock.is_locked());
+    if (m_not_acked.is_empty())
+        return;
+
+    size_t in_flight = bytes_in_flight();
+    bool found_loss = false;
+
+    // With SACK, a segment counts as lost once three segments' worth of data above it has arrived (RFC 6675).
+    // Segments that were already retransmitted during this recovery are left to the retransmission timer.
+    if (m_sack_enabled) {
+        size_t sacked_bytes_above = 0;
+        for (auto& packet : m_not_acked) {
+            if (packet.is_sacked)
+                sacked_bytes_above += packet.ack_number - packet.sequence_number;
+        }
+        for (auto& packet : m_not_acked) {
+            if (sacked_bytes_above < duplicate_ack_threshold * m_send_maximum_segment_size || packet.tx_counter == 0)
+                break;
+            if (packet.is_sacked) {
+                sacked_bytes_above -= packet.ack_number - packet.sequence_number;
+                continue;
+            }
+            if (packet.is_lost || (m_in_loss_recovery && packet.tx_time >= m_recovery_start))
+                continue;
+            packet.is_lost = true;
+            found_loss = true;
         }
     }
+
+    // Without SACK information, the third duplicate acknowledgement triggers a fast retransmit (RFC 5681).
+    if (!found_loss && !m_in_loss_recovery && m_duplicate_ack_count >= duplicate_ack_threshold) {
+        auto& first = m_not_acked.first();
+        if (first.tx_counter > 0 && !first.is_sacked && !first.is_lost) {
+            first.is_lost = true;
+            found_loss = true;
+        }
+    }
+
+    if (found_loss && !m_in_loss_recovery) {
+        auto now = TimeManagement::the().monotonic_time();
+        dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket: Entering loss recovery, {} bytes in flight", in_flight);
+        m_in_loss_recovery = true;
+        m_recovery_point = m_highest_transmitted_sequence_number;
+        m_recovery_start = now;
+        m_congestion_control->on_congestion_event(in_flight, now);
+    }
 }
 
-void TCPSocket::receive_tcp_packet(const TCPPacket& packet, u16 size)
+void TCPSocket::process_acknowledgement(const TCPPacket& packet, u16 size)
 {
-    if (packet.has_ack()) {
-        u32 ack_number = packet.ack_number();
+    u32 ack_number = packet.ack_number();
+    auto now = TimeManagement::the().monotonic_time();
 
-        dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket: receive_tcp_packet: {}", ack_number);
+    dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket: receive_tcp_packet: {}", ack_number);
 
-        int removed = 0;
+    // The window in a SYN is never scaled.
+    m_send_window = (u32)packet.window_size() << (packet.has_syn() ? 0 : m_send_window_scale);
+
+    u32 acknowledged_bytes = 0;
+    {
         LOCKER(m_not_acked_lock);
+
+        int removed = 0;
+        Optional<Time> round_trip_time;
         while (!m_not_acked.is_empty()) {
-            auto& packet = m_not_acked.first();
+            auto& outgoing_packet = m_not_acked.first();
 
-            dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket: iterate: {}", packet.ack_number);
+            dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket: iterate: {}", outgoing_packet.ack_number);
 
-            if (packet.ack_number <= ack_number) {
-                m_not_acked.take_first();
-                removed++;
-            } else {
+            if (!sequence_number_is_before_or_equal(outgoing_packet.ack_number, ack_number))
                 break;
-            }
+            // Karn's algorithm: only a segment that was sent once gives an unambiguous sample.
+            if (outgoing_packet.tx_counter == 1)
+                round_trip_time = now - outgoing_packet.tx_time;
+            acknowledged_bytes += outgoing_packet.ack_number - outgoing_packet.sequence_number;
+            m_not_acked_size -= outgoing_packet.ack_number - outgoing_packet.sequence_number;
+            m_not_acked.take_first();
+            removed++;
         }
 
         dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket: receive_tcp_packet acknowledged {} packets", removed);
+
+        if (round_trip_time.has_value())
+            update_round_trip_time(round_trip_time.value());
+
+        if (m_sack_enabled)
+            process_sack_blocks(packet);
+
+        if (acknowledged_bytes > 0) {
+            m_duplicate_ack_count = 0;
+            if (!m_in_loss_recovery) {
+                m_congestion_control->on_ack(acknowledged_bytes, now);
+            } else if (sequence_number_is_before_or_equal(m_recovery_point, ack_number)) {
+                m_in_loss_recovery = false;
+                m_congestion_control->on_recovery_complete();
+            } else if (!m_sack_enabled && !m_not_acked.is_empty()) {
+                // A partial acknowledgement means the next segment was lost as well (RFC 6582).
+                auto& next = m_not_acked.first();
+                if (next.tx_counter > 0 && next.tx_time < m_recovery_start)
+                    next.is_lost = true;
+            }
+        } else if (size == packet.header_size() && !packet.has_syn() && !packet.has_fin() && !m_not_acked.is_empty() && m_not_acked.first().sequence_number == ack_number) {
+            m_duplicate_ack_count++;
+        }
+
+        mark_lost_packets();
     }
 
+    send_outgoing_packets();
+
+    // Writers waiting for room in the send buffer can go on now.
+    if (acknowledged_bytes > 0)
+        evaluate_block_conditions();
+}
+
+void TCPSocket::receive_tcp_packet(const TCPPacket& packet, u16 size)
+{
+    if (packet.has_ack())
+        process_acknowledgement(packet, size);
+
     m_packets_in++;
     m_bytes_in += packet.header_size() + size;
 }
 
+void TCPSocket::retransmit_timed_out_packets()
+{
+    {
+        LOCKER(m_not_acked_lock);
+
+        // The timer runs for the oldest segment that is still outstanding.
+        OutgoingPacket* oldest_packet = nullptr;
+        for (auto& packet : m_not_acked) {
+            if (packet.tx_counter > 0 && !packet.is_sacked && !packet.is_lost) {
+                oldest_packet = &packet;
+                break;
+            }
+        }
+        if (!oldest_packet)
+            return;
+
+        auto now = TimeManagement::the().monotonic_time();
+        if (now - oldest_packet->tx_time < m_retransmission_timeout)
+            return;
+
+        dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket: Retransmission timeout after {}ms, seq_no={}", m_retransmission_timeout.to_milliseconds(), oldest_packet->sequence_number);
+
+        // With the peer's window closed, the retransmission is only a probe for it opening up again (RFC 1122,
+        // section 4.2.2.17), and going unanswered says nothing about congestion.
+        if (m_send_window > 0)
+            m_congestion_control->on_retransmission_timeout(bytes_in_flight(), now);
+
+        // Start over from the first unacknowledged segment. The peer is allowed to drop data that it has
+        // selectively acknowledged, so the SACK scoreboard goes too (RFC 2018, section 8).
+        for (auto& packet : m_not_acked) {
+            if (packet.tx_counter > 0) {
+                packet.is_sacked = false;
+                packet.is_lost = true;
+            }
+        }
+        m_in_loss_recovery = false;
+        m_duplicate_ack_count = 0;
+        m_retransmission_timeout = min(m_retransmission_timeout + m_retransmission_timeout, max_retransmission_timeout);
+    }
+
+    send_outgoing_packets();
+}
+
+void TCPSocket::protocol_did_read_received_data()
+{
+    if (m_state != State::Established && m_state != State::FinWait1 && m_state != State::FinWait2)
+        return;
+
+    // The peer only finds out that the application has made room in the receive buffer from our next segment,
+    // and a closed window would otherwise stay closed until its persist timer fires. Send a window update once
+    // the window has opened up far enough to be worth it (RFC 1122, section 4.2.3.3).
+    u32 window = (u32)advertised_window(false) << m_receive_window_scale;
+    if (window <= m_last_advertised_window)
+        return;
+    size_t threshold = min<size_t>(local_maximum_segment_size(), receive_buffer_capacity() / 2);
+    if (window - m_last_advertised_window < threshold)
+        return;
+    [[maybe_unused]] auto rc = send_tcp_packet(TCPFlags::ACK);
+}
+
+void TCPSocket::retransmit_timed_out_packets_on_all_sockets()
+{
+    Vector<NonnullRefPtr<TCPSocket>> sockets;
+    {
+        LOCKER(sockets_by_tuple().lock(), Lock::Mode::Shared);
+        for (auto& it : sockets_by_tuple().resource())
+            sockets.append(*it.value);
+    }
+
+    for (auto& socket : sockets) {
+        LOCKER(socket->lock());
+        socket->retransmit_timed_out_packets();
+    }
+}
+
+void TCPSocket::process_syn_options(const TCPPacket& packet)
+{
+    VERIFY(packet.has_syn());
+
+    Optional<u16> maximum_segment_size;
+    Optional<u8> window_scale;
+    bool sack_permitted = false;
+    packet.for_each_option([&](TCPOptionKind kind, ReadonlyBytes data) {
+        switch (kind) {
+        case TCPOptionKind::MaximumSegmentSize:
+            if (data.size() == 2 && (data[0] || data[1]))
+                maximum_segment_size = (data[0] << 8) | data[1];
+            break;
+        case TCPOptionKind::WindowScale:
+            if (data.size() == 1)
+                window_scale = min(data[0], tcp_max_window_scale);
+            break;
+        case TCPOptionKind::SACKPermitted:
+            sack_permitted = true;
+            break;
+        default:
+            break;
+        }
+    });
+
+    // Both window scaling and SACK are only used if both sides asked for them.
+    if (m_window_scaling_enabled && window_scale.has_value()) {
+        m_send_window_scale = window_scale.value();
+    } else {
+        m_window_scaling_enabled = false;
+        m_send_window_scale = 0;
+        m_receive_window_scale = 0;
+    }
+    m_sack_enabled = m_sack_enabled && sack_permitted;
+
+    m_send_maximum_segment_size = min(maximum_segment_size.value_or(tcp_default_maximum_segment_size), local_maximum_segment_size());
+    m_congestion_control->set_maximum_segment_size(m_send_maximum_segment_size);
+    m_send_window = packet.window_size();
+
+    dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket: Negotiated mss={}, window_scale={}/{}, sack={}", m_send_maximum_segment_size, m_send_window_scale, m_receive_window_scale, m_sack_enabled);
+}
+
+bool TCPSocket::receive_payload(const TCPPacket& tcp_packet, NonnullRefPtr<PacketBuffer> packet, size_t payload_size)
+{
+    u32 sequence_number = tcp_packet.sequence_number();
+    u32 end_sequence_number = sequence_number + payload_size;
+    if (payload_size == 0)
+        return sequence_number == m_ack_number;
+
+    if (sequence_number_is_before_or_equal(end_sequence_number, m_ack_number)) {
+        dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket: Ignoring duplicate segment, seq_no={}, payload_size={}", sequence_number, payload_size);
+        return false;
+    }
+
+    auto payload = protocol_payload(packet->bytes());
+    if (payload.size() != payload_size) {
+        dbgln("TCPSocket: Segment payload size mismatch ({}, expected {})", payload.size(), payload_size);
+        return false;
+    }
+
+    if (sequence_number_is_before(m_ack_number, sequence_number)) {
+        // Something before this segment went missing. Hold on to it until the gap has been filled,
+        // the SACK blocks in our acknowledgements will tell the peer what we have.
+        if (m_out_of_order_bytes + payload_size > receive_buffer_space()) {
+            dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket: No room for out-of-order segment, seq_no={}", sequence_number);
+            return false;
+        }
+        size_t index = 0;
+        for (; index < m_out_of_order_segments.size(); ++index) {
+            auto& segment = m_out_of_order_segments[index];
+            if (segment.sequence_number == sequence_number)
+                return false;
+            if (sequence_number_is_before(sequence_number, segment.sequence_number))
+                break;
+        }
+        m_out_of_order_segments.insert(index, OutOfOrderSegment { sequence_number, payload, move(packet) });
+        m_out_of_order_bytes += payload_size;
+        m_last_out_of_order_sequence_number = sequence_number;
+        return false;
+    }
+
+    // A retransmission may have been cut differently and overlap data we already have.
+    if (!did_receive_stream_data(payload.slice(m_ack_number - sequence_number)))
+        return false;
+    m_ack_number = end_sequence_number;
+    deliver_out_of_order_segments();
+    return true;
+}
+
+void TCPSocket::deliver_out_of_order_segments()
+{
+    while (!m_out_of_order_segments.is_empty()) {
+        auto& segment = m_out_of_order_segments.first();
+        if (sequence_number_is_before(m_ack_number, segment.sequence_number))
+            return;
+        u32 end_sequence_number = segment.sequence_number + segment.payload.size();
+        if (sequence_number_is_before(m_ack_number, end_sequence_number)) {
+            if (!did_receive_stream_data(segment.payload.slice(m_ack_number - segment.sequence_number)))
+                return;
+            m_ack_number = end_sequence_number;
+        }
+        m_out_of_order_bytes -= segment.payload.size();
+        m_out_of_order_segments.take_first();
+    }
+}
+
 NetworkOrdered<u16> TCPSocket::compute_tcp_checksum(const IPv4Address& source, const IPv4Address& destination, const TCPPacket& packet, u16 payload_size)
 {
     struct [[gnu::packed]] PseudoHeader {
@@ -325,7 +897,7 @@ NetworkOrdered<u16> TCPSocket::compute_tcp_checksum(const IPv4Address& source, c
         NetworkOrdered<u16> payload_size;
     };
 
-    PseudoHeader pseudo_header { source, destination, 0, (u8)IPv4Protocol::TCP, sizeof(TCPPacket) + payload_size };
+    PseudoHeader pseudo_header { source, destination, 0, (u8)IPv4Protocol::TCP, (u16)(packet.header_size() + payload_size) };
 
     u32 checksum = 0;
     auto* w = (const NetworkOrdered<u16>*)&pseudo_header;
@@ -335,12 +907,11 @@ NetworkOrdered<u16> TCPSocket::compute_tcp_checksum(const IPv4Address& source, c
             checksum = (checksum >> 16) + (checksum & 0xffff);
     }
     w = (const NetworkOrdered<u16>*)&packet;
-    for (size_t i = 0; i < sizeof(packet) / sizeof(u16); ++i) {
+    for (size_t i = 0; i < packet.header_size() / sizeof(u16); ++i) {
         checksum += w[i];
         if (checksum > 0xffff)
             checksum = (checksum >> 16) + (checksum & 0xffff);
     }
-    VERIFY(packet.data_offset() * 4 == sizeof(TCPPacket));
     w = (const NetworkOrdered<u16>*)packet.payload();
     for (size_t i = 0; i < payload_size / sizeof(u16); ++i) {
         checksum += w[i];
@@ -28,14 +28,20 @@
 
 #include <AK/Function.h>
 #include <AK/HashMap.h>
+#include <AK/OwnPtr.h>
 #include <AK/SinglyLinkedList.h>
 #include <AK/WeakPtr.h>
 #include <Kernel/Net/IPv4Socket.h>
+#include <Kernel/Net/TCP.h>
+#include <Kernel/Net/TCPCongestionControl.h>
 
 namespace Kernel {
 
+struct RoutingDecision;
+
 class TCPSocket final : public IPv4Socket {
 public:
+    static void initialize();
     static void for_each(Function<void(const TCPSocket&)>);
     static NonnullRefPtr<TCPSocket> create(int protocol);
     virtual ~TCPSocket() override;
@@ -147,11 +153,28 @@ public:
     u32 bytes_in() const { return m_bytes_in; }
     u32 packets_out() const { return m_packets_out; }
     u32 bytes_out() const { return m_bytes_out; }
+    u32 retransmissions() const { return m_retransmissions; }
+    const char* congestion_control_name() const { return m_congestion_control->name(); }
+    u32 congestion_window() const { return m_congestion_control->congestion_window(); }
+    u32 slow_start_threshold() const { return m_congestion_control->slow_start_threshold(); }
+    i64 smoothed_round_trip_time_us() const { return m_smoothed_round_trip_time_us; }
+    bool is_window_scaling_enabled() const { return m_window_scaling_enabled; }
+    bool is_sack_enabled() const { return m_sack_enabled; }
 
     KResult send_tcp_packet(u16 flags, const UserOrKernelBuffer* = nullptr, size_t = 0);
     void send_outgoing_packets();
     void receive_tcp_packet(const TCPPacket&, u16 size);
 
+    // Negotiates the maximum segment size, window scaling and selective acknowledgements from a received SYN.
+    void process_syn_options(const TCPPacket&);
+    // Hands the payload of a segment to the receive buffer, holding on to segments that arrive out of order
+    // until the gap before them has been filled. Returns true if everything up to the end of the segment has
+    // now been received.
+    bool receive_payload(const TCPPacket&, NonnullRefPtr<PacketBuffer>, size_t payload_size);
+
+    // Called periodically by the NetworkTask to drive the retransmission timers of all connections.
+    static void retransmit_timed_out_packets_on_all_sockets();
+
     static Lockable<HashMap<IPv4SocketTuple, TCPSocket*>>& sockets_by_tuple();
     static RefPtr<TCPSocket> from_tuple(const IPv4SocketTuple& tuple);
     static RefPtr<TCPSocket> from_endpoints(const IPv4Address& local_address, u16 local_port, const IPv4Address& peer_address, u16 peer_port);
@@ -165,6 +188,7 @@ public:
     void release_for_accept(RefPtr<TCPSocket>);
 
     virtual KResult close() override;
+    virtual bool can_write(const FileDescription&, size_t) const override;
 
 protected:
     void set_direction(Direction direction) { m_direction = direction; }
@@ -175,13 +199,41 @@ private:
 
     static NetworkOrdered<u16> compute_tcp_checksum(const IPv4Address& source, const IPv4Address& destination, const TCPPacket&, u16 payload_size);
 
+    struct OutgoingPacket {
+        u32 sequence_number { 0 };
+        u32 ack_number { 0 };
+        ByteBuffer buffer;
+        int tx_counter { 0 };
+        Time tx_time {};
+        // Covered by a SACK block, so the peer has it even though it hasn't been cumulatively acknowledged.
+        bool is_sacked { false };
+        // Presumed lost and waiting to be retransmitted.
+        bool is_lost { false };
+    };
+
+    KResultOr<ByteBuffer> build_tcp_packet(u16 flags, const UserOrKernelBuffer*, size_t payload_size) const;
+    void enqueue_packet(ByteBuffer&&, u32 sequence_length);
+    u16 local_maximum_segment_size() const;
+    u16 advertised_window(bool is_syn) const;
+    size_t write_options(u16 flags, u8* options) const;
+    size_t bytes_in_flight() const;
+    KResult transmit_packet(OutgoingPacket&, RoutingDecision&);
+    void update_round_trip_time(const Time& sample);
+    void process_acknowledgement(const TCPPacket&, u16 size);
+    void process_sack_blocks(const TCPPacket&);
+    void mark_lost_packets();
+    void retransmit_timed_out_packets();
+    void deliver_out_of_order_segments();
+
     virtual void shut_down_for_writing() override;
 
     virtual KResultOr<size_t> protocol_receive(ReadonlyBytes raw_ipv4_packet, UserOrKernelBuffer& buffer, size_t buffer_size, int flags) override;
+    virtual ReadonlyBytes protocol_payload(ReadonlyBytes raw_ipv4_packet) const override;
     virtual KResultOr<size_t> protocol_send(const UserOrKernelBuffer&, size_t) override;
     virtual KResult protocol_connect(FileDescription&, ShouldBlock) override;
     virtual int protocol_allocate_local_port() override;
     virtual bool protocol_is_disconnected() const override;
+    virtual void protocol_did_read_received_data() override;
     virtual KResult protocol_bind() override;
     virtual KResult protocol_listen() override;
 
@@ -198,15 +250,46 @@ private:
     u32 m_packets_out { 0 };
     u32 m_bytes_out { 0 };
 
-    struct OutgoingPacket {
-        u32 ack_number { 0 };
-        ByteBuffer buffer;
-        int tx_counter { 0 };
-        Time tx_time {};
-    };
-
     Lock m_not_acked_lock { "TCPSocket unacked packets" };
     SinglyLinkedList<OutgoingPacket> m_not_acked;
+    // Sequence space taken up by m_not_acked, i.e. the data that is waiting to be sent or acknowledged.
+    size_t m_not_acked_size { 0 };
+
+    // Negotiated on SYN.
+    u16 m_send_maximum_segment_size { tcp_default_maximum_segment_size };
+    u8 m_send_window_scale { 0 };
+    u8 m_receive_window_scale { 0 };
+    bool m_window_scaling_enabled { false };
+    bool m_sack_enabled { false };
+
+    // The peer's receive window, already scaled.
+    u32 m_send_window { 0xffff };
+    // The receive window we last told the peer about, already scaled.
+    u32 m_last_advertised_window { 0 };
+    u32 m_highest_transmitted_sequence_number { 0 };
+    u32 m_duplicate_ack_count { 0 };
+    bool m_in_loss_recovery { false };
+    u32 m_recovery_point { 0 };
+    Time m_recovery_start;
+    u32 m_retransmissions { 0 };
+    NonnullOwnPtr<TCPCongestionControl> m_congestion_control;
+
+    // RFC 6298 retransmission timer state.
+    i64 m_smoothed_round_trip_time_us { 0 };
+    i64 m_round_trip_time_variance_us { 0 };
+    Time m_retransmission_timeout;
+
+    struct OutOfOrderSegment {
+        u32 sequence_number { 0 };
+        ReadonlyBytes payload;
+        // Keeps the payload alive.
+        NonnullRefPtr<PacketBuffer> packet;
+    };
+
+    // Sorted by sequence number, never overlapping m_ack_number.
+    Vector<OutOfOrderSegment> m_out_of_order_segments;
+    size_t m_out_of_order_bytes { 0 };
+    u32 m_last_out_of_order_sequence_number { 0 };
 };
 
 }
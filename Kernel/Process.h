@@ -314,6 +314,9 @@ public:
     KResultOr<int> sys$purge(int mode);
     KResultOr<int> sys$select(Userspace<const Syscall::SC_select_params*>);
     KResultOr<int> sys$poll(Userspace<const Syscall::SC_poll_params*>);
+    KResultOr<int> sys$epoll_create1(int flags);
+    KResultOr<int> sys$epoll_ctl(Userspace<const Syscall::SC_epoll_ctl_params*>);
+    KResultOr<int> sys$epoll_wait(Userspace<const Syscall::SC_epoll_wait_params*>);
     KResultOr<ssize_t> sys$get_dir_entries(int fd, Userspace<void*>, ssize_t);
     KResultOr<int> sys$getcwd(Userspace<char*>, size_t);
     KResultOr<int> sys$chdir(Userspace<const char*>, size_t);
@@ -36,18 +36,6 @@
 
 namespace Kernel {
 
-NonnullRefPtr<AHCIPort::ScatterList> AHCIPort::ScatterList::create(AsyncBlockDeviceRequest& request, NonnullRefPtrVector<PhysicalPage> allocated_pages, size_t device_block_size)
-{
-    return adopt(*new ScatterList(request, allocated_pages, device_block_size));
-}
-
-AHCIPort::ScatterList::ScatterList(AsyncBlockDeviceRequest& request, NonnullRefPtrVector<PhysicalPage> allocated_pages, size_t device_block_size)
-    : m_vm_object(AnonymousVMObject::create_with_physical_pages(allocated_pages))
-    , m_device_block_size(device_block_size)
-{
-    m_dma_region = MM.allocate_kernel_region_with_vmobject(m_vm_object, page_round_up((request.block_count() * device_block_size)), "AHCI Scattered DMA", Region::Access::Read | Region::Access::Write, Region::Cacheable::Yes);
-}
-
 NonnullRefPtr<AHCIPort> AHCIPort::create(const AHCIPortHandler& handler, volatile AHCI::PortRegisters& registers, u32 port_index)
 {
     return adopt(*new AHCIPort(handler, registers, port_index));
@@ -73,12 +61,11 @@ AHCIPort::AHCIPort(const AHCIPortHandler& handler, volatile AHCI::PortRegisters&
     dbgln_if(AHCI_DEBUG, "AHCI Port {}: Command list page at {}", representative_port_index(), m_command_list_page->paddr());
     dbgln_if(AHCI_DEBUG, "AHCI Port {}: FIS receive page at {}", representative_port_index(), m_command_list_page->paddr());
 
-    for (size_t index = 0; index < 1; index++) {
-        m_dma_buffers.append(MM.allocate_supervisor_physical_page().release_nonnull());
-    }
-    for (size_t index = 0; index < 1; index++) {
-        m_command_table_pages.append(MM.allocate_supervisor_physical_page().release_nonnull());
-    }
+    // Every command slot the HBA implements gets its own command table, all mapped once up front.
+    m_command_tables_region = MM.allocate_contiguous_kernel_region(page_round_up(m_parent_handler->hba_capabilities().max_command_list_entries_count * command_table_size), "AHCI Port Command Tables", Region::Access::Read | Region::Access::Write, PAGE_SIZE, Region::Cacheable::No);
+    if (!m_command_tables_region)
+        return;
+
     m_command_list_region = MM.allocate_kernel_region(m_command_list_page->paddr(), PAGE_SIZE, "AHCI Port Command List", Region::Access::Read | Region::Access::Write, Region::Cacheable::No);
     dbgln_if(AHCI_DEBUG, "AHCI Port {}: Command list region at {}", representative_port_index(), m_command_list_region->vaddr());
 
@@ -116,35 +103,64 @@ void AHCIPort::handle_interrupt()
         return;
     }
     if (m_interrupt_status.is_set(AHCI::PortInterruptFlag::DHR) || m_interrupt_status.is_set(AHCI::PortInterruptFlag::PS)) {
+        // Only the identify request waits for this, every other command is tracked by its slot below.
         m_wait_for_completion = false;
+    }
 
-        // Now schedule reading/writing the buffer as soon as we leave the irq handler.
-        // This is important so that we can safely access the buffers, which could
-        // trigger page faults
-        if (!m_current_request) {
-            dbgln_if(AHCI_DEBUG, "AHCI Port {}: Request handled, probably identify request", representative_port_index());
-        } else {
-            g_io_work->queue([this]() {
-                dbgln_if(AHCI_DEBUG, "AHCI Port {}: Request handled", representative_port_index());
-                LOCKER(m_lock);
-                VERIFY(m_current_request);
-                VERIFY(m_current_scatter_list);
-                if (m_current_request->request_type() == AsyncBlockDeviceRequest::Read) {
-                    if (!m_current_request->write_to_buffer(m_current_request->buffer(), m_current_scatter_list->dma_region().as_ptr(), m_connected_device->block_size() * m_current_request->block_count())) {
-                        dbgln_if(AHCI_DEBUG, "AHCI Port {}: Request failure, memory fault occurred when reading in data.", representative_port_index());
-                        m_current_scatter_list = nullptr;
-                        complete_current_request(AsyncDeviceRequest::MemoryFault);
-                        return;
-                    }
-                }
-                m_current_scatter_list = nullptr;
-                dbgln_if(AHCI_DEBUG, "AHCI Port {}: Request success", representative_port_index());
-                complete_current_request(AsyncDeviceRequest::Success);
+    // Clear the status before looking at which commands have finished, so a command
+    // finishing after that point raises another interrupt instead of getting lost.
+    m_interrupt_status.clear();
+
+    // A queued command is finished once the HBA has cleared both its PxCI and PxSACT bits.
+    u32 finished_slots;
+    {
+        ScopedSpinLock lock(m_issued_command_slots_lock);
+        finished_slots = m_issued_command_slots & ~(m_port_registers.ci | m_port_registers.sact);
+        m_issued_command_slots &= ~finished_slots;
+    }
+    if (finished_slots == 0) {
+        dbgln_if(AHCI_DEBUG, "AHCI Port {}: No request handled, probably identify request", representative_port_index());
+        return;
+    }
+
+    // Now schedule reading/writing the buffers as soon as we leave the irq handler.
+    // This is important so that we can safely access the buffers, which could
+    // trigger page faults
+    g_io_work->queue([this, finished_slots]() {
+        complete_finished_commands(finished_slots);
+    });
+}
+
+void AHCIPort::complete_finished_commands(u32 finished_slots)
+{
+    LOCKER(m_lock);
+    for (u8 slot_index = 0; slot_index < m_command_slots.size(); slot_index++) {
+        if (!(finished_slots & (1u << slot_index)))
+            continue;
+        auto& slot = m_command_slots[slot_index];
+        // The request may have been failed already while recovering from an error.
+        if (!slot.request)
+            continue;
+        dbgln_if(AHCI_DEBUG, "AHCI Port {}: Request in command slot {} handled", representative_port_index(), slot_index);
+        auto& request = *slot.request;
+        if (slot.uses_bounce_buffer && request.request_type() == AsyncBlockDeviceRequest::Read) {
+            bool success = true;
+            auto* data = slot.bounce_buffer_region->vaddr().as_ptr();
+            request.for_each_part([&](auto& part) {
+                size_t size = m_connected_device->block_size() * part.block_count();
+                if (success && !part.write_to_buffer(part.buffer(), data, size))
+                    success = false;
+                data += size;
             });
+            if (!success) {
+                dbgln_if(AHCI_DEBUG, "AHCI Port {}: Request failure, memory fault occurred when reading in data.", representative_port_index());
+                complete_request_in_slot(slot_index, AsyncDeviceRequest::MemoryFault);
+                continue;
+            }
         }
+        dbgln_if(AHCI_DEBUG, "AHCI Port {}: Request success", representative_port_index());
+        complete_request_in_slot(slot_index, AsyncDeviceRequest::Success);
     }
-
-    m_interrupt_status.clear();
 }
 
 bool AHCIPort::is_interrupts_enabled() const
@@ -155,12 +171,29 @@ bool AHCIPort::is_interrupts_enabled() const
 void AHCIPort::recover_from_fatal_error()
 {
     LOCKER(m_lock);
-    ScopedSpinLock lock(m_hard_lock);
-    dmesgln("{}: AHCI Port {} fatal error, shutting down!", m_parent_handler->hba_controller()->pci_address(), representative_port_index());
-    dmesgln("{}: AHCI Port {} fatal error, SError {}", m_parent_handler->hba_controller()->pci_address(), representative_port_index(), (u32)m_port_registers.serr);
-    stop_command_list_processing();
-    stop_fis_receiving();
-    m_interrupt_enable.clear();
+    {
+        ScopedSpinLock lock(m_hard_lock);
+        dmesgln("{}: AHCI Port {} fatal error, shutting down!", m_parent_handler->hba_controller()->pci_address(), representative_port_index());
+        dmesgln("{}: AHCI Port {} fatal error, SError {}", m_parent_handler->hba_controller()->pci_address(), representative_port_index(), (u32)m_port_registers.serr);
+        stop_command_list_processing();
+        stop_fis_receiving();
+        m_interrupt_enable.clear();
+    }
+    fail_outstanding_requests();
+}
+
+void AHCIPort::fail_outstanding_requests()
+{
+    VERIFY(m_lock.is_locked());
+    VERIFY(!m_hard_lock.is_locked());
+    {
+        ScopedSpinLock lock(m_issued_command_slots_lock);
+        m_issued_command_slots = 0;
+    }
+    for (u8 slot_index = 0; slot_index < m_command_slots.size(); slot_index++) {
+        if (m_command_slots[slot_index].request)
+            complete_request_in_slot(slot_index, AsyncDeviceRequest::Failure);
+    }
 }
 
 void AHCIPort::eject()
@@ -179,7 +212,7 @@ void AHCIPort::eject()
     auto unused_command_header = try_to_find_unused_command_header();
     VERIFY(unused_command_header.has_value());
     auto* command_list_entries = (volatile AHCI::CommandHeader*)m_command_list_region->vaddr().as_ptr();
-    command_list_entries[unused_command_header.value()].ctba = m_command_table_pages[unused_command_header.value()].paddr().get();
+    command_list_entries[unused_command_header.value()].ctba = command_table_physical_address(unused_command_header.value()).get();
     command_list_entries[unused_command_header.value()].ctbau = 0;
     command_list_entries[unused_command_header.value()].prdbc = 0;
     command_list_entries[unused_command_header.value()].prdtl = 0;
@@ -190,8 +223,7 @@ void AHCIPort::eject()
     // handshake error bit in PxSERR register if CFL is incorrect.
     command_list_entries[unused_command_header.value()].attributes = (size_t)FIS::DwordCount::RegisterHostToDevice | AHCI::CommandHeaderAttributes::P | AHCI::CommandHeaderAttributes::C | AHCI::CommandHeaderAttributes::A;
 
-    auto command_table_region = MM.allocate_kernel_region(m_command_table_pages[unused_command_header.value()].paddr().page_base(), page_round_up(sizeof(AHCI::CommandTable)), "AHCI Command Table", Region::Access::Read | Region::Access::Write, Region::Cacheable::No);
-    auto& command_table = *(volatile AHCI::CommandTable*)command_table_region->vaddr().as_ptr();
+    auto& command_table = this->command_table(unused_command_header.value());
     memset(const_cast<u8*>(command_table.command_fis), 0, 64);
     auto& fis = *(volatile FIS::HostToDevice::Register*)command_table.command_fis;
     fis.header.fis_type = (u8)FIS::Type::RegisterHostToDevice;
@@ -239,26 +271,30 @@ void AHCIPort::eject()
 bool AHCIPort::reset()
 {
     LOCKER(m_lock);
-    ScopedSpinLock lock(m_hard_lock);
+    bool success;
+    {
+        ScopedSpinLock lock(m_hard_lock);
 
-    dbgln_if(AHCI_DEBUG, "AHCI Port {}: Resetting", representative_port_index());
+        dbgln_if(AHCI_DEBUG, "AHCI Port {}: Resetting", representative_port_index());
 
-    if (m_disabled_by_firmware) {
-        dmesgln("AHCI Port {}: Disabled by firmware ", representative_port_index());
-        return false;
-    }
-    full_memory_barrier();
-    m_interrupt_enable.clear();
-    m_interrupt_status.clear();
-    full_memory_barrier();
-    start_fis_receiving();
-    full_memory_barrier();
-    clear_sata_error_register();
-    full_memory_barrier();
-    if (!initiate_sata_reset(lock)) {
-        return false;
+        if (m_disabled_by_firmware) {
+            dmesgln("AHCI Port {}: Disabled by firmware ", representative_port_index());
+            return false;
+        }
+        full_memory_barrier();
+        m_interrupt_enable.clear();
+        m_interrupt_status.clear();
+        full_memory_barrier();
+        start_fis_receiving();
+        full_memory_barrier();
+        clear_sata_error_register();
+        full_memory_barrier();
+        success = initiate_sata_reset(lock) && initialize(lock);
     }
-    return initialize(lock);
+    // Whatever was in flight got lost in the reset. Failing it lets the requests
+    // queued behind it start on the freshly initialized port.
+    fail_outstanding_requests();
+    return success;
 }
 
 bool AHCIPort::initialize_without_reset()
@@ -316,6 +352,16 @@ bool AHCIPort::initialize(ScopedSpinLock<SpinLock<u8>>& main_lock)
             m_port_registers.cmd = m_port_registers.cmd | (1 << 24);
         }
 
+        // Word 76 bit 8 tells whether the device supports native command queuing, word 75 how deep its queue is.
+        m_native_command_queuing_enabled = !is_atapi_attached()
+            && m_parent_handler->hba_capabilities().native_command_queuing_supported
+            && (identify_block->serial_ata_capabilities & (1 << 8));
+        if (m_native_command_queuing_enabled)
+            m_command_slots_count = min(m_parent_handler->hba_capabilities().max_command_list_entries_count, (size_t)(identify_block->queue_depth & 0x1f) + 1);
+        else
+            m_command_slots_count = 1;
+        dbgln_if(AHCI_DEBUG, "AHCI Port {}: Native command queuing {}, {} command slots", representative_port_index(), m_native_command_queuing_enabled ? "enabled" : "disabled", m_command_slots_count);
+
         dmesgln("AHCI Port {}: Device found, Capacity={}, Bytes per logical sector={}, Bytes per physical sector={}", representative_port_index(), max_addressable_sector * logical_sector_size, logical_sector_size, physical_sector_size);
 
         // FIXME: We don't support ATAPI devices yet, so for now we don't "create" them
@@ -428,6 +474,7 @@ bool AHCIPort::is_operable() const
     // by 3 parameters as shown below.
     return (!m_command_list_page.is_null())
         && (!m_fis_receive_page.is_null())
+        && m_command_tables_region
         && ((m_port_registers.cmd & (1 << 14)) != 0);
 }
 
@@ -446,29 +493,106 @@ void AHCIPort::set_sleep_state() const
     m_port_registers.cmd = (m_port_registers.cmd & 0x0ffffff) | (0b1000 << 28);
 }
 
-size_t AHCIPort::calculate_descriptors_count(size_t block_count) const
+volatile AHCI::CommandTable& AHCIPort::command_table(u8 slot_index) const
 {
-    VERIFY(m_connected_device);
-    size_t needed_dma_regions_count = page_round_up((block_count * m_connected_device->block_size())) / PAGE_SIZE;
-    VERIFY(needed_dma_regions_count <= m_dma_buffers.size());
-    return needed_dma_regions_count;
+    VERIFY(slot_index < m_parent_handler->hba_capabilities().max_command_list_entries_count);
+    return *(volatile AHCI::CommandTable*)m_command_tables_region->vaddr().offset(slot_index * command_table_size).as_ptr();
+}
+
+PhysicalAddress AHCIPort::command_table_physical_address(u8 slot_index) const
+{
+    VERIFY(slot_index < m_parent_handler->hba_capabilities().max_command_list_entries_count);
+    return m_command_tables_region->physical_page(0)->paddr().offset(slot_index * command_table_size);
 }
 
-Optional<AsyncDeviceRequest::RequestResult> AHCIPort::prepare_and_set_scatter_list(AsyncBlockDeviceRequest& request)
+bool AHCIPort::try_to_scatter_request_buffer(CommandSlot& slot, AsyncBlockDeviceRequest& request)
+{
+    VERIFY(m_lock.is_locked());
+    bool success = true;
+    request.for_each_part([&](auto& part) {
+        if (success && !try_to_scatter_buffer(slot, part))
+            success = false;
+    });
+    return success;
+}
+
+bool AHCIPort::try_to_scatter_buffer(CommandSlot& slot, AsyncBlockDeviceRequest& request)
+{
+    VERIFY(m_lock.is_locked());
+    // FIXME: User buffers would have to be pinned for as long as the HBA is working on them,
+    //        so for now only kernel buffers (like the disk cache) are handed to the HBA directly.
+    if (!request.buffer().is_kernel_buffer())
+        return false;
+    // Note: The data base address of a physical region descriptor has to be word aligned.
+    auto vaddr = VirtualAddress(request.buffer().user_or_kernel_ptr());
+    if (vaddr.get() & 1)
+        return false;
+
+    size_t remaining = m_connected_device->block_size() * request.block_count();
+    while (remaining > 0) {
+        auto page = MM.committed_physical_page_for_kernel_vaddr(vaddr);
+        if (!page)
+            return false;
+        size_t offset_in_page = vaddr.get() % PAGE_SIZE;
+        size_t size = min(remaining, PAGE_SIZE - offset_in_page);
+        auto address = page->paddr().offset(offset_in_page);
+        if (!slot.scatter_entries.is_empty() && slot.scatter_entries.last().address.offset(slot.scatter_entries.last().size) == address) {
+            slot.scatter_entries.last().size += size;
+        } else {
+            if (slot.scatter_entries.size() == max_physical_region_descriptors_count)
+                return false;
+            slot.scatter_entries.append({ address, size });
+        }
+        slot.request_pages.append(page.release_nonnull());
+        vaddr = vaddr.offset(size);
+        remaining -= size;
+    }
+    return true;
+}
+
+Optional<AsyncDeviceRequest::RequestResult> AHCIPort::prepare_scatter_list(CommandSlot& slot, AsyncBlockDeviceRequest& request)
 {
     VERIFY(m_lock.is_locked());
     VERIFY(request.block_count() > 0);
 
-    NonnullRefPtrVector<PhysicalPage> allocated_dma_regions;
-    for (size_t index = 0; index < calculate_descriptors_count(request.block_count()); index++) {
-        allocated_dma_regions.append(m_dma_buffers.at(index));
+    slot.uses_bounce_buffer = false;
+    if (try_to_scatter_request_buffer(slot, request))
+        return {};
+
+    dbgln_if(AHCI_DEBUG, "AHCI Port {}: Using a bounce buffer for the request", representative_port_index());
+    slot.scatter_entries.clear_with_capacity();
+    slot.request_pages.clear();
+    slot.uses_bounce_buffer = true;
+
+    size_t size = m_connected_device->block_size() * request.total_block_count();
+    if (!slot.bounce_buffer_region || slot.bounce_buffer_region->size() < size) {
+        slot.bounce_buffer_region = MM.allocate_contiguous_kernel_region(page_round_up(size), "AHCI Bounce Buffer", Region::Access::Read | Region::Access::Write);
+        if (!slot.bounce_buffer_region)
+            return AsyncDeviceRequest::Failure;
     }
+    slot.scatter_entries.append({ slot.bounce_buffer_region->physical_page(0)->paddr(), size });
 
-    m_current_scatter_list = ScatterList::create(request, allocated_dma_regions, m_connected_device->block_size());
     if (request.request_type() == AsyncBlockDeviceRequest::Write) {
-        if (!request.read_from_buffer(request.buffer(), m_current_scatter_list->dma_region().as_ptr(), m_connected_device->block_size() * request.block_count())) {
+        bool success = true;
+        auto* data = slot.bounce_buffer_region->vaddr().as_ptr();
+        request.for_each_part([&](auto& part) {
+            size_t part_size = m_connected_device->block_size() * part.block_count();
+            if (success && !part.read_from_buffer(part.buffer(), data, part_size))
+                success = false;
+            data += part_size;
+        });
+        if (!success)
             return AsyncDeviceRequest::MemoryFault;
-        }
+    }
+    return {};
+}
+
+Optional<u8> AHCIPort::try_to_find_unused_command_slot() const
+{
+    VERIFY(m_lock.is_locked());
+    for (u8 slot_index = 0; slot_index < m_command_slots_count; slot_index++) {
+        if (!m_command_slots[slot_index].request)
+            return slot_index;
     }
     return {};
 }
@@ -477,34 +601,37 @@ void AHCIPort::start_request(AsyncBlockDeviceRequest& request)
 {
     LOCKER(m_lock);
     dbgln_if(AHCI_DEBUG, "AHCI Port {}: Request start", representative_port_index());
-    VERIFY(!m_current_request);
-    VERIFY(!m_current_scatter_list);
 
-    m_current_request = request;
+    // Note: The device never starts more requests than we have command slots for.
+    auto slot_index = try_to_find_unused_command_slot();
+    VERIFY(slot_index.has_value());
+    auto& slot = m_command_slots[slot_index.value()];
+    slot.request = request;
 
-    auto result = prepare_and_set_scatter_list(request);
+    auto result = prepare_scatter_list(slot, request);
     if (result.has_value()) {
         dbgln_if(AHCI_DEBUG, "AHCI Port {}: Request failure.", representative_port_index());
-        m_lock.unlock();
-        complete_current_request(result.value());
+        complete_request_in_slot(slot_index.value(), result.value());
         return;
     }
 
-    auto success = access_device(request.request_type(), request.block_index(), request.block_count());
+    auto success = is_operable() && access_device(slot_index.value(), request.request_type(), request.block_index(), request.total_block_count());
     if (!success) {
         dbgln_if(AHCI_DEBUG, "AHCI Port {}: Request failure.", representative_port_index());
-        m_lock.unlock();
-        complete_current_request(AsyncDeviceRequest::Failure);
+        complete_request_in_slot(slot_index.value(), AsyncDeviceRequest::Failure);
         return;
     }
 }
 
-void AHCIPort::complete_current_request(AsyncDeviceRequest::RequestResult result)
+void AHCIPort::complete_request_in_slot(u8 slot_index, AsyncDeviceRequest::RequestResult result)
 {
-    VERIFY(m_current_request);
-    auto current_request = m_current_request;
-    m_current_request.clear();
-    current_request->complete(result);
+    VERIFY(m_lock.is_locked());
+    auto& slot = m_command_slots[slot_index];
+    VERIFY(slot.request);
+    auto request = slot.request.release_nonnull();
+    slot.scatter_entries.clear_with_capacity();
+    slot.request_pages.clear();
+    request->complete(result);
 }
 
 bool AHCIPort::spin_until_ready() const
@@ -523,59 +650,45 @@ bool AHCIPort::spin_until_ready() const
     return true;
 }
 
-bool AHCIPort::access_device(AsyncBlockDeviceRequest::RequestType direction, u64 lba, u8 block_count)
+bool AHCIPort::access_device(u8 slot_index, AsyncBlockDeviceRequest::RequestType direction, u64 lba, u8 block_count)
 {
     VERIFY(m_connected_device);
     VERIFY(is_operable());
     VERIFY(m_lock.is_locked());
-    VERIFY(m_current_scatter_list);
+    auto& slot = m_command_slots[slot_index];
+    VERIFY(!slot.scatter_entries.is_empty());
     ScopedSpinLock lock(m_hard_lock);
 
-    dbgln_if(AHCI_DEBUG, "AHCI Port {}: Do a {}, lba {}, block count {}", representative_port_index(), direction == AsyncBlockDeviceRequest::RequestType::Write ? "write" : "read", lba, block_count);
-    if (!spin_until_ready())
+    dbgln_if(AHCI_DEBUG, "AHCI Port {}: Do a {}, lba {}, block count {} in command slot {}", representative_port_index(), direction == AsyncBlockDeviceRequest::RequestType::Write ? "write" : "read", lba, block_count, slot_index);
+    // Note: Queued commands may be issued while the device is busy with other ones, the HBA hands them over when it can.
+    if (!m_native_command_queuing_enabled && !spin_until_ready())
         return false;
 
-    auto unused_command_header = try_to_find_unused_command_header();
-    VERIFY(unused_command_header.has_value());
     auto* command_list_entries = (volatile AHCI::CommandHeader*)m_command_list_region->vaddr().as_ptr();
-    command_list_entries[unused_command_header.value()].ctba = m_command_table_pages[unused_command_header.value()].paddr().get();
-    command_list_entries[unused_command_header.value()].ctbau = 0;
-    command_list_entries[unused_command_header.value()].prdbc = 0;
-    command_list_entries[unused_command_header.value()].prdtl = m_current_scatter_list->scatters_count();
+    command_list_entries[slot_index].ctba = command_table_physical_address(slot_index).get();
+    command_list_entries[slot_index].ctbau = 0;
+    command_list_entries[slot_index].prdbc = 0;
+    command_list_entries[slot_index].prdtl = slot.scatter_entries.size();
 
     // Note: we must set the correct Dword count in this register. Real hardware
     // AHCI controllers do care about this field! QEMU doesn't care if we don't
     // set the correct CFL field in this register, real hardware will set an
     // handshake error bit in PxSERR register if CFL is incorrect.
-    command_list_entries[unused_command_header.value()].attributes = (size_t)FIS::DwordCount::RegisterHostToDevice | AHCI::CommandHeaderAttributes::P | AHCI::CommandHeaderAttributes::C | (is_atapi_attached() ? AHCI::CommandHeaderAttributes::A : 0) | (direction == AsyncBlockDeviceRequest::RequestType::Write ? AHCI::CommandHeaderAttributes::W : 0);
-
-    dbgln_if(AHCI_DEBUG, "AHCI Port {}: CLE: ctba=0x{:08x}, ctbau=0x{:08x}, prdbc=0x{:08x}, prdtl=0x{:04x}, attributes=0x{:04x}", representative_port_index(), (u32)command_list_entries[unused_command_header.value()].ctba, (u32)command_list_entries[unused_command_header.value()].ctbau, (u32)command_list_entries[unused_command_header.value()].prdbc, (u16)command_list_entries[unused_command_header.value()].prdtl, (u16)command_list_entries[unused_command_header.value()].attributes);
+    // Note: We don't ask the HBA to clear busy upon R_OK, so PxCI stays set until the command is done.
+    command_list_entries[slot_index].attributes = (size_t)FIS::DwordCount::RegisterHostToDevice | AHCI::CommandHeaderAttributes::P | (is_atapi_attached() ? AHCI::CommandHeaderAttributes::A : 0) | (direction == AsyncBlockDeviceRequest::RequestType::Write ? AHCI::CommandHeaderAttributes::W : 0);
 
-    auto command_table_region = MM.allocate_kernel_region(m_command_table_pages[unused_command_header.value()].paddr().page_base(), page_round_up(sizeof(AHCI::CommandTable)), "AHCI Command Table", Region::Access::Read | Region::Access::Write, Region::Cacheable::No);
-    auto& command_table = *(volatile AHCI::CommandTable*)command_table_region->vaddr().as_ptr();
-
-    dbgln_if(AHCI_DEBUG, "AHCI Port {}: Allocated command table at {}", representative_port_index(), command_table_region->vaddr());
+    dbgln_if(AHCI_DEBUG, "AHCI Port {}: CLE: ctba=0x{:08x}, ctbau=0x{:08x}, prdbc=0x{:08x}, prdtl=0x{:04x}, attributes=0x{:04x}", representative_port_index(), (u32)command_list_entries[slot_index].ctba, (u32)command_list_entries[slot_index].ctbau, (u32)command_list_entries[slot_index].prdbc, (u16)command_list_entries[slot_index].prdtl, (u16)command_list_entries[slot_index].attributes);
 
+    auto& command_table = this->command_table(slot_index);
     memset(const_cast<u8*>(command_table.command_fis), 0, 64);
 
-    size_t scatter_entry_index = 0;
-    size_t data_transfer_count = (block_count * m_connected_device->block_size());
-    for (auto scatter_page : m_current_scatter_list->vmobject().physical_pages()) {
-        VERIFY(data_transfer_count != 0);
-        VERIFY(scatter_page);
-        dbgln_if(AHCI_DEBUG, "AHCI Port {}: Add a transfer scatter entry @ {}", representative_port_index(), scatter_page->paddr());
+    for (size_t scatter_entry_index = 0; scatter_entry_index < slot.scatter_entries.size(); scatter_entry_index++) {
+        auto& scatter_entry = slot.scatter_entries[scatter_entry_index];
+        dbgln_if(AHCI_DEBUG, "AHCI Port {}: Add a transfer scatter entry @ {}, size {}", representative_port_index(), scatter_entry.address, scatter_entry.size);
         command_table.descriptors[scatter_entry_index].base_high = 0;
-        command_table.descriptors[scatter_entry_index].base_low = scatter_page->paddr().get();
-        if (data_transfer_count <= PAGE_SIZE) {
-            command_table.descriptors[scatter_entry_index].byte_count = data_transfer_count - 1;
-            data_transfer_count = 0;
-        } else {
-            command_table.descriptors[scatter_entry_index].byte_count = PAGE_SIZE - 1;
-            data_transfer_count -= PAGE_SIZE;
-        }
-        scatter_entry_index++;
+        command_table.descriptors[scatter_entry_index].base_low = scatter_entry.address.get();
+        command_table.descriptors[scatter_entry_index].byte_count = scatter_entry.size - 1;
     }
-    command_table.descriptors[scatter_entry_index].byte_count = (PAGE_SIZE - 1) | (1 << 31);
 
     memset(const_cast<u8*>(command_table.atapi_command), 0, 32);
 
@@ -584,6 +697,11 @@ bool AHCIPort::access_device(AsyncBlockDeviceRequest::RequestType direction, u64
     if (is_atapi_attached()) {
         fis.command = ATA_CMD_PACKET;
         TODO();
+    } else if (m_native_command_queuing_enabled) {
+        if (direction == AsyncBlockDeviceRequest::RequestType::Write)
+            fis.command = ATA_CMD_WRITE_FPDMA_QUEUED;
+        else
+            fis.command = ATA_CMD_READ_FPDMA_QUEUED;
     } else {
         if (direction == AsyncBlockDeviceRequest::RequestType::Write)
             fis.command = ATA_CMD_WRITE_DMA_EXT;
@@ -602,17 +720,30 @@ bool AHCIPort::access_device(AsyncBlockDeviceRequest::RequestType direction, u64
     fis.lba_low[0] = lba & 0xff;
     fis.lba_low[1] = (lba >> 8) & 0xff;
     fis.lba_low[2] = (lba >> 16) & 0xff;
-    fis.count = (block_count);
+    if (m_native_command_queuing_enabled) {
+        // Queued commands carry the block count in the features field and their tag in the count field.
+        fis.features_low = block_count;
+        fis.features_high = 0;
+        fis.count = slot_index << 3;
+    } else {
+        fis.count = block_count;
+    }
 
     // The below loop waits until the port is no longer busy before issuing a new command
-    if (!spin_until_ready())
+    if (!m_native_command_queuing_enabled && !spin_until_ready())
         return false;
 
     full_memory_barrier();
-    mark_command_header_ready_to_process(unused_command_header.value());
+    {
+        ScopedSpinLock issued_command_slots_lock(m_issued_command_slots_lock);
+        m_issued_command_slots |= 1u << slot_index;
+        if (m_native_command_queuing_enabled)
+            m_port_registers.sact = 1u << slot_index;
+        mark_command_header_ready_to_process(slot_index);
+    }
     full_memory_barrier();
 
-    dbgln_if(AHCI_DEBUG, "AHCI Port {}: Do a {}, lba {}, block count {} @ {}, ended", representative_port_index(), direction == AsyncBlockDeviceRequest::RequestType::Write ? "write" : "read", lba, block_count, m_dma_buffers[0].paddr());
+    dbgln_if(AHCI_DEBUG, "AHCI Port {}: Do a {}, lba {}, block count {} in command slot {}, ended", representative_port_index(), direction == AsyncBlockDeviceRequest::RequestType::Write ? "write" : "read", lba, block_count, slot_index);
     return true;
 }
 
@@ -626,7 +757,7 @@ bool AHCIPort::identify_device(ScopedSpinLock<SpinLock<u8>>& main_lock)
     auto unused_command_header = try_to_find_unused_command_header();
     VERIFY(unused_command_header.has_value());
     auto* command_list_entries = (volatile AHCI::CommandHeader*)m_command_list_region->vaddr().as_ptr();
-    command_list_entries[unused_command_header.value()].ctba = m_command_table_pages[unused_command_header.value()].paddr().get();
+    command_list_entries[unused_command_header.value()].ctba = command_table_physical_address(unused_command_header.value()).get();
     command_list_entries[unused_command_header.value()].ctbau = 0;
     command_list_entries[unused_command_header.value()].prdbc = 512;
     command_list_entries[unused_command_header.value()].prdtl = 1;
@@ -635,8 +766,7 @@ bool AHCIPort::identify_device(ScopedSpinLock<SpinLock<u8>>& main_lock)
     // QEMU doesn't care if we don't set the correct CFL field in this register, real hardware will set an handshake error bit in PxSERR register.
     command_list_entries[unused_command_header.value()].attributes = (size_t)FIS::DwordCount::RegisterHostToDevice | AHCI::CommandHeaderAttributes::P | AHCI::CommandHeaderAttributes::C;
 
-    auto command_table_region = MM.allocate_kernel_region(m_command_table_pages[unused_command_header.value()].paddr().page_base(), page_round_up(sizeof(AHCI::CommandTable)), "AHCI Command Table", Region::Access::Read | Region::Access::Write);
-    auto& command_table = *(volatile AHCI::CommandTable*)command_table_region->vaddr().as_ptr();
+    auto& command_table = this->command_table(unused_command_header.value());
     memset(const_cast<u8*>(command_table.command_fis), 0, 64);
     command_table.descriptors[0].base_high = 0;
     command_table.descriptors[0].base_low = m_parent_handler->get_identify_metadata_physical_region(m_port_index).get();
@@ -713,8 +843,6 @@ void AHCIPort::mark_command_header_ready_to_process(u8 command_header_index) con
     VERIFY(m_lock.is_locked());
     VERIFY(m_hard_lock.is_locked());
     VERIFY(is_operable());
-    VERIFY(!m_wait_for_completion);
-    m_wait_for_completion = true;
     dbgln_if(AHCI_DEBUG, "AHCI Port {}: Marking command header at index {} as ready to process.", representative_port_index(), command_header_index);
     m_port_registers.ci = 1 << command_header_index;
 }
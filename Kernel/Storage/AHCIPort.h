@@ -26,8 +26,10 @@
 
 #pragma once
 
+#include <AK/Array.h>
 #include <AK/OwnPtr.h>
 #include <AK/RefPtr.h>
+#include <AK/Vector.h>
 #include <Kernel/Devices/Device.h>
 #include <Kernel/IO.h>
 #include <Kernel/Interrupts/IRQHandler.h>
@@ -53,18 +55,22 @@ class AHCIPort : public RefCounted<AHCIPort> {
     friend class SATADiskDevice;
 
 private:
-    class ScatterList : public RefCounted<ScatterList> {
-    public:
-        static NonnullRefPtr<ScatterList> create(AsyncBlockDeviceRequest&, NonnullRefPtrVector<PhysicalPage> allocated_pages, size_t device_block_size);
-        const VMObject& vmobject() const { return m_vm_object; }
-        VirtualAddress dma_region() const { return m_dma_region->vaddr(); }
-        size_t scatters_count() const { return m_vm_object->physical_pages().size(); }
-
-    private:
-        ScatterList(AsyncBlockDeviceRequest&, NonnullRefPtrVector<PhysicalPage> allocated_pages, size_t device_block_size);
-        NonnullRefPtr<AnonymousVMObject> m_vm_object;
-        size_t m_device_block_size;
-        OwnPtr<Region> m_dma_region;
+    static constexpr size_t max_physical_region_descriptors_count = 8;
+    static constexpr size_t command_table_size = sizeof(AHCI::CommandTable) + max_physical_region_descriptors_count * sizeof(AHCI::PhysicalRegionDescriptor);
+
+    struct ScatterEntry {
+        PhysicalAddress address;
+        size_t size { 0 };
+    };
+
+    struct CommandSlot {
+        RefPtr<AsyncBlockDeviceRequest> request;
+        Vector<ScatterEntry, max_physical_region_descriptors_count> scatter_entries;
+        // The pages of the request buffer the HBA transfers to or from, kept alive until the command completes.
+        NonnullRefPtrVector<PhysicalPage> request_pages;
+        // Used instead when the request buffer can't be handed to the HBA directly.
+        OwnPtr<Region> bounce_buffer_region;
+        bool uses_bounce_buffer { false };
     };
 
 public:
@@ -77,6 +83,7 @@ public:
     bool is_atapi_attached() const { return m_port_registers.sig == (u32)AHCI::DeviceSignature::ATAPI; };
 
     RefPtr<StorageDevice> connected_device() const { return m_connected_device; }
+    size_t command_slots_count() const { return m_command_slots_count; }
 
     bool reset();
     UNMAP_AFTER_INIT bool initialize_without_reset();
@@ -103,10 +110,16 @@ private:
     ALWAYS_INLINE void power_on() const;
 
     void start_request(AsyncBlockDeviceRequest&);
-    void complete_current_request(AsyncDeviceRequest::RequestResult);
-    bool access_device(AsyncBlockDeviceRequest::RequestType, u64 lba, u8 block_count);
-    size_t calculate_descriptors_count(size_t block_count) const;
-    [[nodiscard]] Optional<AsyncDeviceRequest::RequestResult> prepare_and_set_scatter_list(AsyncBlockDeviceRequest& request);
+    void complete_request_in_slot(u8 slot_index, AsyncDeviceRequest::RequestResult);
+    void complete_finished_commands(u32 finished_slots);
+    void fail_outstanding_requests();
+    bool access_device(u8 slot_index, AsyncBlockDeviceRequest::RequestType, u64 lba, u8 block_count);
+    bool try_to_scatter_request_buffer(CommandSlot&, AsyncBlockDeviceRequest&);
+    bool try_to_scatter_buffer(CommandSlot&, AsyncBlockDeviceRequest&);
+    [[nodiscard]] Optional<AsyncDeviceRequest::RequestResult> prepare_scatter_list(CommandSlot&, AsyncBlockDeviceRequest&);
+
+    volatile AHCI::CommandTable& command_table(u8 slot_index) const;
+    PhysicalAddress command_table_physical_address(u8 slot_index) const;
 
     ALWAYS_INLINE bool is_interrupts_enabled() const;
 
@@ -127,21 +140,27 @@ private:
     void set_interface_state(AHCI::DeviceDetectionInitialization);
 
     Optional<u8> try_to_find_unused_command_header();
+    Optional<u8> try_to_find_unused_command_slot() const;
 
     ALWAYS_INLINE bool is_interface_disabled() const { return (m_port_registers.ssts & 0xf) == 4; };
 
     // Data members
 
     EntropySource m_entropy_source;
-    RefPtr<AsyncBlockDeviceRequest> m_current_request;
     SpinLock<u8> m_hard_lock;
     Lock m_lock { "AHCIPort" };
 
+    Array<CommandSlot, 32> m_command_slots;
+    size_t m_command_slots_count { 1 };
+    bool m_native_command_queuing_enabled { false };
+    // Bit N is set from the moment the command in slot N is issued until the interrupt handler sees it finish.
+    u32 m_issued_command_slots { 0 };
+    SpinLock<u8> m_issued_command_slots_lock;
+
     mutable bool m_wait_for_completion { false };
     bool m_wait_connect_for_completion { false };
 
-    NonnullRefPtrVector<PhysicalPage> m_dma_buffers;
-    NonnullRefPtrVector<PhysicalPage> m_command_table_pages;
+    OwnPtr<Region> m_command_tables_region;
     RefPtr<PhysicalPage> m_command_list_page;
     OwnPtr<Region> m_command_list_region;
     RefPtr<PhysicalPage> m_fis_receive_page;
@@ -153,7 +172,6 @@ private:
     AHCI::PortInterruptStatusBitField m_interrupt_status;
     AHCI::PortInterruptEnableBitField m_interrupt_enable;
 
-    RefPtr<AHCIPort::ScatterList> m_current_scatter_list;
     bool m_disabled_by_firmware { false };
 };
 }
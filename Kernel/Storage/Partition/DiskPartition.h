@@ -26,6 +26,7 @@
 
 #pragma once
 
+#include <AK/NumericLimits.h>
 #include <AK/RefPtr.h>
 #include <Kernel/Devices/BlockDevice.h>
 #include <Kernel/Storage/Partition/DiskPartitionMetadata.h>
@@ -48,6 +49,9 @@ public:
     // ^Device
     virtual mode_t required_mode() const override { return 0600; }
     virtual String device_name() const override;
+    // Requests are passed on right away, so they are scheduled by the I/O scheduler of the disk itself.
+    virtual size_t max_concurrent_requests() const override { return NumericLimits<size_t>::max(); }
+    virtual size_t max_blocks_per_request() const override { return m_device->max_blocks_per_request(); }
 
     const DiskPartitionMetadata& metadata() const;
 
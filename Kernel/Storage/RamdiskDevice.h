@@ -26,6 +26,7 @@
 
 #pragma once
 
+#include <AK/NumericLimits.h>
 #include <Kernel/Lock.h>
 #include <Kernel/Storage/StorageDevice.h>
 
@@ -46,6 +47,7 @@ public:
 
     // ^BlockDevice
     virtual void start_request(AsyncBlockDeviceRequest&) override;
+    virtual size_t max_blocks_per_request() const override { return NumericLimits<u32>::max(); }
 
     // ^DiskDevice
     virtual const char* class_name() const override;
@@ -58,6 +58,18 @@ void SATADiskDevice::start_request(AsyncBlockDeviceRequest& request)
     m_port->start_request(request);
 }
 
+size_t SATADiskDevice::max_concurrent_requests() const
+{
+    return m_port->command_slots_count();
+}
+
+size_t SATADiskDevice::max_blocks_per_request() const
+{
+    // As much as always fits into the physical region descriptors of a command, so the HBA
+    // can transfer straight to and from the request buffer without needing a bounce buffer.
+    return AHCIPort::max_physical_region_descriptors_count * PAGE_SIZE / block_size();
+}
+
 String SATADiskDevice::device_name() const
 {
     return String::formatted("hd{:c}", 'a' + minor());
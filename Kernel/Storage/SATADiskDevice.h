@@ -52,6 +52,10 @@ public:
     // ^BlockDevice
     virtual void start_request(AsyncBlockDeviceRequest&) override;
     virtual String device_name() const override;
+    // ^Device
+    virtual size_t max_concurrent_requests() const override;
+    virtual size_t max_blocks_per_request() const override;
+    virtual bool supports_merged_requests() const override { return true; }
 
 private:
     SATADiskDevice(const AHCIController&, const AHCIPort&, size_t sector_size, u64 max_addressable_block);
@@ -28,6 +28,7 @@
 #include <AK/StringView.h>
 #include <Kernel/Debug.h>
 #include <Kernel/FileSystem/FileDescription.h>
+#include <Kernel/FileSystem/ProcFS.h>
 #include <Kernel/Storage/StorageDevice.h>
 #include <Kernel/Storage/StorageManagement.h>
 
@@ -38,6 +39,7 @@ StorageDevice::StorageDevice(const StorageController& controller, size_t sector_
     , m_storage_controller(controller)
     , m_max_addressable_block(max_addressable_block)
 {
+    set_io_scheduler("deadline");
 }
 
 StorageDevice::StorageDevice(const StorageController& controller, int major, int minor, size_t sector_size, u64 max_addressable_block)
@@ -45,6 +47,21 @@ StorageDevice::StorageDevice(const StorageController& controller, int major, int
     , m_storage_controller(controller)
     , m_max_addressable_block(max_addressable_block)
 {
+    set_io_scheduler("deadline");
+}
+
+void StorageDevice::register_io_scheduler_setting()
+{
+    m_io_scheduler_setting.resource() = io_scheduler_name();
+    ProcFS::add_sys_string(String::formatted("io_scheduler_{}", device_name()), m_io_scheduler_setting, [this] {
+        LOCKER(m_io_scheduler_setting.lock());
+        auto& setting = m_io_scheduler_setting.resource();
+        auto name = setting.view().trim_whitespace();
+        if (!set_io_scheduler(name))
+            dmesgln("{}: Unknown I/O scheduler '{}'", device_name(), name);
+        // Always show the scheduler that is actually in use.
+        setting = io_scheduler_name();
+    });
 }
 
 const char* StorageDevice::class_name() const
@@ -60,15 +77,13 @@ NonnullRefPtr<StorageController> StorageDevice::controller() const
 KResultOr<size_t> StorageDevice::read(FileDescription&, u64 offset, UserOrKernelBuffer& outbuf, size_t len)
 {
     unsigned index = offset / block_size();
-    u16 whole_blocks = len / block_size();
+    size_t whole_blocks = len / block_size();
     ssize_t remaining = len % block_size();
 
-    unsigned blocks_per_page = PAGE_SIZE / block_size();
-
-    // PATAChannel will chuck a wobbly if we try to read more than PAGE_SIZE
-    // at a time, because it uses a single page for its DMA buffer.
-    if (whole_blocks >= blocks_per_page) {
-        whole_blocks = blocks_per_page;
+    // Don't ask the driver for more than it can take in a single request.
+    // Callers are expected to come back for the rest.
+    if (whole_blocks >= max_blocks_per_request()) {
+        whole_blocks = max_blocks_per_request();
         remaining = 0;
     }
 
@@ -125,15 +140,13 @@ bool StorageDevice::can_read(const FileDescription&, size_t offset) const
 KResultOr<size_t> StorageDevice::write(FileDescription&, u64 offset, const UserOrKernelBuffer& inbuf, size_t len)
 {
     unsigned index = offset / block_size();
-    u16 whole_blocks = len / block_size();
+    size_t whole_blocks = len / block_size();
     ssize_t remaining = len % block_size();
 
-    unsigned blocks_per_page = PAGE_SIZE / block_size();
-
-    // PATAChannel will chuck a wobbly if we try to write more than PAGE_SIZE
-    // at a time, because it uses a single page for its DMA buffer.
-    if (whole_blocks >= blocks_per_page) {
-        whole_blocks = blocks_per_page;
+    // Don't ask the driver for more than it can take in a single request.
+    // Callers are expected to come back for the rest.
+    if (whole_blocks >= max_blocks_per_request()) {
+        whole_blocks = max_blocks_per_request();
         remaining = 0;
     }
 
@@ -60,6 +60,8 @@ public:
     // ^Device
     virtual mode_t required_mode() const override { return 0600; }
 
+    void register_io_scheduler_setting();
+
 protected:
     StorageDevice(const StorageController&, size_t, u64);
     StorageDevice(const StorageController&, int, int, size_t, u64);
@@ -70,6 +72,7 @@ private:
     NonnullRefPtr<StorageController> m_storage_controller;
     NonnullRefPtrVector<DiskPartition> m_partitions;
     u64 m_max_addressable_block;
+    Lockable<String> m_io_scheduler_setting;
 };
 
 }
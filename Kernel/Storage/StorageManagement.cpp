@@ -50,6 +50,8 @@ UNMAP_AFTER_INIT StorageManagement::StorageManagement(String boot_argument, bool
     , m_disk_partitions(enumerate_disk_partitions())
 {
     s_device_minor_number = 0;
+    for (auto& storage_device : m_storage_devices)
+        storage_device.register_io_scheduler_setting();
     if (!boot_argument_contains_partition_uuid()) {
         determine_boot_device();
         return;
@@ -0,0 +1,161 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <AK/ScopeGuard.h>
+#include <Kernel/Debug.h>
+#include <Kernel/FileSystem/EventPoll.h>
+#include <Kernel/FileSystem/FileDescription.h>
+#include <Kernel/Process.h>
+
+namespace Kernel {
+
+KResultOr<int> Process::sys$epoll_create1(int flags)
+{
+    REQUIRE_PROMISE(stdio);
+
+    if (flags & ~EPOLL_CLOEXEC)
+        return EINVAL;
+
+    int fd = alloc_fd();
+    if (fd < 0)
+        return fd;
+
+    auto description_or_error = FileDescription::create(EventPoll::create());
+    if (description_or_error.is_error())
+        return description_or_error.error();
+
+    auto description = description_or_error.release_value();
+    description->set_readable(true);
+
+    u32 fd_flags = 0;
+    if (flags & EPOLL_CLOEXEC)
+        fd_flags |= FD_CLOEXEC;
+
+    m_fds[fd].set(move(description), fd_flags);
+    return fd;
+}
+
+KResultOr<int> Process::sys$epoll_ctl(Userspace<const Syscall::SC_epoll_ctl_params*> user_params)
+{
+    REQUIRE_PROMISE(stdio);
+
+    Syscall::SC_epoll_ctl_params params;
+    if (!copy_from_user(&params, user_params))
+        return EFAULT;
+
+    auto event_poll_description = file_description(params.epfd);
+    if (!event_poll_description)
+        return EBADF;
+    if (!event_poll_description->file().is_event_poll())
+        return EINVAL;
+    auto& event_poll = static_cast<EventPoll&>(event_poll_description->file());
+
+    // Entries are keyed by fd, so removing one doesn't need the fd to still be open.
+    if (params.op == EPOLL_CTL_DEL)
+        return event_poll.remove(params.fd);
+
+    if (params.op != EPOLL_CTL_ADD && params.op != EPOLL_CTL_MOD)
+        return EINVAL;
+
+    epoll_event event;
+    if (!copy_from_user(&event, params.event))
+        return EFAULT;
+
+    auto description = file_description(params.fd);
+    if (!description)
+        return EBADF;
+
+    dbgln_if(POLL_SELECT_DEBUG, "epoll_ctl: {} fd {} events {:#x}", params.op == EPOLL_CTL_ADD ? "add" : "modify", params.fd, event.events);
+
+    if (params.op == EPOLL_CTL_ADD)
+        return event_poll.add(params.fd, *description, event);
+    return event_poll.modify(params.fd, *description, event);
+}
+
+KResultOr<int> Process::sys$epoll_wait(Userspace<const Syscall::SC_epoll_wait_params*> user_params)
+{
+    REQUIRE_PROMISE(stdio);
+
+    Syscall::SC_epoll_wait_params params;
+    if (!copy_from_user(&params, user_params))
+        return EFAULT;
+
+    if (params.maxevents <= 0)
+        return EINVAL;
+
+    auto description = file_description(params.epfd);
+    if (!description)
+        return EBADF;
+    if (!description->file().is_event_poll())
+        return EINVAL;
+    auto& event_poll = static_cast<EventPoll&>(description->file());
+
+    Thread::BlockTimeout timeout;
+    if (params.timeout) {
+        auto timeout_time = copy_time_from_user(params.timeout);
+        if (!timeout_time.has_value())
+            return EFAULT;
+        timeout = Thread::BlockTimeout(false, &timeout_time.value());
+    }
+
+    auto current_thread = Thread::current();
+
+    u32 previous_signal_mask = 0;
+    if (params.sigmask) {
+        sigset_t sigmask_copy;
+        if (!copy_from_user(&sigmask_copy, params.sigmask))
+            return EFAULT;
+        previous_signal_mask = current_thread->update_signal_mask(sigmask_copy);
+    }
+    ScopeGuard rollback_signal_mask([&]() {
+        if (params.sigmask)
+            current_thread->update_signal_mask(previous_signal_mask);
+    });
+
+    Vector<epoll_event> events;
+    for (;;) {
+        event_poll.collect_ready_events(events, params.maxevents);
+        if (!events.is_empty())
+            break;
+
+        // Entries may have stopped being ready again by the time we look at them,
+        // so keep waiting until we actually have something to report.
+        auto unblock_flags = Thread::FileBlocker::BlockFlags::None;
+        auto block_result = current_thread->block<Thread::ReadBlocker>(timeout, *description, unblock_flags);
+        if (block_result.was_interrupted())
+            return EINTR;
+        if (block_result.timed_out())
+            return 0;
+    }
+
+    dbgln_if(POLL_SELECT_DEBUG, "epoll_wait: {} fds ready", events.size());
+
+    if (!copy_to_user(params.events, events.data(), events.size() * sizeof(epoll_event)))
+        return EFAULT;
+    return events.size();
+}
+
+}
@@ -24,13 +24,17 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <AK/Singleton.h>
 #include <Kernel/FileSystem/VirtualFileSystem.h>
 #include <Kernel/Process.h>
 #include <Kernel/Tasks/SyncTask.h>
 #include <Kernel/Time/TimeManagement.h>
+#include <Kernel/WaitQueue.h>
 
 namespace Kernel {
 
+static AK::Singleton<WaitQueue> s_sync_wait_queue;
+
 void SyncTask::spawn()
 {
     RefPtr<Thread> syncd_thread;
@@ -38,9 +42,15 @@ void SyncTask::spawn()
         dbgln("SyncTask is running");
         for (;;) {
             VFS::the().sync();
-            (void)Thread::current()->sleep(Time::from_seconds(1));
+            auto timeout = Time::from_seconds(1);
+            (void)s_sync_wait_queue->wait_on(Thread::BlockTimeout(false, &timeout), "SyncTask");
         }
     });
 }
 
+void SyncTask::request_sync()
+{
+    s_sync_wait_queue->wake_all();
+}
+
 }
@@ -431,15 +431,25 @@ Region* MemoryManager::kernel_region_from_vaddr(VirtualAddress vaddr)
     return nullptr;
 }
 
+RefPtr<PhysicalPage> MemoryManager::committed_physical_page_for_kernel_vaddr(VirtualAddress vaddr)
+{
+    ScopedSpinLock lock(s_mm_lock);
+    auto* region = kernel_region_from_vaddr(vaddr);
+    if (!region)
+        return nullptr;
+    auto* page = region->physical_page((vaddr.get() - region->vaddr().get()) / PAGE_SIZE);
+    if (!page || page->is_shared_zero_page() || page->is_lazy_committed_page())
+        return nullptr;
+    return const_cast<PhysicalPage*>(page);
+}
+
 Region* MemoryManager::user_region_from_vaddr(Space& space, VirtualAddress vaddr)
 {
-    // FIXME: Use a binary search tree (maybe red/black?) or some other more appropriate data structure!
     ScopedSpinLock lock(space.get_lock());
-    for (auto& region : space.regions()) {
-        if (region.contains(vaddr))
-            return &region;
-    }
-    return nullptr;
+    auto* candidate = space.regions().find_largest_not_above(vaddr.get());
+    if (!candidate || !(*candidate)->contains(vaddr))
+        return nullptr;
+    return candidate->ptr();
 }
 
 Region* MemoryManager::find_region_from_vaddr(Space& space, VirtualAddress vaddr)
@@ -551,14 +561,23 @@ OwnPtr<Region> MemoryManager::allocate_kernel_region_with_vmobject(VMObject& vmo
     return allocate_kernel_region_with_vmobject(range.value(), vmobject, move(name), access, cacheable);
 }
 
+bool MemoryManager::take_uncommitted_user_physical_pages(size_t page_count)
+{
+    // Page allocations don't hold the MM lock, so this has to be a single atomic step.
+    unsigned uncommitted = m_user_physical_pages_uncommitted.load();
+    do {
+        if (uncommitted < page_count)
+            return false;
+    } while (!m_user_physical_pages_uncommitted.compare_exchange_strong(uncommitted, uncommitted - page_count));
+    return true;
+}
+
 bool MemoryManager::commit_user_physical_pages(size_t page_count)
 {
     VERIFY(page_count > 0);
-    ScopedSpinLock lock(s_mm_lock);
-    if (m_user_physical_pages_uncommitted < page_count)
+    if (!take_uncommitted_user_physical_pages(page_count))
         return false;
 
-    m_user_physical_pages_uncommitted -= page_count;
     m_user_physical_pages_committed += page_count;
     return true;
 }
@@ -566,64 +585,118 @@ bool MemoryManager::commit_user_physical_pages(size_t page_count)
 void MemoryManager::uncommit_user_physical_pages(size_t page_count)
 {
     VERIFY(page_count > 0);
-    ScopedSpinLock lock(s_mm_lock);
     VERIFY(m_user_physical_pages_committed >= page_count);
 
     m_user_physical_pages_uncommitted += page_count;
     m_user_physical_pages_committed -= page_count;
 }
 
-void MemoryManager::deallocate_user_physical_page(const PhysicalPage& page)
+void MemoryManager::return_user_physical_page_to_region(PhysicalAddress paddr)
 {
-    ScopedSpinLock lock(s_mm_lock);
+    VERIFY(m_user_physical_regions_lock.is_locked());
     for (auto& region : m_user_physical_regions) {
-        if (!region.contains(page))
+        if (!region.contains(paddr))
             continue;
-
-        region.return_page(page);
-        --m_user_physical_pages_used;
-
-        // Always return pages to the uncommitted pool. Pages that were
-        // committed and allocated are only freed upon request. Once
-        // returned there is no guarantee being able to get them back.
-        ++m_user_physical_pages_uncommitted;
+        region.return_page(paddr);
         return;
     }
 
-    dmesgln("MM: deallocate_user_physical_page couldn't figure out region for user page @ {}", page.paddr());
+    dmesgln("MM: deallocate_user_physical_page couldn't figure out region for user page @ {}", paddr);
     VERIFY_NOT_REACHED();
 }
 
+void MemoryManager::deallocate_user_physical_page(const PhysicalPage& page)
+{
+    auto& cache = get_data().m_user_physical_page_cache;
+    ScopedSpinLock cache_lock(cache.lock);
+    if (cache.count == cache.capacity) {
+        // Hand the oldest batch back to the regions and keep the recently freed (and likely cached) pages.
+        ScopedSpinLock lock(m_user_physical_regions_lock);
+        for (size_t i = 0; i < cache.batch_size; ++i)
+            return_user_physical_page_to_region(cache.pages[i]);
+        for (size_t i = cache.batch_size; i < cache.count; ++i)
+            cache.pages[i - cache.batch_size] = cache.pages[i];
+        cache.count -= cache.batch_size;
+    }
+    cache.pages[cache.count++] = page.paddr();
+    --m_user_physical_pages_used;
+
+    // Always return pages to the uncommitted pool. Pages that were
+    // committed and allocated are only freed upon request. Once
+    // returned there is no guarantee being able to get them back.
+    ++m_user_physical_pages_uncommitted;
+}
+
+Optional<PhysicalAddress> MemoryManager::take_free_user_physical_page(bool committed)
+{
+    for (;;) {
+        {
+            auto& cache = get_data().m_user_physical_page_cache;
+            ScopedSpinLock cache_lock(cache.lock);
+            if (cache.count) {
+                ++cache.hits;
+                return cache.pages[--cache.count];
+            }
+
+            ++cache.misses;
+            ScopedSpinLock lock(m_user_physical_regions_lock);
+            for (auto& region : m_user_physical_regions) {
+                while (cache.count < cache.batch_size) {
+                    auto paddr = region.take_free_page();
+                    if (!paddr.has_value())
+                        break;
+                    cache.pages[cache.count++] = paddr.value();
+                }
+            }
+            if (cache.count)
+                return cache.pages[--cache.count];
+        }
+
+        // The regions ran dry, but other processors may still have some free pages cached.
+        Optional<PhysicalAddress> paddr;
+        Processor::for_each([&](Processor& processor) {
+            auto& cache = processor.get_mm_data().m_user_physical_page_cache;
+            ScopedSpinLock cache_lock(cache.lock);
+            if (!cache.count)
+                return IterationDecision::Continue;
+            paddr = cache.pages[--cache.count];
+            return IterationDecision::Break;
+        });
+        if (paddr.has_value() || !committed)
+            return paddr;
+
+        // A committed page is guaranteed to exist, but it may have been freed into a cache
+        // we already looked at while we were walking them, so keep looking until we find it.
+        Processor::wait_check();
+    }
+}
+
 RefPtr<PhysicalPage> MemoryManager::find_free_user_physical_page(bool committed)
 {
-    VERIFY(s_mm_lock.is_locked());
-    RefPtr<PhysicalPage> page;
     if (committed) {
         // Draw from the committed pages pool. We should always have these pages available
         VERIFY(m_user_physical_pages_committed > 0);
         m_user_physical_pages_committed--;
     } else {
         // We need to make sure we don't touch pages that we have committed to
-        if (m_user_physical_pages_uncommitted == 0)
+        if (!take_uncommitted_user_physical_pages(1))
             return {};
-        m_user_physical_pages_uncommitted--;
     }
-    for (auto& region : m_user_physical_regions) {
-        page = region.take_free_page(false);
-        if (!page.is_null()) {
-            ++m_user_physical_pages_used;
-            break;
-        }
+    auto paddr = take_free_user_physical_page(committed);
+    VERIFY(!committed || paddr.has_value());
+    if (!paddr.has_value()) {
+        ++m_user_physical_pages_uncommitted;
+        return {};
     }
-    VERIFY(!committed || !page.is_null());
-    return page;
+    ++m_user_physical_pages_used;
+    return PhysicalPage::create(paddr.value(), false);
 }
 
 NonnullRefPtr<PhysicalPage> MemoryManager::allocate_committed_user_physical_page(ShouldZeroFill should_zero_fill)
 {
-    ScopedSpinLock lock(s_mm_lock);
     auto page = find_free_user_physical_page(true);
     if (should_zero_fill == ShouldZeroFill::Yes) {
+        InterruptDisabler disabler;
         auto* ptr = quickmap_page(*page);
         memset(ptr, 0, PAGE_SIZE);
         unquickmap_page();
@@ -633,11 +706,11 @@ NonnullRefPtr<PhysicalPage> MemoryManager::allocate_committed_user_physical_page
 
 RefPtr<PhysicalPage> MemoryManager::allocate_user_physical_page(ShouldZeroFill should_zero_fill, bool* did_purge)
 {
-    ScopedSpinLock lock(s_mm_lock);
     auto page = find_free_user_physical_page(false);
     bool purged_pages = false;
 
     if (!page) {
+        ScopedSpinLock lock(s_mm_lock);
         // We didn't have a single free physical page. Let's try to free something up!
         // First, we look for a purgeable VMObject in the volatile state.
         for_each_vmobject([&](auto& vmobject) {
@@ -660,6 +733,7 @@ RefPtr<PhysicalPage> MemoryManager::allocate_user_physical_page(ShouldZeroFill s
     }
 
     if (should_zero_fill == ShouldZeroFill::Yes) {
+        InterruptDisabler disabler;
         auto* ptr = quickmap_page(*page);
         memset(ptr, 0, PAGE_SIZE);
         unquickmap_page();
@@ -679,7 +753,7 @@ void MemoryManager::deallocate_supervisor_physical_page(const PhysicalPage& page
             continue;
         }
 
-        region.return_page(page);
+        region.return_page(page.paddr());
         --m_super_physical_pages_used;
         return;
     }
@@ -698,7 +772,7 @@ NonnullRefPtrVector<PhysicalPage> MemoryManager::allocate_contiguous_supervisor_
     for (auto& region : m_super_physical_regions) {
         physical_pages = region.take_contiguous_free_pages(count, true, physical_alignment);
         if (!physical_pages.is_empty())
-            continue;
+            break;
     }
 
     if (physical_pages.is_empty()) {
@@ -723,9 +797,11 @@ RefPtr<PhysicalPage> MemoryManager::allocate_supervisor_physical_page()
     RefPtr<PhysicalPage> page;
 
     for (auto& region : m_super_physical_regions) {
-        page = region.take_free_page(true);
-        if (!page.is_null())
+        auto paddr = region.take_free_page();
+        if (paddr.has_value()) {
+            page = PhysicalPage::create(paddr.value(), true);
             break;
+        }
     }
 
     if (!page) {
@@ -26,6 +26,7 @@
 
 #pragma once
 
+#include <AK/Array.h>
 #include <AK/HashTable.h>
 #include <AK/NonnullRefPtrVector.h>
 #include <AK/String.h>
@@ -107,12 +108,29 @@ struct PhysicalMemoryRange {
 
 #define MM Kernel::MemoryManager::the()
 
+// A small stack of free user physical pages owned by one processor. Most page allocations and
+// frees are served from here; the physical regions are only touched to refill or drain a batch.
+struct PhysicalPageCache {
+    static constexpr size_t capacity = 64;
+    static constexpr size_t batch_size = capacity / 2;
+
+    // Only contended when another processor steals pages because the regions ran dry.
+    SpinLock<u8> lock;
+    size_t count { 0 };
+    Array<PhysicalAddress, capacity> pages;
+
+    u64 hits { 0 };
+    u64 misses { 0 };
+};
+
 struct MemoryManagerData {
     SpinLock<u8> m_quickmap_in_use;
     u32 m_quickmap_prev_flags;
 
     PhysicalAddress m_last_quickmap_pd;
     PhysicalAddress m_last_quickmap_pt;
+
+    PhysicalPageCache m_user_physical_page_cache;
 };
 
 extern RecursiveSpinLock s_mm_lock;
@@ -174,6 +192,10 @@ public:
     unsigned user_physical_pages_used() const { return m_user_physical_pages_used; }
     unsigned user_physical_pages_committed() const { return m_user_physical_pages_committed; }
     unsigned user_physical_pages_uncommitted() const { return m_user_physical_pages_uncommitted; }
+
+    // Opportunistic caches (like the disk cache) use these to decide whether to grow or to give memory back.
+    bool has_plenty_of_free_user_physical_pages() const { return m_user_physical_pages_uncommitted > m_user_physical_pages / 4; }
+    bool is_low_on_user_physical_pages() const { return m_user_physical_pages_uncommitted < m_user_physical_pages / 8; }
     unsigned super_physical_pages() const { return m_super_physical_pages; }
     unsigned super_physical_pages_used() const { return m_super_physical_pages_used; }
 
@@ -188,6 +210,9 @@ public:
 
     static Region* find_region_from_vaddr(Space&, VirtualAddress);
 
+    // Returns the page backing a kernel virtual address, or null if there is no committed page behind it yet.
+    RefPtr<PhysicalPage> committed_physical_page_for_kernel_vaddr(VirtualAddress);
+
     void dump_kernel_regions();
 
     PhysicalPage& shared_zero_page() { return *m_shared_zero_page; }
@@ -220,6 +245,9 @@ private:
     static Region* find_region_from_vaddr(VirtualAddress);
 
     RefPtr<PhysicalPage> find_free_user_physical_page(bool);
+    bool take_uncommitted_user_physical_pages(size_t);
+    Optional<PhysicalAddress> take_free_user_physical_page(bool committed);
+    void return_user_physical_page_to_region(PhysicalAddress);
     u8* quickmap_page(PhysicalPage&);
     void unquickmap_page();
 
@@ -243,6 +271,7 @@ private:
     Atomic<unsigned, AK::MemoryOrder::memory_order_relaxed> m_super_physical_pages_used { 0 };
 
     NonnullRefPtrVector<PhysicalRegion> m_user_physical_regions;
+    SpinLock<u8> m_user_physical_regions_lock;
     NonnullRefPtrVector<PhysicalRegion> m_super_physical_regions;
 
     InlineLinkedList<Region> m_user_regions;
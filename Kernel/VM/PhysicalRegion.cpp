@@ -29,7 +29,6 @@
 #include <AK/RefPtr.h>
 #include <AK/Vector.h>
 #include <Kernel/Assertions.h>
-#include <Kernel/Random.h>
 #include <Kernel/VM/PhysicalPage.h>
 #include <Kernel/VM/PhysicalRegion.h>
 
@@ -59,133 +58,152 @@ unsigned PhysicalRegion::finalize_capacity()
     VERIFY(!m_pages);
 
     m_pages = (m_upper.get() - m_lower.get()) / PAGE_SIZE;
-    m_bitmap.grow(m_pages, false);
+
+    auto first_page = m_lower.get() / PAGE_SIZE;
+    m_base_page = first_page & ~(((FlatPtr)1 << max_order) - 1);
+    size_t first_index = first_page - m_base_page;
+    size_t index_count = first_index + m_pages;
+    for (unsigned order = 0; order <= max_order; ++order) {
+        // Bitmap searches only look at whole bytes. The padding bits are never set, since they stand for pages outside the region.
+        auto block_count = ceil_div(index_count, (size_t)1 << order);
+        m_free_blocks[order].bitmap.grow(round_up_to_power_of_two(block_count, 8), false);
+    }
+
+    free_range(first_index, m_pages);
 
     return size();
 }
 
-NonnullRefPtrVector<PhysicalPage> PhysicalRegion::take_contiguous_free_pages(size_t count, bool supervisor, size_t physical_alignment)
+size_t PhysicalRegion::page_index_of(PhysicalAddress paddr) const
 {
-    VERIFY(m_pages);
-    VERIFY(m_used != m_pages);
-
-    NonnullRefPtrVector<PhysicalPage> physical_pages;
-    physical_pages.ensure_capacity(count);
-
-    auto first_contiguous_page = find_contiguous_free_pages(count, physical_alignment);
+    VERIFY(paddr >= m_lower);
+    Checked<FlatPtr> local_offset = paddr.get();
+    local_offset -= m_lower.get();
+    VERIFY(!local_offset.has_overflow());
+    VERIFY(local_offset.value() < (FlatPtr)(m_pages * PAGE_SIZE));
+    return paddr.get() / PAGE_SIZE - m_base_page;
+}
 
-    for (size_t index = 0; index < count; index++)
-        physical_pages.append(PhysicalPage::create(m_lower.offset(PAGE_SIZE * (index + first_contiguous_page)), supervisor));
-    return physical_pages;
+void PhysicalRegion::mark_block_free(size_t page_index, unsigned order)
+{
+    auto& free_blocks = m_free_blocks[order];
+    auto block = page_index >> order;
+    VERIFY(!free_blocks.bitmap.get(block));
+    free_blocks.bitmap.set(block, true);
+    free_blocks.count++;
+    // Recently freed blocks are the most likely to still be in the cache.
+    free_blocks.search_hint = block;
 }
 
-unsigned PhysicalRegion::find_contiguous_free_pages(size_t count, size_t physical_alignment)
+void PhysicalRegion::mark_block_used(size_t page_index, unsigned order)
 {
-    VERIFY(count != 0);
-    VERIFY(physical_alignment % PAGE_SIZE == 0);
-    // search from the last page we allocated
-    auto range = find_and_allocate_contiguous_range(count, physical_alignment / PAGE_SIZE);
-    VERIFY(range.has_value());
-    return range.value();
+    auto& free_blocks = m_free_blocks[order];
+    auto block = page_index >> order;
+    VERIFY(free_blocks.bitmap.get(block));
+    free_blocks.bitmap.set(block, false);
+    free_blocks.count--;
 }
 
-Optional<unsigned> PhysicalRegion::find_one_free_page()
+Optional<size_t> PhysicalRegion::allocate_block(unsigned order)
 {
-    if (m_used == m_pages) {
-        // We know we don't have any free pages, no need to check the bitmap
-        // Check if we can draw one from the return queue
-        if (m_recently_returned.size() > 0) {
-            u8 index = get_fast_random<u8>() % m_recently_returned.size();
-            Checked<FlatPtr> local_offset = m_recently_returned[index].get();
-            local_offset -= m_lower.get();
-            m_recently_returned.remove(index);
-            VERIFY(!local_offset.has_overflow());
-            VERIFY(local_offset.value() < (FlatPtr)(m_pages * PAGE_SIZE));
-            return local_offset.value() / PAGE_SIZE;
+    for (unsigned block_order = order; block_order <= max_order; ++block_order) {
+        auto& free_blocks = m_free_blocks[block_order];
+        if (!free_blocks.count)
+            continue;
+
+        auto block = free_blocks.bitmap.find_one_anywhere_set(free_blocks.search_hint);
+        VERIFY(block.has_value());
+        size_t page_index = block.value() << block_order;
+        mark_block_used(page_index, block_order);
+
+        // Split the block, keeping the lower half and giving back the upper one until it has the size we want.
+        while (block_order > order) {
+            --block_order;
+            mark_block_free(page_index + ((size_t)1 << block_order), block_order);
         }
-        return {};
+        return page_index;
     }
-    auto free_index = m_bitmap.find_one_anywhere_unset(m_free_hint);
-    if (!free_index.has_value())
-        return {};
-
-    auto page_index = free_index.value();
-    m_bitmap.set(page_index, true);
-    m_used++;
-    m_free_hint = free_index.value() + 1; // Just a guess
-    if (m_free_hint >= m_bitmap.size())
-        m_free_hint = 0;
-    return page_index;
+    return {};
 }
 
-Optional<unsigned> PhysicalRegion::find_and_allocate_contiguous_range(size_t count, unsigned alignment)
+void PhysicalRegion::free_block(size_t page_index, unsigned order)
 {
-    VERIFY(count != 0);
-    size_t found_pages_count = 0;
-    // TODO: Improve how we deal with alignment != 1
-    auto first_index = m_bitmap.find_longest_range_of_unset_bits(count + alignment - 1, found_pages_count);
-    if (!first_index.has_value())
-        return {};
-
-    auto page = first_index.value();
-    if (alignment != 1) {
-        auto lower_page = m_lower.get() / PAGE_SIZE;
-        page = ((lower_page + page + alignment - 1) & ~(alignment - 1)) - lower_page;
+    // Merge with the buddy block for as long as it is free too.
+    while (order < max_order) {
+        size_t buddy_index = page_index ^ ((size_t)1 << order);
+        auto buddy_block = buddy_index >> order;
+        auto& free_blocks = m_free_blocks[order];
+        if (buddy_block >= free_blocks.bitmap.size() || !free_blocks.bitmap.get(buddy_block))
+            break;
+        mark_block_used(buddy_index, order);
+        page_index = min(page_index, buddy_index);
+        ++order;
     }
-    if (found_pages_count >= count) {
-        m_bitmap.set_range<true>(page, count);
-        m_used += count;
-        m_free_hint = first_index.value() + count + 1; // Just a guess
-        if (m_free_hint >= m_bitmap.size())
-            m_free_hint = 0;
-        return page;
+    mark_block_free(page_index, order);
+}
+
+void PhysicalRegion::free_range(size_t page_index, size_t count)
+{
+    while (count) {
+        unsigned order = max_order;
+        while (order > 0 && ((page_index & (((size_t)1 << order) - 1)) || ((size_t)1 << order) > count))
+            --order;
+        free_block(page_index, order);
+        page_index += (size_t)1 << order;
+        count -= (size_t)1 << order;
     }
-    return {};
 }
 
-RefPtr<PhysicalPage> PhysicalRegion::take_free_page(bool supervisor)
+Optional<PhysicalAddress> PhysicalRegion::take_free_page()
 {
     VERIFY(m_pages);
 
-    auto free_index = find_one_free_page();
-    if (!free_index.has_value())
-        return nullptr;
+    auto page_index = allocate_block(0);
+    if (!page_index.has_value())
+        return {};
 
-    return PhysicalPage::create(m_lower.offset(free_index.value() * PAGE_SIZE), supervisor);
+    m_used++;
+    return address_of_page(page_index.value());
 }
 
-void PhysicalRegion::free_page_at(PhysicalAddress addr)
+NonnullRefPtrVector<PhysicalPage> PhysicalRegion::take_contiguous_free_pages(size_t count, bool supervisor, size_t physical_alignment)
 {
     VERIFY(m_pages);
+    VERIFY(count != 0);
+    VERIFY(physical_alignment % PAGE_SIZE == 0);
 
-    if (m_used == 0) {
-        VERIFY_NOT_REACHED();
-    }
+    // Blocks are naturally aligned, so a block at least as large as the alignment is aligned too.
+    size_t pages_needed = max(count, physical_alignment / PAGE_SIZE);
+    unsigned order = 0;
+    while (((size_t)1 << order) < pages_needed)
+        ++order;
+    if (order > max_order)
+        return {};
 
-    Checked<FlatPtr> local_offset = addr.get();
-    local_offset -= m_lower.get();
-    VERIFY(!local_offset.has_overflow());
-    VERIFY(local_offset.value() < (FlatPtr)(m_pages * PAGE_SIZE));
+    auto page_index = allocate_block(order);
+    if (!page_index.has_value())
+        return {};
 
-    auto page = local_offset.value() / PAGE_SIZE;
-    m_bitmap.set(page, false);
-    m_free_hint = page; // We know we can find one here for sure
-    m_used--;
+    // Give back the part of the block we don't need.
+    size_t block_size = (size_t)1 << order;
+    if (count < block_size)
+        free_range(page_index.value() + count, block_size - count);
+    m_used += count;
+
+    NonnullRefPtrVector<PhysicalPage> physical_pages;
+    physical_pages.ensure_capacity(count);
+    for (size_t index = 0; index < count; index++)
+        physical_pages.append(PhysicalPage::create(address_of_page(page_index.value() + index), supervisor));
+    return physical_pages;
 }
 
-void PhysicalRegion::return_page(const PhysicalPage& page)
+void PhysicalRegion::return_page(PhysicalAddress paddr)
 {
-    auto returned_count = m_recently_returned.size();
-    if (returned_count >= m_recently_returned.capacity()) {
-        // Return queue is full, pick a random entry and free that page
-        // and replace the entry with this page
-        auto& entry = m_recently_returned[get_fast_random<u8>()];
-        free_page_at(entry);
-        entry = page.paddr();
-    } else {
-        // Still filling the return queue, just append it
-        m_recently_returned.append(page.paddr());
-    }
+    VERIFY(m_pages);
+    VERIFY(m_used > 0);
+
+    free_block(page_index_of(paddr), 0);
+    m_used--;
 }
 
 }
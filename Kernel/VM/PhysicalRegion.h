@@ -26,6 +26,7 @@
 
 #pragma once
 
+#include <AK/Array.h>
 #include <AK/Bitmap.h>
 #include <AK/NonnullRefPtrVector.h>
 #include <AK/Optional.h>
@@ -34,10 +35,15 @@
 
 namespace Kernel {
 
+// Hands out physical pages with a binary buddy allocator: free memory is kept as naturally
+// aligned blocks of 2^order pages, so single pages and contiguous runs both come from the
+// per-order free bitmaps without scanning the whole region.
 class PhysicalRegion : public RefCounted<PhysicalRegion> {
     AK_MAKE_ETERNAL
 
 public:
+    static constexpr unsigned max_order = 12;
+
     static NonnullRefPtr<PhysicalRegion> create(PhysicalAddress lower, PhysicalAddress upper);
     ~PhysicalRegion() = default;
 
@@ -47,19 +53,31 @@ public:
     PhysicalAddress lower() const { return m_lower; }
     PhysicalAddress upper() const { return m_upper; }
     unsigned size() const { return m_pages; }
-    unsigned used() const { return m_used - m_recently_returned.size(); }
-    unsigned free() const { return m_pages - m_used + m_recently_returned.size(); }
-    bool contains(const PhysicalPage& page) const { return page.paddr() >= m_lower && page.paddr() <= m_upper; }
+    unsigned used() const { return m_used; }
+    unsigned free() const { return m_pages - m_used; }
+    bool contains(PhysicalAddress paddr) const { return paddr >= m_lower && paddr <= m_upper; }
+    bool contains(const PhysicalPage& page) const { return contains(page.paddr()); }
 
-    RefPtr<PhysicalPage> take_free_page(bool supervisor);
+    Optional<PhysicalAddress> take_free_page();
     NonnullRefPtrVector<PhysicalPage> take_contiguous_free_pages(size_t count, bool supervisor, size_t physical_alignment = PAGE_SIZE);
-    void return_page(const PhysicalPage& page);
+    void return_page(PhysicalAddress);
 
 private:
-    unsigned find_contiguous_free_pages(size_t count, size_t physical_alignment = PAGE_SIZE);
-    Optional<unsigned> find_and_allocate_contiguous_range(size_t count, unsigned alignment = 1);
-    Optional<unsigned> find_one_free_page();
-    void free_page_at(PhysicalAddress addr);
+    struct FreeBlocks {
+        // One bit per block of this order, set if the block is free.
+        Bitmap bitmap;
+        size_t count { 0 };
+        size_t search_hint { 0 };
+    };
+
+    Optional<size_t> allocate_block(unsigned order);
+    void free_block(size_t page_index, unsigned order);
+    void free_range(size_t page_index, size_t count);
+    void mark_block_free(size_t page_index, unsigned order);
+    void mark_block_used(size_t page_index, unsigned order);
+
+    PhysicalAddress address_of_page(size_t page_index) const { return PhysicalAddress((m_base_page + page_index) * PAGE_SIZE); }
+    size_t page_index_of(PhysicalAddress) const;
 
     PhysicalRegion(PhysicalAddress lower, PhysicalAddress upper);
 
@@ -67,9 +85,11 @@ private:
     PhysicalAddress m_upper;
     unsigned m_pages { 0 };
     unsigned m_used { 0 };
-    Bitmap m_bitmap;
-    size_t m_free_hint { 0 };
-    Vector<PhysicalAddress, 256> m_recently_returned;
+
+    // Page indices are relative to m_base_page, the first page of the region rounded down to
+    // a max_order block, so that every block is also naturally aligned in physical memory.
+    FlatPtr m_base_page { 0 };
+    Array<FreeBlocks, max_order + 1> m_free_blocks;
 };
 
 }
@@ -24,9 +24,7 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
-#include <AK/BinarySearch.h>
 #include <AK/Checked.h>
-#include <AK/QuickSort.h>
 #include <Kernel/Random.h>
 #include <Kernel/Thread.h>
 #include <Kernel/VM/RangeAllocator.h>
@@ -43,7 +41,7 @@ RangeAllocator::RangeAllocator()
 void RangeAllocator::initialize_with_range(VirtualAddress base, size_t size)
 {
     m_total_range = { base, size };
-    m_available_ranges.append({ base, size });
+    insert_available_range({ base, size });
 }
 
 void RangeAllocator::initialize_from_parent(const RangeAllocator& parent_allocator)
@@ -51,6 +49,7 @@ void RangeAllocator::initialize_from_parent(const RangeAllocator& parent_allocat
     ScopedSpinLock lock(parent_allocator.m_lock);
     m_total_range = parent_allocator.m_total_range;
     m_available_ranges = parent_allocator.m_available_ranges;
+    m_available_ranges_by_size = parent_allocator.m_available_ranges_by_size;
 }
 
 RangeAllocator::~RangeAllocator()
@@ -66,16 +65,30 @@ void RangeAllocator::dump() const
     }
 }
 
-void RangeAllocator::carve_at_index(int index, const Range& range)
+void RangeAllocator::insert_available_range(const Range& range)
+{
+    m_available_ranges.insert(range.base().get(), range);
+    m_available_ranges_by_size.insert({ range.size(), range.base().get() }, range);
+}
+
+void RangeAllocator::remove_available_range(const Range& range)
+{
+    // The range may live in one of the trees, so don't touch it after the first removal.
+    SizeAndBase key { range.size(), range.base().get() };
+    bool removed = m_available_ranges.remove(key.base);
+    VERIFY(removed);
+    removed = m_available_ranges_by_size.remove(key);
+    VERIFY(removed);
+}
+
+void RangeAllocator::carve_from_available_range(const Range& available_range, const Range& range)
 {
     VERIFY(m_lock.is_locked());
-    auto remaining_parts = m_available_ranges[index].carve(range);
-    VERIFY(remaining_parts.size() >= 1);
-    VERIFY(m_total_range.contains(remaining_parts[0]));
-    m_available_ranges[index] = remaining_parts[0];
-    if (remaining_parts.size() == 2) {
-        VERIFY(m_total_range.contains(remaining_parts[1]));
-        m_available_ranges.insert(index + 1, move(remaining_parts[1]));
+    auto remaining_parts = available_range.carve(range);
+    remove_available_range(available_range);
+    for (auto& part : remaining_parts) {
+        VERIFY(m_total_range.contains(part));
+        insert_available_range(part);
     }
 }
 
@@ -127,11 +140,10 @@ Optional<Range> RangeAllocator::allocate_anywhere(size_t size, size_t alignment)
         return {};
 
     ScopedSpinLock lock(m_lock);
-    for (size_t i = 0; i < m_available_ranges.size(); ++i) {
-        auto& available_range = m_available_ranges[i];
-        // FIXME: This check is probably excluding some valid candidates when using a large alignment.
-        if (available_range.size() < (effective_size + alignment))
-            continue;
+    // Best fit: take the smallest available range that is large enough.
+    // FIXME: This check is probably excluding some valid candidates when using a large alignment.
+    if (auto* candidate = m_available_ranges_by_size.find_smallest_not_below({ effective_size + alignment, 0 })) {
+        auto available_range = *candidate;
 
         FlatPtr initial_base = available_range.base().offset(offset_from_effective_base).get();
         FlatPtr aligned_base = round_up_to_power_of_two(initial_base, alignment);
@@ -139,11 +151,7 @@ Optional<Range> RangeAllocator::allocate_anywhere(size_t size, size_t alignment)
         Range allocated_range(VirtualAddress(aligned_base), size);
         VERIFY(m_total_range.contains(allocated_range));
 
-        if (available_range == allocated_range) {
-            m_available_ranges.remove(i);
-            return allocated_range;
-        }
-        carve_at_index(i, allocated_range);
+        carve_from_available_range(available_range, allocated_range);
         return allocated_range;
     }
     dmesgln("RangeAllocator: Failed to allocate anywhere: size={}, alignment={}", size, alignment);
@@ -160,19 +168,13 @@ Optional<Range> RangeAllocator::allocate_specific(VirtualAddress base, size_t si
 
     Range allocated_range(base, size);
     ScopedSpinLock lock(m_lock);
-    for (size_t i = 0; i < m_available_ranges.size(); ++i) {
-        auto& available_range = m_available_ranges[i];
-        VERIFY(m_total_range.contains(allocated_range));
-        if (!available_range.contains(base, size))
-            continue;
-        if (available_range == allocated_range) {
-            m_available_ranges.remove(i);
-            return allocated_range;
-        }
-        carve_at_index(i, allocated_range);
-        return allocated_range;
-    }
-    return {};
+    // Only the available range with the largest base not above the requested one can contain it.
+    auto* candidate = m_available_ranges.find_largest_not_above(base.get());
+    if (!candidate || !candidate->contains(base, size))
+        return {};
+    VERIFY(m_total_range.contains(allocated_range));
+    carve_from_available_range(*candidate, allocated_range);
+    return allocated_range;
 }
 
 void RangeAllocator::deallocate(const Range& range)
@@ -182,37 +184,26 @@ void RangeAllocator::deallocate(const Range& range)
     VERIFY(range.size());
     VERIFY((range.size() % PAGE_SIZE) == 0);
     VERIFY(range.base() < range.end());
-    VERIFY(!m_available_ranges.is_empty());
-
-    size_t nearby_index = 0;
-    auto* existing_range = binary_search(
-        m_available_ranges.span(),
-        range,
-        &nearby_index,
-        [](auto& a, auto& b) { return a.base().get() - b.end().get(); });
-
-    size_t inserted_index = 0;
-    if (existing_range) {
-        existing_range->m_size += range.size();
-        inserted_index = nearby_index;
-    } else {
-        m_available_ranges.insert_before_matching(
-            Range(range), [&](auto& entry) {
-                return entry.base() >= range.end();
-            },
-            nearby_index, &inserted_index);
-    }
 
-    if (inserted_index < (m_available_ranges.size() - 1)) {
-        // We already merged with previous. Try to merge with next.
-        auto& inserted_range = m_available_ranges[inserted_index];
-        auto& next_range = m_available_ranges[inserted_index + 1];
-        if (inserted_range.end() == next_range.base()) {
-            inserted_range.m_size += next_range.size();
-            m_available_ranges.remove(inserted_index + 1);
-            return;
+    Range merged_range = range;
+
+    // Coalesce with the available ranges directly before and after, if any.
+    if (auto* previous_range = m_available_ranges.find_largest_not_above(range.base().get())) {
+        VERIFY(previous_range->end() <= range.base());
+        if (previous_range->end() == range.base()) {
+            merged_range = { previous_range->base(), previous_range->size() + merged_range.size() };
+            remove_available_range(*previous_range);
         }
     }
+    if (auto* next_range = m_available_ranges.find_smallest_not_below(range.base().get())) {
+        VERIFY(next_range->base() >= range.end());
+        if (next_range->base() == range.end()) {
+            merged_range = { merged_range.base(), merged_range.size() + next_range->size() };
+            remove_available_range(*next_range);
+        }
+    }
+
+    insert_available_range(merged_range);
 }
 
 }
@@ -26,8 +26,8 @@
 
 #pragma once
 
+#include <AK/RedBlackTree.h>
 #include <AK/Traits.h>
-#include <AK/Vector.h>
 #include <Kernel/SpinLock.h>
 #include <Kernel/VM/Range.h>
 
@@ -55,9 +55,27 @@ public:
     }
 
 private:
-    void carve_at_index(int, const Range&);
+    void insert_available_range(const Range&);
+    void remove_available_range(const Range&);
+    void carve_from_available_range(const Range& available_range, const Range&);
 
-    Vector<Range> m_available_ranges;
+    struct SizeAndBase {
+        size_t size;
+        FlatPtr base;
+
+        bool operator<(const SizeAndBase& other) const
+        {
+            if (size != other.size)
+                return size < other.size;
+            return base < other.base;
+        }
+    };
+
+    // Every available range is kept in both trees: by base address to find neighbors when
+    // carving and coalescing, and by size so that allocate_anywhere() can pick the smallest
+    // range that fits without walking the whole address space.
+    RedBlackTree<FlatPtr, Range> m_available_ranges;
+    RedBlackTree<SizeAndBase, Range> m_available_ranges_by_size;
     Range m_total_range;
     mutable SpinLock<u8> m_lock;
 };
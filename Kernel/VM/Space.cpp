@@ -25,7 +25,6 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
-#include <AK/QuickSort.h>
 #include <Kernel/Process.h>
 #include <Kernel/SpinLock.h>
 #include <Kernel/VM/AnonymousVMObject.h>
@@ -118,18 +117,19 @@ KResultOr<Region*> Space::allocate_region_with_vmobject(const Range& range, Nonn
 
 bool Space::deallocate_region(Region& region)
 {
-    OwnPtr<Region> region_protector;
+    return take_region(region);
+}
+
+OwnPtr<Region> Space::take_region(Region& region)
+{
     ScopedSpinLock lock(m_lock);
 
     if (m_region_lookup_cache.region.unsafe_ptr() == &region)
         m_region_lookup_cache.region = nullptr;
-    for (size_t i = 0; i < m_regions.size(); ++i) {
-        if (&m_regions[i] == &region) {
-            region_protector = m_regions.unstable_take(i);
-            return true;
-        }
-    }
-    return false;
+    auto* found_region = m_regions.find(region.vaddr().get());
+    if (!found_region || found_region->ptr() != &region)
+        return {};
+    return m_regions.take(region.vaddr().get()).release_value();
 }
 
 Region* Space::find_region_from_range(const Range& range)
@@ -138,25 +138,25 @@ Region* Space::find_region_from_range(const Range& range)
     if (m_region_lookup_cache.range.has_value() && m_region_lookup_cache.range.value() == range && m_region_lookup_cache.region)
         return m_region_lookup_cache.region.unsafe_ptr();
 
+    auto* found_region = m_regions.find(range.base().get());
+    if (!found_region)
+        return nullptr;
+    auto& region = *found_region;
     size_t size = page_round_up(range.size());
-    for (auto& region : m_regions) {
-        if (region.vaddr() == range.base() && region.size() == size) {
-            m_region_lookup_cache.range = range;
-            m_region_lookup_cache.region = region;
-            return &region;
-        }
-    }
-    return nullptr;
+    if (region->size() != size)
+        return nullptr;
+    m_region_lookup_cache.range = range;
+    m_region_lookup_cache.region = *region;
+    return region.ptr();
 }
 
 Region* Space::find_region_containing(const Range& range)
 {
     ScopedSpinLock lock(m_lock);
-    for (auto& region : m_regions) {
-        if (region.contains(range))
-            return &region;
-    }
-    return nullptr;
+    auto* candidate = m_regions.find_largest_not_above(range.base().get());
+    if (!candidate)
+        return nullptr;
+    return (*candidate)->contains(range) ? candidate->ptr() : nullptr;
 }
 
 Vector<Region*> Space::find_regions_intersecting(const Range& range)
@@ -166,12 +166,18 @@ Vector<Region*> Space::find_regions_intersecting(const Range& range)
 
     ScopedSpinLock lock(m_lock);
 
-    // FIXME: Maybe take the cache from the single lookup?
-    for (auto& region : m_regions) {
-        if (region.range().base() < range.end() && region.range().end() > range.base()) {
-            regions.append(&region);
-
-            total_size_collected += region.size() - region.range().intersect(range).size();
+    // Start at the region that may contain the base of the range, then walk upwards in address order.
+    auto it = m_regions.find_largest_not_above_iterator(range.base().get());
+    if (it.is_end())
+        it = m_regions.begin();
+    for (; it != m_regions.end(); ++it) {
+        auto& region = *it;
+        if (region->range().base() >= range.end())
+            break;
+        if (region->range().end() > range.base()) {
+            regions.append(region.ptr());
+
+            total_size_collected += region->size() - region->range().intersect(range).size();
             if (total_size_collected == range.size())
                 break;
         }
@@ -184,7 +190,7 @@ Region& Space::add_region(NonnullOwnPtr<Region> region)
 {
     auto* ptr = region.ptr();
     ScopedSpinLock lock(m_lock);
-    m_regions.append(move(region));
+    m_regions.insert(region->vaddr().get(), move(region));
     return *ptr;
 }
 
@@ -214,16 +220,8 @@ void Space::dump_regions()
 
     ScopedSpinLock lock(m_lock);
 
-    Vector<Region*> sorted_regions;
-    sorted_regions.ensure_capacity(m_regions.size());
-    for (auto& region : m_regions)
-        sorted_regions.append(&region);
-    quick_sort(sorted_regions, [](auto& a, auto& b) {
-        return a->vaddr() < b->vaddr();
-    });
-
-    for (auto& sorted_region : sorted_regions) {
-        auto& region = *sorted_region;
+    for (auto& region_ptr : m_regions) {
+        auto& region = *region_ptr;
         dbgln("{:08x} -- {:08x} {:08x} {:c}{:c}{:c}{:c}{:c}{:c} {}", region.vaddr().get(), region.vaddr().offset(region.size() - 1).get(), region.size(),
             region.is_readable() ? 'R' : ' ',
             region.is_writable() ? 'W' : ' ',
@@ -250,8 +248,8 @@ size_t Space::amount_dirty_private() const
     //        That's probably a situation that needs to be looked at in general.
     size_t amount = 0;
     for (auto& region : m_regions) {
-        if (!region.is_shared())
-            amount += region.amount_dirty();
+        if (!region->is_shared())
+            amount += region->amount_dirty();
     }
     return amount;
 }
@@ -261,8 +259,8 @@ size_t Space::amount_clean_inode() const
     ScopedSpinLock lock(m_lock);
     HashTable<const InodeVMObject*> vmobjects;
     for (auto& region : m_regions) {
-        if (region.vmobject().is_inode())
-            vmobjects.set(&static_cast<const InodeVMObject&>(region.vmobject()));
+        if (region->vmobject().is_inode())
+            vmobjects.set(&static_cast<const InodeVMObject&>(region->vmobject()));
     }
     size_t amount = 0;
     for (auto& vmobject : vmobjects)
@@ -275,7 +273,7 @@ size_t Space::amount_virtual() const
     ScopedSpinLock lock(m_lock);
     size_t amount = 0;
     for (auto& region : m_regions) {
-        amount += region.size();
+        amount += region->size();
     }
     return amount;
 }
@@ -286,7 +284,7 @@ size_t Space::amount_resident() const
     // FIXME: This will double count if multiple regions use the same physical page.
     size_t amount = 0;
     for (auto& region : m_regions) {
-        amount += region.amount_resident();
+        amount += region->amount_resident();
     }
     return amount;
 }
@@ -300,7 +298,7 @@ size_t Space::amount_shared() const
     //        so that every Region contributes +1 ref to each of its PhysicalPages.
     size_t amount = 0;
     for (auto& region : m_regions) {
-        amount += region.amount_shared();
+        amount += region->amount_shared();
     }
     return amount;
 }
@@ -310,8 +308,8 @@ size_t Space::amount_purgeable_volatile() const
     ScopedSpinLock lock(m_lock);
     size_t amount = 0;
     for (auto& region : m_regions) {
-        if (region.vmobject().is_anonymous() && static_cast<const AnonymousVMObject&>(region.vmobject()).is_any_volatile())
-            amount += region.amount_resident();
+        if (region->vmobject().is_anonymous() && static_cast<const AnonymousVMObject&>(region->vmobject()).is_any_volatile())
+            amount += region->amount_resident();
     }
     return amount;
 }
@@ -321,8 +319,8 @@ size_t Space::amount_purgeable_nonvolatile() const
     ScopedSpinLock lock(m_lock);
     size_t amount = 0;
     for (auto& region : m_regions) {
-        if (region.vmobject().is_anonymous() && !static_cast<const AnonymousVMObject&>(region.vmobject()).is_any_volatile())
-            amount += region.amount_resident();
+        if (region->vmobject().is_anonymous() && !static_cast<const AnonymousVMObject&>(region->vmobject()).is_any_volatile())
+            amount += region->amount_resident();
     }
     return amount;
 }
@@ -459,6 +459,14 @@ Tab::Tab(Type type)
             m_web_content_view->debug_request("collect-garbage");
         }
     }));
+    debug_menu.add_action(GUI::Action::create("Dump GC statistics", [this](auto&) {
+        if (m_type == Type::InProcessWebView) {
+            if (auto* document = m_page_view->document())
+                document->interpreter().heap().dump_statistics();
+        } else {
+            m_web_content_view->debug_request("dump-gc-statistics");
+        }
+    }));
 
     auto& help_menu = m_menubar->add_menu("Help");
     help_menu.add_action(WindowActions::the().about_action());
@@ -59,6 +59,7 @@ void Cell::set_data(JS::Value new_data)
     m_data = builder.build();
 
     m_evaluated_data = move(new_data);
+    did_store_js_value();
 }
 
 void Cell::set_type(const CellType* type)
@@ -119,6 +120,7 @@ void Cell::update_data(Badge<Sheet>)
                 auto [value, exception] = m_sheet->evaluate(m_data, this);
                 m_evaluated_data = value;
                 m_js_exception = move(exception);
+                did_store_js_value();
             }
         }
 
@@ -143,6 +145,7 @@ void Cell::update_data(Badge<Sheet>)
                 auto [value, exception] = m_sheet->evaluate(builder.string_view(), this);
                 if (exception) {
                     m_js_exception = move(exception);
+                    did_store_js_value();
                 } else {
                     if (value.to_boolean()) {
                         if (fmt.background_color.has_value())
@@ -206,6 +209,13 @@ void Cell::copy_from(const Cell& other)
     m_evaluated_formats = other.m_evaluated_formats;
     if (!other.m_js_exception)
         m_js_exception = other.m_js_exception;
+    did_store_js_value();
+}
+
+void Cell::did_store_js_value()
+{
+    if (m_sheet)
+        m_sheet->global_object().write_barrier();
 }
 
 }
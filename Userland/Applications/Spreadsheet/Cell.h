@@ -60,6 +60,7 @@ struct Cell : public Weakable<Cell> {
         , m_sheet(sheet)
         , m_position(move(position))
     {
+        did_store_js_value();
     }
 
     void reference_from(Cell*);
@@ -69,7 +70,11 @@ struct Cell : public Weakable<Cell> {
     bool dirty() const { return m_dirty; }
     void clear_dirty() { m_dirty = false; }
 
-    void set_exception(JS::Exception* exc) { m_js_exception = exc; }
+    void set_exception(JS::Exception* exc)
+    {
+        m_js_exception = exc;
+        did_store_js_value();
+    }
     JS::Exception* exception() const { return m_js_exception; }
 
     const String& data() const { return m_data; }
@@ -119,6 +124,10 @@ struct Cell : public Weakable<Cell> {
     void copy_from(const Cell&);
 
 private:
+    // Our JS values are only reachable through the sheet's global object, which the GC has to know about
+    // whenever we store a new one.
+    void did_store_js_value();
+
     bool m_dirty { false };
     bool m_evaluated_externally { false };
     String m_data;
@@ -519,6 +519,10 @@ bool Emulator::find_malloc_symbols(const MmapRegion& libc_text)
     auto realloc_symbol = image.find_demangled_function("realloc");
     auto calloc_symbol = image.find_demangled_function("calloc");
     auto malloc_size_symbol = image.find_demangled_function("malloc_size");
+    // These write freelist links into chunks that we already consider freed: the thread cache hands
+    // chunks back to their blocks long after the free() call they came from.
+    auto flush_thread_cache_symbol = image.find_demangled_function("__malloc_flush_thread_cache");
+    auto free_chunk_symbol = image.find_demangled_function("free_chunk");
     if (!malloc_symbol.has_value() || !free_symbol.has_value() || !realloc_symbol.has_value() || !malloc_size_symbol.has_value())
         return false;
 
@@ -532,6 +536,15 @@ bool Emulator::find_malloc_symbols(const MmapRegion& libc_text)
     m_calloc_symbol_end = m_calloc_symbol_start + calloc_symbol.value().size();
     m_malloc_size_symbol_start = malloc_size_symbol.value().value() + libc_text.base();
     m_malloc_size_symbol_end = m_malloc_size_symbol_start + malloc_size_symbol.value().size();
+    if (flush_thread_cache_symbol.has_value()) {
+        m_flush_thread_cache_symbol_start = flush_thread_cache_symbol.value().value() + libc_text.base();
+        m_flush_thread_cache_symbol_end = m_flush_thread_cache_symbol_start + flush_thread_cache_symbol.value().size();
+    }
+    // free_chunk() is static, so it may well have been inlined into its callers.
+    if (free_chunk_symbol.has_value()) {
+        m_free_chunk_symbol_start = free_chunk_symbol.value().value() + libc_text.base();
+        m_free_chunk_symbol_end = m_free_chunk_symbol_start + free_chunk_symbol.value().size();
+    }
     return true;
 }
 
@@ -155,6 +155,9 @@ private:
     int virt$getsockname(FlatPtr);
     int virt$getpeername(FlatPtr);
     int virt$select(FlatPtr);
+    int virt$epoll_create1(int);
+    int virt$epoll_ctl(FlatPtr);
+    int virt$epoll_wait(FlatPtr);
     int virt$get_stack_bounds(FlatPtr, FlatPtr);
     int virt$accept(int sockfd, FlatPtr address, FlatPtr address_length);
     int virt$bind(int sockfd, FlatPtr address, socklen_t address_length);
@@ -209,6 +212,10 @@ private:
     FlatPtr m_free_symbol_end { 0 };
     FlatPtr m_malloc_size_symbol_start { 0 };
     FlatPtr m_malloc_size_symbol_end { 0 };
+    FlatPtr m_flush_thread_cache_symbol_start { 0 };
+    FlatPtr m_flush_thread_cache_symbol_end { 0 };
+    FlatPtr m_free_chunk_symbol_start { 0 };
+    FlatPtr m_free_chunk_symbol_end { 0 };
 
     FlatPtr m_libc_start { 0 };
     FlatPtr m_libc_end { 0 };
@@ -257,7 +264,9 @@ ALWAYS_INLINE bool Emulator::is_in_malloc_or_free() const
         || (m_cpu.base_eip() >= m_free_symbol_start && m_cpu.base_eip() < m_free_symbol_end)
         || (m_cpu.base_eip() >= m_realloc_symbol_start && m_cpu.base_eip() < m_realloc_symbol_end)
         || (m_cpu.base_eip() >= m_calloc_symbol_start && m_cpu.base_eip() < m_calloc_symbol_end)
-        || (m_cpu.base_eip() >= m_malloc_size_symbol_start && m_cpu.base_eip() < m_malloc_size_symbol_end);
+        || (m_cpu.base_eip() >= m_malloc_size_symbol_start && m_cpu.base_eip() < m_malloc_size_symbol_end)
+        || (m_cpu.base_eip() >= m_flush_thread_cache_symbol_start && m_cpu.base_eip() < m_flush_thread_cache_symbol_end)
+        || (m_cpu.base_eip() >= m_free_chunk_symbol_start && m_cpu.base_eip() < m_free_chunk_symbol_end);
 }
 
 ALWAYS_INLINE bool Emulator::is_in_loader_code() const
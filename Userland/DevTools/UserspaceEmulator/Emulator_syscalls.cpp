@@ -32,6 +32,7 @@
 #include <sched.h>
 #include <serenity.h>
 #include <strings.h>
+#include <sys/epoll.h>
 #include <sys/ioctl.h>
 #include <sys/mman.h>
 #include <sys/select.h>
@@ -206,6 +207,12 @@ u32 Emulator::virt_syscall(u32 function, u32 arg1, u32 arg2, u32 arg3)
         return virt$listen(arg1, arg2);
     case SC_select:
         return virt$select(arg1);
+    case SC_epoll_create1:
+        return virt$epoll_create1(arg1);
+    case SC_epoll_ctl:
+        return virt$epoll_ctl(arg1);
+    case SC_epoll_wait:
+        return virt$epoll_wait(arg1);
     case SC_recvmsg:
         return virt$recvmsg(arg1, arg2, arg3);
     case SC_sendmsg:
@@ -691,6 +698,49 @@ int Emulator::virt$select(FlatPtr params_addr)
     return rc;
 }
 
+int Emulator::virt$epoll_create1(int flags)
+{
+    return syscall(SC_epoll_create1, flags);
+}
+
+int Emulator::virt$epoll_ctl(FlatPtr params_addr)
+{
+    Syscall::SC_epoll_ctl_params params;
+    mmu().copy_from_vm(&params, params_addr, sizeof(params));
+
+    epoll_event event {};
+    if (params.event)
+        mmu().copy_from_vm(&event, (FlatPtr)params.event, sizeof(event));
+
+    Syscall::SC_epoll_ctl_params host_params { params.epfd, params.op, params.fd, params.event ? &event : nullptr };
+    return syscall(SC_epoll_ctl, &host_params);
+}
+
+int Emulator::virt$epoll_wait(FlatPtr params_addr)
+{
+    Syscall::SC_epoll_wait_params params;
+    mmu().copy_from_vm(&params, params_addr, sizeof(params));
+
+    if (params.maxevents <= 0)
+        return -EINVAL;
+
+    struct timespec timeout;
+    u32 sigmask;
+    if (params.timeout)
+        mmu().copy_from_vm(&timeout, (FlatPtr)params.timeout, sizeof(timeout));
+    if (params.sigmask)
+        mmu().copy_from_vm(&sigmask, (FlatPtr)params.sigmask, sizeof(sigmask));
+
+    Vector<epoll_event> events;
+    events.resize(params.maxevents);
+
+    Syscall::SC_epoll_wait_params host_params { params.epfd, events.data(), params.maxevents, params.timeout ? &timeout : nullptr, params.sigmask ? &sigmask : nullptr };
+    int rc = syscall(SC_epoll_wait, &host_params);
+    if (rc > 0)
+        mmu().copy_to_vm((FlatPtr)params.events, events.data(), rc * sizeof(epoll_event));
+    return rc;
+}
+
 int Emulator::virt$getsockopt(FlatPtr params_addr)
 {
     Syscall::SC_getsockopt_params params;
@@ -38,11 +38,14 @@ void __pthread_fork_atfork_register_parent(void (*)(void));
 void __pthread_fork_atfork_register_child(void (*)(void));
 
 int __pthread_mutex_lock(void*);
+int __pthread_mutex_trylock(void*);
 int __pthread_mutex_unlock(void*);
 int __pthread_mutex_init(void*, const void*);
 
 int __pthread_self();
 
+void __malloc_flush_thread_cache(void);
+
 #define __PTHREAD_MUTEX_NORMAL 0
 #define __PTHREAD_MUTEX_RECURSIVE 1
 #define __PTHREAD_MUTEX_INITIALIZER     \
@@ -31,6 +31,7 @@
 #include <LibELF/AuxiliaryVector.h>
 #include <LibThread/Lock.h>
 #include <assert.h>
+#include <bits/pthread_integration.h>
 #include <mallocdefs.h>
 #include <serenity.h>
 #include <stdio.h>
@@ -55,6 +56,18 @@ static LibThread::Lock& malloc_lock()
 constexpr size_t number_of_chunked_blocks_to_keep_around_per_size_class = 4;
 constexpr size_t number_of_big_blocks_to_keep_around_per_size_class = 8;
 
+// Small chunks are cached per thread, so that most malloc() and free() calls don't take the
+// malloc lock. A thread moves chunks between its cache and the shared allocators in batches.
+constexpr size_t max_thread_cached_chunk_size = 1016;
+constexpr size_t number_of_chunks_to_cache_per_size_class = 32;
+constexpr size_t number_of_chunks_to_move_per_batch = number_of_chunks_to_cache_per_size_class / 2;
+constexpr size_t number_of_thread_cached_size_classes = [] {
+    size_t count = 0;
+    while (size_classes[count] && size_classes[count] <= max_thread_cached_chunk_size)
+        ++count;
+    return count;
+}();
+
 static bool s_log_malloc = false;
 static bool s_scrub_malloc = true;
 static bool s_scrub_free = true;
@@ -99,9 +112,40 @@ struct MallocStats {
     size_t number_of_freed_full_blocks;
     size_t number_of_keeps;
     size_t number_of_frees;
+
+    size_t number_of_thread_cache_hits;
+    size_t number_of_thread_cache_misses;
+    size_t number_of_thread_cache_flushes;
 };
 static MallocStats g_malloc_stats = {};
 
+struct ThreadCache {
+    struct SizeClass {
+        size_t count;
+        void* chunks[number_of_chunks_to_cache_per_size_class];
+    };
+    SizeClass size_classes[number_of_thread_cached_size_classes];
+};
+
+// These are counted here so that the fast paths don't write to shared memory,
+// and are added to g_malloc_stats whenever this thread takes the malloc lock.
+struct ThreadCacheStats {
+    size_t number_of_malloc_calls;
+    size_t number_of_free_calls;
+    size_t number_of_hits;
+    size_t number_of_misses;
+    size_t number_of_flushes;
+};
+
+#ifdef NO_TLS
+// The dynamic loader mallocs before the TLS is set up, and must not have a TLS segment of its own,
+// so it goes without a thread cache and always takes the locked path.
+static ThreadCacheStats t_cache_stats;
+#else
+static __thread ThreadCache t_cache;
+static __thread ThreadCacheStats t_cache_stats;
+#endif
+
 struct Allocator {
     size_t size { 0 };
     size_t block_count { 0 };
@@ -146,6 +190,27 @@ static Allocator* allocator_for_size(size_t size, size_t& good_size)
     return nullptr;
 }
 
+static ThreadCache::SizeClass* thread_cache_for([[maybe_unused]] const Allocator& allocator)
+{
+#ifdef NO_TLS
+    return nullptr;
+#else
+    size_t index = &allocator - allocators();
+    if (index >= number_of_thread_cached_size_classes)
+        return nullptr;
+    return &t_cache.size_classes[index];
+#endif
+}
+
+static void add_thread_cache_stats()
+{
+    g_malloc_stats.number_of_malloc_calls += exchange(t_cache_stats.number_of_malloc_calls, 0);
+    g_malloc_stats.number_of_free_calls += exchange(t_cache_stats.number_of_free_calls, 0);
+    g_malloc_stats.number_of_thread_cache_hits += exchange(t_cache_stats.number_of_hits, 0);
+    g_malloc_stats.number_of_thread_cache_misses += exchange(t_cache_stats.number_of_misses, 0);
+    g_malloc_stats.number_of_thread_cache_flushes += exchange(t_cache_stats.number_of_flushes, 0);
+}
+
 #ifdef RECYCLE_BIG_ALLOCATIONS
 static BigAllocator* big_allocator_for_size(size_t size)
 {
@@ -175,22 +240,76 @@ enum class CallerWillInitializeMemory {
     Yes,
 };
 
-static void* malloc_impl(size_t size, CallerWillInitializeMemory caller_will_initialize_memory)
+static void* allocate_chunk(Allocator& allocator, size_t good_size)
 {
-    LOCKER(malloc_lock());
+    ChunkedBlock* block = nullptr;
+
+    for (block = allocator.usable_blocks.head(); block; block = block->next()) {
+        if (block->free_chunks())
+            break;
+    }
+
+    if (!block && allocator.empty_block_count) {
+        g_malloc_stats.number_of_empty_block_hits++;
+        block = allocator.empty_blocks[--allocator.empty_block_count];
+        int rc = madvise(block, ChunkedBlock::block_size, MADV_SET_NONVOLATILE);
+        bool this_block_was_purged = rc == 1;
+        if (rc < 0) {
+            perror("madvise");
+            VERIFY_NOT_REACHED();
+        }
+        rc = mprotect(block, ChunkedBlock::block_size, PROT_READ | PROT_WRITE);
+        if (rc < 0) {
+            perror("mprotect");
+            VERIFY_NOT_REACHED();
+        }
+        if (this_block_was_purged) {
+            g_malloc_stats.number_of_empty_block_purge_hits++;
+            new (block) ChunkedBlock(good_size);
+        }
+        allocator.usable_blocks.append(block);
+    }
+
+    if (!block) {
+        g_malloc_stats.number_of_block_allocs++;
+        char buffer[64];
+        snprintf(buffer, sizeof(buffer), "malloc: ChunkedBlock(%zu)", good_size);
+        block = (ChunkedBlock*)os_alloc(ChunkedBlock::block_size, buffer);
+        new (block) ChunkedBlock(good_size);
+        allocator.usable_blocks.append(block);
+        ++allocator.block_count;
+    }
 
+    --block->m_free_chunks;
+    void* ptr = block->m_freelist;
+    VERIFY(ptr);
+    block->m_freelist = block->m_freelist->next;
+    if (block->is_full()) {
+        g_malloc_stats.number_of_blocks_full++;
+        dbgln_if(MALLOC_DEBUG, "Block {:p} is now full in size class {}", block, good_size);
+        allocator.usable_blocks.remove(block);
+        allocator.full_blocks.append(block);
+    }
+    dbgln_if(MALLOC_DEBUG, "LibC: allocated {:p} (chunk in block {:p}, size {})", ptr, block, block->bytes_per_chunk());
+    return ptr;
+}
+
+static void* malloc_impl(size_t size, CallerWillInitializeMemory caller_will_initialize_memory)
+{
     if (s_log_malloc)
         dbgln("LibC: malloc({})", size);
 
     if (!size)
         return nullptr;
 
-    g_malloc_stats.number_of_malloc_calls++;
+    t_cache_stats.number_of_malloc_calls++;
 
     size_t good_size;
     auto* allocator = allocator_for_size(size, good_size);
 
     if (!allocator) {
+        LOCKER(malloc_lock());
+        add_thread_cache_stats();
         size_t real_size = round_up_to_power_of_two(sizeof(BigAllocationBlock) + size, ChunkedBlock::block_size);
 #ifdef RECYCLE_BIG_ALLOCATIONS
         if (auto* allocator = big_allocator_for_size(real_size)) {
@@ -224,61 +343,68 @@ static void* malloc_impl(size_t size, CallerWillInitializeMemory caller_will_ini
         return &block->m_slot[0];
     }
 
-    ChunkedBlock* block = nullptr;
-
-    for (block = allocator->usable_blocks.head(); block; block = block->next()) {
-        if (block->free_chunks())
-            break;
-    }
-
-    if (!block && allocator->empty_block_count) {
-        g_malloc_stats.number_of_empty_block_hits++;
-        block = allocator->empty_blocks[--allocator->empty_block_count];
-        int rc = madvise(block, ChunkedBlock::block_size, MADV_SET_NONVOLATILE);
-        bool this_block_was_purged = rc == 1;
-        if (rc < 0) {
-            perror("madvise");
-            VERIFY_NOT_REACHED();
+    void* ptr = nullptr;
+    if (auto* cache = thread_cache_for(*allocator)) {
+        if (cache->count) {
+            t_cache_stats.number_of_hits++;
+        } else {
+            t_cache_stats.number_of_misses++;
+            LOCKER(malloc_lock());
+            add_thread_cache_stats();
+            while (cache->count < number_of_chunks_to_move_per_batch)
+                cache->chunks[cache->count++] = allocate_chunk(*allocator, good_size);
         }
-        rc = mprotect(block, ChunkedBlock::block_size, PROT_READ | PROT_WRITE);
-        if (rc < 0) {
-            perror("mprotect");
-            VERIFY_NOT_REACHED();
-        }
-        if (this_block_was_purged) {
-            g_malloc_stats.number_of_empty_block_purge_hits++;
-            new (block) ChunkedBlock(good_size);
-        }
-        allocator->usable_blocks.append(block);
+        ptr = cache->chunks[--cache->count];
+    } else {
+        LOCKER(malloc_lock());
+        add_thread_cache_stats();
+        ptr = allocate_chunk(*allocator, good_size);
     }
 
-    if (!block) {
-        g_malloc_stats.number_of_block_allocs++;
-        char buffer[64];
-        snprintf(buffer, sizeof(buffer), "malloc: ChunkedBlock(%zu)", good_size);
-        block = (ChunkedBlock*)os_alloc(ChunkedBlock::block_size, buffer);
-        new (block) ChunkedBlock(good_size);
-        allocator->usable_blocks.append(block);
-        ++allocator->block_count;
-    }
+    if (s_scrub_malloc && caller_will_initialize_memory == CallerWillInitializeMemory::No)
+        memset(ptr, MALLOC_SCRUB_BYTE, good_size);
+
+    ue_notify_malloc(ptr, size);
+    return ptr;
+}
+
+static void free_chunk(void* ptr)
+{
+    auto* block = (ChunkedBlock*)((FlatPtr)ptr & ChunkedBlock::block_mask);
+
+    auto* entry = (FreelistEntry*)ptr;
+    entry->next = block->m_freelist;
+    block->m_freelist = entry;
 
-    --block->m_free_chunks;
-    void* ptr = block->m_freelist;
-    VERIFY(ptr);
-    block->m_freelist = block->m_freelist->next;
     if (block->is_full()) {
-        g_malloc_stats.number_of_blocks_full++;
-        dbgln_if(MALLOC_DEBUG, "Block {:p} is now full in size class {}", block, good_size);
-        allocator->usable_blocks.remove(block);
-        allocator->full_blocks.append(block);
+        size_t good_size;
+        auto* allocator = allocator_for_size(block->m_size, good_size);
+        dbgln_if(MALLOC_DEBUG, "Block {:p} no longer full in size class {}", block, good_size);
+        g_malloc_stats.number_of_freed_full_blocks++;
+        allocator->full_blocks.remove(block);
+        allocator->usable_blocks.prepend(block);
     }
-    dbgln_if(MALLOC_DEBUG, "LibC: allocated {:p} (chunk in block {:p}, size {})", ptr, block, block->bytes_per_chunk());
 
-    if (s_scrub_malloc && caller_will_initialize_memory == CallerWillInitializeMemory::No)
-        memset(ptr, MALLOC_SCRUB_BYTE, block->m_size);
+    ++block->m_free_chunks;
 
-    ue_notify_malloc(ptr, size);
-    return ptr;
+    if (!block->used_chunks()) {
+        size_t good_size;
+        auto* allocator = allocator_for_size(block->m_size, good_size);
+        if (allocator->block_count < number_of_chunked_blocks_to_keep_around_per_size_class) {
+            dbgln_if(MALLOC_DEBUG, "Keeping block {:p} around for size class {}", block, good_size);
+            g_malloc_stats.number_of_keeps++;
+            allocator->usable_blocks.remove(block);
+            allocator->empty_blocks[allocator->empty_block_count++] = block;
+            mprotect(block, ChunkedBlock::block_size, PROT_NONE);
+            madvise(block, ChunkedBlock::block_size, MADV_SET_VOLATILE);
+            return;
+        }
+        dbgln_if(MALLOC_DEBUG, "Releasing block {:p} for size class {}", block, good_size);
+        g_malloc_stats.number_of_frees++;
+        allocator->usable_blocks.remove(block);
+        --allocator->block_count;
+        os_free(block, ChunkedBlock::block_size);
+    }
 }
 
 static void free_impl(void* ptr)
@@ -288,14 +414,14 @@ static void free_impl(void* ptr)
     if (!ptr)
         return;
 
-    g_malloc_stats.number_of_free_calls++;
-
-    LOCKER(malloc_lock());
+    t_cache_stats.number_of_free_calls++;
 
     void* block_base = (void*)((FlatPtr)ptr & ChunkedBlock::ChunkedBlock::block_mask);
     size_t magic = *(size_t*)block_base;
 
     if (magic == MAGIC_BIGALLOC_HEADER) {
+        LOCKER(malloc_lock());
+        add_thread_cache_stats();
         auto* block = (BigAllocationBlock*)block_base;
 #ifdef RECYCLE_BIG_ALLOCATIONS
         if (auto* allocator = big_allocator_for_size(block->m_size)) {
@@ -328,39 +454,39 @@ static void free_impl(void* ptr)
     if (s_scrub_free)
         memset(ptr, FREE_SCRUB_BYTE, block->bytes_per_chunk());
 
-    auto* entry = (FreelistEntry*)ptr;
-    entry->next = block->m_freelist;
-    block->m_freelist = entry;
-
-    if (block->is_full()) {
-        size_t good_size;
-        auto* allocator = allocator_for_size(block->m_size, good_size);
-        dbgln_if(MALLOC_DEBUG, "Block {:p} no longer full in size class {}", block, good_size);
-        g_malloc_stats.number_of_freed_full_blocks++;
-        allocator->full_blocks.remove(block);
-        allocator->usable_blocks.prepend(block);
+    size_t good_size;
+    auto* allocator = allocator_for_size(block->m_size, good_size);
+    if (auto* cache = thread_cache_for(*allocator)) {
+        if (cache->count == number_of_chunks_to_cache_per_size_class) {
+            // Give the oldest chunks back and keep the recently freed ones, which are more likely to be in the CPU cache.
+            t_cache_stats.number_of_flushes++;
+            LOCKER(malloc_lock());
+            add_thread_cache_stats();
+            for (size_t i = 0; i < number_of_chunks_to_move_per_batch; ++i)
+                free_chunk(cache->chunks[i]);
+            cache->count -= number_of_chunks_to_move_per_batch;
+            memmove(&cache->chunks[0], &cache->chunks[number_of_chunks_to_move_per_batch], cache->count * sizeof(void*));
+        }
+        cache->chunks[cache->count++] = ptr;
+        return;
     }
 
-    ++block->m_free_chunks;
+    LOCKER(malloc_lock());
+    add_thread_cache_stats();
+    free_chunk(ptr);
+}
 
-    if (!block->used_chunks()) {
-        size_t good_size;
-        auto* allocator = allocator_for_size(block->m_size, good_size);
-        if (allocator->block_count < number_of_chunked_blocks_to_keep_around_per_size_class) {
-            dbgln_if(MALLOC_DEBUG, "Keeping block {:p} around for size class {}", block, good_size);
-            g_malloc_stats.number_of_keeps++;
-            allocator->usable_blocks.remove(block);
-            allocator->empty_blocks[allocator->empty_block_count++] = block;
-            mprotect(block, ChunkedBlock::block_size, PROT_NONE);
-            madvise(block, ChunkedBlock::block_size, MADV_SET_VOLATILE);
-            return;
-        }
-        dbgln_if(MALLOC_DEBUG, "Releasing block {:p} for size class {}", block, good_size);
-        g_malloc_stats.number_of_frees++;
-        allocator->usable_blocks.remove(block);
-        --allocator->block_count;
-        os_free(block, ChunkedBlock::block_size);
+void __malloc_flush_thread_cache()
+{
+    LOCKER(malloc_lock());
+    add_thread_cache_stats();
+#ifndef NO_TLS
+    for (auto& cache : t_cache.size_classes) {
+        for (size_t i = 0; i < cache.count; ++i)
+            free_chunk(cache.chunks[i]);
+        cache.count = 0;
     }
+#endif
 }
 
 [[gnu::flatten]] void* malloc(size_t size)
@@ -456,6 +582,9 @@ void __malloc_init()
 
 void serenity_dump_malloc_stats()
 {
+    LOCKER(malloc_lock());
+    add_thread_cache_stats();
+
     dbgln("# malloc() calls: {}", g_malloc_stats.number_of_malloc_calls);
     dbgln();
     dbgln("big alloc hits: {}", g_malloc_stats.number_of_big_allocator_hits);
@@ -475,5 +604,11 @@ void serenity_dump_malloc_stats()
     dbgln("full block frees: {}", g_malloc_stats.number_of_freed_full_blocks);
     dbgln("number of keeps: {}", g_malloc_stats.number_of_keeps);
     dbgln("number of frees: {}", g_malloc_stats.number_of_frees);
+    dbgln();
+    size_t thread_cache_lookups = g_malloc_stats.number_of_thread_cache_hits + g_malloc_stats.number_of_thread_cache_misses;
+    dbgln("thread cache hits: {}", g_malloc_stats.number_of_thread_cache_hits);
+    dbgln("thread cache misses: {}", g_malloc_stats.number_of_thread_cache_misses);
+    dbgln("thread cache hit rate: {}%", thread_cache_lookups ? g_malloc_stats.number_of_thread_cache_hits * 100 / thread_cache_lookups : 0);
+    dbgln("thread cache flushes: {}", g_malloc_stats.number_of_thread_cache_flushes);
 }
 }
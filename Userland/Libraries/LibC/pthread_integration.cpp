@@ -29,7 +29,8 @@
 #include <AK/Types.h>
 #include <AK/Vector.h>
 #include <bits/pthread_integration.h>
-#include <sched.h>
+#include <errno.h>
+#include <serenity.h>
 #include <sys/types.h>
 #include <unistd.h>
 
@@ -42,6 +43,46 @@ static NeverDestroyed<Vector<void (*)(void), 4>> g_atfork_prepare_list;
 static NeverDestroyed<Vector<void (*)(void), 4>> g_atfork_child_list;
 static NeverDestroyed<Vector<void (*)(void), 4>> g_atfork_parent_list;
 
+// The lock word of a mutex moves between these three states. Unlocking only has to
+// enter the kernel when somebody might be sleeping on the futex.
+enum MutexState : u32 {
+    Unlocked = 0,
+    Locked = 1,
+    LockedWithWaiters = 2,
+};
+
+// How often we check the lock word before going to sleep. Critical sections are
+// usually short, so the owner may well be gone before a futex round trip would be.
+static constexpr int mutex_spin_count = 100;
+
+static bool try_acquire_mutex(Atomic<u32>& state)
+{
+    u32 expected = MutexState::Unlocked;
+    return state.compare_exchange_strong(expected, MutexState::Locked, AK::memory_order_acquire);
+}
+
+static void acquire_mutex_slow(Atomic<u32>& state)
+{
+    for (int i = 0; i < mutex_spin_count; ++i) {
+        if (state.load(AK::memory_order_relaxed) == MutexState::Unlocked && try_acquire_mutex(state))
+            return;
+#if ARCH(I386) || ARCH(X86_64)
+        __builtin_ia32_pause();
+#endif
+    }
+
+    // From here on we can't tell whether anybody else is waiting, so we have to
+    // assume so and leave the lock marked as contended when we get it.
+    while (state.exchange(MutexState::LockedWithWaiters, AK::memory_order_acquire) != MutexState::Unlocked)
+        futex(reinterpret_cast<u32*>(&state), FUTEX_WAIT | FUTEX_PRIVATE_FLAG, MutexState::LockedWithWaiters, nullptr, nullptr, 0);
+}
+
+static void release_mutex(Atomic<u32>& state)
+{
+    if (state.exchange(MutexState::Unlocked, AK::memory_order_release) == MutexState::LockedWithWaiters)
+        futex(reinterpret_cast<u32*>(&state), FUTEX_WAKE | FUTEX_PRIVATE_FLAG, 1, nullptr, nullptr, 0);
+}
+
 }
 
 extern "C" {
@@ -115,20 +156,33 @@ int __pthread_mutex_lock(void* mutexp)
     auto* mutex = reinterpret_cast<pthread_mutex_t*>(mutexp);
     auto& atomic = reinterpret_cast<Atomic<u32>&>(mutex->lock);
     pthread_t this_thread = __pthread_self();
-    for (;;) {
-        u32 expected = false;
-        if (!atomic.compare_exchange_strong(expected, true, AK::memory_order_acq_rel)) {
-            if (mutex->type == __PTHREAD_MUTEX_RECURSIVE && mutex->owner == this_thread) {
-                mutex->level++;
-                return 0;
-            }
-            sched_yield();
-            continue;
+    if (!try_acquire_mutex(atomic)) {
+        if (mutex->type == __PTHREAD_MUTEX_RECURSIVE && mutex->owner == this_thread) {
+            mutex->level++;
+            return 0;
         }
-        mutex->owner = this_thread;
-        mutex->level = 0;
-        return 0;
+        acquire_mutex_slow(atomic);
     }
+    mutex->owner = this_thread;
+    mutex->level = 0;
+    return 0;
+}
+
+int __pthread_mutex_trylock(void* mutexp)
+{
+    auto* mutex = reinterpret_cast<pthread_mutex_t*>(mutexp);
+    auto& atomic = reinterpret_cast<Atomic<u32>&>(mutex->lock);
+    pthread_t this_thread = __pthread_self();
+    if (!try_acquire_mutex(atomic)) {
+        if (mutex->type == __PTHREAD_MUTEX_RECURSIVE && mutex->owner == this_thread) {
+            mutex->level++;
+            return 0;
+        }
+        return EBUSY;
+    }
+    mutex->owner = this_thread;
+    mutex->level = 0;
+    return 0;
 }
 
 int __pthread_mutex_unlock(void* mutexp)
@@ -139,7 +193,7 @@ int __pthread_mutex_unlock(void* mutexp)
         return 0;
     }
     mutex->owner = 0;
-    mutex->lock = 0;
+    release_mutex(reinterpret_cast<Atomic<u32>&>(mutex->lock));
     return 0;
 }
 
@@ -79,15 +79,14 @@ Optional<CanonicalCode> CanonicalCode::from_bytes(ReadonlyBytes bytes)
         }
     }
     if (non_zero_symbols == 1) { // special case - only 1 symbol
-        code.m_symbol_codes.append(0b10);
-        code.m_symbol_values.append(last_non_zero);
         code.m_bit_codes[last_non_zero] = 0;
         code.m_bit_code_lengths[last_non_zero] = 1;
+        code.build_decode_tables();
         return code;
     }
 
     auto next_code = 0;
-    for (size_t code_length = 1; code_length <= 15; ++code_length) {
+    for (size_t code_length = 1; code_length <= max_code_length; ++code_length) {
         next_code <<= 1;
         auto start_bit = 1 << code_length;
 
@@ -98,8 +97,6 @@ Optional<CanonicalCode> CanonicalCode::from_bytes(ReadonlyBytes bytes)
             if (next_code > start_bit)
                 return {};
 
-            code.m_symbol_codes.append(start_bit | next_code);
-            code.m_symbol_values.append(symbol);
             code.m_bit_codes[symbol] = fast_reverse16(start_bit | next_code, code_length); // DEFLATE writes huffman encoded symbols as lsb-first
             code.m_bit_code_lengths[symbol] = code_length;
 
@@ -107,30 +104,76 @@ Optional<CanonicalCode> CanonicalCode::from_bytes(ReadonlyBytes bytes)
         }
     }
 
-    if (next_code != (1 << 15)) {
+    if (next_code != (1 << max_code_length)) {
         return {};
     }
 
+    code.build_decode_tables();
     return code;
 }
 
-u32 CanonicalCode::read_symbol(InputBitStream& stream) const
+void CanonicalCode::build_decode_tables()
 {
-    u32 code_bits = 1;
-
-    for (;;) {
-        code_bits = code_bits << 1 | stream.read_bits(1);
-        if (code_bits >= (1 << 16))
-            return UINT32_MAX; // the maximum symbol in deflate is 288, so we use UINT32_MAX (an impossible value) to indicate an error
-
-        // FIXME: This is very inefficient and could greatly be improved by implementing this
-        //        algorithm: https://www.hanshq.net/zip.html#huffdec
-        size_t index;
-        if (binary_search(m_symbol_codes.span(), code_bits, &index))
-            return m_symbol_values[index];
+    // Since the codes are stored lsb-first, the first primary_table_bits bits of a code are its low bits. Every
+    // code that fits into the primary table occupies all the entries that share those low bits, longer codes are
+    // grouped by their primary_table_bits prefix into a secondary table that is indexed by the remaining bits.
+    constexpr u16 primary_mask = (1 << primary_table_bits) - 1;
+
+    Array<u8, 1 << primary_table_bits> secondary_bits {};
+    for (size_t symbol = 0; symbol < m_bit_code_lengths.size(); ++symbol) {
+        const auto length = m_bit_code_lengths[symbol];
+        if (length <= primary_table_bits)
+            continue;
+        auto& bits = secondary_bits[m_bit_codes[symbol] & primary_mask];
+        bits = max<u8>(bits, length - primary_table_bits);
+    }
+
+    for (size_t prefix = 0; prefix < secondary_bits.size(); ++prefix) {
+        if (secondary_bits[prefix] == 0)
+            continue;
+        m_primary_table[prefix] = { static_cast<u16>(m_secondary_table.size()), secondary_bits[prefix], true };
+        m_secondary_table.resize(m_secondary_table.size() + (1 << secondary_bits[prefix]));
+    }
+
+    for (size_t symbol = 0; symbol < m_bit_code_lengths.size(); ++symbol) {
+        const auto length = m_bit_code_lengths[symbol];
+        const auto code = m_bit_codes[symbol];
+        const DecodeEntry entry { static_cast<u16>(symbol), static_cast<u8>(length), false };
+
+        if (length == 0)
+            continue;
+
+        if (length <= primary_table_bits) {
+            for (size_t index = code; index < m_primary_table.size(); index += 1 << length)
+                m_primary_table[index] = entry;
+            continue;
+        }
+
+        const auto& link = m_primary_table[code & primary_mask];
+        const auto remaining_length = length - primary_table_bits;
+        for (size_t index = code >> primary_table_bits; index < (1u << link.length); index += 1 << remaining_length)
+            m_secondary_table[link.value + index] = entry;
     }
 }
 
+u32 CanonicalCode::read_symbol(InputBitStream& stream) const
+{
+    const auto bits = stream.peek_bits(max_code_length);
+
+    auto entry = m_primary_table[bits & ((1 << primary_table_bits) - 1)];
+    if (entry.is_link)
+        entry = m_secondary_table[entry.value + ((bits >> primary_table_bits) & ((1 << entry.length) - 1))];
+
+    if (entry.length == 0)
+        return UINT32_MAX; // the maximum symbol in deflate is 288, so we use UINT32_MAX (an impossible value) to indicate an error
+
+    stream.discard_previously_peeked_bits(entry.length);
+    if (stream.has_any_error())
+        return UINT32_MAX;
+
+    return entry.value;
+}
+
 void CanonicalCode::write_symbol(OutputBitStream& stream, u32 symbol) const
 {
     stream.write_bits(m_bit_codes[symbol], m_bit_code_lengths[symbol]);
@@ -175,14 +218,10 @@ bool DeflateDecompressor::CompressedBlock::try_read_more()
         }
         const auto distance = m_decompressor.decode_distance(distance_symbol);
 
-        for (size_t idx = 0; idx < length; ++idx) {
-            u8 byte = 0;
-            m_decompressor.m_output_stream.read({ &byte, sizeof(byte) }, distance);
-            if (m_decompressor.m_output_stream.handle_any_error()) {
-                m_decompressor.set_fatal_error();
-                return false; // a back reference was requested that was too far back (outside our current sliding window)
-            }
-            m_decompressor.m_output_stream << byte;
+        m_decompressor.m_output_stream.copy_from_seekback(distance, length);
+        if (m_decompressor.m_output_stream.handle_any_error()) {
+            m_decompressor.set_fatal_error();
+            return false; // a back reference was requested that was too far back (outside our current sliding window)
         }
 
         return true;
@@ -48,9 +48,20 @@ public:
     static Optional<CanonicalCode> from_bytes(ReadonlyBytes);
 
 private:
-    // Decompression - indexed by code
-    Vector<u16> m_symbol_codes;
-    Vector<u16> m_symbol_values;
+    void build_decode_tables();
+
+    static constexpr size_t max_code_length = 15;
+    static constexpr size_t primary_table_bits = 9;
+
+    // Decompression - each table entry is either a symbol (value = symbol, length = code length) or, for codes
+    // longer than primary_table_bits, a link into the secondary table (value = offset, length = sub-table bits).
+    struct DecodeEntry {
+        u16 value { 0 };
+        u8 length { 0 };
+        bool is_link { false };
+    };
+    Array<DecodeEntry, 1 << primary_table_bits> m_primary_table {};
+    Vector<DecodeEntry> m_secondary_table;
 
     // Compression - indexed by symbol
     Array<u16, 288> m_bit_codes {}; // deflate uses a maximum of 288 symbols (maximum of 32 for distances)
@@ -106,6 +117,9 @@ public:
 
     static Optional<ByteBuffer> decompress_all(ReadonlyBytes);
 
+    // Once the final block was read, this provides the (byte aligned) input that follows the deflate stream.
+    InputStream& trailing_input() { return m_input_stream; }
+
 private:
     u32 decode_length(u32);
     u32 decode_distance(u32);
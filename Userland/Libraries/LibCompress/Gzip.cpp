@@ -89,7 +89,7 @@ size_t GzipDecompressor::read(Bytes bytes)
 
             if (nread < slice.size()) {
                 LittleEndian<u32> crc32, input_size;
-                m_input_stream >> crc32 >> input_size;
+                current_member().m_stream.trailing_input() >> crc32 >> input_size;
 
                 if (crc32 != current_member().m_checksum.digest()) {
                     // FIXME: Somehow the checksum is incorrect?
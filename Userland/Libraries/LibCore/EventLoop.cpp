@@ -55,6 +55,10 @@
 #include <time.h>
 #include <unistd.h>
 
+#ifdef __serenity__
+#    include <sys/epoll.h>
+#endif
+
 namespace Core {
 
 class RPCClient;
@@ -80,6 +84,20 @@ static Vector<EventLoop*>* s_event_loop_stack;
 static NeverDestroyed<IDAllocator> s_id_allocator;
 static HashMap<int, NonnullOwnPtr<EventLoopTimer>>* s_timers;
 static HashTable<Notifier*>* s_notifiers;
+
+#ifdef __serenity__
+// The kernel keeps our notifier fds in a persistent epoll interest set.
+// Only fds whose notifiers changed since the last wait are synced, so
+// idle fds cost nothing per event loop iteration.
+struct EventPollState {
+    int fd { -1 };
+    HashMap<int, Vector<Notifier*, 1>> notifiers_by_fd;
+    HashTable<int> dirty_fds;
+};
+static EventPollState* s_event_poll;
+static constexpr size_t max_events_per_wait = 256;
+#endif
+
 int EventLoop::s_wake_pipe_fds[2];
 static RefPtr<LocalServer> s_rpc_server;
 HashMap<int, RefPtr<RPCClient>> s_rpc_clients;
@@ -283,6 +301,9 @@ EventLoop::EventLoop()
         s_event_loop_stack = new Vector<EventLoop*>;
         s_timers = new HashMap<int, NonnullOwnPtr<EventLoopTimer>>;
         s_notifiers = new HashTable<Notifier*>;
+#ifdef __serenity__
+        s_event_poll = new EventPollState;
+#endif
     }
 
     if (!s_main_event_loop) {
@@ -600,6 +621,14 @@ void EventLoop::notify_forked(ForkEvent event)
         s_event_loop_stack->clear();
         s_timers->clear();
         s_notifiers->clear();
+#ifdef __serenity__
+        // The interest set is shared with the parent, so we need our own.
+        if (s_event_poll->fd >= 0)
+            close(s_event_poll->fd);
+        s_event_poll->fd = -1;
+        s_event_poll->notifiers_by_fd.clear();
+        s_event_poll->dirty_fds.clear();
+#endif
         if (auto* info = signals_info<false>()) {
             info->signal_handlers.clear();
             info->next_signal_id = 0;
@@ -615,8 +644,62 @@ void EventLoop::notify_forked(ForkEvent event)
     VERIFY_NOT_REACHED();
 }
 
+#ifdef __serenity__
+static void update_event_poll_interest(int wake_fd)
+{
+    auto& state = *s_event_poll;
+    if (state.fd < 0) {
+        state.fd = epoll_create1(EPOLL_CLOEXEC);
+        if (state.fd < 0) {
+            perror("epoll_create1");
+            VERIFY_NOT_REACHED();
+        }
+        state.dirty_fds.set(wake_fd);
+        for (auto& it : state.notifiers_by_fd)
+            state.dirty_fds.set(it.key);
+    }
+
+    for (int fd : state.dirty_fds) {
+        u32 events = 0;
+        if (fd == wake_fd)
+            events |= EPOLLIN;
+        if (auto it = state.notifiers_by_fd.find(fd); it != state.notifiers_by_fd.end()) {
+            for (auto* notifier : it->value) {
+                if (notifier->event_mask() & Notifier::Read)
+                    events |= EPOLLIN;
+                if (notifier->event_mask() & Notifier::Write)
+                    events |= EPOLLOUT;
+                if (notifier->event_mask() & Notifier::Exceptional)
+                    VERIFY_NOT_REACHED();
+            }
+        }
+
+        if (!events) {
+            // The fd may already be closed or may never have been added, neither of which matters here.
+            (void)epoll_ctl(state.fd, EPOLL_CTL_DEL, fd, nullptr);
+            continue;
+        }
+
+        epoll_event event {};
+        event.events = events;
+        event.data.fd = fd;
+        int rc = epoll_ctl(state.fd, EPOLL_CTL_ADD, fd, &event);
+        if (rc < 0 && errno == EEXIST)
+            rc = epoll_ctl(state.fd, EPOLL_CTL_MOD, fd, &event);
+        if (rc < 0)
+            dbgln("Core::EventLoop: Failed to watch fd {}: {}", fd, strerror(errno));
+    }
+    state.dirty_fds.clear();
+}
+#endif
+
 void EventLoop::wait_for_event(WaitMode mode)
 {
+#ifdef __serenity__
+    epoll_event events[max_events_per_wait];
+retry:
+    update_event_poll_interest(s_wake_pipe_fds[0]);
+#else
     fd_set rfds;
     fd_set wfds;
 retry:
@@ -641,6 +724,7 @@ retry:
         if (notifier->event_mask() & Notifier::Exceptional)
             VERIFY_NOT_REACHED();
     }
+#endif
 
     bool queued_events_is_empty;
     {
@@ -669,7 +753,13 @@ retry:
     }
 
 try_select_again:
+#ifdef __serenity__
+    // Round up so we don't wake up just before a timer is due and spin.
+    int timeout_ms = should_wait_forever ? -1 : timeout.tv_sec * 1000 + (timeout.tv_usec + 999) / 1000;
+    int marked_fd_count = epoll_wait(s_event_poll->fd, events, max_events_per_wait, timeout_ms);
+#else
     int marked_fd_count = select(max_fd + 1, &rfds, &wfds, nullptr, should_wait_forever ? nullptr : &timeout);
+#endif
     if (marked_fd_count < 0) {
         int saved_errno = errno;
         if (saved_errno == EINTR) {
@@ -683,7 +773,17 @@ try_select_again:
         // Blow up, similar to Core::safe_syscall.
         VERIFY_NOT_REACHED();
     }
-    if (FD_ISSET(s_wake_pipe_fds[0], &rfds)) {
+
+#ifdef __serenity__
+    bool wake_pipe_is_readable = false;
+    for (int i = 0; i < marked_fd_count; ++i) {
+        if (events[i].data.fd == s_wake_pipe_fds[0])
+            wake_pipe_is_readable = true;
+    }
+#else
+    bool wake_pipe_is_readable = FD_ISSET(s_wake_pipe_fds[0], &rfds);
+#endif
+    if (wake_pipe_is_readable) {
         int wake_events[8];
         auto nread = read(s_wake_pipe_fds[0], wake_events, sizeof(wake_events));
         if (nread < 0) {
@@ -736,6 +836,20 @@ try_select_again:
     if (!marked_fd_count)
         return;
 
+#ifdef __serenity__
+    for (int i = 0; i < marked_fd_count; ++i) {
+        int fd = events[i].data.fd;
+        auto it = s_event_poll->notifiers_by_fd.find(fd);
+        if (it == s_event_poll->notifiers_by_fd.end())
+            continue;
+        for (auto* notifier : it->value) {
+            if ((events[i].events & EPOLLIN) && (notifier->event_mask() & Notifier::Event::Read))
+                post_event(*notifier, make<NotifierReadEvent>(fd));
+            if ((events[i].events & EPOLLOUT) && (notifier->event_mask() & Notifier::Event::Write))
+                post_event(*notifier, make<NotifierWriteEvent>(fd));
+        }
+    }
+#else
     for (auto& notifier : *s_notifiers) {
         if (FD_ISSET(notifier->fd(), &rfds)) {
             if (notifier->event_mask() & Notifier::Event::Read)
@@ -746,6 +860,7 @@ try_select_again:
                 post_event(*notifier, make<NotifierWriteEvent>(notifier->fd()));
         }
     }
+#endif
 }
 
 bool EventLoopTimer::has_expired(const timeval& now) const
@@ -809,11 +924,36 @@ bool EventLoop::unregister_timer(int timer_id)
 void EventLoop::register_notifier(Badge<Notifier>, Notifier& notifier)
 {
     s_notifiers->set(&notifier);
+#ifdef __serenity__
+    auto& notifiers = s_event_poll->notifiers_by_fd.ensure(notifier.fd());
+    if (!notifiers.contains_slow(&notifier))
+        notifiers.append(&notifier);
+    s_event_poll->dirty_fds.set(notifier.fd());
+#endif
 }
 
 void EventLoop::unregister_notifier(Badge<Notifier>, Notifier& notifier)
 {
     s_notifiers->remove(&notifier);
+#ifdef __serenity__
+    auto it = s_event_poll->notifiers_by_fd.find(notifier.fd());
+    if (it == s_event_poll->notifiers_by_fd.end())
+        return;
+    it->value.remove_first_matching([&](auto* entry) { return entry == &notifier; });
+    if (it->value.is_empty())
+        s_event_poll->notifiers_by_fd.remove(it);
+    s_event_poll->dirty_fds.set(notifier.fd());
+#endif
+}
+
+void EventLoop::update_notifier(Badge<Notifier>, Notifier& notifier)
+{
+#ifdef __serenity__
+    if (s_notifiers->contains(&notifier))
+        s_event_poll->dirty_fds.set(notifier.fd());
+#else
+    (void)notifier;
+#endif
 }
 
 void EventLoop::wake()
@@ -53,53 +53,46 @@ const char* IODevice::error_string() const
 }
 
 int IODevice::read(u8* buffer, int length)
-{
-    auto read_buffer = read(length);
-    if (read_buffer.is_null())
-        return 0;
-    memcpy(buffer, read_buffer.data(), length);
-    return read_buffer.size();
-}
-
-ByteBuffer IODevice::read(size_t max_size)
 {
     if (m_fd < 0)
-        return {};
-    if (!max_size)
-        return {};
-    auto buffer = ByteBuffer::create_uninitialized(max_size);
-    auto* buffer_ptr = (char*)buffer.data();
-    size_t remaining_buffer_space = buffer.size();
+        return 0;
+    if (length <= 0)
+        return 0;
+    size_t remaining_buffer_space = length;
     size_t taken_from_buffered = 0;
     if (!m_buffered_data.is_empty()) {
         taken_from_buffered = min(remaining_buffer_space, m_buffered_data.size());
-        memcpy(buffer_ptr, m_buffered_data.data(), taken_from_buffered);
+        memcpy(buffer, m_buffered_data.data(), taken_from_buffered);
         Vector<u8> new_buffered_data;
         new_buffered_data.append(m_buffered_data.data() + taken_from_buffered, m_buffered_data.size() - taken_from_buffered);
         m_buffered_data = move(new_buffered_data);
         remaining_buffer_space -= taken_from_buffered;
-        buffer_ptr += taken_from_buffered;
+        buffer += taken_from_buffered;
     }
     if (!remaining_buffer_space)
-        return buffer;
-    int nread = ::read(m_fd, buffer_ptr, remaining_buffer_space);
+        return taken_from_buffered;
+    int nread = ::read(m_fd, buffer, remaining_buffer_space);
     if (nread < 0) {
-        if (taken_from_buffered) {
-            buffer.trim(taken_from_buffered);
-            return buffer;
-        }
-        set_error(errno);
-        return {};
+        if (!taken_from_buffered)
+            set_error(errno);
+        return taken_from_buffered;
     }
-    if (nread == 0) {
+    if (nread == 0)
         set_eof(true);
-        if (taken_from_buffered) {
-            buffer.trim(taken_from_buffered);
-            return buffer;
-        }
+    return taken_from_buffered + nread;
+}
+
+ByteBuffer IODevice::read(size_t max_size)
+{
+    if (m_fd < 0)
         return {};
-    }
-    buffer.trim(taken_from_buffered + nread);
+    if (!max_size)
+        return {};
+    auto buffer = ByteBuffer::create_uninitialized(max_size);
+    auto nread = read(buffer.data(), max_size);
+    if (nread == 0)
+        return {};
+    buffer.trim(nread);
     return buffer;
 }
 
@@ -24,13 +24,21 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <AK/Atomic.h>
 #include <AK/Debug.h>
 #include <AK/MemoryStream.h>
+#include <AK/Platform.h>
 #include <AK/Types.h>
 #include <AK/Vector.h>
 #include <LibCrypto/Authentication/GHash.h>
 #include <LibCrypto/BigInt/UnsignedBigInteger.h>
 
+#if ARCH(I386) || ARCH(X86_64)
+#    include <cpuid.h>
+#    include <tmmintrin.h>
+#    include <wmmintrin.h>
+#endif
+
 namespace {
 
 static u32 to_u32(const u8* b)
@@ -46,6 +54,114 @@ static void to_u8s(u8* b, const u32* w)
     }
 }
 
+static void galois_multiply_blocks(u32 (&tag)[4], const u32 (&key)[4], const u8* data, size_t block_count)
+{
+    for (size_t i = 0; i < block_count; ++i, data += 16) {
+        for (auto j = 0; j < 4; ++j)
+            tag[j] ^= to_u32(data + j * 4);
+        Crypto::Authentication::galois_multiply(tag, key, tag);
+    }
+}
+
+#if ARCH(I386) || ARCH(X86_64)
+
+static bool cpu_supports_pclmul()
+{
+    // Threads racing to fill in the cache all come up with the same answer, so relaxed ordering is enough.
+    static Atomic<int> s_supported { -1 };
+    int supported = s_supported.load(AK::memory_order_relaxed);
+    if (supported < 0) {
+        unsigned int eax, ebx, ecx, edx;
+        supported = __get_cpuid(1, &eax, &ebx, &ecx, &edx) && (ecx & bit_PCLMUL) && (ecx & bit_SSSE3);
+        s_supported.store(supported, AK::memory_order_relaxed);
+    }
+    return supported;
+}
+
+// GHASH is defined on bit-reflected field elements, reversing the bytes of each block makes the
+// reflection line up with the bit order PCLMULQDQ works in (the remaining off-by-one is the shift in reduce()).
+[[gnu::target("pclmul,ssse3")]] ALWAYS_INLINE static __m128i load_reversed(const u8* pointer)
+{
+    auto reverse = _mm_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+    return _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pointer)), reverse);
+}
+
+[[gnu::target("pclmul,ssse3")]] ALWAYS_INLINE static void store_reversed(u8* pointer, __m128i value)
+{
+    auto reverse = _mm_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(pointer), _mm_shuffle_epi8(value, reverse));
+}
+
+// The unreduced 256-bit carry-less product of a and b, accumulated into low and high.
+[[gnu::target("pclmul,ssse3")]] ALWAYS_INLINE static void multiply_accumulate(__m128i a, __m128i b, __m128i& low, __m128i& high)
+{
+    auto middle = _mm_xor_si128(_mm_clmulepi64_si128(a, b, 0x10), _mm_clmulepi64_si128(a, b, 0x01));
+    low = _mm_xor_si128(low, _mm_xor_si128(_mm_clmulepi64_si128(a, b, 0x00), _mm_slli_si128(middle, 8)));
+    high = _mm_xor_si128(high, _mm_xor_si128(_mm_clmulepi64_si128(a, b, 0x11), _mm_srli_si128(middle, 8)));
+}
+
+// Shifts the product left by one to undo the reflection, then reduces it modulo x^128 + x^7 + x^2 + x + 1.
+// This is the reduction from "Intel Carry-Less Multiplication Instruction and its Usage for Computing the GCM Mode"
+// by Gueron and Kounavis. Both steps are linear, so a sum of several products can be reduced at once.
+[[gnu::target("pclmul,ssse3")]] ALWAYS_INLINE static __m128i reduce(__m128i low, __m128i high)
+{
+    auto low_carry = _mm_srli_epi32(low, 31);
+    auto high_carry = _mm_srli_epi32(high, 31);
+    low = _mm_or_si128(_mm_slli_epi32(low, 1), _mm_slli_si128(low_carry, 4));
+    high = _mm_or_si128(_mm_or_si128(_mm_slli_epi32(high, 1), _mm_slli_si128(high_carry, 4)), _mm_srli_si128(low_carry, 12));
+
+    auto a = _mm_xor_si128(_mm_xor_si128(_mm_slli_epi32(low, 31), _mm_slli_epi32(low, 30)), _mm_slli_epi32(low, 25));
+    auto b = _mm_srli_si128(a, 4);
+    low = _mm_xor_si128(low, _mm_slli_si128(a, 12));
+
+    auto c = _mm_xor_si128(_mm_xor_si128(_mm_srli_epi32(low, 1), _mm_srli_epi32(low, 2)), _mm_srli_epi32(low, 7));
+    c = _mm_xor_si128(c, b);
+    return _mm_xor_si128(high, _mm_xor_si128(low, c));
+}
+
+[[gnu::target("pclmul,ssse3")]] ALWAYS_INLINE static __m128i multiply(__m128i a, __m128i b)
+{
+    auto low = _mm_setzero_si128();
+    auto high = _mm_setzero_si128();
+    multiply_accumulate(a, b, low, high);
+    return reduce(low, high);
+}
+
+// Hashes four blocks per reduction by multiplying them with H^4, H^3, H^2 and H respectively,
+// which also lets the multiplications overlap instead of waiting on each other.
+[[gnu::target("pclmul,ssse3")]] static void galois_multiply_blocks_pclmul(u32 (&tag)[4], const u32 (&key)[4], const u8* data, size_t block_count)
+{
+    u8 bytes[16];
+    to_u8s(bytes, key);
+    auto h1 = load_reversed(bytes);
+    to_u8s(bytes, tag);
+    auto y = load_reversed(bytes);
+
+    if (block_count >= 4) {
+        auto h2 = multiply(h1, h1);
+        auto h3 = multiply(h2, h1);
+        auto h4 = multiply(h3, h1);
+        for (; block_count >= 4; block_count -= 4, data += 64) {
+            auto low = _mm_setzero_si128();
+            auto high = _mm_setzero_si128();
+            multiply_accumulate(_mm_xor_si128(y, load_reversed(data)), h4, low, high);
+            multiply_accumulate(load_reversed(data + 16), h3, low, high);
+            multiply_accumulate(load_reversed(data + 32), h2, low, high);
+            multiply_accumulate(load_reversed(data + 48), h1, low, high);
+            y = reduce(low, high);
+        }
+    }
+
+    for (; block_count > 0; --block_count, data += 16)
+        y = multiply(_mm_xor_si128(y, load_reversed(data)), h1);
+
+    store_reversed(bytes, y);
+    for (auto i = 0; i < 4; ++i)
+        tag[i] = to_u32(bytes + i * 4);
+}
+
+#endif
+
 }
 
 namespace Crypto {
@@ -55,28 +171,33 @@ GHash::TagType GHash::process(ReadonlyBytes aad, ReadonlyBytes cipher)
 {
     u32 tag[4] { 0, 0, 0, 0 };
 
-    auto transform_one = [&](auto& buf) {
-        size_t i = 0;
-        for (; i < buf.size(); i += 16) {
-            if (i + 16 <= buf.size()) {
-                for (auto j = 0; j < 4; ++j) {
-                    tag[j] ^= to_u32(buf.offset(i + j * 4));
-                }
-                galois_multiply(tag, m_key, tag);
-            }
+#if ARCH(I386) || ARCH(X86_64)
+    auto use_pclmul = cpu_supports_pclmul();
+#endif
+
+    auto multiply_blocks = [&](const u8* data, size_t block_count) {
+#if ARCH(I386) || ARCH(X86_64)
+        if (use_pclmul) {
+            galois_multiply_blocks_pclmul(tag, m_key, data, block_count);
+            return;
         }
+#endif
+        galois_multiply_blocks(tag, m_key, data, block_count);
+    };
 
-        if (i > buf.size()) {
-            static u8 buffer[16];
+    auto transform_one = [&](auto& buf) {
+        auto block_count = buf.size() / 16;
+        multiply_blocks(buf.data(), block_count);
+
+        auto tail_offset = block_count * 16;
+        if (tail_offset < buf.size()) {
+            u8 buffer[16];
             Bytes buffer_bytes { buffer, 16 };
             OutputMemoryStream stream { buffer_bytes };
-            stream.write(buf.slice(i - 16));
+            stream.write(buf.slice(tail_offset));
             stream.fill_to_end(0);
 
-            for (auto j = 0; j < 4; ++j) {
-                tag[j] ^= to_u32(buffer_bytes.offset(j * 4));
-            }
-            galois_multiply(tag, m_key, tag);
+            multiply_blocks(buffer, 1);
         }
     };
 
@@ -95,15 +216,13 @@ GHash::TagType GHash::process(ReadonlyBytes aad, ReadonlyBytes cipher)
         dbgln("Tag bits: {} : {} : {} : {}", tag[0], tag[1], tag[2], tag[3]);
     }
 
-    tag[0] ^= high(aad_bits);
-    tag[1] ^= low(aad_bits);
-    tag[2] ^= high(cipher_bits);
-    tag[3] ^= low(cipher_bits);
+    u32 lengths[4] { high(aad_bits), low(aad_bits), high(cipher_bits), low(cipher_bits) };
+    u8 length_block[16];
+    to_u8s(length_block, lengths);
+    multiply_blocks(length_block, 1);
 
     dbgln_if(GHASH_PROCESS_DEBUG, "Tag bits: {} : {} : {} : {}", tag[0], tag[1], tag[2], tag[3]);
 
-    galois_multiply(tag, m_key, tag);
-
     TagType digest;
     to_u8s(digest.data, tag);
 
@@ -112,6 +231,7 @@ GHash::TagType GHash::process(ReadonlyBytes aad, ReadonlyBytes cipher)
 
 /// Galois Field multiplication using <x^127 + x^7 + x^2 + x + 1>.
 /// Note that x, y, and z are strictly BE.
+/// This doesn't branch or index memory on the operands, so the time it takes doesn't leak the key.
 void galois_multiply(u32 (&z)[4], const u32 (&_x)[4], const u32 (&_y)[4])
 {
     u32 x[4] { _x[0], _x[1], _x[2], _x[3] };
@@ -119,12 +239,12 @@ void galois_multiply(u32 (&z)[4], const u32 (&_x)[4], const u32 (&_y)[4])
     __builtin_memset(z, 0, sizeof(z));
 
     for (ssize_t i = 127; i > -1; --i) {
-        if ((y[3 - (i / 32)] >> (i % 32)) & 1) {
-            z[0] ^= x[0];
-            z[1] ^= x[1];
-            z[2] ^= x[2];
-            z[3] ^= x[3];
-        }
+        u32 mask = -((y[3 - (i / 32)] >> (i % 32)) & 1);
+        z[0] ^= x[0] & mask;
+        z[1] ^= x[1] & mask;
+        z[2] ^= x[2] & mask;
+        z[3] ^= x[3] & mask;
+
         auto a0 = x[0] & 1;
         x[0] >>= 1;
         auto a1 = x[1] & 1;
@@ -137,8 +257,7 @@ void galois_multiply(u32 (&z)[4], const u32 (&_x)[4], const u32 (&_y)[4])
         x[3] >>= 1;
         x[3] |= a2 << 31;
 
-        if (a3)
-            x[0] ^= 0xe1000000;
+        x[0] ^= 0xe1000000 & -a3;
     }
 }
 
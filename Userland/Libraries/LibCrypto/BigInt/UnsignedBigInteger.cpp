@@ -587,40 +587,188 @@ FLATTEN void UnsignedBigInteger::shift_left_without_allocation(
     }
 }
 
+// Below this many words, the schoolbook method's lower overhead beats Karatsuba's fewer
+// word multiplications.
+static constexpr size_t KARATSUBA_THRESHOLD = 32;
+
+// output[0 .. length) += input[0 .. length), returns the carry out of the top word.
+static u32 add_words_in_place(u32* output, const u32* input, size_t length)
+{
+    u64 carry = 0;
+    for (size_t i = 0; i < length; ++i) {
+        u64 sum = (u64)output[i] + input[i] + carry;
+        output[i] = (u32)sum;
+        carry = sum >> 32;
+    }
+    return (u32)carry;
+}
+
+// output[0 .. length) -= input[0 .. length), returns the borrow out of the top word.
+static u32 subtract_words_in_place(u32* output, const u32* input, size_t length)
+{
+    u32 borrow = 0;
+    for (size_t i = 0; i < length; ++i) {
+        u64 difference = (u64)output[i] - input[i] - borrow;
+        output[i] = (u32)difference;
+        borrow = (difference >> 32) ? 1 : 0;
+    }
+    return borrow;
+}
+
+// Adds a single word to output[0 .. length), returns the carry out of the top word.
+static u32 add_word_in_place(u32* output, size_t length, u32 word)
+{
+    for (size_t i = 0; i < length && word; ++i) {
+        output[i] += word;
+        word = output[i] < word ? 1 : 0;
+    }
+    return word;
+}
+
+// Subtracts a single word from output[0 .. length), returns the borrow out of the top word.
+static u32 subtract_word_in_place(u32* output, size_t length, u32 word)
+{
+    for (size_t i = 0; i < length && word; ++i) {
+        u32 previous = output[i];
+        output[i] -= word;
+        word = previous < word ? 1 : 0;
+    }
+    return word;
+}
+
+// output[0 .. left_length + right_length) = left * right
+static void schoolbook_multiply_words(u32* output, const u32* left, size_t left_length, const u32* right, size_t right_length)
+{
+    __builtin_memset(output, 0, (left_length + right_length) * sizeof(u32));
+    for (size_t i = 0; i < left_length; ++i) {
+        u64 left_word = left[i];
+        if (left_word == 0)
+            continue;
+        u64 carry = 0;
+        for (size_t j = 0; j < right_length; ++j) {
+            // (2^32 - 1)^2 + 2 * (2^32 - 1) is exactly 2^64 - 1, so this can't overflow.
+            u64 product = left_word * right[j] + output[i + j] + carry;
+            output[i + j] = (u32)product;
+            carry = product >> 32;
+        }
+        output[i + right_length] = (u32)carry;
+    }
+}
+
+static size_t karatsuba_scratch_size(size_t length)
+{
+    if (length < KARATSUBA_THRESHOLD)
+        return 0;
+    size_t high_length = length - length / 2;
+    return 4 * high_length + 2 + karatsuba_scratch_size(high_length);
+}
+
 /**
- * Complexity: O(N^2) where N is the number of words in the larger number
+ * Complexity: O(N^1.585) where N is the number of words in each operand
+ * Method:
+ * Split both operands in a low and a high half, x = x1 * B + x0, and use that
+ * x * y = x1y1 * B^2 + ((x0 + x1)(y0 + y1) - x1y1 - x0y0) * B + x0y0
+ * to get away with three half-sized multiplications instead of four.
+ */
+static void karatsuba_multiply_words(u32* output, const u32* left, const u32* right, size_t length, u32* scratch)
+{
+    if (length < KARATSUBA_THRESHOLD) {
+        schoolbook_multiply_words(output, left, length, right, length);
+        return;
+    }
+
+    size_t low_length = length / 2;
+    size_t high_length = length - low_length;
+
+    // The two outer products go straight to where they belong in the output.
+    karatsuba_multiply_words(output, left, right, low_length, scratch);
+    karatsuba_multiply_words(output + 2 * low_length, left + low_length, right + low_length, high_length, scratch);
+
+    u32* left_sum = scratch;
+    u32* right_sum = left_sum + high_length;
+    u32* middle = right_sum + high_length;
+    size_t middle_length = 2 * high_length + 2;
+    u32* next_scratch = middle + middle_length;
+
+    __builtin_memcpy(left_sum, left + low_length, high_length * sizeof(u32));
+    __builtin_memcpy(right_sum, right + low_length, high_length * sizeof(u32));
+    u32 left_carry = add_words_in_place(left_sum, left, low_length);
+    left_carry = add_word_in_place(left_sum + low_length, high_length - low_length, left_carry);
+    u32 right_carry = add_words_in_place(right_sum, right, low_length);
+    right_carry = add_word_in_place(right_sum + low_length, high_length - low_length, right_carry);
+
+    karatsuba_multiply_words(middle, left_sum, right_sum, high_length, next_scratch);
+    middle[2 * high_length] = 0;
+    middle[2 * high_length + 1] = 0;
+    // Account for the bits that carried out of the sums.
+    if (left_carry)
+        add_word_in_place(middle + 2 * high_length, 2, add_words_in_place(middle + high_length, right_sum, high_length));
+    if (right_carry)
+        add_word_in_place(middle + 2 * high_length, 2, add_words_in_place(middle + high_length, left_sum, high_length));
+    if (left_carry && right_carry)
+        add_word_in_place(middle + 2 * high_length, 2, 1);
+
+    auto borrow = subtract_words_in_place(middle, output, 2 * low_length);
+    subtract_word_in_place(middle + 2 * low_length, middle_length - 2 * low_length, borrow);
+    borrow = subtract_words_in_place(middle, output + 2 * low_length, 2 * high_length);
+    subtract_word_in_place(middle + 2 * high_length, 2, borrow);
+
+    add_words_in_place(output + low_length, middle, middle_length);
+}
+
+/**
+ * Complexity: O(N^2) where N is the number of words in the larger number,
+ *             O(N^1.585) when both numbers are at least KARATSUBA_THRESHOLD words long
  * Multiplication method:
- * An integer is equal to the sum of the powers of two
- * according to the indexes of its 'on' bits.
- * So to multiple x*y, we go over each '1' bit in x (say the i'th bit),
- * and add y<<i to the result.
+ * Small numbers are multiplied word by word the way one would by hand. For large ones,
+ * the longer number is cut into chunks the length of the shorter one, and each chunk
+ * is multiplied with Karatsuba's method.
  */
 FLATTEN void UnsignedBigInteger::multiply_without_allocation(
     const UnsignedBigInteger& left,
     const UnsignedBigInteger& right,
     UnsignedBigInteger& temp_shift_result,
     UnsignedBigInteger& temp_shift_plus,
-    UnsignedBigInteger& temp_shift,
+    [[maybe_unused]] UnsignedBigInteger& temp_shift,
     UnsignedBigInteger& temp_plus,
     UnsignedBigInteger& output)
 {
-    output.set_to_0();
-
-    // iterate all bits
-    for (size_t word_index = 0; word_index < left.length(); ++word_index) {
-        for (size_t bit_index = 0; bit_index < UnsignedBigInteger::BITS_IN_WORD; ++bit_index) {
-            // If the bit is off - skip over it
-            if (!(left.m_words[word_index] & (1 << bit_index)))
-                continue;
+    const UnsignedBigInteger* longer = &left;
+    const UnsignedBigInteger* shorter = &right;
+    if (longer->trimmed_length() < shorter->trimmed_length())
+        swap(longer, shorter);
+    auto longer_length = longer->trimmed_length();
+    auto shorter_length = shorter->trimmed_length();
 
-            const size_t shift_amount = word_index * UnsignedBigInteger::BITS_IN_WORD + bit_index;
+    output.set_to_0();
+    if (shorter_length == 0)
+        return;
+    output.m_words.resize_and_keep_capacity(longer_length + shorter_length);
 
-            // output += (right << shift_amount);
-            shift_left_without_allocation(right, shift_amount, temp_shift_result, temp_shift_plus, temp_shift);
-            add_without_allocation(output, temp_shift, temp_plus);
-            output.set_to(temp_plus);
+    if (shorter_length < KARATSUBA_THRESHOLD) {
+        schoolbook_multiply_words(output.m_words.data(), longer->m_words.data(), longer_length, shorter->m_words.data(), shorter_length);
+    } else {
+        __builtin_memset(output.m_words.data(), 0, output.m_words.size() * sizeof(u32));
+        // Each chunk of the longer number is zero-padded to the length of the shorter one.
+        temp_shift_result.m_words.resize_and_keep_capacity(shorter_length);
+        temp_shift_plus.m_words.resize_and_keep_capacity(2 * shorter_length);
+        temp_plus.m_words.resize_and_keep_capacity(karatsuba_scratch_size(shorter_length));
+        auto* chunk = temp_shift_result.m_words.data();
+        auto* chunk_product = temp_shift_plus.m_words.data();
+        for (size_t offset = 0; offset < longer_length; offset += shorter_length) {
+            auto chunk_length = min(shorter_length, longer_length - offset);
+            __builtin_memcpy(chunk, longer->m_words.data() + offset, chunk_length * sizeof(u32));
+            __builtin_memset(chunk + chunk_length, 0, (shorter_length - chunk_length) * sizeof(u32));
+            karatsuba_multiply_words(chunk_product, chunk, shorter->m_words.data(), shorter_length, temp_plus.m_words.data());
+            // The full product fits in the output, so the words of this chunk's product that
+            // would land past its end are zero, and so is the carry.
+            auto words_to_add = min(2 * shorter_length, output.m_words.size() - offset);
+            add_words_in_place(output.m_words.data() + offset, chunk_product, words_to_add);
         }
     }
+
+    output.m_words.resize_and_keep_capacity(output.trimmed_length());
+    output.m_cached_trimmed_length = {};
 }
 
 /**
@@ -694,6 +842,67 @@ FLATTEN void UnsignedBigInteger::divide_u16_without_allocation(
     remainder.set_to(remainder_word);
 }
 
+/**
+ * Returns -modulus^-1 mod 2^32, which is what each step of the reduction multiplies by.
+ */
+u32 UnsignedBigInteger::montgomery_factor(const UnsignedBigInteger& modulus)
+{
+    u32 lowest_word = modulus.m_words[0];
+    VERIFY(lowest_word & 1);
+    // Every odd number is its own inverse modulo 8, and each Newton iteration doubles the
+    // number of correct bits: 3, 6, 12, 24, 48.
+    u32 inverse = lowest_word;
+    for (size_t i = 0; i < 4; ++i)
+        inverse *= 2 - lowest_word * inverse;
+    return -inverse;
+}
+
+/**
+ * Complexity: O(N^2) where N is the number of words in the modulus
+ * Reduction method:
+ * For each of the N low words of the value, add the multiple of the modulus that turns that
+ * word into zero. The value then ends in N zero words, which are dropped to divide by R.
+ * What's left is less than twice the modulus, so a single subtraction finishes the job.
+ */
+FLATTEN void UnsignedBigInteger::montgomery_reduce_without_allocation(
+    const UnsignedBigInteger& value,
+    const UnsignedBigInteger& modulus,
+    u32 montgomery_factor,
+    UnsignedBigInteger& output)
+{
+    auto modulus_length = modulus.trimmed_length();
+    auto value_length = value.trimmed_length();
+    VERIFY(value_length <= 2 * modulus_length);
+
+    output.set_to_0();
+    output.m_words.resize_and_keep_capacity(2 * modulus_length + 1);
+    auto* words = output.m_words.data();
+    __builtin_memcpy(words, value.m_words.data(), value_length * sizeof(u32));
+    __builtin_memset(words + value_length, 0, (2 * modulus_length + 1 - value_length) * sizeof(u32));
+
+    const auto* modulus_words = modulus.m_words.data();
+    for (size_t i = 0; i < modulus_length; ++i) {
+        u64 factor = (u32)(words[i] * montgomery_factor);
+        u64 carry = 0;
+        for (size_t j = 0; j < modulus_length; ++j) {
+            u64 product = factor * modulus_words[j] + words[i + j] + carry;
+            words[i + j] = (u32)product;
+            carry = product >> 32;
+        }
+        add_word_in_place(words + i + modulus_length, modulus_length + 1 - i, (u32)carry);
+    }
+
+    __builtin_memmove(words, words + modulus_length, (modulus_length + 1) * sizeof(u32));
+    output.m_words.resize_and_keep_capacity(modulus_length + 1);
+    if (words[modulus_length] != 0 || !(output < modulus)) {
+        auto borrow = subtract_words_in_place(words, modulus_words, modulus_length);
+        words[modulus_length] -= borrow;
+        VERIFY(words[modulus_length] == 0);
+    }
+    output.m_words.resize_and_keep_capacity(modulus_length);
+    output.m_cached_trimmed_length = {};
+}
+
 ALWAYS_INLINE void UnsignedBigInteger::shift_left_by_n_words(
     const UnsignedBigInteger& number,
     const size_t number_of_words,
@@ -104,6 +104,12 @@ public:
     static void divide_without_allocation(const UnsignedBigInteger& numerator, const UnsignedBigInteger& denominator, UnsignedBigInteger& temp_shift_result, UnsignedBigInteger& temp_shift_plus, UnsignedBigInteger& temp_shift, UnsignedBigInteger& temp_minus, UnsignedBigInteger& quotient, UnsignedBigInteger& remainder);
     static void divide_u16_without_allocation(const UnsignedBigInteger& numerator, u32 denominator, UnsignedBigInteger& quotient, UnsignedBigInteger& remainder);
 
+    // Montgomery reduction, with R = 2^(32 * modulus.trimmed_length()) for an odd modulus:
+    // output = value / R mod modulus, for any value < modulus * R.
+    // The factor is what montgomery_factor() returns for the same modulus.
+    static u32 montgomery_factor(const UnsignedBigInteger& modulus);
+    static void montgomery_reduce_without_allocation(const UnsignedBigInteger& value, const UnsignedBigInteger& modulus, u32 montgomery_factor, UnsignedBigInteger& output);
+
     bool operator==(const UnsignedBigInteger& other) const;
     bool operator!=(const UnsignedBigInteger& other) const;
     bool operator<(const UnsignedBigInteger& other) const;
@@ -24,17 +24,68 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <AK/SIMD.h>
 #include <AK/Span.h>
 #include <AK/Types.h>
 #include <LibCrypto/Checksum/Adler32.h>
 
 namespace Crypto::Checksum {
 
+using namespace AK::SIMD;
+
+static constexpr u32 modulus = 65521;
+
+// The largest amount of bytes (rounded down to whole 16 byte chunks) that can be summed up before state_b
+// could overflow 32 bits, so the (expensive) modulo only has to be applied once per block.
+static constexpr size_t block_size = 5552;
+
+ALWAYS_INLINE static u32x4 load_u32x4(const u8* data)
+{
+    u8x4 bytes;
+    __builtin_memcpy(&bytes, data, sizeof(bytes));
+    return __builtin_convertvector(bytes, u32x4);
+}
+
+ALWAYS_INLINE static u32 horizontal_sum(u32x4 vector)
+{
+    return vector[0] + vector[1] + vector[2] + vector[3];
+}
+
 void Adler32::update(ReadonlyBytes data)
 {
-    for (size_t i = 0; i < data.size(); i++) {
-        m_state_a = (m_state_a + data.at(i)) % 65521;
-        m_state_b = (m_state_b + m_state_a) % 65521;
+    auto* pointer = data.data();
+    auto size = data.size();
+
+    while (size >= 16) {
+        auto chunk_count = min(size, block_size) / 16;
+        size -= chunk_count * 16;
+
+        // Each byte is added to state_a once, and to state_b once for every byte following it (including itself).
+        // Per chunk of 16 bytes that means state_b grows by 16 * state_a (as of the start of the chunk), plus the
+        // bytes of the chunk weighted by their distance to its end. The former is accumulated in prefix_sums.
+        u32x4 sums {};
+        u32x4 prefix_sums {};
+        u32x4 weighted_sums {};
+        u32 state_b = m_state_b + m_state_a * chunk_count * 16;
+
+        for (size_t chunk = 0; chunk < chunk_count; ++chunk, pointer += 16) {
+            auto first = load_u32x4(pointer);
+            auto second = load_u32x4(pointer + 4);
+            auto third = load_u32x4(pointer + 8);
+            auto fourth = load_u32x4(pointer + 12);
+
+            prefix_sums += sums;
+            sums += first + second + third + fourth;
+            weighted_sums += first * u32x4 { 16, 15, 14, 13 } + second * u32x4 { 12, 11, 10, 9 } + third * u32x4 { 8, 7, 6, 5 } + fourth * u32x4 { 4, 3, 2, 1 };
+        }
+
+        m_state_a = (m_state_a + horizontal_sum(sums)) % modulus;
+        m_state_b = (state_b + 16 * horizontal_sum(prefix_sums) + horizontal_sum(weighted_sums)) % modulus;
+    }
+
+    for (size_t i = 0; i < size; i++) {
+        m_state_a = (m_state_a + pointer[i]) % modulus;
+        m_state_b = (m_state_b + m_state_a) % modulus;
     }
 };
 
@@ -24,17 +24,167 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <AK/Platform.h>
 #include <AK/Span.h>
 #include <AK/Types.h>
 #include <LibCrypto/Checksum/CRC32.h>
 
+#if ARCH(I386) || ARCH(X86_64)
+#    include <cpuid.h>
+#    include <smmintrin.h>
+#    include <wmmintrin.h>
+#endif
+
 namespace Crypto::Checksum {
 
+// Table k maps a byte to the CRC of that byte followed by k zero bytes, which lets us process eight bytes per iteration.
+struct Table {
+    u32 data[8][256];
+
+    constexpr Table()
+        : data()
+    {
+        for (auto i = 0; i < 256; i++) {
+            u32 value = i;
+
+            for (auto j = 0; j < 8; j++) {
+                if (value & 1) {
+                    value = 0xEDB88320 ^ (value >> 1);
+                } else {
+                    value = value >> 1;
+                }
+            }
+
+            data[0][i] = value;
+        }
+
+        for (auto k = 1; k < 8; k++) {
+            for (auto i = 0; i < 256; i++)
+                data[k][i] = (data[k - 1][i] >> 8) ^ data[0][data[k - 1][i] & 0xFF];
+        }
+    }
+};
+
+constexpr static auto table = Table();
+
+static u32 update_byte_by_byte(u32 state, const u8* data, size_t size)
+{
+    for (size_t i = 0; i < size; i++)
+        state = table.data[0][(state ^ data[i]) & 0xFF] ^ (state >> 8);
+    return state;
+}
+
+static u32 update_slice_by_8(u32 state, const u8* data, size_t size)
+{
+    for (; size >= 8; data += 8, size -= 8) {
+        u32 low;
+        u32 high;
+        __builtin_memcpy(&low, data, sizeof(low));
+        __builtin_memcpy(&high, data + 4, sizeof(high));
+        low ^= state;
+
+        state = table.data[7][low & 0xFF] ^ table.data[6][(low >> 8) & 0xFF] ^ table.data[5][(low >> 16) & 0xFF] ^ table.data[4][low >> 24]
+            ^ table.data[3][high & 0xFF] ^ table.data[2][(high >> 8) & 0xFF] ^ table.data[1][(high >> 16) & 0xFF] ^ table.data[0][high >> 24];
+    }
+
+    return update_byte_by_byte(state, data, size);
+}
+
+#if ARCH(I386) || ARCH(X86_64)
+
+static constexpr size_t pclmul_minimum_size = 64;
+
+static bool cpu_supports_pclmul()
+{
+    static int supported = -1;
+    if (supported < 0) {
+        unsigned int eax, ebx, ecx, edx;
+        supported = __get_cpuid(1, &eax, &ebx, &ecx, &edx) && (ecx & bit_PCLMUL) && (ecx & bit_SSE4_1);
+    }
+    return supported;
+}
+
+[[gnu::target("pclmul,sse4.1")]] ALWAYS_INLINE static __m128i load(const u8* pointer)
+{
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(pointer));
+}
+
+[[gnu::target("pclmul,sse4.1")]] ALWAYS_INLINE static __m128i fold(__m128i value, __m128i constants, __m128i next)
+{
+    auto low = _mm_clmulepi64_si128(value, constants, 0x00);
+    auto high = _mm_clmulepi64_si128(value, constants, 0x11);
+    return _mm_xor_si128(_mm_xor_si128(high, low), next);
+}
+
+// Folds the input 64 bytes at a time using carry-less multiplication, followed by a Barrett reduction.
+// See "Fast CRC Computation for Generic Polynomials Using PCLMULQDQ Instruction" by Gopal et al. (Intel, 2009),
+// the constants are the bit-reflected ones for the CRC-32 polynomial. Expects size to be a multiple of 16 and at least 64.
+[[gnu::target("pclmul,sse4.1")]] static u32 update_pclmul(u32 state, const u8* data, size_t size)
+{
+    alignas(16) static constexpr u64 k1k2[] = { 0x154442bd4, 0x1c6e41596 };
+    alignas(16) static constexpr u64 k3k4[] = { 0x1751997d0, 0x0ccaa009e };
+    alignas(16) static constexpr u64 k5k0[] = { 0x163cd6124, 0x000000000 };
+    alignas(16) static constexpr u64 poly[] = { 0x1db710641, 0x1f7011641 };
+
+    auto x1 = _mm_xor_si128(load(data + 0x00), _mm_cvtsi32_si128(static_cast<int>(state)));
+    auto x2 = load(data + 0x10);
+    auto x3 = load(data + 0x20);
+    auto x4 = load(data + 0x30);
+    data += 64;
+    size -= 64;
+
+    auto constants = _mm_load_si128(reinterpret_cast<const __m128i*>(k1k2));
+    for (; size >= 64; data += 64, size -= 64) {
+        x1 = fold(x1, constants, load(data + 0x00));
+        x2 = fold(x2, constants, load(data + 0x10));
+        x3 = fold(x3, constants, load(data + 0x20));
+        x4 = fold(x4, constants, load(data + 0x30));
+    }
+
+    constants = _mm_load_si128(reinterpret_cast<const __m128i*>(k3k4));
+    x1 = fold(x1, constants, x2);
+    x1 = fold(x1, constants, x3);
+    x1 = fold(x1, constants, x4);
+
+    for (; size >= 16; data += 16, size -= 16)
+        x1 = fold(x1, constants, load(data));
+
+    // Fold 128 bits down to 64 bits.
+    auto mask = _mm_setr_epi32(~0, 0, ~0, 0);
+    x2 = _mm_clmulepi64_si128(x1, constants, 0x10);
+    x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), x2);
+
+    constants = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(k5k0));
+    x2 = _mm_srli_si128(x1, 4);
+    x1 = _mm_clmulepi64_si128(_mm_and_si128(x1, mask), constants, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+
+    // Barrett reduction down to 32 bits.
+    constants = _mm_load_si128(reinterpret_cast<const __m128i*>(poly));
+    x2 = _mm_clmulepi64_si128(_mm_and_si128(x1, mask), constants, 0x10);
+    x2 = _mm_clmulepi64_si128(_mm_and_si128(x2, mask), constants, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+
+    return static_cast<u32>(_mm_extract_epi32(x1, 1));
+}
+
+#endif
+
 void CRC32::update(ReadonlyBytes data)
 {
-    for (size_t i = 0; i < data.size(); i++) {
-        m_state = table[(m_state ^ data.at(i)) & 0xFF] ^ (m_state >> 8);
+    auto* pointer = data.data();
+    auto size = data.size();
+
+#if ARCH(I386) || ARCH(X86_64)
+    if (size >= pclmul_minimum_size && cpu_supports_pclmul()) {
+        auto folded_size = size & ~static_cast<size_t>(15);
+        m_state = update_pclmul(m_state, pointer, folded_size);
+        pointer += folded_size;
+        size -= folded_size;
     }
+#endif
+
+    m_state = update_slice_by_8(m_state, pointer, size);
 };
 
 u32 CRC32::digest()
@@ -24,12 +24,488 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <AK/Atomic.h>
+#include <AK/Endian.h>
+#include <AK/Platform.h>
 #include <AK/StringBuilder.h>
 #include <LibCrypto/Cipher/AES.h>
 
+// The kernel is built without SSE, so it always takes the bitsliced path.
+#if (ARCH(I386) || ARCH(X86_64)) && !defined(KERNEL)
+#    define AES_HAS_AESNI_PATH
+#    include <cpuid.h>
+#    include <wmmintrin.h>
+#endif
+
 namespace Crypto {
 namespace Cipher {
 
+#ifdef AES_HAS_AESNI_PATH
+
+static bool cpu_supports_aesni()
+{
+    // Threads racing to fill in the cache all come up with the same answer, so relaxed ordering is enough.
+    static Atomic<int> s_supported { -1 };
+    int supported = s_supported.load(AK::memory_order_relaxed);
+    if (supported < 0) {
+        unsigned int eax, ebx, ecx, edx;
+        supported = __get_cpuid(1, &eax, &ebx, &ecx, &edx) && (ecx & bit_AES) && (edx & bit_SSE2);
+        s_supported.store(supported, AK::memory_order_relaxed);
+    }
+    return supported;
+}
+
+template<bool encrypting>
+[[gnu::target("aes,sse2")]] ALWAYS_INLINE static __m128i round(__m128i block, __m128i round_key)
+{
+    if constexpr (encrypting)
+        return _mm_aesenc_si128(block, round_key);
+    else
+        return _mm_aesdec_si128(block, round_key);
+}
+
+template<bool encrypting>
+[[gnu::target("aes,sse2")]] ALWAYS_INLINE static __m128i last_round(__m128i block, __m128i round_key)
+{
+    if constexpr (encrypting)
+        return _mm_aesenclast_si128(block, round_key);
+    else
+        return _mm_aesdeclast_si128(block, round_key);
+}
+
+[[gnu::target("aes,sse2")]] ALWAYS_INLINE static __m128i load(const u8* pointer)
+{
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(pointer));
+}
+
+[[gnu::target("aes,sse2")]] ALWAYS_INLINE static void store(u8* pointer, __m128i block)
+{
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(pointer), block);
+}
+
+// Works for decryption too, given the round keys from expand_decrypt_key(), as those are
+// already laid out for the equivalent inverse cipher that AESDEC implements.
+template<bool encrypting>
+[[gnu::target("aes,sse2")]] static void process_blocks_aesni(const AESCipherKey& key, const u8* in, u8* out, size_t count)
+{
+    auto rounds = key.rounds();
+    __m128i round_keys[15];
+    for (size_t i = 0; i <= rounds; ++i)
+        round_keys[i] = load(key.round_key_bytes() + i * 16);
+
+    // Each AES round instruction has a latency of several cycles but can start every cycle,
+    // so interleaving four independent blocks keeps the unit busy.
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4, in += 64, out += 64) {
+        auto block0 = _mm_xor_si128(load(in), round_keys[0]);
+        auto block1 = _mm_xor_si128(load(in + 16), round_keys[0]);
+        auto block2 = _mm_xor_si128(load(in + 32), round_keys[0]);
+        auto block3 = _mm_xor_si128(load(in + 48), round_keys[0]);
+        for (size_t r = 1; r < rounds; ++r) {
+            block0 = round<encrypting>(block0, round_keys[r]);
+            block1 = round<encrypting>(block1, round_keys[r]);
+            block2 = round<encrypting>(block2, round_keys[r]);
+            block3 = round<encrypting>(block3, round_keys[r]);
+        }
+        store(out, last_round<encrypting>(block0, round_keys[rounds]));
+        store(out + 16, last_round<encrypting>(block1, round_keys[rounds]));
+        store(out + 32, last_round<encrypting>(block2, round_keys[rounds]));
+        store(out + 48, last_round<encrypting>(block3, round_keys[rounds]));
+    }
+    for (; i < count; ++i, in += 16, out += 16) {
+        auto block = _mm_xor_si128(load(in), round_keys[0]);
+        for (size_t r = 1; r < rounds; ++r)
+            block = round<encrypting>(block, round_keys[r]);
+        store(out, last_round<encrypting>(block, round_keys[rounds]));
+    }
+}
+
+#endif
+
+// Without AES-NI, AES is computed bitsliced instead of with lookup tables, as table lookups indexed by
+// secret data leak it through the cache. Four blocks are processed at once: q[b] holds bit b of all 64
+// bytes, where byte i of block n (in the column-major order of the AES state) is at bit 16 * n + i.
+
+static u64 transpose_bits_in_bytes(u64 x)
+{
+    // Transposes the 8x8 bit matrix with the bytes as rows (Hacker's Delight, 7-3).
+    u64 t = (x ^ (x >> 7)) & 0x00aa00aa00aa00aaULL;
+    x ^= t ^ (t << 7);
+    t = (x ^ (x >> 14)) & 0x0000cccc0000ccccULL;
+    x ^= t ^ (t << 14);
+    t = (x ^ (x >> 28)) & 0x00000000f0f0f0f0ULL;
+    x ^= t ^ (t << 28);
+    return x;
+}
+
+static void transpose_bytes(u64* q)
+{
+    // Transposes the 8x8 byte matrix with the words as rows.
+    for (size_t i = 0; i < 8; i += 2) {
+        u64 t = ((q[i] >> 8) ^ q[i + 1]) & 0x00ff00ff00ff00ffULL;
+        q[i + 1] ^= t;
+        q[i] ^= t << 8;
+    }
+    for (size_t base = 0; base < 8; base += 4) {
+        for (size_t i = base; i < base + 2; ++i) {
+            u64 t = ((q[i] >> 16) ^ q[i + 2]) & 0x0000ffff0000ffffULL;
+            q[i + 2] ^= t;
+            q[i] ^= t << 16;
+        }
+    }
+    for (size_t i = 0; i < 4; ++i) {
+        u64 t = ((q[i] >> 32) ^ q[i + 4]) & 0x00000000ffffffffULL;
+        q[i + 4] ^= t;
+        q[i] ^= t << 32;
+    }
+}
+
+static void load_bitsliced(u64* q, const u8* in)
+{
+    for (size_t i = 0; i < 8; ++i) {
+        u64 word;
+        __builtin_memcpy(&word, in + i * 8, sizeof(word));
+        q[i] = transpose_bits_in_bytes(AK::convert_between_host_and_little_endian(word));
+    }
+    transpose_bytes(q);
+}
+
+static void store_bitsliced(u8* out, u64* q)
+{
+    transpose_bytes(q);
+    for (size_t i = 0; i < 8; ++i) {
+        u64 word = AK::convert_between_host_and_little_endian(transpose_bits_in_bytes(q[i]));
+        __builtin_memcpy(out + i * 8, &word, sizeof(word));
+    }
+}
+
+// The S-box circuit by Boyar and Peralta, "A depth-16 circuit for the AES S-box".
+static void sub_bytes(u64* q)
+{
+    u64 x0 = q[7], x1 = q[6], x2 = q[5], x3 = q[4], x4 = q[3], x5 = q[2], x6 = q[1], x7 = q[0];
+
+    // Top linear transformation.
+    u64 y14 = x3 ^ x5;
+    u64 y13 = x0 ^ x6;
+    u64 y9 = x0 ^ x3;
+    u64 y8 = x0 ^ x5;
+    u64 t0 = x1 ^ x2;
+    u64 y1 = t0 ^ x7;
+    u64 y4 = y1 ^ x3;
+    u64 y12 = y13 ^ y14;
+    u64 y2 = y1 ^ x0;
+    u64 y5 = y1 ^ x6;
+    u64 y3 = y5 ^ y8;
+    u64 t1 = x4 ^ y12;
+    u64 y15 = t1 ^ x5;
+    u64 y20 = t1 ^ x1;
+    u64 y6 = y15 ^ x7;
+    u64 y10 = y15 ^ t0;
+    u64 y11 = y20 ^ y9;
+    u64 y7 = x7 ^ y11;
+    u64 y17 = y10 ^ y11;
+    u64 y19 = y10 ^ y8;
+    u64 y16 = t0 ^ y11;
+    u64 y21 = y13 ^ y16;
+    u64 y18 = x0 ^ y16;
+
+    // Non-linear section.
+    u64 t2 = y12 & y15;
+    u64 t3 = y3 & y6;
+    u64 t4 = t3 ^ t2;
+    u64 t5 = y4 & x7;
+    u64 t6 = t5 ^ t2;
+    u64 t7 = y13 & y16;
+    u64 t8 = y5 & y1;
+    u64 t9 = t8 ^ t7;
+    u64 t10 = y2 & y7;
+    u64 t11 = t10 ^ t7;
+    u64 t12 = y9 & y11;
+    u64 t13 = y14 & y17;
+    u64 t14 = t13 ^ t12;
+    u64 t15 = y8 & y10;
+    u64 t16 = t15 ^ t12;
+    u64 t17 = t4 ^ t14;
+    u64 t18 = t6 ^ t16;
+    u64 t19 = t9 ^ t14;
+    u64 t20 = t11 ^ t16;
+    u64 t21 = t17 ^ y20;
+    u64 t22 = t18 ^ y19;
+    u64 t23 = t19 ^ y21;
+    u64 t24 = t20 ^ y18;
+
+    u64 t25 = t21 ^ t22;
+    u64 t26 = t21 & t23;
+    u64 t27 = t24 ^ t26;
+    u64 t28 = t25 & t27;
+    u64 t29 = t28 ^ t22;
+    u64 t30 = t23 ^ t24;
+    u64 t31 = t22 ^ t26;
+    u64 t32 = t31 & t30;
+    u64 t33 = t32 ^ t24;
+    u64 t34 = t23 ^ t33;
+    u64 t35 = t27 ^ t33;
+    u64 t36 = t24 & t35;
+    u64 t37 = t36 ^ t34;
+    u64 t38 = t27 ^ t36;
+    u64 t39 = t29 & t38;
+    u64 t40 = t25 ^ t39;
+
+    u64 t41 = t40 ^ t37;
+    u64 t42 = t29 ^ t33;
+    u64 t43 = t29 ^ t40;
+    u64 t44 = t33 ^ t37;
+    u64 t45 = t42 ^ t41;
+    u64 z0 = t44 & y15;
+    u64 z1 = t37 & y6;
+    u64 z2 = t33 & x7;
+    u64 z3 = t43 & y16;
+    u64 z4 = t40 & y1;
+    u64 z5 = t29 & y7;
+    u64 z6 = t42 & y11;
+    u64 z7 = t45 & y17;
+    u64 z8 = t41 & y10;
+    u64 z9 = t44 & y12;
+    u64 z10 = t37 & y3;
+    u64 z11 = t33 & y4;
+    u64 z12 = t43 & y13;
+    u64 z13 = t40 & y5;
+    u64 z14 = t29 & y2;
+    u64 z15 = t42 & y9;
+    u64 z16 = t45 & y14;
+    u64 z17 = t41 & y8;
+
+    // Bottom linear transformation.
+    u64 t46 = z15 ^ z16;
+    u64 t47 = z10 ^ z11;
+    u64 t48 = z5 ^ z13;
+    u64 t49 = z9 ^ z10;
+    u64 t50 = z2 ^ z12;
+    u64 t51 = z2 ^ z5;
+    u64 t52 = z7 ^ z8;
+    u64 t53 = z0 ^ z3;
+    u64 t54 = z6 ^ z7;
+    u64 t55 = z16 ^ z17;
+    u64 t56 = z12 ^ t48;
+    u64 t57 = t50 ^ t53;
+    u64 t58 = z4 ^ t46;
+    u64 t59 = z3 ^ t54;
+    u64 t60 = t46 ^ t57;
+    u64 t61 = z14 ^ t57;
+    u64 t62 = t52 ^ t58;
+    u64 t63 = t49 ^ t58;
+    u64 t64 = z4 ^ t59;
+    u64 t65 = t61 ^ t62;
+    u64 t66 = z1 ^ t63;
+    u64 s0 = t59 ^ t63;
+    u64 s6 = t56 ^ ~t62;
+    u64 s7 = t48 ^ ~t60;
+    u64 t67 = t64 ^ t65;
+    u64 s3 = t53 ^ t66;
+    u64 s4 = t51 ^ t66;
+    u64 s5 = t47 ^ t65;
+    u64 s1 = t64 ^ ~s3;
+    u64 s2 = t55 ^ ~t67;
+
+    q[7] = s0;
+    q[6] = s1;
+    q[5] = s2;
+    q[4] = s3;
+    q[3] = s4;
+    q[2] = s5;
+    q[1] = s6;
+    q[0] = s7;
+}
+
+// Undoes the affine transformation at the end of the S-box: y -> M^-1 * (y ^ 0x63).
+static void inverse_affine_transform(u64* q)
+{
+    u64 r[8];
+    for (size_t i = 0; i < 8; ++i)
+        r[i] = q[(i + 2) % 8] ^ q[(i + 5) % 8] ^ q[(i + 7) % 8];
+    r[0] = ~r[0];
+    r[2] = ~r[2];
+    for (size_t i = 0; i < 8; ++i)
+        q[i] = r[i];
+}
+
+// The inverse S-box is x -> inverse(A^-1(x)), and inverse(y) is A^-1(S(y)).
+static void inverse_sub_bytes(u64* q)
+{
+    inverse_affine_transform(q);
+    sub_bytes(q);
+    inverse_affine_transform(q);
+}
+
+// Row r of the state moves r columns to the left, i.e. r nibbles down within the 16 bits of its block.
+static void shift_rows(u64* q)
+{
+    for (size_t i = 0; i < 8; ++i) {
+        u64 x = q[i];
+        q[i] = (x & 0x1111111111111111ULL)
+            | ((x & 0x2220222022202220ULL) >> 4) | ((x & 0x0002000200020002ULL) << 12)
+            | ((x & 0x4400440044004400ULL) >> 8) | ((x & 0x0044004400440044ULL) << 8)
+            | ((x & 0x8000800080008000ULL) >> 12) | ((x & 0x0888088808880888ULL) << 4);
+    }
+}
+
+static void inverse_shift_rows(u64* q)
+{
+    for (size_t i = 0; i < 8; ++i) {
+        u64 x = q[i];
+        q[i] = (x & 0x1111111111111111ULL)
+            | ((x & 0x0222022202220222ULL) << 4) | ((x & 0x2000200020002000ULL) >> 12)
+            | ((x & 0x4400440044004400ULL) >> 8) | ((x & 0x0044004400440044ULL) << 8)
+            | ((x & 0x0008000800080008ULL) << 12) | ((x & 0x8880888088808880ULL) >> 4);
+    }
+}
+
+// Moves row r + n of every column to row r.
+template<size_t n>
+static u64 rotate_rows(u64 x)
+{
+    constexpr u64 low_rows = 0x1111111111111111ULL * ((1 << (4 - n)) - 1);
+    return ((x >> n) & low_rows) | ((x << (4 - n)) & ~low_rows);
+}
+
+// Multiplication by x in GF(2^8), applied to the bit planes.
+static void multiply_by_x(u64* q)
+{
+    u64 top = q[7];
+    q[7] = q[6];
+    q[6] = q[5];
+    q[5] = q[4];
+    q[4] = q[3] ^ top;
+    q[3] = q[2] ^ top;
+    q[2] = q[1];
+    q[1] = q[0] ^ top;
+    q[0] = top;
+}
+
+static void mix_columns(u64* q)
+{
+    // Row r becomes 2 * a[r] ^ 3 * a[r + 1] ^ a[r + 2] ^ a[r + 3], i.e. x * (a[r] ^ a[r + 1]) ^ a[r + 1] ^ a[r + 2] ^ a[r + 3].
+    u64 doubled[8];
+    for (size_t i = 0; i < 8; ++i)
+        doubled[i] = q[i] ^ rotate_rows<1>(q[i]);
+    multiply_by_x(doubled);
+    for (size_t i = 0; i < 8; ++i)
+        q[i] = doubled[i] ^ rotate_rows<1>(q[i]) ^ rotate_rows<2>(q[i]) ^ rotate_rows<3>(q[i]);
+}
+
+static void inverse_mix_columns(u64* q)
+{
+    // InvMixColumns is MixColumns after adding x^2 * (a[r] ^ a[r + 2]) to every row.
+    u64 u[8];
+    for (size_t i = 0; i < 8; ++i)
+        u[i] = q[i] ^ rotate_rows<2>(q[i]);
+    multiply_by_x(u);
+    multiply_by_x(u);
+    for (size_t i = 0; i < 8; ++i)
+        q[i] ^= u[i];
+    mix_columns(q);
+}
+
+static void add_round_key(u64* q, const u64* round_key)
+{
+    for (size_t i = 0; i < 8; ++i)
+        q[i] ^= round_key[i];
+}
+
+// Works for decryption too, given the round keys from expand_decrypt_key(), as those are
+// laid out for the equivalent inverse cipher.
+template<bool encrypting>
+static void process_blocks_bitsliced(const AESCipherKey& key, const u8* in, u8* out, size_t count)
+{
+    auto rounds = key.rounds();
+    const u64* round_keys = key.bitsliced_round_keys();
+    u8 buffer[64];
+    u64 q[8];
+
+    while (count > 0) {
+        size_t batch = min<size_t>(count, 4);
+        if (batch < 4) {
+            __builtin_memset(buffer, 0, sizeof(buffer));
+            __builtin_memcpy(buffer, in, batch * 16);
+            load_bitsliced(q, buffer);
+        } else {
+            load_bitsliced(q, in);
+        }
+
+        add_round_key(q, round_keys);
+        for (size_t r = 1; r <= rounds; ++r) {
+            if constexpr (encrypting) {
+                sub_bytes(q);
+                shift_rows(q);
+                if (r != rounds)
+                    mix_columns(q);
+            } else {
+                inverse_sub_bytes(q);
+                inverse_shift_rows(q);
+                if (r != rounds)
+                    inverse_mix_columns(q);
+            }
+            add_round_key(q, round_keys + r * 8);
+        }
+
+        if (batch < 4) {
+            store_bitsliced(buffer, q);
+            __builtin_memcpy(out, buffer, batch * 16);
+        } else {
+            store_bitsliced(out, q);
+        }
+        in += batch * 16;
+        out += batch * 16;
+        count -= batch;
+    }
+}
+
+// SubWord() of the key schedule, with the same S-box circuit.
+static u32 sub_word(u32 word)
+{
+    u64 q[8] {};
+    for (size_t b = 0; b < 8; ++b) {
+        for (size_t i = 0; i < 4; ++i)
+            q[b] |= (u64)((word >> (i * 8 + b)) & 1) << i;
+    }
+    sub_bytes(q);
+    u32 result = 0;
+    for (size_t b = 0; b < 8; ++b) {
+        for (size_t i = 0; i < 4; ++i)
+            result |= (u32)((q[b] >> i) & 1) << (i * 8 + b);
+    }
+    return result;
+}
+
+// Multiplication by x in GF(2^8) of each byte of the word.
+static u32 multiply_by_x(u32 word)
+{
+    return ((word & 0x7f7f7f7f) << 1) ^ (((word >> 7) & 0x01010101) * 0x1b);
+}
+
+// Moves row r + n of a column to row r.
+static u32 rotate_bytes(u32 word, size_t n)
+{
+    return (word << (n * 8)) | (word >> (32 - n * 8));
+}
+
+// InvMixColumns on a single column, with row 0 in the most significant byte.
+static u32 inverse_mix_column(u32 word)
+{
+    word ^= multiply_by_x(multiply_by_x(word ^ rotate_bytes(word, 2)));
+    u32 rotated = rotate_bytes(word, 1);
+    return multiply_by_x(word ^ rotated) ^ rotated ^ rotate_bytes(word, 2) ^ rotate_bytes(word, 3);
+}
+
+bool AESCipher::is_hardware_accelerated()
+{
+#ifdef AES_HAS_AESNI_PATH
+    return cpu_supports_aesni();
+#else
+    return false;
+#endif
+}
+
 template<typename T>
 constexpr u32 get_key(T pt)
 {
@@ -86,13 +562,7 @@ void AESCipherKey::expand_encrypt_key(ReadonlyBytes user_key, size_t bits)
     if (bits == 128) {
         for (;;) {
             temp = round_key[3];
-            // clang-format off
-            round_key[4] = round_key[0] ^
-                    (AESTables::Encode2[(temp >> 16) & 0xff] & 0xff000000) ^
-                    (AESTables::Encode3[(temp >>  8) & 0xff] & 0x00ff0000) ^
-                    (AESTables::Encode0[(temp      ) & 0xff] & 0x0000ff00) ^
-                    (AESTables::Encode1[(temp >> 24)       ] & 0x000000ff) ^ AESTables::RCON[i];
-            // clang-format on
+            round_key[4] = round_key[0] ^ sub_word(rotate_bytes(temp, 1)) ^ AESTables::RCON[i];
             round_key[5] = round_key[1] ^ round_key[4];
             round_key[6] = round_key[2] ^ round_key[5];
             round_key[7] = round_key[3] ^ round_key[6];
@@ -109,13 +579,7 @@ void AESCipherKey::expand_encrypt_key(ReadonlyBytes user_key, size_t bits)
     if (bits == 192) {
         for (;;) {
             temp = round_key[5];
-            // clang-format off
-            round_key[6] = round_key[0] ^
-                    (AESTables::Encode2[(temp >> 16) & 0xff] & 0xff000000) ^
-                    (AESTables::Encode3[(temp >>  8) & 0xff] & 0x00ff0000) ^
-                    (AESTables::Encode0[(temp      ) & 0xff] & 0x0000ff00) ^
-                    (AESTables::Encode1[(temp >> 24)       ] & 0x000000ff) ^ AESTables::RCON[i];
-            // clang-format on
+            round_key[6] = round_key[0] ^ sub_word(rotate_bytes(temp, 1)) ^ AESTables::RCON[i];
             round_key[7] = round_key[1] ^ round_key[6];
             round_key[8] = round_key[2] ^ round_key[7];
             round_key[9] = round_key[3] ^ round_key[8];
@@ -137,13 +601,7 @@ void AESCipherKey::expand_encrypt_key(ReadonlyBytes user_key, size_t bits)
     if (true) { // bits == 256
         for (;;) {
             temp = round_key[7];
-            // clang-format off
-            round_key[8] = round_key[0] ^
-                    (AESTables::Encode2[(temp >> 16) & 0xff] & 0xff000000) ^
-                    (AESTables::Encode3[(temp >>  8) & 0xff] & 0x00ff0000) ^
-                    (AESTables::Encode0[(temp      ) & 0xff] & 0x0000ff00) ^
-                    (AESTables::Encode1[(temp >> 24)       ] & 0x000000ff) ^ AESTables::RCON[i];
-            // clang-format on
+            round_key[8] = round_key[0] ^ sub_word(rotate_bytes(temp, 1)) ^ AESTables::RCON[i];
             round_key[9] = round_key[1] ^ round_key[8];
             round_key[10] = round_key[2] ^ round_key[9];
             round_key[11] = round_key[3] ^ round_key[10];
@@ -153,13 +611,7 @@ void AESCipherKey::expand_encrypt_key(ReadonlyBytes user_key, size_t bits)
                 break;
 
             temp = round_key[11];
-            // clang-format off
-            round_key[12] = round_key[4] ^
-                    (AESTables::Encode2[(temp >> 24)       ] & 0xff000000) ^
-                    (AESTables::Encode3[(temp >> 16) & 0xff] & 0x00ff0000) ^
-                    (AESTables::Encode0[(temp >>  8) & 0xff] & 0x0000ff00) ^
-                    (AESTables::Encode1[(temp      ) & 0xff] & 0x000000ff) ;
-            // clang-format on
+            round_key[12] = round_key[4] ^ sub_word(temp);
             round_key[13] = round_key[5] ^ round_key[12];
             round_key[14] = round_key[6] ^ round_key[13];
             round_key[15] = round_key[7] ^ round_key[14];
@@ -170,6 +622,22 @@ void AESCipherKey::expand_encrypt_key(ReadonlyBytes user_key, size_t bits)
     }
 }
 
+void AESCipherKey::update_round_key_bytes()
+{
+    for (size_t i = 0; i < (rounds() + 1) * 4; ++i) {
+        u32 word = AK::convert_between_host_and_big_endian(m_rd_keys[i]);
+        __builtin_memcpy(m_round_key_bytes + i * 4, &word, sizeof(word));
+    }
+
+    // The bitsliced code adds the same round key to all four blocks it works on.
+    u8 repeated_round_key[64];
+    for (size_t i = 0; i <= rounds(); ++i) {
+        for (size_t j = 0; j < 4; ++j)
+            __builtin_memcpy(repeated_round_key + j * 16, m_round_key_bytes + i * 16, 16);
+        load_bitsliced(m_bitsliced_round_keys + i * 8, repeated_round_key);
+    }
+}
+
 void AESCipherKey::expand_decrypt_key(ReadonlyBytes user_key, size_t bits)
 {
     u32* round_key;
@@ -189,211 +657,44 @@ void AESCipherKey::expand_decrypt_key(ReadonlyBytes user_key, size_t bits)
     // apply inverse mix-column to middle rounds
     for (size_t i = 1; i < rounds(); ++i) {
         round_key += 4;
-        // clang-format off
-        round_key[0] =
-                AESTables::Decode0[AESTables::Encode1[(round_key[0] >> 24)       ] & 0xff] ^
-                AESTables::Decode1[AESTables::Encode1[(round_key[0] >> 16) & 0xff] & 0xff] ^
-                AESTables::Decode2[AESTables::Encode1[(round_key[0] >>  8) & 0xff] & 0xff] ^
-                AESTables::Decode3[AESTables::Encode1[(round_key[0]      ) & 0xff] & 0xff] ;
-        round_key[1] =
-                AESTables::Decode0[AESTables::Encode1[(round_key[1] >> 24)       ] & 0xff] ^
-                AESTables::Decode1[AESTables::Encode1[(round_key[1] >> 16) & 0xff] & 0xff] ^
-                AESTables::Decode2[AESTables::Encode1[(round_key[1] >>  8) & 0xff] & 0xff] ^
-                AESTables::Decode3[AESTables::Encode1[(round_key[1]      ) & 0xff] & 0xff] ;
-        round_key[2] =
-                AESTables::Decode0[AESTables::Encode1[(round_key[2] >> 24)       ] & 0xff] ^
-                AESTables::Decode1[AESTables::Encode1[(round_key[2] >> 16) & 0xff] & 0xff] ^
-                AESTables::Decode2[AESTables::Encode1[(round_key[2] >>  8) & 0xff] & 0xff] ^
-                AESTables::Decode3[AESTables::Encode1[(round_key[2]      ) & 0xff] & 0xff] ;
-        round_key[3] =
-                AESTables::Decode0[AESTables::Encode1[(round_key[3] >> 24)       ] & 0xff] ^
-                AESTables::Decode1[AESTables::Encode1[(round_key[3] >> 16) & 0xff] & 0xff] ^
-                AESTables::Decode2[AESTables::Encode1[(round_key[3] >>  8) & 0xff] & 0xff] ^
-                AESTables::Decode3[AESTables::Encode1[(round_key[3]      ) & 0xff] & 0xff] ;
-        // clang-format on
+        round_key[0] = inverse_mix_column(round_key[0]);
+        round_key[1] = inverse_mix_column(round_key[1]);
+        round_key[2] = inverse_mix_column(round_key[2]);
+        round_key[3] = inverse_mix_column(round_key[3]);
     }
 }
 
-void AESCipher::encrypt_block(const AESCipherBlock& in, AESCipherBlock& out)
+void AESCipher::encrypt_blocks(const u8* in, u8* out, size_t count)
 {
-    u32 s0, s1, s2, s3, t0, t1, t2, t3;
-    size_t r { 0 };
-
-    const auto& dec_key = key();
-    const auto* round_keys = dec_key.round_keys();
-
-    s0 = get_key(in.bytes().offset_pointer(0)) ^ round_keys[0];
-    s1 = get_key(in.bytes().offset_pointer(4)) ^ round_keys[1];
-    s2 = get_key(in.bytes().offset_pointer(8)) ^ round_keys[2];
-    s3 = get_key(in.bytes().offset_pointer(12)) ^ round_keys[3];
-
-    r = dec_key.rounds() >> 1;
-
-    // apply the first |r - 1| rounds
-    auto i { 0 };
-    for (;;) {
-        ++i;
-        // clang-format off
-        t0 = AESTables::Encode0[(s0 >> 24)       ] ^
-             AESTables::Encode1[(s1 >> 16) & 0xff] ^
-             AESTables::Encode2[(s2 >>  8) & 0xff] ^
-             AESTables::Encode3[(s3      ) & 0xff] ^ round_keys[4];
-        t1 = AESTables::Encode0[(s1 >> 24)       ] ^
-             AESTables::Encode1[(s2 >> 16) & 0xff] ^
-             AESTables::Encode2[(s3 >>  8) & 0xff] ^
-             AESTables::Encode3[(s0      ) & 0xff] ^ round_keys[5];
-        t2 = AESTables::Encode0[(s2 >> 24)       ] ^
-             AESTables::Encode1[(s3 >> 16) & 0xff] ^
-             AESTables::Encode2[(s0 >>  8) & 0xff] ^
-             AESTables::Encode3[(s1      ) & 0xff] ^ round_keys[6];
-        t3 = AESTables::Encode0[(s3 >> 24)       ] ^
-             AESTables::Encode1[(s0 >> 16) & 0xff] ^
-             AESTables::Encode2[(s1 >>  8) & 0xff] ^
-             AESTables::Encode3[(s2      ) & 0xff] ^ round_keys[7];
-        // clang-format on
-
-        round_keys += 8;
-        --r;
-        ++i;
-        if (r == 0)
-            break;
-
-        // clang-format off
-        s0 = AESTables::Encode0[(t0 >> 24)       ] ^
-             AESTables::Encode1[(t1 >> 16) & 0xff] ^
-             AESTables::Encode2[(t2 >>  8) & 0xff] ^
-             AESTables::Encode3[(t3      ) & 0xff] ^ round_keys[0];
-        s1 = AESTables::Encode0[(t1 >> 24)       ] ^
-             AESTables::Encode1[(t2 >> 16) & 0xff] ^
-             AESTables::Encode2[(t3 >>  8) & 0xff] ^
-             AESTables::Encode3[(t0      ) & 0xff] ^ round_keys[1];
-        s2 = AESTables::Encode0[(t2 >> 24)       ] ^
-             AESTables::Encode1[(t3 >> 16) & 0xff] ^
-             AESTables::Encode2[(t0 >>  8) & 0xff] ^
-             AESTables::Encode3[(t1      ) & 0xff] ^ round_keys[2];
-        s3 = AESTables::Encode0[(t3 >> 24)       ] ^
-             AESTables::Encode1[(t0 >> 16) & 0xff] ^
-             AESTables::Encode2[(t1 >>  8) & 0xff] ^
-             AESTables::Encode3[(t2      ) & 0xff] ^ round_keys[3];
-        // clang-format on
+#ifdef AES_HAS_AESNI_PATH
+    if (cpu_supports_aesni()) {
+        process_blocks_aesni<true>(key(), in, out, count);
+        return;
     }
+#endif
+    process_blocks_bitsliced<true>(key(), in, out, count);
+}
 
-    // apply the last round and put the encrypted data into out
-    // clang-format off
-    s0 = (AESTables::Encode2[(t0 >> 24)       ] & 0xff000000) ^
-         (AESTables::Encode3[(t1 >> 16) & 0xff] & 0x00ff0000) ^
-         (AESTables::Encode0[(t2 >>  8) & 0xff] & 0x0000ff00) ^
-         (AESTables::Encode1[(t3      ) & 0xff] & 0x000000ff) ^ round_keys[0];
-    out.put(0, s0);
-
-    s1 = (AESTables::Encode2[(t1 >> 24)       ] & 0xff000000) ^
-         (AESTables::Encode3[(t2 >> 16) & 0xff] & 0x00ff0000) ^
-         (AESTables::Encode0[(t3 >>  8) & 0xff] & 0x0000ff00) ^
-         (AESTables::Encode1[(t0      ) & 0xff] & 0x000000ff) ^ round_keys[1];
-    out.put(4, s1);
-
-    s2 = (AESTables::Encode2[(t2 >> 24)       ] & 0xff000000) ^
-         (AESTables::Encode3[(t3 >> 16) & 0xff] & 0x00ff0000) ^
-         (AESTables::Encode0[(t0 >>  8) & 0xff] & 0x0000ff00) ^
-         (AESTables::Encode1[(t1      ) & 0xff] & 0x000000ff) ^ round_keys[2];
-    out.put(8, s2);
-
-    s3 = (AESTables::Encode2[(t3 >> 24)       ] & 0xff000000) ^
-         (AESTables::Encode3[(t0 >> 16) & 0xff] & 0x00ff0000) ^
-         (AESTables::Encode0[(t1 >>  8) & 0xff] & 0x0000ff00) ^
-         (AESTables::Encode1[(t2      ) & 0xff] & 0x000000ff) ^ round_keys[3];
-    out.put(12, s3);
-    // clang-format on
+void AESCipher::encrypt_block(const AESCipherBlock& in, AESCipherBlock& out)
+{
+#ifdef AES_HAS_AESNI_PATH
+    if (cpu_supports_aesni()) {
+        process_blocks_aesni<true>(key(), in.bytes().data(), out.bytes().data(), 1);
+        return;
+    }
+#endif
+    process_blocks_bitsliced<true>(key(), in.bytes().data(), out.bytes().data(), 1);
 }
 
 void AESCipher::decrypt_block(const AESCipherBlock& in, AESCipherBlock& out)
 {
-
-    u32 s0, s1, s2, s3, t0, t1, t2, t3;
-    size_t r { 0 };
-
-    const auto& dec_key = key();
-    const auto* round_keys = dec_key.round_keys();
-
-    s0 = get_key(in.bytes().offset_pointer(0)) ^ round_keys[0];
-    s1 = get_key(in.bytes().offset_pointer(4)) ^ round_keys[1];
-    s2 = get_key(in.bytes().offset_pointer(8)) ^ round_keys[2];
-    s3 = get_key(in.bytes().offset_pointer(12)) ^ round_keys[3];
-
-    r = dec_key.rounds() >> 1;
-
-    // apply the first |r - 1| rounds
-    for (;;) {
-        // clang-format off
-        t0 = AESTables::Decode0[(s0 >> 24)       ] ^
-             AESTables::Decode1[(s3 >> 16) & 0xff] ^
-             AESTables::Decode2[(s2 >>  8) & 0xff] ^
-             AESTables::Decode3[(s1      ) & 0xff] ^ round_keys[4];
-        t1 = AESTables::Decode0[(s1 >> 24)       ] ^
-             AESTables::Decode1[(s0 >> 16) & 0xff] ^
-             AESTables::Decode2[(s3 >>  8) & 0xff] ^
-             AESTables::Decode3[(s2      ) & 0xff] ^ round_keys[5];
-        t2 = AESTables::Decode0[(s2 >> 24)       ] ^
-             AESTables::Decode1[(s1 >> 16) & 0xff] ^
-             AESTables::Decode2[(s0 >>  8) & 0xff] ^
-             AESTables::Decode3[(s3      ) & 0xff] ^ round_keys[6];
-        t3 = AESTables::Decode0[(s3 >> 24)       ] ^
-             AESTables::Decode1[(s2 >> 16) & 0xff] ^
-             AESTables::Decode2[(s1 >>  8) & 0xff] ^
-             AESTables::Decode3[(s0      ) & 0xff] ^ round_keys[7];
-        // clang-format on
-
-        round_keys += 8;
-        --r;
-        if (r == 0)
-            break;
-
-        // clang-format off
-        s0 = AESTables::Decode0[(t0 >> 24)       ] ^
-             AESTables::Decode1[(t3 >> 16) & 0xff] ^
-             AESTables::Decode2[(t2 >>  8) & 0xff] ^
-             AESTables::Decode3[(t1      ) & 0xff] ^ round_keys[0];
-        s1 = AESTables::Decode0[(t1 >> 24)       ] ^
-             AESTables::Decode1[(t0 >> 16) & 0xff] ^
-             AESTables::Decode2[(t3 >>  8) & 0xff] ^
-             AESTables::Decode3[(t2      ) & 0xff] ^ round_keys[1];
-        s2 = AESTables::Decode0[(t2 >> 24)       ] ^
-             AESTables::Decode1[(t1 >> 16) & 0xff] ^
-             AESTables::Decode2[(t0 >>  8) & 0xff] ^
-             AESTables::Decode3[(t3      ) & 0xff] ^ round_keys[2];
-        s3 = AESTables::Decode0[(t3 >> 24)       ] ^
-             AESTables::Decode1[(t2 >> 16) & 0xff] ^
-             AESTables::Decode2[(t1 >>  8) & 0xff] ^
-             AESTables::Decode3[(t0      ) & 0xff] ^ round_keys[3];
-        // clang-format on
+#ifdef AES_HAS_AESNI_PATH
+    if (cpu_supports_aesni()) {
+        process_blocks_aesni<false>(key(), in.bytes().data(), out.bytes().data(), 1);
+        return;
     }
-
-    // apply the last round and put the decrypted data into out
-    // clang-format off
-    s0 = ((u32)AESTables::Decode4[(t0 >> 24)       ] << 24) ^
-         ((u32)AESTables::Decode4[(t3 >> 16) & 0xff] << 16) ^
-         ((u32)AESTables::Decode4[(t2 >>  8) & 0xff] <<  8) ^
-         ((u32)AESTables::Decode4[(t1      ) & 0xff]      ) ^ round_keys[0];
-    out.put(0, s0);
-
-    s1 = ((u32)AESTables::Decode4[(t1 >> 24)       ] << 24) ^
-         ((u32)AESTables::Decode4[(t0 >> 16) & 0xff] << 16) ^
-         ((u32)AESTables::Decode4[(t3 >>  8) & 0xff] <<  8) ^
-         ((u32)AESTables::Decode4[(t2      ) & 0xff]      ) ^ round_keys[1];
-    out.put(4, s1);
-
-    s2 = ((u32)AESTables::Decode4[(t2 >> 24)       ] << 24) ^
-         ((u32)AESTables::Decode4[(t1 >> 16) & 0xff] << 16) ^
-         ((u32)AESTables::Decode4[(t0 >>  8) & 0xff] <<  8) ^
-         ((u32)AESTables::Decode4[(t3      ) & 0xff]      ) ^ round_keys[2];
-    out.put(8, s2);
-
-    s3 = ((u32)AESTables::Decode4[(t3 >> 24)       ] << 24) ^
-         ((u32)AESTables::Decode4[(t2 >> 16) & 0xff] << 16) ^
-         ((u32)AESTables::Decode4[(t1 >>  8) & 0xff] <<  8) ^
-         ((u32)AESTables::Decode4[(t0      ) & 0xff]      ) ^ round_keys[3];
-    out.put(12, s3);
-    // clang-format on
+#endif
+    process_blocks_bitsliced<false>(key(), in.bytes().data(), out.bytes().data(), 1);
 }
 
 void AESCipherBlock::overwrite(ReadonlyBytes bytes)
@@ -117,15 +117,20 @@ public:
         m_cipher_block.set_padding_mode(cipher.padding_mode());
         size_t offset { 0 };
 
+        // Each ciphertext block is the IV of the next one, keep a copy of it so that in and out may be the same buffer.
+        VERIFY(block_size <= BlockSize);
+        __builtin_memcpy(m_iv_storage, iv, block_size);
+
         while (length > 0) {
             auto* slice = in.offset(offset);
             m_cipher_block.overwrite(slice, block_size);
+            __builtin_memcpy(m_next_iv_storage, slice, block_size);
             cipher.decrypt_block(m_cipher_block, m_cipher_block);
-            m_cipher_block.apply_initialization_vector(iv);
+            m_cipher_block.apply_initialization_vector(m_iv_storage);
             auto decrypted = m_cipher_block.bytes();
             VERIFY(offset + decrypted.size() <= out.size());
             __builtin_memcpy(out.offset(offset), decrypted.data(), decrypted.size());
-            iv = slice;
+            __builtin_memcpy(m_iv_storage, m_next_iv_storage, block_size);
             length -= block_size;
             offset += block_size;
         }
@@ -134,7 +139,11 @@ public:
     }
 
 private:
+    constexpr static size_t BlockSize = T::BlockType::BlockSizeInBits / 8;
+
     typename T::BlockType m_cipher_block {};
+    u8 m_iv_storage[BlockSize];
+    u8 m_next_iv_storage[BlockSize];
 };
 
 }
@@ -150,7 +150,26 @@ public:
     }
 
 private:
+    constexpr static size_t BlockSize = T::BlockType::BlockSizeInBits / 8;
+    constexpr static size_t BatchBlockCount = 8;
+
+    // Encrypts the counter blocks in m_key_stream in place.
+    void generate_key_stream(T& cipher, size_t block_count, size_t block_size)
+    {
+        if constexpr (requires { cipher.encrypt_blocks(m_key_stream, m_key_stream, block_count); }) {
+            cipher.encrypt_blocks(m_key_stream, m_key_stream, block_count);
+        } else {
+            for (size_t i = 0; i < block_count; ++i) {
+                auto* block = m_key_stream + i * block_size;
+                m_cipher_block.overwrite(block, block_size);
+                cipher.encrypt_block(m_cipher_block, m_cipher_block);
+                __builtin_memcpy(block, m_cipher_block.bytes().data(), block_size);
+            }
+        }
+    }
+
     u8 m_ivec_storage[IVSizeInBits / 8];
+    u8 m_key_stream[BatchBlockCount * BlockSize];
     typename T::BlockType m_cipher_block {};
 
 protected:
@@ -182,20 +201,27 @@ protected:
 
         size_t offset { 0 };
         auto block_size = cipher.block_size();
+        VERIFY(block_size <= BlockSize);
 
+        // Counter blocks are independent of each other, so generate the key stream for a batch
+        // of them at a time; ciphers that can pipeline several blocks get to do so.
         while (length > 0) {
-            m_cipher_block.overwrite(iv.slice(0, block_size));
-
-            cipher.encrypt_block(m_cipher_block, m_cipher_block);
-            if (in) {
-                m_cipher_block.apply_initialization_vector(in->data() + offset);
+            auto block_count = min(BatchBlockCount, (length + block_size - 1) / block_size);
+            for (size_t i = 0; i < block_count; ++i) {
+                __builtin_memcpy(m_key_stream + i * block_size, iv.data(), block_size);
+                increment(iv);
             }
-            auto write_size = min(block_size, length);
+            generate_key_stream(cipher, block_count, block_size);
 
+            auto write_size = min(block_count * block_size, length);
             VERIFY(offset + write_size <= out.size());
-            __builtin_memcpy(out.offset(offset), m_cipher_block.bytes().data(), write_size);
+            if (in) {
+                for (size_t i = 0; i < write_size; ++i)
+                    out[offset + i] = in->data()[offset + i] ^ m_key_stream[i];
+            } else {
+                __builtin_memcpy(out.offset(offset), m_key_stream, write_size);
+            }
 
-            increment(iv);
             length -= write_size;
             offset += write_size;
         }
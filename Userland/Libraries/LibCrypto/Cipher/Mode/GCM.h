@@ -86,8 +86,10 @@ public:
 
     void encrypt(const ReadonlyBytes& in, Bytes out, const ReadonlyBytes& iv_in, const ReadonlyBytes& aad, Bytes tag)
     {
-        auto iv_buf = ByteBuffer::copy(iv_in.data(), iv_in.size());
-        auto iv = iv_buf.bytes();
+        VERIFY(iv_in.size() == IV_length());
+        u8 iv_storage[IVSizeInBits / 8];
+        Bytes iv { iv_storage, sizeof(iv_storage) };
+        iv_in.copy_to(iv);
 
         // Increment the IV for block 0
         CTR<T>::increment(iv);
@@ -110,8 +112,10 @@ public:
 
     VerificationConsistency decrypt(ReadonlyBytes in, Bytes out, ReadonlyBytes iv_in, ReadonlyBytes aad, ReadonlyBytes tag)
     {
-        auto iv_buf = ByteBuffer::copy(iv_in.data(), iv_in.size());
-        auto iv = iv_buf.bytes();
+        VERIFY(iv_in.size() == IV_length());
+        u8 iv_storage[IVSizeInBits / 8];
+        Bytes iv { iv_storage, sizeof(iv_storage) };
+        iv_in.copy_to(iv);
 
         // Increment the IV for block 0
         CTR<T>::increment(iv);
@@ -125,13 +129,19 @@ public:
         auto auth_tag = m_ghash->process(aad, in);
         block0.apply_initialization_vector(auth_tag.data);
 
+        // Compare every byte, so the time this takes doesn't tell how much of a forged tag was right.
         auto test_consistency = [&] {
-            if (block0.block_size() != tag.size() || __builtin_memcmp(block0.bytes().data(), tag.data(), tag.size()) != 0)
+            if (block0.block_size() != tag.size())
+                return VerificationConsistency::Inconsistent;
+
+            u8 difference = 0;
+            for (size_t i = 0; i < tag.size(); ++i)
+                difference |= block0.bytes()[i] ^ tag[i];
+            if (difference != 0)
                 return VerificationConsistency::Inconsistent;
 
             return VerificationConsistency::Consistent;
         };
-        // FIXME: This block needs constant-time comparisons.
 
         if (in.is_empty()) {
             out = {};
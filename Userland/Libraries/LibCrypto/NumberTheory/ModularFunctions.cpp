@@ -117,7 +117,7 @@ UnsignedBigInteger ModularInverse(const UnsignedBigInteger& a_, const UnsignedBi
     return temp_remainder;
 }
 
-UnsignedBigInteger ModularPower(const UnsignedBigInteger& b, const UnsignedBigInteger& e, const UnsignedBigInteger& m)
+static UnsignedBigInteger ModularPower_with_division(const UnsignedBigInteger& b, const UnsignedBigInteger& e, const UnsignedBigInteger& m)
 {
     if (m == 1)
         return 0;
@@ -154,6 +154,130 @@ UnsignedBigInteger ModularPower(const UnsignedBigInteger& b, const UnsignedBigIn
     return exp;
 }
 
+// Everything needed to multiply modulo an odd number in Montgomery form, where x is
+// represented by x * R mod m. Setting this up takes two divisions, after which a whole
+// exponentiation can be done without any.
+class MontgomeryContext {
+public:
+    explicit MontgomeryContext(const UnsignedBigInteger& modulus)
+        : m_modulus(modulus)
+        , m_factor(UnsignedBigInteger::montgomery_factor(modulus))
+    {
+        auto r = UnsignedBigInteger { 1 }.shift_left(32 * modulus.trimmed_length());
+        m_one = r.divided_by(modulus).remainder;
+        m_r_squared = m_one.multiplied_by(m_one).divided_by(modulus).remainder;
+    }
+
+    const UnsignedBigInteger& one() const { return m_one; }
+
+    // The output may be the same object as either operand.
+    void multiply(const UnsignedBigInteger& left, const UnsignedBigInteger& right, UnsignedBigInteger& output)
+    {
+        UnsignedBigInteger::multiply_without_allocation(left, right, m_temp_1, m_temp_2, m_temp_3, m_temp_4, m_temp_product);
+        UnsignedBigInteger::montgomery_reduce_without_allocation(m_temp_product, m_modulus, m_factor, output);
+    }
+
+    // The value must be less than the modulus.
+    void to_montgomery_form(const UnsignedBigInteger& value, UnsignedBigInteger& output)
+    {
+        multiply(value, m_r_squared, output);
+    }
+
+    void from_montgomery_form(const UnsignedBigInteger& value, UnsignedBigInteger& output)
+    {
+        UnsignedBigInteger::montgomery_reduce_without_allocation(value, m_modulus, m_factor, output);
+    }
+
+private:
+    const UnsignedBigInteger& m_modulus;
+    u32 m_factor { 0 };
+    UnsignedBigInteger m_one;
+    UnsignedBigInteger m_r_squared;
+
+    UnsignedBigInteger m_temp_1;
+    UnsignedBigInteger m_temp_2;
+    UnsignedBigInteger m_temp_3;
+    UnsignedBigInteger m_temp_4;
+    UnsignedBigInteger m_temp_product;
+};
+
+static size_t sliding_window_size(size_t exponent_bits)
+{
+    // Larger windows need fewer multiplications, but more precomputed powers.
+    if (exponent_bits > 671)
+        return 6;
+    if (exponent_bits > 239)
+        return 5;
+    if (exponent_bits > 79)
+        return 4;
+    if (exponent_bits > 23)
+        return 3;
+    return 1;
+}
+
+UnsignedBigInteger ModularPower(const UnsignedBigInteger& b, const UnsignedBigInteger& e, const UnsignedBigInteger& m)
+{
+    if (m == 1)
+        return 0;
+
+    // Montgomery reduction only works for odd moduli, which RSA and primality tests always use.
+    if (m.words()[0] % 2 == 0)
+        return ModularPower_with_division(b, e, m);
+
+    auto exponent_length = e.trimmed_length();
+    if (exponent_length == 0)
+        return 1;
+    size_t exponent_bits = exponent_length * 32 - __builtin_clz(e.words()[exponent_length - 1]);
+    auto exponent_bit = [&](size_t index) -> u32 {
+        return (e.words()[index / 32] >> (index % 32)) & 1;
+    };
+
+    MontgomeryContext context(m);
+
+    // Sliding window exponentiation: the exponent is processed in windows of up to
+    // window_size bits that start and end with a one, so only odd powers of the base are
+    // ever needed. These are precomputed, odd_powers[i] = b^(2i + 1).
+    auto window_size = sliding_window_size(exponent_bits);
+    Vector<UnsignedBigInteger> odd_powers;
+    odd_powers.resize(1 << (window_size - 1));
+    if (b < m) {
+        context.to_montgomery_form(b, odd_powers[0]);
+    } else {
+        context.to_montgomery_form(b.divided_by(m).remainder, odd_powers[0]);
+    }
+    if (odd_powers.size() > 1) {
+        UnsignedBigInteger base_squared;
+        context.multiply(odd_powers[0], odd_powers[0], base_squared);
+        for (size_t i = 1; i < odd_powers.size(); ++i)
+            context.multiply(odd_powers[i - 1], base_squared, odd_powers[i]);
+    }
+
+    UnsignedBigInteger result { context.one() };
+    for (ssize_t i = exponent_bits - 1; i >= 0;) {
+        if (!exponent_bit(i)) {
+            context.multiply(result, result, result);
+            --i;
+            continue;
+        }
+
+        ssize_t window_end = max<ssize_t>(i - window_size + 1, 0);
+        while (!exponent_bit(window_end))
+            ++window_end;
+
+        u32 window_value = 0;
+        for (ssize_t j = i; j >= window_end; --j) {
+            window_value = (window_value << 1) | exponent_bit(j);
+            context.multiply(result, result, result);
+        }
+        context.multiply(result, odd_powers[window_value / 2], result);
+        i = window_end - 1;
+    }
+
+    UnsignedBigInteger output;
+    context.from_montgomery_form(result, output);
+    return output;
+}
+
 static void GCD_without_allocation(
     const UnsignedBigInteger& a,
     const UnsignedBigInteger& b,
@@ -33,6 +33,7 @@
 #include <AK/TemporaryChange.h>
 #include <LibCrypto/BigInt/SignedBigInteger.h>
 #include <LibJS/AST.h>
+#include <LibJS/Bytecode/Generator.h>
 #include <LibJS/Interpreter.h>
 #include <LibJS/Runtime/Accessor.h>
 #include <LibJS/Runtime/Array.h>
@@ -40,6 +41,7 @@
 #include <LibJS/Runtime/Error.h>
 #include <LibJS/Runtime/GlobalObject.h>
 #include <LibJS/Runtime/IteratorOperations.h>
+#include <LibJS/Runtime/LexicalEnvironment.h>
 #include <LibJS/Runtime/MarkedValueList.h>
 #include <LibJS/Runtime/NativeFunction.h>
 #include <LibJS/Runtime/PrimitiveString.h>
@@ -100,13 +102,13 @@ static void update_function_name(Value value, const FlyString& name, HashTable<J
     }
 }
 
-static void update_function_name(Value value, const FlyString& name)
+void update_function_name(Value value, const FlyString& name)
 {
     HashTable<JS::Cell*> visited;
     update_function_name(value, name, visited);
 }
 
-static String get_function_name(GlobalObject& global_object, Value value)
+String get_function_name(GlobalObject& global_object, Value value)
 {
     if (value.is_symbol())
         return String::formatted("[{}]", value.as_symbol().description());
@@ -115,6 +117,41 @@ static String get_function_name(GlobalObject& global_object, Value value)
     return value.to_string(global_object);
 }
 
+ScopeNode::ScopeNode(SourceRange source_range)
+    : Statement(move(source_range))
+{
+}
+
+ScopeNode::~ScopeNode()
+{
+}
+
+const Bytecode::Executable* ScopeNode::bytecode_executable() const
+{
+    if (!m_attempted_bytecode_generation) {
+        m_attempted_bytecode_generation = true;
+        m_bytecode_executable = Bytecode::Generator::generate(*this);
+    }
+    return m_bytecode_executable.ptr();
+}
+
+const EnvironmentLayout& ScopeNode::block_environment_layout() const
+{
+    if (!m_block_environment_layout) {
+        m_block_environment_layout = EnvironmentLayout::create();
+        for (auto& declaration : m_variables) {
+            for (auto& declarator : declaration.declarations())
+                m_block_environment_layout->add_binding(declarator.id().string(), declaration.declaration_kind());
+        }
+    }
+    return *m_block_environment_layout;
+}
+
+void ScopeNode::set_function_environment_layout(NonnullRefPtr<EnvironmentLayout> layout) const
+{
+    m_function_environment_layout = move(layout);
+}
+
 Value ScopeNode::execute(Interpreter& interpreter, GlobalObject& global_object) const
 {
     InterpreterNodeScope node_scope { interpreter, *this };
@@ -184,6 +221,23 @@ CallExpression::ThisAndCallee CallExpression::compute_this_and_callee(Interprete
     return { &global_object, m_callee->execute(interpreter, global_object) };
 }
 
+void CallExpression::throw_type_error_for_callee(Interpreter& interpreter, GlobalObject& global_object, Value callee) const
+{
+    auto& vm = interpreter.vm();
+    auto call_type = is<NewExpression>(*this) ? "constructor" : "function";
+    if (is<Identifier>(*m_callee) || is<MemberExpression>(*m_callee)) {
+        String expression_string;
+        if (is<Identifier>(*m_callee)) {
+            expression_string = static_cast<const Identifier&>(*m_callee).string();
+        } else {
+            expression_string = static_cast<const MemberExpression&>(*m_callee).to_string_approximation();
+        }
+        vm.throw_exception<TypeError>(global_object, ErrorType::IsNotAEvaluatedFrom, callee.to_string_without_side_effects(), call_type, expression_string);
+    } else {
+        vm.throw_exception<TypeError>(global_object, ErrorType::IsNotA, callee.to_string_without_side_effects(), call_type);
+    }
+}
+
 Value CallExpression::execute(Interpreter& interpreter, GlobalObject& global_object) const
 {
     InterpreterNodeScope node_scope { interpreter, *this };
@@ -196,19 +250,7 @@ Value CallExpression::execute(Interpreter& interpreter, GlobalObject& global_obj
 
     if (!callee.is_function()
         || (is<NewExpression>(*this) && (is<NativeFunction>(callee.as_object()) && !static_cast<NativeFunction&>(callee.as_object()).has_constructor()))) {
-        String error_message;
-        auto call_type = is<NewExpression>(*this) ? "constructor" : "function";
-        if (is<Identifier>(*m_callee) || is<MemberExpression>(*m_callee)) {
-            String expression_string;
-            if (is<Identifier>(*m_callee)) {
-                expression_string = static_cast<const Identifier&>(*m_callee).string();
-            } else {
-                expression_string = static_cast<const MemberExpression&>(*m_callee).to_string_approximation();
-            }
-            vm.throw_exception<TypeError>(global_object, ErrorType::IsNotAEvaluatedFrom, callee.to_string_without_side_effects(), call_type, expression_string);
-        } else {
-            vm.throw_exception<TypeError>(global_object, ErrorType::IsNotA, callee.to_string_without_side_effects(), call_type);
-        }
+        throw_type_error_for_callee(interpreter, global_object, callee);
         return {};
     }
 
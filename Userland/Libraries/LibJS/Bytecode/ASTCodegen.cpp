@@ -0,0 +1,719 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <LibJS/AST.h>
+#include <LibJS/Bytecode/Generator.h>
+
+namespace JS {
+
+Optional<Bytecode::Register> ASTNode::generate_bytecode(Bytecode::Generator& generator) const
+{
+    generator.fail();
+    return {};
+}
+
+Optional<Bytecode::Register> Expression::generate_bytecode(Bytecode::Generator& generator) const
+{
+    return generator.emit_evaluate(*this);
+}
+
+Optional<Bytecode::Register> EmptyStatement::generate_bytecode(Bytecode::Generator&) const
+{
+    return {};
+}
+
+Optional<Bytecode::Register> DebuggerStatement::generate_bytecode(Bytecode::Generator&) const
+{
+    return {};
+}
+
+Optional<Bytecode::Register> FunctionDeclaration::generate_bytecode(Bytecode::Generator&) const
+{
+    // NOTE: Function declarations are hoisted when their scope is entered.
+    return {};
+}
+
+Optional<Bytecode::Register> ClassDeclaration::generate_bytecode(Bytecode::Generator& generator) const
+{
+    generator.add_dynamic_binding(m_class_expression->name());
+    generator.emit_evaluate(*this);
+    return {};
+}
+
+Optional<Bytecode::Register> ExpressionStatement::generate_bytecode(Bytecode::Generator& generator) const
+{
+    (void)m_expression->generate_bytecode(generator);
+    return {};
+}
+
+Optional<Bytecode::Register> ScopeNode::generate_bytecode(Bytecode::Generator& generator) const
+{
+    bool needs_scope = !m_variables.is_empty() || !m_functions.is_empty();
+    if (needs_scope)
+        generator.enter_scope(*this);
+    for (auto& child : m_children) {
+        (void)child.generate_bytecode(generator);
+        if (generator.has_failed())
+            return {};
+    }
+    if (needs_scope)
+        generator.leave_scope();
+    return {};
+}
+
+Optional<Bytecode::Register> VariableDeclaration::generate_bytecode(Bytecode::Generator& generator) const
+{
+    for (auto& declarator : m_declarations) {
+        auto* init = declarator.init();
+        if (!init)
+            continue;
+        auto value = init->generate_bytecode(generator);
+        if (generator.has_failed())
+            return {};
+        generator.emit_set_variable(*value, declarator.id().string(), true);
+    }
+    return {};
+}
+
+Optional<Bytecode::Register> ReturnStatement::generate_bytecode(Bytecode::Generator& generator) const
+{
+    Optional<Bytecode::Register> value;
+    if (m_argument)
+        value = m_argument->generate_bytecode(generator);
+    else
+        value = generator.emit_load(js_undefined());
+    if (generator.has_failed())
+        return {};
+    generator.emit(Bytecode::Instruction::Type::Return, {}, *value);
+    return {};
+}
+
+Optional<Bytecode::Register> ThrowStatement::generate_bytecode(Bytecode::Generator& generator) const
+{
+    auto value = m_argument->generate_bytecode(generator);
+    if (generator.has_failed())
+        return {};
+    generator.emit(Bytecode::Instruction::Type::Throw, {}, *value, {}, generator.add_node(*this));
+    return {};
+}
+
+Optional<Bytecode::Register> BreakStatement::generate_bytecode(Bytecode::Generator& generator) const
+{
+    if (!m_target_label.is_null()) {
+        generator.fail();
+        return {};
+    }
+    generator.emit_break();
+    return {};
+}
+
+Optional<Bytecode::Register> ContinueStatement::generate_bytecode(Bytecode::Generator& generator) const
+{
+    if (!m_target_label.is_null()) {
+        generator.fail();
+        return {};
+    }
+    generator.emit_continue();
+    return {};
+}
+
+Optional<Bytecode::Register> IfStatement::generate_bytecode(Bytecode::Generator& generator) const
+{
+    auto predicate = m_predicate->generate_bytecode(generator);
+    if (generator.has_failed())
+        return {};
+
+    auto alternate_label = generator.make_label();
+    auto end_label = generator.make_label();
+    generator.emit_jump(Bytecode::Instruction::Type::JumpIfFalse, alternate_label, *predicate);
+    (void)m_consequent->generate_bytecode(generator);
+    generator.emit_jump(Bytecode::Instruction::Type::Jump, end_label);
+    generator.link_label(alternate_label);
+    if (m_alternate)
+        (void)m_alternate->generate_bytecode(generator);
+    generator.link_label(end_label);
+    return {};
+}
+
+Optional<Bytecode::Register> WhileStatement::generate_bytecode(Bytecode::Generator& generator) const
+{
+    auto test_label = generator.make_label();
+    auto end_label = generator.make_label();
+
+    generator.link_label(test_label);
+    auto test = m_test->generate_bytecode(generator);
+    if (generator.has_failed())
+        return {};
+    generator.emit_jump(Bytecode::Instruction::Type::JumpIfFalse, end_label, *test);
+
+    generator.begin_loop(end_label, test_label);
+    (void)m_body->generate_bytecode(generator);
+    generator.end_loop();
+    generator.emit_jump(Bytecode::Instruction::Type::Jump, test_label);
+
+    generator.link_label(end_label);
+    return {};
+}
+
+Optional<Bytecode::Register> DoWhileStatement::generate_bytecode(Bytecode::Generator& generator) const
+{
+    auto body_label = generator.make_label();
+    auto test_label = generator.make_label();
+    auto end_label = generator.make_label();
+
+    generator.link_label(body_label);
+    generator.begin_loop(end_label, test_label);
+    (void)m_body->generate_bytecode(generator);
+    generator.end_loop();
+
+    generator.link_label(test_label);
+    auto test = m_test->generate_bytecode(generator);
+    if (generator.has_failed())
+        return {};
+    generator.emit_jump(Bytecode::Instruction::Type::JumpIfTrue, body_label, *test);
+
+    generator.link_label(end_label);
+    return {};
+}
+
+Optional<Bytecode::Register> ForStatement::generate_bytecode(Bytecode::Generator& generator) const
+{
+    // NOTE: Like ForStatement::execute(), a let/const initializer gets a block scope around the whole loop.
+    bool has_lexical_init = m_init && is<VariableDeclaration>(*m_init) && static_cast<const VariableDeclaration&>(*m_init).declaration_kind() != DeclarationKind::Var;
+    if (has_lexical_init) {
+        auto wrapper = create_ast_node<BlockStatement>(source_range());
+        NonnullRefPtrVector<VariableDeclaration> decls;
+        decls.append(*static_cast<const VariableDeclaration*>(m_init.ptr()));
+        wrapper->add_variables(decls);
+        generator.enter_scope(generator.add_synthesized_scope(move(wrapper)));
+    }
+
+    if (m_init)
+        (void)m_init->generate_bytecode(generator);
+    if (generator.has_failed())
+        return {};
+
+    auto test_label = generator.make_label();
+    auto update_label = generator.make_label();
+    auto end_label = generator.make_label();
+
+    generator.link_label(test_label);
+    if (m_test) {
+        auto test = m_test->generate_bytecode(generator);
+        if (generator.has_failed())
+            return {};
+        generator.emit_jump(Bytecode::Instruction::Type::JumpIfFalse, end_label, *test);
+    }
+
+    generator.begin_loop(end_label, update_label);
+    (void)m_body->generate_bytecode(generator);
+    generator.end_loop();
+
+    generator.link_label(update_label);
+    if (m_update)
+        (void)m_update->generate_bytecode(generator);
+    generator.emit_jump(Bytecode::Instruction::Type::Jump, test_label);
+
+    generator.link_label(end_label);
+    if (has_lexical_init)
+        generator.leave_scope();
+    return {};
+}
+
+Optional<Bytecode::Register> NumericLiteral::generate_bytecode(Bytecode::Generator& generator) const
+{
+    return generator.emit_load(Value(m_value));
+}
+
+Optional<Bytecode::Register> BooleanLiteral::generate_bytecode(Bytecode::Generator& generator) const
+{
+    return generator.emit_load(Value(m_value));
+}
+
+Optional<Bytecode::Register> NullLiteral::generate_bytecode(Bytecode::Generator& generator) const
+{
+    return generator.emit_load(js_null());
+}
+
+Optional<Bytecode::Register> StringLiteral::generate_bytecode(Bytecode::Generator& generator) const
+{
+    auto dst = generator.allocate_register();
+    generator.emit(Bytecode::Instruction::Type::NewString, dst, {}, {}, generator.add_string(m_value));
+    return dst;
+}
+
+Optional<Bytecode::Register> Identifier::generate_bytecode(Bytecode::Generator& generator) const
+{
+    auto dst = generator.allocate_register();
+    generator.emit_get_variable(dst, m_string);
+    return dst;
+}
+
+Optional<Bytecode::Register> ThisExpression::generate_bytecode(Bytecode::Generator& generator) const
+{
+    auto dst = generator.allocate_register();
+    generator.emit(Bytecode::Instruction::Type::ResolveThis, dst);
+    return dst;
+}
+
+static Bytecode::Instruction::Type instruction_type_for(BinaryOp op)
+{
+    using Type = Bytecode::Instruction::Type;
+    switch (op) {
+    case BinaryOp::Addition:
+        return Type::Add;
+    case BinaryOp::Subtraction:
+        return Type::Sub;
+    case BinaryOp::Multiplication:
+        return Type::Mul;
+    case BinaryOp::Division:
+        return Type::Div;
+    case BinaryOp::Modulo:
+        return Type::Mod;
+    case BinaryOp::Exponentiation:
+        return Type::Exp;
+    case BinaryOp::TypedEquals:
+        return Type::StrictlyEquals;
+    case BinaryOp::TypedInequals:
+        return Type::StrictlyInequals;
+    case BinaryOp::AbstractEquals:
+        return Type::LooselyEquals;
+    case BinaryOp::AbstractInequals:
+        return Type::LooselyInequals;
+    case BinaryOp::GreaterThan:
+        return Type::GreaterThan;
+    case BinaryOp::GreaterThanEquals:
+        return Type::GreaterThanEquals;
+    case BinaryOp::LessThan:
+        return Type::LessThan;
+    case BinaryOp::LessThanEquals:
+        return Type::LessThanEquals;
+    case BinaryOp::BitwiseAnd:
+        return Type::BitwiseAnd;
+    case BinaryOp::BitwiseOr:
+        return Type::BitwiseOr;
+    case BinaryOp::BitwiseXor:
+        return Type::BitwiseXor;
+    case BinaryOp::LeftShift:
+        return Type::LeftShift;
+    case BinaryOp::RightShift:
+        return Type::RightShift;
+    case BinaryOp::UnsignedRightShift:
+        return Type::UnsignedRightShift;
+    case BinaryOp::In:
+        return Type::In;
+    case BinaryOp::InstanceOf:
+        return Type::InstanceOf;
+    }
+    VERIFY_NOT_REACHED();
+}
+
+// Returns the instruction for a compound assignment such as `+=`, or nothing for plain and logical assignments.
+static Optional<Bytecode::Instruction::Type> instruction_type_for(AssignmentOp op)
+{
+    switch (op) {
+    case AssignmentOp::AdditionAssignment:
+        return instruction_type_for(BinaryOp::Addition);
+    case AssignmentOp::SubtractionAssignment:
+        return instruction_type_for(BinaryOp::Subtraction);
+    case AssignmentOp::MultiplicationAssignment:
+        return instruction_type_for(BinaryOp::Multiplication);
+    case AssignmentOp::DivisionAssignment:
+        return instruction_type_for(BinaryOp::Division);
+    case AssignmentOp::ModuloAssignment:
+        return instruction_type_for(BinaryOp::Modulo);
+    case AssignmentOp::ExponentiationAssignment:
+        return instruction_type_for(BinaryOp::Exponentiation);
+    case AssignmentOp::BitwiseAndAssignment:
+        return instruction_type_for(BinaryOp::BitwiseAnd);
+    case AssignmentOp::BitwiseOrAssignment:
+        return instruction_type_for(BinaryOp::BitwiseOr);
+    case AssignmentOp::BitwiseXorAssignment:
+        return instruction_type_for(BinaryOp::BitwiseXor);
+    case AssignmentOp::LeftShiftAssignment:
+        return instruction_type_for(BinaryOp::LeftShift);
+    case AssignmentOp::RightShiftAssignment:
+        return instruction_type_for(BinaryOp::RightShift);
+    case AssignmentOp::UnsignedRightShiftAssignment:
+        return instruction_type_for(BinaryOp::UnsignedRightShift);
+    default:
+        return {};
+    }
+}
+
+Optional<Bytecode::Register> BinaryExpression::generate_bytecode(Bytecode::Generator& generator) const
+{
+    auto lhs = m_lhs->generate_bytecode(generator);
+    auto rhs = m_rhs->generate_bytecode(generator);
+    if (generator.has_failed())
+        return {};
+    auto dst = generator.allocate_register();
+    generator.emit(instruction_type_for(m_op), dst, *lhs, *rhs);
+    return dst;
+}
+
+Optional<Bytecode::Register> LogicalExpression::generate_bytecode(Bytecode::Generator& generator) const
+{
+    auto lhs = m_lhs->generate_bytecode(generator);
+    if (generator.has_failed())
+        return {};
+
+    auto dst = generator.allocate_register();
+    auto end_label = generator.make_label();
+    generator.emit(Bytecode::Instruction::Type::Move, dst, *lhs);
+    switch (m_op) {
+    case LogicalOp::And:
+        generator.emit_jump(Bytecode::Instruction::Type::JumpIfFalse, end_label, *lhs);
+        break;
+    case LogicalOp::Or:
+        generator.emit_jump(Bytecode::Instruction::Type::JumpIfTrue, end_label, *lhs);
+        break;
+    case LogicalOp::NullishCoalescing:
+        generator.emit_jump(Bytecode::Instruction::Type::JumpIfNotNullish, end_label, *lhs);
+        break;
+    }
+
+    auto rhs = m_rhs->generate_bytecode(generator);
+    if (generator.has_failed())
+        return {};
+    generator.emit(Bytecode::Instruction::Type::Move, dst, *rhs);
+    generator.link_label(end_label);
+    return dst;
+}
+
+Optional<Bytecode::Register> UnaryExpression::generate_bytecode(Bytecode::Generator& generator) const
+{
+    using Type = Bytecode::Instruction::Type;
+
+    // NOTE: typeof and delete look at references rather than values, leave them to the AST interpreter.
+    if (m_op == UnaryOp::Typeof || m_op == UnaryOp::Delete)
+        return generator.emit_evaluate(*this);
+
+    auto operand = m_lhs->generate_bytecode(generator);
+    if (generator.has_failed())
+        return {};
+
+    if (m_op == UnaryOp::Void)
+        return generator.emit_load(js_undefined());
+
+    auto dst = generator.allocate_register();
+    switch (m_op) {
+    case UnaryOp::BitwiseNot:
+        generator.emit(Type::BitwiseNot, dst, *operand);
+        break;
+    case UnaryOp::Not:
+        generator.emit(Type::Not, dst, *operand);
+        break;
+    case UnaryOp::Plus:
+        generator.emit(Type::UnaryPlus, dst, *operand);
+        break;
+    case UnaryOp::Minus:
+        generator.emit(Type::UnaryMinus, dst, *operand);
+        break;
+    default:
+        VERIFY_NOT_REACHED();
+    }
+    return dst;
+}
+
+Optional<Bytecode::Register> SequenceExpression::generate_bytecode(Bytecode::Generator& generator) const
+{
+    Optional<Bytecode::Register> last_value;
+    for (auto& expression : m_expressions) {
+        last_value = expression.generate_bytecode(generator);
+        if (generator.has_failed())
+            return {};
+    }
+    return last_value;
+}
+
+Optional<Bytecode::Register> ConditionalExpression::generate_bytecode(Bytecode::Generator& generator) const
+{
+    auto test = m_test->generate_bytecode(generator);
+    if (generator.has_failed())
+        return {};
+
+    auto dst = generator.allocate_register();
+    auto alternate_label = generator.make_label();
+    auto end_label = generator.make_label();
+    generator.emit_jump(Bytecode::Instruction::Type::JumpIfFalse, alternate_label, *test);
+
+    auto consequent = m_consequent->generate_bytecode(generator);
+    if (generator.has_failed())
+        return {};
+    generator.emit(Bytecode::Instruction::Type::Move, dst, *consequent);
+    generator.emit_jump(Bytecode::Instruction::Type::Jump, end_label);
+
+    generator.link_label(alternate_label);
+    auto alternate = m_alternate->generate_bytecode(generator);
+    if (generator.has_failed())
+        return {};
+    generator.emit(Bytecode::Instruction::Type::Move, dst, *alternate);
+
+    generator.link_label(end_label);
+    return dst;
+}
+
+Optional<Bytecode::Register> ArrayExpression::generate_bytecode(Bytecode::Generator& generator) const
+{
+    for (auto& element : m_elements) {
+        if (!element || is<SpreadExpression>(*element))
+            return generator.emit_evaluate(*this);
+    }
+
+    Vector<Bytecode::Register> elements;
+    elements.ensure_capacity(m_elements.size());
+    for (auto& element : m_elements) {
+        auto value = element->generate_bytecode(generator);
+        if (generator.has_failed())
+            return {};
+        elements.append(*value);
+    }
+    auto dst = generator.allocate_register();
+    generator.emit(Bytecode::Instruction::Type::NewArray, dst, {}, {}, generator.add_register_list(move(elements)));
+    return dst;
+}
+
+// A property access whose base and key have already been evaluated into registers.
+struct MemberReference {
+    Bytecode::Register base;
+    Optional<Bytecode::Register> computed_key;
+    const FlyString* identifier { nullptr };
+};
+
+static Optional<MemberReference> generate_member_reference(Bytecode::Generator& generator, const MemberExpression& expression)
+{
+    auto base = expression.object().generate_bytecode(generator);
+    if (generator.has_failed())
+        return {};
+    if (!expression.is_computed())
+        return MemberReference { *base, {}, &static_cast<const Identifier&>(expression.property()).string() };
+    auto key = expression.property().generate_bytecode(generator);
+    if (generator.has_failed())
+        return {};
+    return MemberReference { *base, key };
+}
+
+static Bytecode::Register generate_get(Bytecode::Generator& generator, const MemberReference& reference)
+{
+    auto dst = generator.allocate_register();
+    if (reference.computed_key.has_value())
+        generator.emit(Bytecode::Instruction::Type::GetByValue, dst, reference.base, *reference.computed_key);
+    else
+        generator.emit(Bytecode::Instruction::Type::GetById, dst, reference.base, {}, generator.add_property_site(*reference.identifier));
+    return dst;
+}
+
+static void generate_put(Bytecode::Generator& generator, const MemberReference& reference, Bytecode::Register value)
+{
+    if (reference.computed_key.has_value())
+        generator.emit(Bytecode::Instruction::Type::PutByValue, reference.base, *reference.computed_key, value);
+    else
+        generator.emit(Bytecode::Instruction::Type::PutById, reference.base, value, {}, generator.add_property_site(*reference.identifier));
+}
+
+Optional<Bytecode::Register> MemberExpression::generate_bytecode(Bytecode::Generator& generator) const
+{
+    if (is<SuperExpression>(*m_object))
+        return generator.emit_evaluate(*this);
+
+    auto reference = generate_member_reference(generator, *this);
+    if (generator.has_failed())
+        return {};
+    return generate_get(generator, *reference);
+}
+
+Optional<Bytecode::Register> AssignmentExpression::generate_bytecode(Bytecode::Generator& generator) const
+{
+    using Type = Bytecode::Instruction::Type;
+
+    bool is_identifier = is<Identifier>(*m_lhs);
+    bool is_member = is<MemberExpression>(*m_lhs) && !is<SuperExpression>(static_cast<const MemberExpression&>(*m_lhs).object());
+    if (!is_identifier && !is_member)
+        return generator.emit_evaluate(*this);
+
+    Optional<MemberReference> member_reference;
+    const FlyString* identifier = nullptr;
+    if (is_member) {
+        member_reference = generate_member_reference(generator, static_cast<const MemberExpression&>(*m_lhs));
+        if (generator.has_failed())
+            return {};
+    } else {
+        identifier = &static_cast<const Identifier&>(*m_lhs).string();
+    }
+
+    auto generate_store = [&](Bytecode::Register value) {
+        if (is_member)
+            generate_put(generator, *member_reference, value);
+        else
+            generator.emit_set_variable(value, *identifier);
+    };
+
+    if (m_op == AssignmentOp::Assignment) {
+        auto rhs = m_rhs->generate_bytecode(generator);
+        if (generator.has_failed())
+            return {};
+        generate_store(*rhs);
+        return rhs;
+    }
+
+    Bytecode::Register lhs;
+    if (is_member) {
+        lhs = generate_get(generator, *member_reference);
+    } else {
+        lhs = generator.allocate_register();
+        generator.emit_get_variable(lhs, *identifier);
+    }
+
+    if (auto binary_type = instruction_type_for(m_op); binary_type.has_value()) {
+        auto rhs = m_rhs->generate_bytecode(generator);
+        if (generator.has_failed())
+            return {};
+        auto dst = generator.allocate_register();
+        generator.emit(*binary_type, dst, lhs, *rhs);
+        generate_store(dst);
+        return dst;
+    }
+
+    // Logical assignment only evaluates and stores the right hand side if the left hand side doesn't short-circuit.
+    auto dst = generator.allocate_register();
+    auto end_label = generator.make_label();
+    generator.emit(Type::Move, dst, lhs);
+    switch (m_op) {
+    case AssignmentOp::AndAssignment:
+        generator.emit_jump(Type::JumpIfFalse, end_label, lhs);
+        break;
+    case AssignmentOp::OrAssignment:
+        generator.emit_jump(Type::JumpIfTrue, end_label, lhs);
+        break;
+    case AssignmentOp::NullishAssignment:
+        generator.emit_jump(Type::JumpIfNotNullish, end_label, lhs);
+        break;
+    default:
+        VERIFY_NOT_REACHED();
+    }
+    auto rhs = m_rhs->generate_bytecode(generator);
+    if (generator.has_failed())
+        return {};
+    generate_store(*rhs);
+    generator.emit(Type::Move, dst, *rhs);
+    generator.link_label(end_label);
+    return dst;
+}
+
+Optional<Bytecode::Register> UpdateExpression::generate_bytecode(Bytecode::Generator& generator) const
+{
+    using Type = Bytecode::Instruction::Type;
+
+    bool is_identifier = is<Identifier>(*m_argument);
+    bool is_member = is<MemberExpression>(*m_argument) && !is<SuperExpression>(static_cast<const MemberExpression&>(*m_argument).object());
+    if (!is_identifier && !is_member)
+        return generator.emit_evaluate(*this);
+
+    Optional<MemberReference> member_reference;
+    const FlyString* identifier = nullptr;
+    Bytecode::Register old_value;
+    if (is_member) {
+        member_reference = generate_member_reference(generator, static_cast<const MemberExpression&>(*m_argument));
+        if (generator.has_failed())
+            return {};
+        old_value = generate_get(generator, *member_reference);
+    } else {
+        identifier = &static_cast<const Identifier&>(*m_argument).string();
+        old_value = generator.allocate_register();
+        generator.emit_get_variable(old_value, *identifier);
+    }
+
+    auto old_numeric_value = generator.allocate_register();
+    generator.emit(Type::ToNumeric, old_numeric_value, old_value);
+    auto new_value = generator.allocate_register();
+    generator.emit(m_op == UpdateOp::Increment ? Type::Increment : Type::Decrement, new_value, old_numeric_value);
+
+    if (is_member)
+        generate_put(generator, *member_reference, new_value);
+    else
+        generator.emit_set_variable(new_value, *identifier);
+
+    return m_prefixed ? new_value : old_numeric_value;
+}
+
+Optional<Bytecode::Register> CallExpression::generate_bytecode(Bytecode::Generator& generator) const
+{
+    using Type = Bytecode::Instruction::Type;
+
+    bool is_super_call = is<SuperExpression>(*m_callee);
+    bool is_super_property_call = is<MemberExpression>(*m_callee) && is<SuperExpression>(static_cast<const MemberExpression&>(*m_callee).object());
+    if (is_super_call || is_super_property_call)
+        return generator.emit_evaluate(*this);
+    for (auto& argument : m_arguments) {
+        if (argument.is_spread)
+            return generator.emit_evaluate(*this);
+    }
+
+    bool is_new = is<NewExpression>(*this);
+    Optional<Bytecode::Register> callee;
+    Bytecode::Register this_value;
+    if (!is_new && is<MemberExpression>(*m_callee)) {
+        // NOTE: Like compute_this_and_callee(), the base object is boxed before the property key is evaluated.
+        auto& member_expression = static_cast<const MemberExpression&>(*m_callee);
+        auto base = member_expression.object().generate_bytecode(generator);
+        if (generator.has_failed())
+            return {};
+        this_value = generator.allocate_register();
+        generator.emit(Type::ToObject, this_value, *base);
+        callee = generator.allocate_register();
+        if (member_expression.is_computed()) {
+            auto key = member_expression.property().generate_bytecode(generator);
+            if (generator.has_failed())
+                return {};
+            generator.emit(Type::GetByValue, *callee, this_value, *key);
+        } else {
+            generator.emit(Type::GetById, *callee, this_value, {}, generator.add_property_site(static_cast<const Identifier&>(member_expression.property()).string()));
+        }
+    } else {
+        callee = m_callee->generate_bytecode(generator);
+        if (generator.has_failed())
+            return {};
+        this_value = generator.allocate_register();
+        if (!is_new)
+            generator.emit(Type::LoadGlobalObject, this_value);
+    }
+
+    Vector<Bytecode::Register> arguments;
+    arguments.ensure_capacity(m_arguments.size());
+    for (auto& argument : m_arguments) {
+        auto value = argument.value->generate_bytecode(generator);
+        if (generator.has_failed())
+            return {};
+        arguments.append(*value);
+    }
+
+    auto dst = generator.allocate_register();
+    generator.emit(is_new ? Type::Construct : Type::Call, dst, *callee, this_value, generator.add_call_site(*this, move(arguments)));
+    return dst;
+}
+
+}
@@ -0,0 +1,49 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <AK/Format.h>
+#include <LibJS/Bytecode/Executable.h>
+
+namespace JS::Bytecode {
+
+void Executable::dump() const
+{
+    outln("Executable: {} instruction(s), {} register(s)", instructions.size(), register_count);
+    for (size_t i = 0; i < instructions.size(); ++i)
+        outln("[{:4}] {}", i, instructions[i].to_string());
+    for (size_t i = 0; i < identifiers.size(); ++i)
+        outln("identifiers[{}] = {}", i, identifiers[i]);
+    for (size_t i = 0; i < property_sites.size(); ++i)
+        outln("property_sites[{}] = {}", i, identifiers[property_sites[i].identifier]);
+    for (size_t i = 0; i < locals.size(); ++i)
+        outln("locals[{}] = {} (depth {}, slot {})", i, identifiers[locals[i].identifier], locals[i].depth, locals[i].slot);
+    for (size_t i = 0; i < strings.size(); ++i)
+        outln("strings[{}] = \"{}\"", i, strings[i]);
+    for (size_t i = 0; i < nodes.size(); ++i)
+        outln("nodes[{}] = {}", i, nodes[i]->class_name());
+}
+
+}
@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/FlyString.h>
+#include <AK/NonnullRefPtrVector.h>
+#include <AK/String.h>
+#include <AK/Vector.h>
+#include <LibJS/AST.h>
+#include <LibJS/Bytecode/Instruction.h>
+#include <LibJS/Bytecode/Register.h>
+#include <LibJS/Runtime/Shape.h>
+#include <LibJS/Runtime/Value.h>
+
+namespace JS::Bytecode {
+
+// A binding resolved at compile time: slot `slot` of the environment `depth` hops up the scope
+// chain from the current one. The identifier is kept for error messages and function names.
+struct Local {
+    u32 depth { 0 };
+    u32 slot { 0 };
+    u32 identifier { 0 };
+};
+
+// Remembers where a property was found for the last few shapes seen at a GetById or PutById,
+// so that hitting one of those shapes again can skip the property table lookup. Shapes that
+// are never modified in place are the only ones cached: a different layout means a different
+// shape, and so does a different prototype.
+struct PropertyCache {
+    static constexpr size_t entry_count = 4;
+
+    struct Entry {
+        WeakPtr<Shape> shape;
+        // The shape of the prototype, if that's where the property was found.
+        WeakPtr<Shape> prototype_shape;
+        u32 offset { 0 };
+        bool is_on_prototype { false };
+    };
+
+    Entry entries[entry_count];
+    u8 next_entry { 0 };
+};
+
+struct PropertySite {
+    u32 identifier { 0 };
+    PropertyCache cache;
+};
+
+struct CallSite {
+    const CallExpression* expression { nullptr };
+    Vector<Register> arguments;
+};
+
+// The compiled form of a function body. It refers back into the AST it was generated from,
+// which must therefore outlive it; ScopeNode owns the Executable for exactly that reason.
+class Executable {
+public:
+    void dump() const;
+
+    Vector<Instruction> instructions;
+    size_t register_count { 0 };
+
+    // NOTE: Constants are never cells, so the Executable doesn't need to be visited by the GC.
+    Vector<Value> constants;
+    Vector<String> strings;
+    Vector<FlyString> identifiers;
+    Vector<Local> locals;
+    // NOTE: The property caches are filled in while the executable runs.
+    mutable Vector<PropertySite> property_sites;
+    Vector<const ASTNode*> nodes;
+    Vector<CallSite> call_sites;
+    Vector<Vector<Register>> register_lists;
+
+    // Scopes that the AST interpreter would have synthesized on the fly, e.g. for `for (let ...)`.
+    NonnullRefPtrVector<ScopeNode> synthesized_scopes;
+};
+
+}
@@ -0,0 +1,273 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <LibJS/AST.h>
+#include <LibJS/Bytecode/Generator.h>
+#include <LibJS/Runtime/LexicalEnvironment.h>
+
+namespace JS::Bytecode {
+
+Generator::Generator()
+    : m_executable(make<Executable>())
+{
+}
+
+OwnPtr<Executable> Generator::generate(const ScopeNode& function_body)
+{
+    Generator generator;
+    // NOTE: The body's own declarations are set up by the caller, exactly like the AST interpreter does for function scopes.
+    VERIFY(function_body.function_environment_layout());
+    generator.m_environments.append(function_body.function_environment_layout());
+    for (auto& child : function_body.children()) {
+        (void)child.generate_bytecode(generator);
+        if (generator.has_failed())
+            return {};
+    }
+    auto undefined = generator.emit_load(js_undefined());
+    generator.emit(Instruction::Type::Return, {}, undefined);
+
+    generator.unresolve_dynamic_bindings();
+
+    auto& executable = *generator.m_executable;
+    for (auto jump_index : generator.m_jumps) {
+        auto& jump = executable.instructions[jump_index];
+        auto target = generator.m_label_targets[jump.operand];
+        VERIFY(target.has_value());
+        jump.operand = target.value();
+    }
+    return move(generator.m_executable);
+}
+
+Register Generator::allocate_register()
+{
+    return Register(m_executable->register_count++);
+}
+
+void Generator::emit(Instruction::Type type, Register dst, Register lhs, Register rhs, u32 operand)
+{
+    m_executable->instructions.append({ type, dst, lhs, rhs, operand });
+}
+
+void Generator::emit_jump(Instruction::Type type, Label target, Register condition)
+{
+    m_jumps.append(m_executable->instructions.size());
+    emit(type, {}, condition, {}, target.index());
+}
+
+Label Generator::make_label()
+{
+    m_label_targets.append(Optional<u32> {});
+    return Label(m_label_targets.size() - 1);
+}
+
+void Generator::link_label(Label label)
+{
+    VERIFY(!m_label_targets[label.index()].has_value());
+    m_label_targets[label.index()] = m_executable->instructions.size();
+}
+
+u32 Generator::add_constant(Value value)
+{
+    VERIFY(!value.is_cell());
+    m_executable->constants.append(value);
+    return m_executable->constants.size() - 1;
+}
+
+u32 Generator::add_string(const String& string)
+{
+    m_executable->strings.append(string);
+    return m_executable->strings.size() - 1;
+}
+
+u32 Generator::add_identifier(const FlyString& identifier)
+{
+    if (auto it = m_identifier_indices.find(identifier); it != m_identifier_indices.end())
+        return it->value;
+    m_executable->identifiers.append(identifier);
+    auto index = m_executable->identifiers.size() - 1;
+    m_identifier_indices.set(identifier, index);
+    return index;
+}
+
+u32 Generator::add_property_site(const FlyString& name)
+{
+    m_executable->property_sites.append({ add_identifier(name), {} });
+    return m_executable->property_sites.size() - 1;
+}
+
+u32 Generator::add_node(const ASTNode& node)
+{
+    m_executable->nodes.append(&node);
+    return m_executable->nodes.size() - 1;
+}
+
+u32 Generator::add_call_site(const CallExpression& expression, Vector<Register> arguments)
+{
+    m_executable->call_sites.append({ &expression, move(arguments) });
+    return m_executable->call_sites.size() - 1;
+}
+
+u32 Generator::add_register_list(Vector<Register> registers)
+{
+    m_executable->register_lists.append(move(registers));
+    return m_executable->register_lists.size() - 1;
+}
+
+const ScopeNode& Generator::add_synthesized_scope(NonnullRefPtr<ScopeNode> scope)
+{
+    m_executable->synthesized_scopes.append(move(scope));
+    return m_executable->synthesized_scopes.last();
+}
+
+Register Generator::emit_load(Value value)
+{
+    auto dst = allocate_register();
+    emit(Instruction::Type::Load, dst, {}, {}, add_constant(value));
+    return dst;
+}
+
+Register Generator::emit_evaluate(const ASTNode& node)
+{
+    auto dst = allocate_register();
+    emit(Instruction::Type::Evaluate, dst, {}, {}, add_node(node));
+    return dst;
+}
+
+void Generator::emit_get_variable(Register dst, const FlyString& name)
+{
+    if (auto local = resolve_local(name); local.has_value())
+        emit(Instruction::Type::GetLocal, dst, {}, {}, local.value());
+    else
+        emit(Instruction::Type::GetVariable, dst, {}, {}, add_identifier(name));
+}
+
+void Generator::emit_set_variable(Register value, const FlyString& name, bool is_initialization)
+{
+    if (auto local = resolve_local(name); local.has_value())
+        emit(is_initialization ? Instruction::Type::InitializeLocal : Instruction::Type::SetLocal, {}, value, {}, local.value());
+    else
+        emit(is_initialization ? Instruction::Type::InitializeVariable : Instruction::Type::SetVariable, {}, value, {}, add_identifier(name));
+}
+
+Optional<u32> Generator::resolve_local(const FlyString& name)
+{
+    // NOTE: VM::get_variable() has special handling for "arguments" that only looks at the innermost scope.
+    if (name == "arguments")
+        return {};
+    for (size_t i = m_environments.size(); i > 0; --i) {
+        auto slot = m_environments[i - 1]->slot_for(name);
+        if (!slot.has_value())
+            continue;
+        m_executable->locals.append({ static_cast<u32>(m_environments.size() - i), slot.value(), add_identifier(name) });
+        return m_executable->locals.size() - 1;
+    }
+    return {};
+}
+
+void Generator::unresolve_dynamic_bindings()
+{
+    if (m_dynamic_bindings.is_empty())
+        return;
+    for (auto& instruction : m_executable->instructions) {
+        Instruction::Type by_name;
+        switch (instruction.type) {
+        case Instruction::Type::GetLocal:
+            by_name = Instruction::Type::GetVariable;
+            break;
+        case Instruction::Type::SetLocal:
+            by_name = Instruction::Type::SetVariable;
+            break;
+        case Instruction::Type::InitializeLocal:
+            by_name = Instruction::Type::InitializeVariable;
+            break;
+        default:
+            continue;
+        }
+        auto identifier = m_executable->locals[instruction.operand].identifier;
+        if (!m_dynamic_bindings.contains(m_executable->identifiers[identifier]))
+            continue;
+        instruction.type = by_name;
+        instruction.operand = identifier;
+    }
+}
+
+void Generator::enter_scope(const ScopeNode& scope)
+{
+    emit(Instruction::Type::EnterScope, {}, {}, {}, add_node(scope));
+    m_scopes.append(&scope);
+    // Interpreter::enter_scope() only pushes an environment for blocks that declare something.
+    if (!scope.variables().is_empty())
+        m_environments.append(&scope.block_environment_layout());
+}
+
+void Generator::leave_scope()
+{
+    auto& scope = *m_scopes.take_last();
+    emit(Instruction::Type::LeaveScope, {}, {}, {}, add_node(scope));
+    if (!scope.variables().is_empty())
+        m_environments.take_last();
+}
+
+void Generator::leave_scopes_down_to(size_t depth)
+{
+    // Interpreter::exit_scope() pops every scope above the one it is given, so leaving the outermost one is enough.
+    if (m_scopes.size() > depth)
+        emit(Instruction::Type::LeaveScope, {}, {}, {}, add_node(*m_scopes[depth]));
+}
+
+void Generator::begin_loop(Label break_target, Label continue_target)
+{
+    m_loops.append({ break_target, continue_target, m_scopes.size() });
+}
+
+void Generator::end_loop()
+{
+    m_loops.take_last();
+}
+
+void Generator::emit_break()
+{
+    if (m_loops.is_empty()) {
+        fail();
+        return;
+    }
+    auto& loop = m_loops.last();
+    leave_scopes_down_to(loop.scope_depth);
+    emit_jump(Instruction::Type::Jump, loop.break_target);
+}
+
+void Generator::emit_continue()
+{
+    if (m_loops.is_empty()) {
+        fail();
+        return;
+    }
+    auto& loop = m_loops.last();
+    leave_scopes_down_to(loop.scope_depth);
+    emit_jump(Instruction::Type::Jump, loop.continue_target);
+}
+
+}
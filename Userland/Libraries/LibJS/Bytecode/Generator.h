@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/HashMap.h>
+#include <AK/HashTable.h>
+#include <AK/OwnPtr.h>
+#include <AK/Vector.h>
+#include <LibJS/Bytecode/Executable.h>
+#include <LibJS/Bytecode/Label.h>
+#include <LibJS/Bytecode/Register.h>
+#include <LibJS/Forward.h>
+
+namespace JS::Bytecode {
+
+class Generator {
+public:
+    // Returns null if the body uses something the bytecode tier doesn't handle yet,
+    // in which case the function keeps running on the AST interpreter.
+    static OwnPtr<Executable> generate(const ScopeNode& function_body);
+
+    Register allocate_register();
+
+    void emit(Instruction::Type, Register dst = {}, Register lhs = {}, Register rhs = {}, u32 operand = 0);
+    void emit_jump(Instruction::Type, Label target, Register condition = {});
+
+    Label make_label();
+    void link_label(Label);
+
+    u32 add_constant(Value);
+    u32 add_string(const String&);
+    u32 add_identifier(const FlyString&);
+    u32 add_property_site(const FlyString&);
+    u32 add_node(const ASTNode&);
+    u32 add_call_site(const CallExpression&, Vector<Register> arguments);
+    u32 add_register_list(Vector<Register>);
+    const ScopeNode& add_synthesized_scope(NonnullRefPtr<ScopeNode>);
+
+    Register emit_load(Value);
+    Register emit_evaluate(const ASTNode&);
+
+    // Names declared by the function or by a block inside it are resolved to an environment slot,
+    // everything else is looked up by name at runtime.
+    void emit_get_variable(Register dst, const FlyString&);
+    void emit_set_variable(Register value, const FlyString&, bool is_initialization = false);
+
+    // For names that get bound at runtime in whatever environment is current, e.g. by a class
+    // declaration. Those may shadow a slot, so every access to them is done by name instead.
+    void add_dynamic_binding(const FlyString& name) { m_dynamic_bindings.set(name); }
+
+    // Blocks with declarations push a scope just like Interpreter::enter_scope() does.
+    // Break and continue leave any scopes entered since the loop they target began.
+    void enter_scope(const ScopeNode&);
+    void leave_scope();
+
+    void begin_loop(Label break_target, Label continue_target);
+    void end_loop();
+    void emit_break();
+    void emit_continue();
+
+    void fail() { m_failed = true; }
+    bool has_failed() const { return m_failed; }
+
+private:
+    Generator();
+
+    struct LoopContext {
+        Label break_target;
+        Label continue_target;
+        size_t scope_depth { 0 };
+    };
+
+    void leave_scopes_down_to(size_t depth);
+    Optional<u32> resolve_local(const FlyString&);
+    void unresolve_dynamic_bindings();
+
+    NonnullOwnPtr<Executable> m_executable;
+    Vector<Optional<u32>> m_label_targets;
+    Vector<size_t> m_jumps;
+    Vector<const ScopeNode*> m_scopes;
+    // The environments the code being generated runs in, innermost last.
+    Vector<const EnvironmentLayout*> m_environments;
+    HashTable<FlyString> m_dynamic_bindings;
+    Vector<LoopContext> m_loops;
+    HashMap<FlyString, u32> m_identifier_indices;
+    bool m_failed { false };
+};
+
+}
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2019-2020, Sergey Bugaev <bugaevc@serenityos.org>
+ * Copyright (c) 2021, the SerenityOS developers
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -24,51 +24,27 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
-#include <AK/Queue.h>
-#include <LibThread/BackgroundAction.h>
-#include <LibThread/Lock.h>
-#include <LibThread/Thread.h>
 
-static LibThread::Lockable<Queue<Function<void()>>>* s_all_actions;
-static LibThread::Thread* s_background_thread;
+#include <AK/String.h>
+#include <LibJS/Bytecode/Instruction.h>
 
-static int background_thread_func()
-{
-    while (true) {
-        Function<void()> work_item;
-        {
-            LOCKER(s_all_actions->lock());
+namespace JS::Bytecode {
 
-            if (!s_all_actions->resource().is_empty())
-                work_item = s_all_actions->resource().dequeue();
-        }
-        if (work_item)
-            work_item();
-        else
-            sleep(1);
+const char* Instruction::type_to_string(Type type)
+{
+    switch (type) {
+#define __ENUMERATE_BYTECODE_OPCODE(name, description) \
+    case Type::name:                                   \
+        return #name;
+        JS_ENUMERATE_BYTECODE_OPCODES(__ENUMERATE_BYTECODE_OPCODE)
+#undef __ENUMERATE_BYTECODE_OPCODE
     }
-
     VERIFY_NOT_REACHED();
 }
 
-static void init()
+String Instruction::to_string() const
 {
-    s_all_actions = new LibThread::Lockable<Queue<Function<void()>>>();
-    s_background_thread = &LibThread::Thread::construct(background_thread_func).leak_ref();
-    s_background_thread->set_name("Background thread");
-    s_background_thread->start();
+    return String::formatted("{} dst:{} lhs:{} rhs:{} operand:{}", type_to_string(type), dst, lhs, rhs, operand);
 }
 
-LibThread::Lockable<Queue<Function<void()>>>& LibThread::BackgroundActionBase::all_actions()
-{
-    if (s_all_actions == nullptr)
-        init();
-    return *s_all_actions;
-}
-
-LibThread::Thread& LibThread::BackgroundActionBase::background_thread()
-{
-    if (s_background_thread == nullptr)
-        init();
-    return *s_background_thread;
 }
@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/String.h>
+#include <AK/Types.h>
+#include <LibJS/Bytecode/Register.h>
+
+// Every instruction has the same shape: up to three registers and one immediate operand.
+// For loads and arithmetic, `dst` receives the result; for stores, `dst` is the thing being
+// written to. The immediate indexes one of the Executable's tables, or is a jump target.
+#define JS_ENUMERATE_BYTECODE_OPCODES(M)                                              \
+    M(Load, "dst <- constants[operand]")                                              \
+    M(NewString, "dst <- strings[operand]")                                           \
+    M(NewArray, "dst <- [register_lists[operand]...]")                                \
+    M(Move, "dst <- lhs")                                                             \
+    M(GetVariable, "dst <- identifiers[operand]")                                     \
+    M(SetVariable, "identifiers[operand] <- lhs")                                     \
+    M(InitializeVariable, "identifiers[operand] <- lhs, ignoring const")              \
+    M(GetLocal, "dst <- locals[operand]")                                             \
+    M(SetLocal, "locals[operand] <- lhs")                                             \
+    M(InitializeLocal, "locals[operand] <- lhs, ignoring const")                      \
+    M(GetById, "dst <- lhs.property_sites[operand]")                                  \
+    M(GetByValue, "dst <- lhs[rhs]")                                                  \
+    M(PutById, "dst.property_sites[operand] <- lhs")                                  \
+    M(PutByValue, "dst[lhs] <- rhs")                                                  \
+    M(ToObject, "dst <- ToObject(lhs)")                                               \
+    M(ToNumeric, "dst <- ToNumeric(lhs)")                                             \
+    M(Increment, "dst <- lhs + 1, lhs is numeric")                                    \
+    M(Decrement, "dst <- lhs - 1, lhs is numeric")                                    \
+    M(Add, "dst <- lhs + rhs")                                                        \
+    M(Sub, "dst <- lhs - rhs")                                                        \
+    M(Mul, "dst <- lhs * rhs")                                                        \
+    M(Div, "dst <- lhs / rhs")                                                        \
+    M(Mod, "dst <- lhs % rhs")                                                        \
+    M(Exp, "dst <- lhs ** rhs")                                                       \
+    M(StrictlyEquals, "dst <- lhs === rhs")                                           \
+    M(StrictlyInequals, "dst <- lhs !== rhs")                                         \
+    M(LooselyEquals, "dst <- lhs == rhs")                                             \
+    M(LooselyInequals, "dst <- lhs != rhs")                                           \
+    M(GreaterThan, "dst <- lhs > rhs")                                                \
+    M(GreaterThanEquals, "dst <- lhs >= rhs")                                         \
+    M(LessThan, "dst <- lhs < rhs")                                                   \
+    M(LessThanEquals, "dst <- lhs <= rhs")                                            \
+    M(BitwiseAnd, "dst <- lhs & rhs")                                                 \
+    M(BitwiseOr, "dst <- lhs | rhs")                                                  \
+    M(BitwiseXor, "dst <- lhs ^ rhs")                                                 \
+    M(LeftShift, "dst <- lhs << rhs")                                                 \
+    M(RightShift, "dst <- lhs >> rhs")                                                \
+    M(UnsignedRightShift, "dst <- lhs >>> rhs")                                       \
+    M(In, "dst <- lhs in rhs")                                                        \
+    M(InstanceOf, "dst <- lhs instanceof rhs")                                        \
+    M(Not, "dst <- !lhs")                                                             \
+    M(BitwiseNot, "dst <- ~lhs")                                                      \
+    M(UnaryPlus, "dst <- +lhs")                                                       \
+    M(UnaryMinus, "dst <- -lhs")                                                      \
+    M(ResolveThis, "dst <- this")                                                     \
+    M(LoadGlobalObject, "dst <- the global object")                                   \
+    M(Evaluate, "dst <- result of running nodes[operand] on the AST interpreter")     \
+    M(Jump, "goto operand")                                                           \
+    M(JumpIfTrue, "if lhs is truthy goto operand")                                    \
+    M(JumpIfFalse, "if lhs is falsy goto operand")                                    \
+    M(JumpIfNullish, "if lhs is null or undefined goto operand")                      \
+    M(JumpIfNotNullish, "if lhs is neither null nor undefined goto operand")          \
+    M(Call, "dst <- lhs.call(rhs, call_sites[operand].arguments...)")                 \
+    M(Construct, "dst <- new lhs(call_sites[operand].arguments...)")                  \
+    M(EnterScope, "push a scope for the declarations of nodes[operand]")              \
+    M(LeaveScope, "pop scopes up to and including the one pushed for nodes[operand]") \
+    M(Throw, "throw lhs, nodes[operand] is the throw statement")                      \
+    M(Return, "return lhs")
+
+namespace JS::Bytecode {
+
+struct Instruction {
+    enum class Type : u8 {
+#define __ENUMERATE_BYTECODE_OPCODE(name, description) name,
+        JS_ENUMERATE_BYTECODE_OPCODES(__ENUMERATE_BYTECODE_OPCODE)
+#undef __ENUMERATE_BYTECODE_OPCODE
+    };
+
+    static const char* type_to_string(Type);
+
+    String to_string() const;
+
+    Type type;
+    Register dst;
+    Register lhs;
+    Register rhs;
+    u32 operand { 0 };
+};
+
+}
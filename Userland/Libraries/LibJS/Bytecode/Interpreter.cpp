@@ -0,0 +1,451 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <LibCrypto/BigInt/SignedBigInteger.h>
+#include <LibJS/AST.h>
+#include <LibJS/Bytecode/Interpreter.h>
+#include <LibJS/Interpreter.h>
+#include <LibJS/Runtime/Array.h>
+#include <LibJS/Runtime/BigInt.h>
+#include <LibJS/Runtime/Error.h>
+#include <LibJS/Runtime/GlobalObject.h>
+#include <LibJS/Runtime/LexicalEnvironment.h>
+#include <LibJS/Runtime/MarkedValueList.h>
+#include <LibJS/Runtime/NativeFunction.h>
+#include <LibJS/Runtime/PrimitiveString.h>
+#include <LibJS/Runtime/Shape.h>
+
+namespace JS::Bytecode {
+
+Interpreter::Interpreter(JS::Interpreter& interpreter, GlobalObject& global_object)
+    : m_interpreter(interpreter)
+    , m_global_object(global_object)
+{
+}
+
+static Value increment_or_decrement(GlobalObject& global_object, Value value, i32 delta)
+{
+    if (value.is_number())
+        return Value(value.as_double() + delta);
+    return js_bigint(global_object.heap(), value.as_bigint().big_integer().plus(Crypto::SignedBigInteger { delta }));
+}
+
+static LexicalEnvironment& local_environment(VM& vm, const Local& local)
+{
+    // NOTE: The generator only resolves names to environments it pushed itself, so these are all LexicalEnvironments.
+    auto* scope = vm.current_scope();
+    for (u32 i = 0; i < local.depth; ++i)
+        scope = scope->parent();
+    return static_cast<LexicalEnvironment&>(*scope);
+}
+
+static Optional<Value> cached_get(VM& vm, const PropertyCache& cache, const Object& object)
+{
+    auto* shape = &object.shape();
+    for (auto& entry : cache.entries) {
+        if (entry.shape.ptr() != shape)
+            continue;
+        auto* holder = &object;
+        if (entry.is_on_prototype) {
+            holder = shape->prototype();
+            if (!holder || entry.prototype_shape.ptr() != &holder->shape())
+                continue;
+        }
+        // NOTE: Redefining a property as a native one keeps the shape, so look before using the value.
+        auto value = holder->get_direct(entry.offset);
+        if (value.is_accessor() || value.is_native_property())
+            break;
+        ++vm.property_cache_statistics().get_hits;
+        return value.value_or(js_undefined());
+    }
+    ++vm.property_cache_statistics().get_misses;
+    return {};
+}
+
+static void update_get_cache(PropertyCache& cache, const Object& object, const FlyString& name)
+{
+    auto& shape = object.shape();
+    if (shape.is_unique())
+        return;
+    auto* holder = &object;
+    auto metadata = shape.lookup(name);
+    if (!metadata.has_value()) {
+        holder = shape.prototype();
+        if (!holder || holder->shape().is_unique())
+            return;
+        metadata = holder->shape().lookup(name);
+        if (!metadata.has_value())
+            return;
+    }
+    auto value = holder->get_direct(metadata.value().offset);
+    if (value.is_accessor() || value.is_native_property())
+        return;
+    auto& entry = cache.entries[cache.next_entry];
+    entry.shape = shape.make_weak_ptr();
+    entry.is_on_prototype = holder != &object;
+    if (entry.is_on_prototype)
+        entry.prototype_shape = holder->shape().make_weak_ptr();
+    else
+        entry.prototype_shape = nullptr;
+    entry.offset = metadata.value().offset;
+    cache.next_entry = (cache.next_entry + 1) % PropertyCache::entry_count;
+}
+
+// Only writes to an existing, writable data property of the object itself are cached.
+static bool cached_put(VM& vm, const PropertyCache& cache, Object& object, Value value)
+{
+    auto* shape = &object.shape();
+    for (auto& entry : cache.entries) {
+        if (entry.shape.ptr() != shape)
+            continue;
+        auto old_value = object.get_direct(entry.offset);
+        if (old_value.is_accessor() || old_value.is_native_property())
+            break;
+        object.put_direct(entry.offset, value);
+        ++vm.property_cache_statistics().put_hits;
+        return true;
+    }
+    ++vm.property_cache_statistics().put_misses;
+    return false;
+}
+
+static void update_put_cache(PropertyCache& cache, const Object& object, const FlyString& name)
+{
+    auto& shape = object.shape();
+    if (shape.is_unique())
+        return;
+    auto metadata = shape.lookup(name);
+    if (!metadata.has_value() || !metadata.value().attributes.is_writable())
+        return;
+    auto value = object.get_direct(metadata.value().offset);
+    if (value.is_accessor() || value.is_native_property())
+        return;
+    auto& entry = cache.entries[cache.next_entry];
+    entry.shape = shape.make_weak_ptr();
+    entry.prototype_shape = nullptr;
+    entry.offset = metadata.value().offset;
+    entry.is_on_prototype = false;
+    cache.next_entry = (cache.next_entry + 1) % PropertyCache::entry_count;
+}
+
+Value Interpreter::run(const Executable& executable)
+{
+    auto& vm = m_interpreter.vm();
+    auto& global_object = m_global_object;
+
+    // NOTE: The register file is a MarkedValueList so that everything it holds is a GC root.
+    MarkedValueList registers(vm.heap());
+    registers.resize(executable.register_count);
+
+    auto* instructions = executable.instructions.data();
+    size_t pc = 0;
+
+    for (;;) {
+        auto& instruction = instructions[pc++];
+        auto& dst = registers[instruction.dst.index()];
+        auto lhs = registers[instruction.lhs.index()];
+        auto rhs = registers[instruction.rhs.index()];
+
+        using Type = Instruction::Type;
+        switch (instruction.type) {
+        case Type::Load:
+            dst = executable.constants[instruction.operand];
+            break;
+        case Type::NewString:
+            dst = js_string(vm, executable.strings[instruction.operand]);
+            break;
+        case Type::NewArray: {
+            auto* array = Array::create(global_object);
+            for (auto& element : executable.register_lists[instruction.operand])
+                array->indexed_properties().append(registers[element.index()]);
+            dst = array;
+            break;
+        }
+        case Type::Move:
+            dst = lhs;
+            break;
+        case Type::GetVariable: {
+            auto& name = executable.identifiers[instruction.operand];
+            auto value = vm.get_variable(name, global_object);
+            if (value.is_empty()) {
+                vm.throw_exception<ReferenceError>(global_object, ErrorType::UnknownIdentifier, name);
+                return {};
+            }
+            dst = value;
+            break;
+        }
+        case Type::SetVariable:
+        case Type::InitializeVariable: {
+            auto& name = executable.identifiers[instruction.operand];
+            update_function_name(lhs, name);
+            vm.set_variable(name, lhs, global_object, instruction.type == Type::InitializeVariable);
+            break;
+        }
+        case Type::GetLocal: {
+            auto& local = executable.locals[instruction.operand];
+            dst = local_environment(vm, local).slot(local.slot).value;
+            break;
+        }
+        case Type::SetLocal:
+        case Type::InitializeLocal: {
+            auto& local = executable.locals[instruction.operand];
+            update_function_name(lhs, executable.identifiers[local.identifier]);
+            auto& environment = local_environment(vm, local);
+            if (instruction.type == Type::SetLocal && environment.slot(local.slot).declaration_kind == DeclarationKind::Const) {
+                vm.throw_exception<TypeError>(global_object, ErrorType::InvalidAssignToConst);
+                return {};
+            }
+            environment.set_slot_value(local.slot, lhs);
+            break;
+        }
+        case Type::GetById: {
+            auto* object = lhs.to_object(global_object);
+            if (!object)
+                return {};
+            auto& site = executable.property_sites[instruction.operand];
+            if (auto value = cached_get(vm, site.cache, *object); value.has_value()) {
+                dst = value.value();
+                break;
+            }
+            auto& name = executable.identifiers[site.identifier];
+            dst = object->get(name).value_or(js_undefined());
+            if (!vm.exception())
+                update_get_cache(site.cache, *object, name);
+            break;
+        }
+        case Type::GetByValue: {
+            auto* object = lhs.to_object(global_object);
+            if (!object)
+                return {};
+            auto property_name = PropertyName::from_value(global_object, rhs);
+            if (vm.exception())
+                return {};
+            dst = object->get(property_name).value_or(js_undefined());
+            break;
+        }
+        case Type::PutById:
+        case Type::PutByValue: {
+            auto base = dst;
+            PropertyName property_name;
+            Value value;
+            if (instruction.type == Type::PutById) {
+                property_name = executable.identifiers[executable.property_sites[instruction.operand].identifier];
+                value = lhs;
+            } else {
+                property_name = PropertyName::from_value(global_object, lhs);
+                if (vm.exception())
+                    return {};
+                value = rhs;
+            }
+            if (value.is_object())
+                update_function_name(value, get_function_name(global_object, property_name.to_value(vm)));
+            if (!base.is_object() && vm.in_strict_mode()) {
+                vm.throw_exception<TypeError>(global_object, ErrorType::ReferencePrimitiveAssignment, property_name.to_value(vm).to_string_without_side_effects());
+                return {};
+            }
+            auto* object = base.to_object(global_object);
+            if (!object)
+                return {};
+            if (instruction.type == Type::PutByValue) {
+                object->put(property_name, value);
+                break;
+            }
+            auto& site = executable.property_sites[instruction.operand];
+            if (cached_put(vm, site.cache, *object, value))
+                break;
+            object->put(property_name, value);
+            if (!vm.exception())
+                update_put_cache(site.cache, *object, property_name.as_string());
+            break;
+        }
+        case Type::ToObject:
+            dst = lhs.to_object(global_object);
+            break;
+        case Type::ToNumeric:
+            dst = lhs.to_numeric(global_object);
+            break;
+        case Type::Increment:
+            dst = increment_or_decrement(global_object, lhs, 1);
+            break;
+        case Type::Decrement:
+            dst = increment_or_decrement(global_object, lhs, -1);
+            break;
+        case Type::Add:
+            dst = add(global_object, lhs, rhs);
+            break;
+        case Type::Sub:
+            dst = sub(global_object, lhs, rhs);
+            break;
+        case Type::Mul:
+            dst = mul(global_object, lhs, rhs);
+            break;
+        case Type::Div:
+            dst = div(global_object, lhs, rhs);
+            break;
+        case Type::Mod:
+            dst = mod(global_object, lhs, rhs);
+            break;
+        case Type::Exp:
+            dst = exp(global_object, lhs, rhs);
+            break;
+        case Type::StrictlyEquals:
+            dst = Value(strict_eq(lhs, rhs));
+            break;
+        case Type::StrictlyInequals:
+            dst = Value(!strict_eq(lhs, rhs));
+            break;
+        case Type::LooselyEquals:
+            dst = Value(abstract_eq(global_object, lhs, rhs));
+            break;
+        case Type::LooselyInequals:
+            dst = Value(!abstract_eq(global_object, lhs, rhs));
+            break;
+        case Type::GreaterThan:
+            dst = greater_than(global_object, lhs, rhs);
+            break;
+        case Type::GreaterThanEquals:
+            dst = greater_than_equals(global_object, lhs, rhs);
+            break;
+        case Type::LessThan:
+            dst = less_than(global_object, lhs, rhs);
+            break;
+        case Type::LessThanEquals:
+            dst = less_than_equals(global_object, lhs, rhs);
+            break;
+        case Type::BitwiseAnd:
+            dst = bitwise_and(global_object, lhs, rhs);
+            break;
+        case Type::BitwiseOr:
+            dst = bitwise_or(global_object, lhs, rhs);
+            break;
+        case Type::BitwiseXor:
+            dst = bitwise_xor(global_object, lhs, rhs);
+            break;
+        case Type::LeftShift:
+            dst = left_shift(global_object, lhs, rhs);
+            break;
+        case Type::RightShift:
+            dst = right_shift(global_object, lhs, rhs);
+            break;
+        case Type::UnsignedRightShift:
+            dst = unsigned_right_shift(global_object, lhs, rhs);
+            break;
+        case Type::In:
+            dst = in(global_object, lhs, rhs);
+            break;
+        case Type::InstanceOf:
+            dst = instance_of(global_object, lhs, rhs);
+            break;
+        case Type::Not:
+            dst = Value(!lhs.to_boolean());
+            break;
+        case Type::BitwiseNot:
+            dst = bitwise_not(global_object, lhs);
+            break;
+        case Type::UnaryPlus:
+            dst = unary_plus(global_object, lhs);
+            break;
+        case Type::UnaryMinus:
+            dst = unary_minus(global_object, lhs);
+            break;
+        case Type::ResolveThis:
+            dst = vm.resolve_this_binding(global_object);
+            break;
+        case Type::LoadGlobalObject:
+            dst = &global_object;
+            break;
+        case Type::Evaluate:
+            dst = executable.nodes[instruction.operand]->execute(m_interpreter, global_object);
+            break;
+        case Type::Jump:
+            pc = instruction.operand;
+            continue;
+        case Type::JumpIfTrue:
+            if (lhs.to_boolean())
+                pc = instruction.operand;
+            continue;
+        case Type::JumpIfFalse:
+            if (!lhs.to_boolean())
+                pc = instruction.operand;
+            continue;
+        case Type::JumpIfNullish:
+            if (lhs.is_nullish())
+                pc = instruction.operand;
+            continue;
+        case Type::JumpIfNotNullish:
+            if (!lhs.is_nullish())
+                pc = instruction.operand;
+            continue;
+        case Type::Call:
+        case Type::Construct: {
+            auto& call_site = executable.call_sites[instruction.operand];
+            bool is_construct = instruction.type == Type::Construct;
+            if (!lhs.is_function() || (is_construct && is<NativeFunction>(lhs.as_object()) && !static_cast<NativeFunction&>(lhs.as_object()).has_constructor())) {
+                call_site.expression->throw_type_error_for_callee(m_interpreter, global_object, lhs);
+                return {};
+            }
+            auto& function = lhs.as_function();
+
+            MarkedValueList arguments(vm.heap());
+            arguments.ensure_capacity(call_site.arguments.size());
+            for (auto& argument : call_site.arguments)
+                arguments.append(registers[argument.index()]);
+
+            // NOTE: Keep the current node up to date for stack traces, like CallExpression::execute() does.
+            m_interpreter.enter_node(*call_site.expression);
+            Value result;
+            if (is_construct) {
+                result = vm.construct(function, function, move(arguments), global_object);
+                if (!result.is_object())
+                    result = js_null();
+            } else {
+                result = vm.call(function, rhs, move(arguments));
+            }
+            m_interpreter.exit_node(*call_site.expression);
+            dst = result;
+            break;
+        }
+        case Type::EnterScope:
+            m_interpreter.enter_scope(static_cast<const ScopeNode&>(*executable.nodes[instruction.operand]), ScopeType::Block, global_object);
+            break;
+        case Type::LeaveScope:
+            m_interpreter.exit_scope(static_cast<const ScopeNode&>(*executable.nodes[instruction.operand]));
+            break;
+        case Type::Throw:
+            m_interpreter.enter_node(*executable.nodes[instruction.operand]);
+            vm.throw_exception(global_object, lhs);
+            m_interpreter.exit_node(*executable.nodes[instruction.operand]);
+            return {};
+        case Type::Return:
+            return lhs;
+        }
+
+        if (vm.exception())
+            return {};
+    }
+}
+
+}
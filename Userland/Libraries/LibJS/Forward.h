@@ -125,6 +125,7 @@ class BoundFunction;
 class Cell;
 class Console;
 class DeferGC;
+class EnvironmentLayout;
 class Error;
 class Exception;
 class Expression;
@@ -171,4 +172,13 @@ JS_ENUMERATE_TYPED_ARRAYS
 template<class T>
 class Handle;
 
+namespace Bytecode {
+class Executable;
+class Generator;
+class Interpreter;
+class Label;
+class Register;
+struct Instruction;
+}
+
 }
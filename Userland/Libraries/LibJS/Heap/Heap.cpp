@@ -29,6 +29,7 @@
 #include <AK/HashTable.h>
 #include <AK/StackInfo.h>
 #include <AK/TemporaryChange.h>
+#include <AK/Time.h>
 #include <LibCore/ElapsedTimer.h>
 #include <LibJS/Heap/Allocator.h>
 #include <LibJS/Heap/Handle.h>
@@ -37,6 +38,7 @@
 #include <LibJS/Interpreter.h>
 #include <LibJS/Runtime/Object.h>
 #include <setjmp.h>
+#include <time.h>
 
 namespace JS {
 
@@ -70,10 +72,10 @@ ALWAYS_INLINE Allocator& Heap::allocator_for_size(size_t cell_size)
 Cell* Heap::allocate_cell(size_t size)
 {
     if (should_collect_on_every_allocation()) {
-        collect_garbage();
+        collect_garbage(automatic_collection_type());
     } else if (m_allocations_since_last_gc > m_max_allocations_between_gc) {
         m_allocations_since_last_gc = 0;
-        collect_garbage();
+        collect_garbage(automatic_collection_type());
     } else {
         ++m_allocations_since_last_gc;
     }
@@ -82,6 +84,21 @@ Cell* Heap::allocate_cell(size_t size)
     return allocator.allocate_cell(*this);
 }
 
+Heap::CollectionType Heap::automatic_collection_type() const
+{
+    // Old cells are only reclaimed by full collections, so do one whenever the old generation has doubled since the last one.
+    if (m_promoted_cells_since_last_full_collection > max(m_live_cells_after_last_full_collection, m_max_allocations_between_gc))
+        return CollectionType::CollectGarbage;
+    return CollectionType::CollectYoungGeneration;
+}
+
+static u64 monotonic_time_in_microseconds()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return Time::from_timespec(now).to_microseconds();
+}
+
 void Heap::collect_garbage(CollectionType collection_type, bool print_report)
 {
     VERIFY(!m_collecting_garbage);
@@ -89,22 +106,48 @@ void Heap::collect_garbage(CollectionType collection_type, bool print_report)
 
     Core::ElapsedTimer collection_measurement_timer;
     collection_measurement_timer.start();
-    if (collection_type == CollectionType::CollectGarbage) {
-        if (m_gc_deferrals) {
-            m_should_gc_when_deferral_ends = true;
-            return;
-        }
-        HashTable<Cell*> roots;
-        gather_roots(roots);
-        mark_live_cells(roots);
+    auto start_time = monotonic_time_in_microseconds();
+
+    if (collection_type == CollectionType::CollectEverything) {
+        forget_remembered_cells();
+        sweep_dead_cells(collection_type, print_report, collection_measurement_timer);
+        return;
+    }
+
+    if (m_gc_deferrals) {
+        m_should_gc_when_deferral_ends = true;
+        return;
+    }
+
+    HashTable<Cell*> roots;
+    HashTable<Cell*> conservative_roots;
+    gather_roots(roots);
+    gather_conservative_roots(conservative_roots);
+
+    if (collection_type == CollectionType::CollectYoungGeneration) {
+        mark_young_cells(roots, conservative_roots);
+    } else {
+        forget_remembered_cells();
+        mark_live_cells(roots, conservative_roots);
     }
-    sweep_dead_cells(print_report, collection_measurement_timer);
+    sweep_dead_cells(collection_type, print_report, collection_measurement_timer);
+
+    // NOTE: Cells that are referenced from the stack may be in the middle of being modified by C++ code that
+    //       doesn't bother with write barriers (constructors, or code holding on to an IndexedProperties&),
+    //       so we trace them again in the next collection.
+    for (auto* cell : conservative_roots)
+        cell->write_barrier();
+
+    auto pause_time = monotonic_time_in_microseconds() - start_time;
+    if (collection_type == CollectionType::CollectYoungGeneration)
+        m_statistics.young_generation_collections.record_pause(pause_time);
+    else
+        m_statistics.full_collections.record_pause(pause_time);
 }
 
 void Heap::gather_roots(HashTable<Cell*>& roots)
 {
     vm().gather_roots(roots);
-    gather_conservative_roots(roots);
 
     for (auto* handle : m_handles)
         roots.set(handle->cell());
@@ -195,7 +238,7 @@ public:
     }
 };
 
-void Heap::mark_live_cells(const HashTable<Cell*>& roots)
+void Heap::mark_live_cells(const HashTable<Cell*>& roots, const HashTable<Cell*>& conservative_roots)
 {
 #if HEAP_DEBUG
     dbgln("mark_live_cells:");
@@ -203,9 +246,62 @@ void Heap::mark_live_cells(const HashTable<Cell*>& roots)
     MarkingVisitor visitor;
     for (auto* root : roots)
         visitor.visit(root);
+    for (auto* root : conservative_roots)
+        visitor.visit(root);
+}
+
+class YoungGenerationMarkingVisitor final : public Cell::Visitor {
+public:
+    YoungGenerationMarkingVisitor() { }
+
+    virtual void visit_impl(Cell* cell)
+    {
+        // Old cells are assumed to be live, and the only ones that can point at young cells are the remembered ones.
+        if (cell->is_old() || cell->is_marked())
+            return;
+#if HEAP_DEBUG
+        dbgln("  ! {}", cell);
+#endif
+        cell->set_marked(true);
+        cell->visit_edges(*this);
+    }
+};
+
+void Heap::mark_young_cells(const HashTable<Cell*>& roots, const HashTable<Cell*>& conservative_roots)
+{
+#if HEAP_DEBUG
+    dbgln("mark_young_cells:");
+#endif
+    YoungGenerationMarkingVisitor visitor;
+    for (auto* cell : m_remembered_cells) {
+        VERIFY(cell->is_old());
+        cell->set_remembered(false);
+        cell->visit_edges(visitor);
+    }
+    m_remembered_cells.clear_with_capacity();
+
+    for (auto* root : roots)
+        visitor.visit(root);
+    for (auto* root : conservative_roots)
+        visitor.visit(root);
+}
+
+void Heap::remember_cell(Badge<Cell>, Cell& cell)
+{
+    VERIFY(cell.is_old());
+    VERIFY(!cell.is_remembered());
+    cell.set_remembered(true);
+    m_remembered_cells.append(&cell);
+}
+
+void Heap::forget_remembered_cells()
+{
+    for (auto* cell : m_remembered_cells)
+        cell->set_remembered(false);
+    m_remembered_cells.clear_with_capacity();
 }
 
-void Heap::sweep_dead_cells(bool print_report, const Core::ElapsedTimer& measurement_timer)
+void Heap::sweep_dead_cells(CollectionType collection_type, bool print_report, const Core::ElapsedTimer& measurement_timer)
 {
 #if HEAP_DEBUG
     dbgln("sweep_dead_cells:");
@@ -215,29 +311,43 @@ void Heap::sweep_dead_cells(bool print_report, const Core::ElapsedTimer& measure
 
     size_t collected_cells = 0;
     size_t live_cells = 0;
+    size_t promoted_cells = 0;
     size_t collected_cell_bytes = 0;
     size_t live_cell_bytes = 0;
 
+    bool is_young_generation_collection = collection_type == CollectionType::CollectYoungGeneration;
+
     for_each_block([&](auto& block) {
+        if (is_young_generation_collection && !block.has_young_cells())
+            return IterationDecision::Continue;
         bool block_has_live_cells = false;
         bool block_was_full = block.is_full();
         block.for_each_cell([&](Cell* cell) {
-            if (cell->is_live()) {
-                if (!cell->is_marked()) {
+            if (!cell->is_live())
+                return;
+            if (is_young_generation_collection && cell->is_old()) {
+                block_has_live_cells = true;
+                return;
+            }
+            if (!cell->is_marked()) {
 #if HEAP_DEBUG
-                    dbgln("  ~ {}", cell);
+                dbgln("  ~ {}", cell);
 #endif
-                    block.deallocate(cell);
-                    ++collected_cells;
-                    collected_cell_bytes += block.cell_size();
-                } else {
-                    cell->set_marked(false);
-                    block_has_live_cells = true;
-                    ++live_cells;
-                    live_cell_bytes += block.cell_size();
+                block.deallocate(cell);
+                ++collected_cells;
+                collected_cell_bytes += block.cell_size();
+            } else {
+                cell->set_marked(false);
+                if (!cell->is_old()) {
+                    cell->set_old(true);
+                    ++promoted_cells;
                 }
+                block_has_live_cells = true;
+                ++live_cells;
+                live_cell_bytes += block.cell_size();
             }
         });
+        block.set_has_young_cells(false);
         if (!block_has_live_cells)
             empty_blocks.append(&block);
         else if (block_was_full != block.is_full())
@@ -266,6 +376,14 @@ void Heap::sweep_dead_cells(bool print_report, const Core::ElapsedTimer& measure
     });
 #endif
 
+    m_statistics.promoted_cells += promoted_cells;
+    if (is_young_generation_collection) {
+        m_promoted_cells_since_last_full_collection += promoted_cells;
+    } else {
+        m_live_cells_after_last_full_collection = live_cells;
+        m_promoted_cells_since_last_full_collection = 0;
+    }
+
     int time_spent = measurement_timer.elapsed();
 
     if (print_report) {
@@ -278,7 +396,9 @@ void Heap::sweep_dead_cells(bool print_report, const Core::ElapsedTimer& measure
         dbgln("Garbage collection report");
         dbgln("=============================================");
         dbgln("     Time spent: {} ms", time_spent);
+        dbgln("     Collection: {}", is_young_generation_collection ? "young generation" : "full");
         dbgln("     Live cells: {} ({} bytes)", live_cells, live_cell_bytes);
+        dbgln(" Promoted cells: {}", promoted_cells);
         dbgln("Collected cells: {} ({} bytes)", collected_cells, collected_cell_bytes);
         dbgln("    Live blocks: {} ({} bytes)", live_block_count, live_block_count * HeapBlock::block_size);
         dbgln("   Freed blocks: {} ({} bytes)", empty_blocks.size(), empty_blocks.size() * HeapBlock::block_size);
@@ -286,6 +406,47 @@ void Heap::sweep_dead_cells(bool print_report, const Core::ElapsedTimer& measure
     }
 }
 
+void Heap::PauseStatistics::record_pause(u64 microseconds)
+{
+    ++collection_count;
+    total_pause_time_in_microseconds += microseconds;
+    max_pause_time_in_microseconds = max(max_pause_time_in_microseconds, microseconds);
+
+    size_t bucket = 0;
+    while (bucket < histogram_bucket_count - 1 && microseconds >= (2ull << bucket))
+        ++bucket;
+    ++histogram[bucket];
+}
+
+static void dump_pause_statistics(const char* name, const Heap::PauseStatistics& statistics)
+{
+    if (!statistics.collection_count) {
+        dbgln("{}: none", name);
+        return;
+    }
+    dbgln("{}: {}, {} us total, {} us average, {} us max", name, statistics.collection_count, statistics.total_pause_time_in_microseconds,
+        statistics.total_pause_time_in_microseconds / statistics.collection_count, statistics.max_pause_time_in_microseconds);
+    for (size_t bucket = 0; bucket < Heap::PauseStatistics::histogram_bucket_count; ++bucket) {
+        if (!statistics.histogram[bucket])
+            continue;
+        u64 lower_bound = bucket ? 1ull << bucket : 0;
+        if (bucket == Heap::PauseStatistics::histogram_bucket_count - 1)
+            dbgln("    {:>7} us and up: {}", lower_bound, statistics.histogram[bucket]);
+        else
+            dbgln("    {:>7} - {:>7} us: {}", lower_bound, 2ull << bucket, statistics.histogram[bucket]);
+    }
+}
+
+void Heap::dump_statistics() const
+{
+    dbgln("Garbage collection statistics");
+    dbgln("=============================================");
+    dump_pause_statistics("Young generation collections", m_statistics.young_generation_collections);
+    dump_pause_statistics("Full collections", m_statistics.full_collections);
+    dbgln("Promoted cells: {}", m_statistics.promoted_cells);
+    dbgln("=============================================");
+}
+
 void Heap::did_create_handle(Badge<HandleImpl>, HandleImpl& impl)
 {
     VERIFY(!m_handles.contains(&impl));
@@ -322,7 +483,7 @@ void Heap::undefer_gc(Badge<DeferGC>)
 
     if (!m_gc_deferrals) {
         if (m_should_gc_when_deferral_ends)
-            collect_garbage();
+            collect_garbage(automatic_collection_type());
         m_should_gc_when_deferral_ends = false;
     }
 }
@@ -26,6 +26,7 @@
 
 #pragma once
 
+#include <AK/Array.h>
 #include <AK/HashTable.h>
 #include <AK/Noncopyable.h>
 #include <AK/NonnullOwnPtr.h>
@@ -53,7 +54,10 @@ public:
     {
         auto* memory = allocate_cell(sizeof(T));
         new (memory) T(forward<Args>(args)...);
-        return static_cast<T*>(memory);
+        auto* cell = static_cast<T*>(memory);
+        // NOTE: The cell may have been promoted by a collection while it was being constructed.
+        cell->write_barrier();
+        return cell;
     }
 
     template<typename T, typename... Args>
@@ -68,16 +72,43 @@ public:
         cell->initialize(global_object);
         if constexpr (is_object)
             static_cast<Object*>(cell)->enable_transitions();
+        // NOTE: The cell may have been promoted by a collection while it was being constructed or initialized.
+        cell->write_barrier();
         return cell;
     }
 
     enum class CollectionType {
         CollectGarbage,
+        CollectYoungGeneration,
         CollectEverything,
     };
 
     void collect_garbage(CollectionType = CollectionType::CollectGarbage, bool print_report = false);
 
+    struct PauseStatistics {
+        // Bucket N counts the pauses that took less than 2^(N+1) microseconds (and at least 2^N, except for the first bucket).
+        // The last bucket also counts everything longer.
+        static constexpr size_t histogram_bucket_count = 20;
+
+        size_t collection_count { 0 };
+        u64 total_pause_time_in_microseconds { 0 };
+        u64 max_pause_time_in_microseconds { 0 };
+        AK::Array<size_t, histogram_bucket_count> histogram {};
+
+        void record_pause(u64 microseconds);
+    };
+
+    struct Statistics {
+        PauseStatistics young_generation_collections;
+        PauseStatistics full_collections;
+        size_t promoted_cells { 0 };
+    };
+
+    const Statistics& statistics() const { return m_statistics; }
+    void dump_statistics() const;
+
+    void remember_cell(Badge<Cell>, Cell&);
+
     VM& vm() { return m_vm; }
 
     bool should_collect_on_every_allocation() const { return m_should_collect_on_every_allocation; }
@@ -95,10 +126,14 @@ public:
 private:
     Cell* allocate_cell(size_t);
 
+    CollectionType automatic_collection_type() const;
+
     void gather_roots(HashTable<Cell*>&);
     void gather_conservative_roots(HashTable<Cell*>&);
-    void mark_live_cells(const HashTable<Cell*>& live_cells);
-    void sweep_dead_cells(bool print_report, const Core::ElapsedTimer&);
+    void mark_live_cells(const HashTable<Cell*>& roots, const HashTable<Cell*>& conservative_roots);
+    void mark_young_cells(const HashTable<Cell*>& roots, const HashTable<Cell*>& conservative_roots);
+    void sweep_dead_cells(CollectionType, bool print_report, const Core::ElapsedTimer&);
+    void forget_remembered_cells();
 
     Allocator& allocator_for_size(size_t);
 
@@ -114,6 +149,9 @@ private:
     size_t m_max_allocations_between_gc { 10000 };
     size_t m_allocations_since_last_gc { false };
 
+    size_t m_live_cells_after_last_full_collection { 0 };
+    size_t m_promoted_cells_since_last_full_collection { 0 };
+
     bool m_should_collect_on_every_allocation { false };
 
     VM& m_vm;
@@ -123,6 +161,11 @@ private:
 
     HashTable<MarkedValueList*> m_marked_value_lists;
 
+    // Old cells that may point at young cells, and have to be traced by the next young generation collection.
+    Vector<Cell*> m_remembered_cells;
+
+    Statistics m_statistics;
+
     size_t m_gc_deferrals { 0 };
     bool m_should_gc_when_deferral_ends { false };
 
@@ -47,11 +47,16 @@ public:
     size_t cell_count() const { return (block_size - sizeof(HeapBlock)) / m_cell_size; }
     bool is_full() const { return !m_freelist; }
 
+    // Set when a cell is allocated from this block, so that young generation collections only have to sweep blocks that got new cells.
+    bool has_young_cells() const { return m_has_young_cells; }
+    void set_has_young_cells(bool b) { m_has_young_cells = b; }
+
     ALWAYS_INLINE Cell* allocate()
     {
         if (!m_freelist)
             return nullptr;
         VERIFY(is_valid_cell_pointer(m_freelist));
+        m_has_young_cells = true;
         return exchange(m_freelist, m_freelist->next);
     }
 
@@ -109,6 +114,7 @@ private:
 
     Heap& m_heap;
     size_t m_cell_size { 0 };
+    bool m_has_young_cells { false };
     FreelistEntry* m_freelist { nullptr };
     alignas(Cell) u8 m_storage[];
 };
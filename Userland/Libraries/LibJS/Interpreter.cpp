@@ -26,6 +26,7 @@
 
 #include <AK/StringBuilder.h>
 #include <LibJS/AST.h>
+#include <LibJS/Bytecode/Interpreter.h>
 #include <LibJS/Interpreter.h>
 #include <LibJS/Runtime/GlobalObject.h>
 #include <LibJS/Runtime/LexicalEnvironment.h>
@@ -102,25 +103,18 @@ void Interpreter::enter_scope(const ScopeNode& scope_node, ScopeType scope_type,
         return;
     }
 
-    HashMap<FlyString, Variable> scope_variables_with_declaration_kind;
-    scope_variables_with_declaration_kind.ensure_capacity(16);
+    bool pushed_lexical_environment = false;
 
-    for (auto& declaration : scope_node.variables()) {
-        for (auto& declarator : declaration.declarations()) {
-            if (is<Program>(scope_node)) {
+    if (is<Program>(scope_node)) {
+        for (auto& declaration : scope_node.variables()) {
+            for (auto& declarator : declaration.declarations()) {
                 global_object.put(declarator.id().string(), js_undefined());
                 if (exception())
                     return;
-            } else {
-                scope_variables_with_declaration_kind.set(declarator.id().string(), { js_undefined(), declaration.declaration_kind() });
             }
         }
-    }
-
-    bool pushed_lexical_environment = false;
-
-    if (!scope_variables_with_declaration_kind.is_empty()) {
-        auto* block_lexical_environment = heap().allocate<LexicalEnvironment>(global_object, move(scope_variables_with_declaration_kind), current_scope());
+    } else if (!scope_node.variables().is_empty()) {
+        auto* block_lexical_environment = heap().allocate<LexicalEnvironment>(global_object, scope_node.block_environment_layout(), current_scope());
         vm().call_frame().scope = block_lexical_environment;
         pushed_lexical_environment = true;
     }
@@ -192,6 +186,19 @@ Value Interpreter::execute_statement(GlobalObject& global_object, const Statemen
     return vm().last_value();
 }
 
+Value Interpreter::execute_function_body_bytecode(GlobalObject& global_object, const ScopeNode& body, const Bytecode::Executable& executable)
+{
+    // NOTE: This mirrors execute_statement() for ScopeType::Function, with the statements themselves run by the bytecode interpreter.
+    enter_scope(body, ScopeType::Function, global_object);
+    auto result = Bytecode::Interpreter(*this, global_object).run(executable);
+    exit_scope(body);
+
+    if (exception())
+        return {};
+    vm().set_last_value({}, result);
+    return result;
+}
+
 LexicalEnvironment* Interpreter::current_environment()
 {
     VERIFY(is<LexicalEnvironment>(vm().call_frame().scope));
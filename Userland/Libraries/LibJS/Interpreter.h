@@ -87,6 +87,7 @@ public:
     const Vector<const ASTNode*>& node_stack() const { return m_ast_nodes; }
 
     Value execute_statement(GlobalObject&, const Statement&, ScopeType = ScopeType::Block);
+    Value execute_function_body_bytecode(GlobalObject&, const ScopeNode& body, const Bytecode::Executable&);
 
 private:
     explicit Interpreter(VM&);
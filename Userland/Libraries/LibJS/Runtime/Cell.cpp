@@ -48,6 +48,11 @@ Heap& Cell::heap() const
     return HeapBlock::from_cell(this)->heap();
 }
 
+void Cell::remember()
+{
+    heap().remember_cell({}, *this);
+}
+
 VM& Cell::vm() const
 {
     return heap().vm();
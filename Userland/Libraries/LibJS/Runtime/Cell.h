@@ -49,6 +49,21 @@ public:
     bool is_live() const { return m_live; }
     void set_live(bool b) { m_live = b; }
 
+    // Cells that have survived a collection are old, and are only traced by full collections.
+    bool is_old() const { return m_old; }
+    void set_old(bool b) { m_old = b; }
+
+    bool is_remembered() const { return m_remembered; }
+    void set_remembered(bool b) { m_remembered = b; }
+
+    // Must be called whenever a cell may have started pointing at another cell after construction,
+    // so that the next young generation collection traces it even though it's old.
+    ALWAYS_INLINE void write_barrier()
+    {
+        if (m_old && !m_remembered)
+            remember();
+    }
+
     virtual const char* class_name() const = 0;
 
     class Visitor {
@@ -69,8 +84,12 @@ protected:
     Cell() { }
 
 private:
+    void remember();
+
     bool m_mark { false };
     bool m_live { true };
+    bool m_old { false };
+    bool m_remembered { false };
 };
 
 }
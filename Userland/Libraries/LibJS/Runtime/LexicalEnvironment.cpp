@@ -33,6 +33,16 @@
 
 namespace JS {
 
+void EnvironmentLayout::add_binding(const FlyString& name, DeclarationKind declaration_kind)
+{
+    if (auto slot = m_slots.get(name); slot.has_value()) {
+        m_bindings[slot.value()].declaration_kind = declaration_kind;
+        return;
+    }
+    m_slots.set(name, m_bindings.size());
+    m_bindings.append({ name, declaration_kind });
+}
+
 LexicalEnvironment::LexicalEnvironment()
     : ScopeObject(nullptr)
 {
@@ -57,6 +67,21 @@ LexicalEnvironment::LexicalEnvironment(HashMap<FlyString, Variable> variables, S
 {
 }
 
+LexicalEnvironment::LexicalEnvironment(const EnvironmentLayout& layout, ScopeObject* parent_scope)
+    : LexicalEnvironment(layout, parent_scope, EnvironmentRecordType::Declarative)
+{
+}
+
+LexicalEnvironment::LexicalEnvironment(const EnvironmentLayout& layout, ScopeObject* parent_scope, EnvironmentRecordType environment_record_type)
+    : ScopeObject(parent_scope)
+    , m_environment_record_type(environment_record_type)
+    , m_layout(layout)
+{
+    m_slots.ensure_capacity(layout.bindings().size());
+    for (auto& binding : layout.bindings())
+        m_slots.unchecked_append({ js_undefined(), binding.declaration_kind });
+}
+
 LexicalEnvironment::~LexicalEnvironment()
 {
 }
@@ -68,18 +93,32 @@ void LexicalEnvironment::visit_edges(Visitor& visitor)
     visitor.visit(m_home_object);
     visitor.visit(m_new_target);
     visitor.visit(m_current_function);
+    for (auto& slot : m_slots)
+        visitor.visit(slot.value);
     for (auto& it : m_variables)
         visitor.visit(it.value.value);
 }
 
 Optional<Variable> LexicalEnvironment::get_from_scope(const FlyString& name) const
 {
+    if (m_layout) {
+        if (auto slot = m_layout->slot_for(name); slot.has_value())
+            return m_slots[slot.value()];
+    }
     return m_variables.get(name);
 }
 
 void LexicalEnvironment::put_to_scope(const FlyString& name, Variable variable)
 {
+    if (m_layout) {
+        if (auto slot = m_layout->slot_for(name); slot.has_value()) {
+            m_slots[slot.value()] = variable;
+            write_barrier();
+            return;
+        }
+    }
     m_variables.set(name, variable);
+    write_barrier();
 }
 
 bool LexicalEnvironment::has_super_binding() const
@@ -129,6 +168,7 @@ void LexicalEnvironment::bind_this_value(GlobalObject& global_object, Value this
     }
     m_this_value = this_value;
     m_this_binding_status = ThisBindingStatus::Initialized;
+    write_barrier();
 }
 
 }
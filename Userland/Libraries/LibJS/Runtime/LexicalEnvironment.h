@@ -28,11 +28,38 @@
 
 #include <AK/FlyString.h>
 #include <AK/HashMap.h>
+#include <AK/RefCounted.h>
+#include <AK/Vector.h>
 #include <LibJS/Runtime/ScopeObject.h>
 #include <LibJS/Runtime/Value.h>
 
 namespace JS {
 
+// The names declared by a scope, each assigned a fixed slot. Every environment created for
+// the same scope shares one layout, which lets compiled code address its locals by index.
+class EnvironmentLayout : public RefCounted<EnvironmentLayout> {
+public:
+    struct Binding {
+        FlyString name;
+        DeclarationKind declaration_kind;
+    };
+
+    static NonnullRefPtr<EnvironmentLayout> create() { return adopt(*new EnvironmentLayout); }
+
+    // Redeclaring a name keeps its slot but takes the new declaration kind.
+    void add_binding(const FlyString& name, DeclarationKind);
+
+    Optional<u32> slot_for(const FlyString& name) const { return m_slots.get(name); }
+    const Vector<Binding>& bindings() const { return m_bindings; }
+    bool is_empty() const { return m_bindings.is_empty(); }
+
+private:
+    EnvironmentLayout() { }
+
+    Vector<Binding> m_bindings;
+    HashMap<FlyString, u32> m_slots;
+};
+
 class LexicalEnvironment final : public ScopeObject {
     JS_OBJECT(LexicalEnvironment, ScopeObject);
 
@@ -54,6 +81,8 @@ public:
     LexicalEnvironment(EnvironmentRecordType);
     LexicalEnvironment(HashMap<FlyString, Variable> variables, ScopeObject* parent_scope);
     LexicalEnvironment(HashMap<FlyString, Variable> variables, ScopeObject* parent_scope, EnvironmentRecordType);
+    LexicalEnvironment(const EnvironmentLayout&, ScopeObject* parent_scope);
+    LexicalEnvironment(const EnvironmentLayout&, ScopeObject* parent_scope, EnvironmentRecordType);
     virtual ~LexicalEnvironment() override;
 
     // ^ScopeObject
@@ -64,9 +93,19 @@ public:
 
     void clear();
 
-    const HashMap<FlyString, Variable>& variables() const { return m_variables; }
-
-    void set_home_object(Value object) { m_home_object = object; }
+    // Direct access to the bindings of the layout this environment was created with.
+    const Variable& slot(u32 index) const { return m_slots[index]; }
+    void set_slot_value(u32 index, Value value)
+    {
+        m_slots[index].value = value;
+        write_barrier();
+    }
+
+    void set_home_object(Value object)
+    {
+        m_home_object = object;
+        write_barrier();
+    }
     bool has_super_binding() const;
     Value get_super_base();
 
@@ -74,13 +113,25 @@ public:
     void bind_this_value(GlobalObject&, Value this_value);
 
     // Not a standard operation.
-    void replace_this_binding(Value this_value) { m_this_value = this_value; }
+    void replace_this_binding(Value this_value)
+    {
+        m_this_value = this_value;
+        write_barrier();
+    }
 
     Value new_target() const { return m_new_target; };
-    void set_new_target(Value new_target) { m_new_target = new_target; }
+    void set_new_target(Value new_target)
+    {
+        m_new_target = new_target;
+        write_barrier();
+    }
 
     Function* current_function() const { return m_current_function; }
-    void set_current_function(Function& function) { m_current_function = &function; }
+    void set_current_function(Function& function)
+    {
+        m_current_function = &function;
+        write_barrier();
+    }
 
     EnvironmentRecordType type() const { return m_environment_record_type; }
 
@@ -89,6 +140,9 @@ private:
 
     EnvironmentRecordType m_environment_record_type : 8 { EnvironmentRecordType::Declarative };
     ThisBindingStatus m_this_binding_status : 8 { ThisBindingStatus::Uninitialized };
+    RefPtr<EnvironmentLayout> m_layout;
+    Vector<Variable> m_slots;
+    // Bindings that aren't part of the layout, e.g. from a class declaration.
     HashMap<FlyString, Variable> m_variables;
     Value m_home_object;
     Value m_this_value;
@@ -139,6 +139,7 @@ bool Object::set_prototype(Object* new_prototype)
         return true;
     }
     m_shape = m_shape->create_prototype_transition(new_prototype);
+    write_barrier();
     return true;
 }
 
@@ -346,6 +347,7 @@ void Object::set_shape(Shape& new_shape)
 {
     m_storage.resize(new_shape.property_count());
     m_shape = &new_shape;
+    write_barrier();
 }
 
 bool Object::define_property(const StringOrSymbol& property_name, const Object& descriptor, bool throw_exceptions)
@@ -488,10 +490,12 @@ bool Object::put_own_property(Object& this_object, const StringOrSymbol& propert
 
     // NOTE: We disable transitions during initialize(), this makes building common runtime objects significantly faster.
     //       Transitions are primarily interesting when scripts add properties to objects.
-    if (!m_transitions_enabled && !m_shape->is_unique()) {
+    //       A shape that other objects may share can't be modified in place though, so those still transition.
+    if (!m_transitions_enabled && !m_shape->is_unique() && !m_shape->is_shared_transition()) {
         m_shape->add_property_without_transition(property_name, attributes);
         m_storage.resize(m_shape->property_count());
         m_storage[m_shape->property_count() - 1] = value;
+        write_barrier();
         return true;
     }
 
@@ -517,7 +521,7 @@ bool Object::put_own_property(Object& this_object, const StringOrSymbol& propert
         if (m_shape->is_unique()) {
             m_shape->add_property_to_unique_shape(property_name, attributes);
             m_storage.resize(m_shape->property_count());
-        } else if (m_transitions_enabled) {
+        } else if (m_transitions_enabled || m_shape->is_shared_transition()) {
             set_shape(*m_shape->create_put_transition(property_name, attributes));
         } else {
             m_shape->add_property_without_transition(property_name, attributes);
@@ -564,6 +568,7 @@ bool Object::put_own_property(Object& this_object, const StringOrSymbol& propert
         call_native_property_setter(value_here.as_native_property(), &this_object, value);
     } else {
         m_storage[metadata.value().offset] = value;
+        write_barrier();
     }
     return true;
 }
@@ -618,6 +623,7 @@ bool Object::put_own_property_by_index(Object& this_object, u32 property_index,
         call_native_property_setter(value_here.as_native_property(), &this_object, value);
     } else {
         m_indexed_properties.put(&this_object, property_index, value, attributes, mode == PutOwnPropertyMode::Put);
+        write_barrier();
     }
     return true;
 }
@@ -656,6 +662,7 @@ void Object::ensure_shape_is_unique()
         return;
 
     m_shape = m_shape->create_unique_clone();
+    write_barrier();
 }
 
 Value Object::get_by_index(u32 property_index) const
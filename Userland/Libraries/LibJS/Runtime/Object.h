@@ -130,10 +130,24 @@ public:
     virtual Value ordinary_to_primitive(Value::PreferredType preferred_type) const;
 
     Value get_direct(size_t index) const { return m_storage[index]; }
+    void put_direct(size_t index, Value value)
+    {
+        m_storage[index] = value;
+        write_barrier();
+    }
 
     const IndexedProperties& indexed_properties() const { return m_indexed_properties; }
-    IndexedProperties& indexed_properties() { return m_indexed_properties; }
-    void set_indexed_property_elements(Vector<Value>&& values) { m_indexed_properties = IndexedProperties(move(values)); }
+    IndexedProperties& indexed_properties()
+    {
+        // NOTE: If a collection happens before the caller is done with this, we'll still be on the stack and get remembered again.
+        write_barrier();
+        return m_indexed_properties;
+    }
+    void set_indexed_property_elements(Vector<Value>&& values)
+    {
+        m_indexed_properties = IndexedProperties(move(values));
+        write_barrier();
+    }
 
     [[nodiscard]] Value invoke_internal(const StringOrSymbol& property_name, Optional<MarkedValueList> arguments);
 
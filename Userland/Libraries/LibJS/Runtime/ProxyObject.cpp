@@ -68,6 +68,8 @@ ProxyObject::ProxyObject(Object& target, Object& handler, Object& prototype)
     , m_target(target)
     , m_handler(handler)
 {
+    // NOTE: Property caches only remember shared shapes, so this keeps every property access going through the handler.
+    ensure_shape_is_unique();
 }
 
 ProxyObject::~ProxyObject()
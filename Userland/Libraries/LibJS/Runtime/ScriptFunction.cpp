@@ -30,6 +30,7 @@
 #include <LibJS/Runtime/Array.h>
 #include <LibJS/Runtime/Error.h>
 #include <LibJS/Runtime/GlobalObject.h>
+#include <LibJS/Runtime/LexicalEnvironment.h>
 #include <LibJS/Runtime/ScriptFunction.h>
 #include <LibJS/Runtime/Value.h>
 
@@ -87,22 +88,35 @@ void ScriptFunction::visit_edges(Visitor& visitor)
     visitor.visit(m_parent_scope);
 }
 
-LexicalEnvironment* ScriptFunction::create_environment()
+const EnvironmentLayout& ScriptFunction::environment_layout()
 {
-    HashMap<FlyString, Variable> variables;
-    for (auto& parameter : m_parameters) {
-        variables.set(parameter.name, { js_undefined(), DeclarationKind::Var });
+    if (m_environment_layout)
+        return *m_environment_layout;
+
+    // Every function with the same body has the same parameters, so the layout is shared through the body.
+    auto* body = is<ScopeNode>(*m_body) ? static_cast<const ScopeNode*>(m_body.ptr()) : nullptr;
+    if (body && body->function_environment_layout()) {
+        m_environment_layout = body->function_environment_layout();
+        return *m_environment_layout;
     }
 
-    if (is<ScopeNode>(body())) {
-        for (auto& declaration : static_cast<const ScopeNode&>(body()).variables()) {
-            for (auto& declarator : declaration.declarations()) {
-                variables.set(declarator.id().string(), { js_undefined(), declaration.declaration_kind() });
-            }
+    auto layout = EnvironmentLayout::create();
+    for (auto& parameter : m_parameters)
+        layout->add_binding(parameter.name, DeclarationKind::Var);
+    if (body) {
+        for (auto& declaration : body->variables()) {
+            for (auto& declarator : declaration.declarations())
+                layout->add_binding(declarator.id().string(), declaration.declaration_kind());
         }
+        body->set_function_environment_layout(layout);
     }
+    m_environment_layout = move(layout);
+    return *m_environment_layout;
+}
 
-    auto* environment = heap().allocate<LexicalEnvironment>(global_object(), move(variables), m_parent_scope, LexicalEnvironment::EnvironmentRecordType::Function);
+LexicalEnvironment* ScriptFunction::create_environment()
+{
+    auto* environment = heap().allocate<LexicalEnvironment>(global_object(), environment_layout(), m_parent_scope, LexicalEnvironment::EnvironmentRecordType::Function);
     environment->set_home_object(home_object());
     environment->set_current_function(*this);
     if (m_is_arrow_function) {
@@ -147,6 +161,12 @@ Value ScriptFunction::execute_function_body()
         vm.current_scope()->put_to_scope(parameter.name, { argument_value, DeclarationKind::Var });
     }
 
+    if (vm.bytecode_enabled() && is<ScopeNode>(*m_body)) {
+        auto& body = static_cast<const ScopeNode&>(*m_body);
+        if (auto* executable = body.bytecode_executable())
+            return interpreter->execute_function_body_bytecode(global_object(), body, *executable);
+    }
+
     return interpreter->execute_statement(global_object(), m_body, ScopeType::Function);
 }
 
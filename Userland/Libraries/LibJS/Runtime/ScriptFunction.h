@@ -59,6 +59,8 @@ private:
     virtual LexicalEnvironment* create_environment() override;
     virtual void visit_edges(Visitor&) override;
 
+    const EnvironmentLayout& environment_layout();
+
     Value execute_function_body();
 
     JS_DECLARE_NATIVE_GETTER(length_getter);
@@ -68,6 +70,7 @@ private:
     NonnullRefPtr<Statement> m_body;
     const Vector<FunctionNode::Parameter> m_parameters;
     ScopeObject* m_parent_scope { nullptr };
+    RefPtr<EnvironmentLayout> m_environment_layout;
     i32 m_function_length { 0 };
     bool m_is_strict { false };
     bool m_is_arrow_function { false };
@@ -50,6 +50,7 @@ Shape* Shape::create_put_transition(const StringOrSymbol& property_name, Propert
         return existing_shape;
     auto* new_shape = heap().allocate_without_global_object<Shape>(*this, property_name, attributes, TransitionType::Put);
     m_forward_transitions.set(key, new_shape);
+    write_barrier();
     return new_shape;
 }
 
@@ -60,12 +61,32 @@ Shape* Shape::create_configure_transition(const StringOrSymbol& property_name, P
         return existing_shape;
     auto* new_shape = heap().allocate_without_global_object<Shape>(*this, property_name, attributes, TransitionType::Configure);
     m_forward_transitions.set(key, new_shape);
+    write_barrier();
     return new_shape;
 }
 
 Shape* Shape::create_prototype_transition(Object* new_prototype)
 {
-    return heap().allocate_without_global_object<Shape>(*this, new_prototype);
+    if (auto existing_shape = m_prototype_transitions.get(new_prototype); existing_shape.has_value() && existing_shape->ptr())
+        return existing_shape->ptr();
+    auto* new_shape = heap().allocate_without_global_object<Shape>(*this, new_prototype);
+    // The transitions are only held weakly, so entries for shapes that have since been collected pile up here.
+    // Sweep them out whenever the map is about to grow so that the cost stays amortized.
+    if (m_prototype_transitions.size() >= m_prototype_transitions.capacity() / 2)
+        remove_dead_prototype_transitions();
+    m_prototype_transitions.set(new_prototype, new_shape->make_weak_ptr());
+    return new_shape;
+}
+
+void Shape::remove_dead_prototype_transitions()
+{
+    Vector<Object*> dead_prototypes;
+    for (auto& it : m_prototype_transitions) {
+        if (it.value.is_null())
+            dead_prototypes.append(it.key);
+    }
+    for (auto* prototype : dead_prototypes)
+        m_prototype_transitions.remove(prototype);
 }
 
 Shape::Shape(ShapeWithoutGlobalObjectTag)
@@ -192,6 +213,7 @@ void Shape::add_property_to_unique_shape(const StringOrSymbol& property_name, Pr
     VERIFY(!m_property_table->contains(property_name));
     m_property_table->set(property_name, { m_property_table->size(), attributes });
     ++m_property_count;
+    write_barrier();
 }
 
 void Shape::reconfigure_property_in_unique_shape(const StringOrSymbol& property_name, PropertyAttributes attributes)
@@ -222,6 +244,7 @@ void Shape::add_property_without_transition(const StringOrSymbol& property_name,
     ensure_property_table();
     if (m_property_table->set(property_name, { m_property_count, attributes }) == AK::HashSetResult::InsertedNewEntry)
         ++m_property_count;
+    write_barrier();
 }
 
 }
@@ -28,6 +28,8 @@
 
 #include <AK/HashMap.h>
 #include <AK/OwnPtr.h>
+#include <AK/WeakPtr.h>
+#include <AK/Weakable.h>
 #include <LibJS/Forward.h>
 #include <LibJS/Runtime/Cell.h>
 #include <LibJS/Runtime/PropertyAttributes.h>
@@ -51,7 +53,9 @@ struct TransitionKey {
     }
 };
 
-class Shape final : public Cell {
+class Shape final
+    : public Cell
+    , public Weakable<Shape> {
 public:
     virtual ~Shape() override;
 
@@ -76,6 +80,9 @@ public:
     void add_property_without_transition(const StringOrSymbol&, PropertyAttributes);
 
     bool is_unique() const { return m_unique; }
+
+    // Shapes created by a transition are cached by the shape they came from, so any number of objects may share them.
+    bool is_shared_transition() const { return m_transition_type != TransitionType::Invalid; }
     Shape* create_unique_clone() const;
 
     GlobalObject* global_object() const;
@@ -94,7 +101,11 @@ public:
 
     Vector<Property> property_table_ordered() const;
 
-    void set_prototype_without_transition(Object* new_prototype) { m_prototype = new_prototype; }
+    void set_prototype_without_transition(Object* new_prototype)
+    {
+        m_prototype = new_prototype;
+        write_barrier();
+    }
 
     void remove_property_from_unique_shape(const StringOrSymbol&, size_t offset);
     void add_property_to_unique_shape(const StringOrSymbol&, PropertyAttributes attributes);
@@ -105,6 +116,7 @@ private:
     virtual void visit_edges(Visitor&) override;
 
     void ensure_property_table() const;
+    void remove_dead_prototype_transitions();
 
     PropertyAttributes m_attributes { 0 };
     TransitionType m_transition_type : 6 { TransitionType::Invalid };
@@ -115,6 +127,8 @@ private:
     mutable OwnPtr<HashMap<StringOrSymbol, PropertyMetadata>> m_property_table;
 
     HashMap<TransitionKey, Shape*> m_forward_transitions;
+    // NOTE: These are weak so that a shape doesn't keep every prototype it was ever combined with alive.
+    HashMap<Object*, WeakPtr<Shape>> m_prototype_transitions;
     Shape* m_previous { nullptr };
     StringOrSymbol m_property_name;
     Object* m_prototype { nullptr };
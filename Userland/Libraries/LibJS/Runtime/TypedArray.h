@@ -45,7 +45,11 @@ public:
     void set_array_length(u32 length) { m_array_length = length; }
     void set_byte_length(u32 length) { m_byte_length = length; }
     void set_byte_offset(u32 offset) { m_byte_offset = offset; }
-    void set_viewed_array_buffer(ArrayBuffer* array_buffer) { m_viewed_array_buffer = array_buffer; }
+    void set_viewed_array_buffer(ArrayBuffer* array_buffer)
+    {
+        m_viewed_array_buffer = array_buffer;
+        write_barrier();
+    }
 
     virtual size_t element_size() const = 0;
 
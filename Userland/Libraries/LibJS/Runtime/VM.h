@@ -177,6 +177,18 @@ public:
     bool underscore_is_last_value() const { return m_underscore_is_last_value; }
     void set_underscore_is_last_value(bool b) { m_underscore_is_last_value = b; }
 
+    bool bytecode_enabled() const { return m_bytecode_enabled; }
+    void set_bytecode_enabled(bool b) { m_bytecode_enabled = b; }
+
+    // How often the bytecode's GetById and PutById found the shape they were given in their cache.
+    struct PropertyCacheStatistics {
+        u64 get_hits { 0 };
+        u64 get_misses { 0 };
+        u64 put_hits { 0 };
+        u64 put_misses { 0 };
+    };
+    PropertyCacheStatistics& property_cache_statistics() { return m_property_cache_statistics; }
+
     void unwind(ScopeType type, FlyString label = {})
     {
         m_unwind_until = type;
@@ -259,6 +271,8 @@ private:
     StackInfo m_stack_info;
 
     bool m_underscore_is_last_value { false };
+    bool m_bytecode_enabled { true };
+    PropertyCacheStatistics m_property_cache_statistics;
 
     HashMap<String, Symbol*> m_global_symbol_map;
 
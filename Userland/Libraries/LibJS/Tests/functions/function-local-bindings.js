@@ -0,0 +1,47 @@
+test("closures see assignments to the locals they capture", () => {
+    function counter(start) {
+        let count = start;
+        const increment = () => ++count;
+        increment();
+        count += 10;
+        return [increment(), count];
+    }
+    expect(counter(1)).toEqual([13, 13]);
+});
+
+test("block declarations shadow function locals", () => {
+    function shadow(x) {
+        let result = [];
+        {
+            let x = "inner";
+            result.push(x);
+            {
+                const y = x + "most";
+                result.push(y);
+            }
+        }
+        result.push(x);
+        return result;
+    }
+    expect(shadow("outer")).toEqual(["inner", "innermost", "outer"]);
+});
+
+test("assigning to a const local throws", () => {
+    function assign() {
+        const value = 1;
+        value = 2;
+    }
+    expect(assign).toThrowWithMessage(TypeError, "Invalid assignment to const variable");
+});
+
+test("class declarations shadow locals of the same name", () => {
+    function classShadow() {
+        let Foo = 1;
+        {
+            let unrelated;
+            class Foo {}
+            return typeof Foo;
+        }
+    }
+    expect(classShadow()).toBe("function");
+});
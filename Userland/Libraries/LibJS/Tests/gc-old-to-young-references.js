@@ -0,0 +1,42 @@
+function churn() {
+    let last;
+    for (let i = 0; i < 30000; ++i) last = { i };
+    return last.i;
+}
+
+test("young values stored in old objects survive collections", () => {
+    const object = {};
+    const array = [];
+    let captured;
+    const capture = value => {
+        captured = value;
+    };
+    churn();
+
+    object.property = { value: "property" };
+    array.push({ value: "element" });
+    array[5] = { value: "sparse" };
+    capture({ value: "captured" });
+    Object.setPrototypeOf(object, { inherited: "prototype" });
+    Object.defineProperty(object, "accessor", { get: () => "getter", configurable: true });
+    churn();
+    churn();
+
+    expect(object.property.value).toBe("property");
+    expect(array[0].value).toBe("element");
+    expect(array[5].value).toBe("sparse");
+    expect(captured.value).toBe("captured");
+    expect(object.inherited).toBe("prototype");
+    expect(object.accessor).toBe("getter");
+});
+
+test("old values stay alive across full collections", () => {
+    const objects = [];
+    for (let i = 0; i < 100; ++i) {
+        objects.push({ i });
+        churn();
+    }
+    gc();
+    churn();
+    for (let i = 0; i < 100; ++i) expect(objects[i].i).toBe(i);
+});
@@ -0,0 +1,58 @@
+test("break leaves block scopes entered inside the loop", () => {
+    let outer = "outer";
+    let result = [];
+    for (let i = 0; i < 5; ++i) {
+        let outer = i;
+        {
+            let inner = outer * 2;
+            if (inner > 4) break;
+            result.push(inner);
+        }
+    }
+    expect(result).toEqual([0, 2, 4]);
+    expect(outer).toBe("outer");
+});
+
+test("continue leaves block scopes entered inside the loop", () => {
+    let value = "value";
+    let result = [];
+    let i = 0;
+    while (i < 5) {
+        ++i;
+        let value = i;
+        {
+            let odd = value % 2;
+            if (odd) continue;
+        }
+        result.push(value);
+    }
+    expect(result).toEqual([2, 4]);
+    expect(value).toBe("value");
+});
+
+test("for-let binding is not visible after the loop", () => {
+    function f() {
+        for (let i = 0; i < 3; ++i) {
+            if (i === 1) return typeof i;
+        }
+    }
+    expect(f()).toBe("number");
+    expect(() => {
+        for (let j = 0; j < 1; ++j) {}
+        j;
+    }).toThrowWithMessage(ReferenceError, "'j' is not defined");
+});
+
+test("nested loops break out of the innermost loop only", () => {
+    let pairs = [];
+    for (let i = 0; i < 3; ++i) {
+        do {
+            for (let j = 0; j < 3; ++j) {
+                if (j > i) break;
+                pairs.push(i * 10 + j);
+            }
+            break;
+        } while (true);
+    }
+    expect(pairs).toEqual([0, 10, 11, 20, 21, 22]);
+});
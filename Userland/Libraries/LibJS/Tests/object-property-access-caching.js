@@ -0,0 +1,58 @@
+function getX(object) {
+    return object.x;
+}
+
+function setX(object, value) {
+    object.x = value;
+}
+
+test("property reads keep up with the objects they see", () => {
+    const a = { x: 1 };
+    const b = { y: 2, x: 3 };
+    for (let i = 0; i < 3; ++i) {
+        expect(getX(a)).toBe(1);
+        expect(getX(b)).toBe(3);
+    }
+    delete a.x;
+    expect(getX(a)).toBeUndefined();
+    Object.defineProperty(b, "x", { get: () => "getter" });
+    expect(getX(b)).toBe("getter");
+});
+
+test("property reads see prototype changes", () => {
+    const first = { x: "first" };
+    const second = { x: "second" };
+    const object = {};
+    Object.setPrototypeOf(object, first);
+    for (let i = 0; i < 3; ++i) expect(getX(object)).toBe("first");
+    first.x = "changed";
+    expect(getX(object)).toBe("changed");
+    Object.setPrototypeOf(object, second);
+    expect(getX(object)).toBe("second");
+    object.x = "own";
+    expect(getX(object)).toBe("own");
+});
+
+test("property writes respect attributes", () => {
+    const object = { x: 1 };
+    for (let i = 0; i < 3; ++i) setX(object, i);
+    expect(object.x).toBe(2);
+    Object.defineProperty(object, "x", { writable: false });
+    setX(object, 42);
+    expect(object.x).toBe(2);
+});
+
+test("property accesses on proxies always reach the handler", () => {
+    let reads = 0;
+    const proxy = new Proxy(
+        { x: 1 },
+        {
+            get(target, property) {
+                ++reads;
+                return target[property];
+            },
+        }
+    );
+    for (let i = 0; i < 3; ++i) expect(getX(proxy)).toBe(1);
+    expect(reads).toBe(3);
+});
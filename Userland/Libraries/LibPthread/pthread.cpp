@@ -106,6 +106,7 @@ static int create_thread(pthread_t* thread, void* (*entry)(void*), void* argumen
 [[noreturn]] static void exit_thread(void* code)
 {
     KeyDestroyer::destroy_for_current_thread();
+    __malloc_flush_thread_cache();
     syscall(SC_exit_thread, code);
     VERIFY_NOT_REACHED();
 }
@@ -187,18 +188,7 @@ int pthread_mutex_lock(pthread_mutex_t* mutex)
 
 int pthread_mutex_trylock(pthread_mutex_t* mutex)
 {
-    auto& atomic = reinterpret_cast<Atomic<u32>&>(mutex->lock);
-    u32 expected = false;
-    if (!atomic.compare_exchange_strong(expected, true, AK::memory_order_acq_rel)) {
-        if (mutex->type == PTHREAD_MUTEX_RECURSIVE && mutex->owner == pthread_self()) {
-            mutex->level++;
-            return 0;
-        }
-        return EBUSY;
-    }
-    mutex->owner = pthread_self();
-    mutex->level = 0;
-    return 0;
+    return __pthread_mutex_trylock(mutex);
 }
 
 int pthread_mutex_unlock(pthread_mutex_t* mutex)
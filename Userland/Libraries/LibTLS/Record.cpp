@@ -36,7 +36,7 @@ namespace TLS {
 
 void TLSv12::write_packet(ByteBuffer& packet)
 {
-    m_context.tls_buffer.append(packet.data(), packet.size());
+    m_context.tls_buffer.append(packet);
     if (m_context.connection_status > ConnectionStatus::Disconnected) {
         if (!m_has_scheduled_write_flush) {
             dbgln_if(TLS_DEBUG, "Scheduling write of {}", m_context.tls_buffer.size());
@@ -84,15 +84,8 @@ void TLSv12::update_packet(ByteBuffer& packet)
             }
 
             if (m_context.crypto.created == 1) {
-                // `buffer' will continue to be encrypted
-                auto buffer = ByteBuffer::create_uninitialized(length);
-                size_t buffer_position = 0;
                 auto iv_size = iv_length();
 
-                // copy the packet, sans the header
-                buffer.overwrite(buffer_position, packet.offset_pointer(header_size), packet.size() - header_size);
-                buffer_position += packet.size() - header_size;
-
                 ByteBuffer ct;
 
                 if (is_aead()) {
@@ -150,31 +143,38 @@ void TLSv12::update_packet(ByteBuffer& packet)
                     // copy the header over
                     ct.overwrite(0, packet.data(), header_size - 2);
 
+                    // Lay out the plaintext, the MAC and the padding where the ciphertext goes, and encrypt them in place.
+                    auto buffer = ct.bytes().slice(header_size + iv_size, length);
+                    size_t buffer_position = 0;
+
+                    // copy the packet, sans the header
+                    packet.bytes().slice(header_size).copy_to(buffer);
+                    buffer_position += packet.size() - header_size;
+
                     // get the appropricate HMAC value for the entire packet
                     auto mac = hmac_message(packet, {}, mac_size, true);
 
                     // write the MAC
-                    buffer.overwrite(buffer_position, mac.data(), mac.size());
-                    buffer_position += mac.size();
+                    __builtin_memcpy(buffer.offset(buffer_position), mac.immutable_data(), mac_size);
+                    buffer_position += mac_size;
 
                     // Apply the padding (a packet MUST always be padded)
-                    memset(buffer.offset_pointer(buffer_position), padding - 1, padding);
+                    memset(buffer.offset(buffer_position), padding - 1, padding);
                     buffer_position += padding;
 
                     VERIFY(buffer_position == buffer.size());
 
-                    auto iv = ByteBuffer::create_uninitialized(iv_size);
-                    fill_with_random(iv.data(), iv.size());
+                    u8 iv[16];
+                    VERIFY(iv_size <= sizeof(iv));
+                    fill_with_random(iv, iv_size);
 
                     // write it into the ciphertext portion of the message
-                    ct.overwrite(header_size, iv.data(), iv.size());
+                    ct.overwrite(header_size, iv, iv_size);
 
                     VERIFY(header_size + iv_size + length == ct.size());
                     VERIFY(length % block_size == 0);
 
-                    // get a block to encrypt into
-                    auto view = ct.bytes().slice(header_size + iv_size, length);
-                    m_aes_local.cbc->encrypt(buffer, view, iv);
+                    m_aes_local.cbc->encrypt(buffer, buffer, { iv, iv_size });
                 }
 
                 // store the correct ciphertext length into the packet
@@ -195,7 +195,7 @@ void TLSv12::update_hash(ReadonlyBytes message)
     m_context.handshake_hash.update(message);
 }
 
-ByteBuffer TLSv12::hmac_message(const ReadonlyBytes& buf, const Optional<ReadonlyBytes> buf2, size_t mac_length, bool local)
+Crypto::Authentication::HMAC<Crypto::Hash::Manager>::TagType TLSv12::hmac_message(const ReadonlyBytes& buf, const Optional<ReadonlyBytes> buf2, size_t mac_length, bool local)
 {
     u64 sequence_number = AK::convert_between_host_and_network_endian(local ? m_context.local_sequence_number : m_context.remote_sequence_number);
     ensure_hmac(mac_length, local);
@@ -214,17 +214,16 @@ ByteBuffer TLSv12::hmac_message(const ReadonlyBytes& buf, const Optional<Readonl
         hmac.update(buf2.value());
     }
     auto digest = hmac.digest();
-    auto mac = ByteBuffer::copy(digest.immutable_data(), digest.data_length());
 
     if constexpr (TLS_DEBUG) {
         dbgln("HMAC of the block for sequence number {}", sequence_number);
-        print_buffer(mac);
+        print_buffer(digest.immutable_data(), digest.data_length());
     }
 
-    return mac;
+    return digest;
 }
 
-ssize_t TLSv12::handle_message(ReadonlyBytes buffer)
+ssize_t TLSv12::handle_message(Bytes buffer)
 {
     auto res { 5ll };
     size_t header_size = res;
@@ -258,10 +257,9 @@ ssize_t TLSv12::handle_message(ReadonlyBytes buffer)
     }
 
     dbgln_if(TLS_DEBUG, "message type: {}, length: {}", (u8)type, length);
-    auto plain = buffer.slice(buffer_position, buffer.size() - buffer_position);
-
-    ByteBuffer decrypted;
+    ReadonlyBytes plain = buffer.slice(buffer_position, buffer.size() - buffer_position);
 
+    // The record is decrypted in place, right in the receive buffer.
     if (m_context.cipher_spec_set && type != MessageType::ChangeCipher) {
         if constexpr (TLS_DEBUG) {
             dbgln("Encrypted: ");
@@ -279,8 +277,7 @@ ssize_t TLSv12::handle_message(ReadonlyBytes buffer)
             }
 
             auto packet_length = length - iv_length() - 16;
-            auto payload = plain;
-            decrypted = ByteBuffer::create_uninitialized(packet_length);
+            auto payload = buffer.slice(buffer_position, buffer.size() - buffer_position);
 
             // AEAD AAD (13)
             // Seq. no (8)
@@ -318,7 +315,7 @@ ssize_t TLSv12::handle_message(ReadonlyBytes buffer)
 
             auto consistency = m_aes_remote.gcm->decrypt(
                 ciphertext,
-                decrypted,
+                ciphertext,
                 iv_bytes,
                 aad_bytes,
                 tag);
@@ -331,22 +328,28 @@ ssize_t TLSv12::handle_message(ReadonlyBytes buffer)
                 return (i8)Error::IntegrityCheckFailed;
             }
 
-            plain = decrypted;
+            plain = ciphertext;
         } else {
             VERIFY(m_aes_remote.cbc);
             auto iv_size = iv_length();
 
-            decrypted = m_aes_remote.cbc->create_aligned_buffer(length - iv_size);
+            if (length < iv_size || (length - iv_size) % m_aes_remote.cbc->cipher().block_size() != 0) {
+                dbgln("broken packet");
+                auto packet = build_alert(true, (u8)AlertDescription::DecryptError);
+                write_packet(packet);
+                return (i8)Error::BrokenPacket;
+            }
+
             auto iv = buffer.slice(header_size, iv_size);
 
-            Bytes decrypted_span = decrypted;
-            m_aes_remote.cbc->decrypt(buffer.slice(header_size + iv_size, length - iv_size), decrypted_span, iv);
+            auto decrypted_span = buffer.slice(header_size + iv_size, length - iv_size);
+            m_aes_remote.cbc->decrypt(decrypted_span, decrypted_span, iv);
 
             length = decrypted_span.size();
 
 #if TLS_DEBUG
             dbgln("Decrypted: ");
-            print_buffer(decrypted);
+            print_buffer(decrypted_span);
 #endif
 
             auto mac_size = mac_length();
@@ -365,18 +368,18 @@ ssize_t TLSv12::handle_message(ReadonlyBytes buffer)
             *(u16*)(temp_buf + 3) = AK::convert_between_host_and_network_endian(length);
             auto hmac = hmac_message({ temp_buf, 5 }, decrypted_span.slice(0, length), mac_size);
             auto message_mac = ReadonlyBytes { message_hmac, mac_size };
-            if (hmac != message_mac) {
+            if (ReadonlyBytes { hmac.immutable_data(), mac_size } != message_mac) {
                 dbgln("integrity check failed (mac length {})", mac_size);
                 dbgln("mac received:");
                 print_buffer(message_mac);
                 dbgln("mac computed:");
-                print_buffer(hmac);
+                print_buffer(hmac.immutable_data(), mac_size);
                 auto packet = build_alert(true, (u8)AlertDescription::BadRecordMAC);
                 write_packet(packet);
 
                 return (i8)Error::IntegrityCheckFailed;
             }
-            plain = decrypted.bytes().slice(0, length);
+            plain = decrypted_span.slice(0, length);
         }
     }
     m_context.remote_sequence_number++;
@@ -391,7 +394,7 @@ ssize_t TLSv12::handle_message(ReadonlyBytes buffer)
         } else {
             dbgln_if(TLS_DEBUG, "application data message of size {}", plain.size());
 
-            m_context.application_buffer.append(plain.data(), plain.size());
+            m_context.application_buffer.append(plain);
         }
         break;
     case MessageType::Handshake:
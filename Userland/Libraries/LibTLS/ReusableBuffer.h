@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/ByteBuffer.h>
+#include <AK/Span.h>
+#include <AK/Types.h>
+
+namespace TLS {
+
+// A queue of bytes that hangs on to its storage. Data is appended at the end and consumed from the front,
+// what's left is only moved back to the start when room is needed, and the storage grows geometrically.
+// ByteBuffer::append() reallocates on every call, this lets a connection in a steady state not allocate at all.
+class ReusableBuffer {
+public:
+    bool is_empty() const { return m_start == m_end; }
+    size_t size() const { return m_end - m_start; }
+
+    Bytes bytes() { return { m_storage.offset_pointer(m_start), size() }; }
+    ReadonlyBytes bytes() const { return { m_storage.offset_pointer(m_start), size() }; }
+
+    // Returns room for at least minimum_size more bytes at the end, call commit() with the number of bytes written into it.
+    Bytes free_space(size_t minimum_size)
+    {
+        if (m_storage.size() - m_end < minimum_size) {
+            auto used_size = size();
+            if (m_storage.size() - used_size >= minimum_size) {
+                __builtin_memmove(m_storage.data(), m_storage.offset_pointer(m_start), used_size);
+            } else {
+                auto new_storage = ByteBuffer::create_uninitialized(max(m_storage.size() * 2, used_size + minimum_size));
+                if (used_size)
+                    __builtin_memcpy(new_storage.data(), m_storage.offset_pointer(m_start), used_size);
+                m_storage = move(new_storage);
+            }
+            m_start = 0;
+            m_end = used_size;
+        }
+        return { m_storage.offset_pointer(m_end), m_storage.size() - m_end };
+    }
+
+    void commit(size_t size)
+    {
+        VERIFY(m_end + size <= m_storage.size());
+        m_end += size;
+    }
+
+    void append(ReadonlyBytes data)
+    {
+        if (data.is_empty())
+            return;
+        data.copy_to(free_space(data.size()));
+        commit(data.size());
+    }
+
+    void consume(size_t size)
+    {
+        VERIFY(size <= this->size());
+        m_start += size;
+        if (m_start == m_end)
+            clear();
+    }
+
+    void clear()
+    {
+        m_start = 0;
+        m_end = 0;
+    }
+
+private:
+    ByteBuffer m_storage;
+    size_t m_start { 0 };
+    size_t m_end { 0 };
+};
+
+}
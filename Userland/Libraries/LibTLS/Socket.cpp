@@ -33,10 +33,13 @@
 
 namespace TLS {
 
+// Leaves room for at least one maximum size record (2^14 bytes of ciphertext plus 2048 of expansion) per read.
+static constexpr size_t receive_buffer_minimum_space = 32 * KiB;
+
 Optional<ByteBuffer> TLSv12::read()
 {
     if (m_context.application_buffer.size()) {
-        auto buf = m_context.application_buffer.slice(0, m_context.application_buffer.size());
+        auto buf = ByteBuffer::copy(m_context.application_buffer.bytes());
         m_context.application_buffer.clear();
         return buf;
     }
@@ -47,8 +50,8 @@ ByteBuffer TLSv12::read(size_t max_size)
 {
     if (m_context.application_buffer.size()) {
         auto length = min(m_context.application_buffer.size(), max_size);
-        auto buf = m_context.application_buffer.slice(0, length);
-        m_context.application_buffer = m_context.application_buffer.slice(length, m_context.application_buffer.size() - length);
+        auto buf = ByteBuffer::copy(m_context.application_buffer.bytes().slice(0, length));
+        m_context.application_buffer.consume(length);
         return buf;
     }
     return {};
@@ -59,8 +62,8 @@ String TLSv12::read_line(size_t max_size)
     if (!can_read_line())
         return {};
 
-    auto* start = m_context.application_buffer.data();
-    auto* newline = (u8*)memchr(m_context.application_buffer.data(), '\n', m_context.application_buffer.size());
+    auto* start = m_context.application_buffer.bytes().data();
+    auto* newline = (const u8*)memchr(start, '\n', m_context.application_buffer.size());
     VERIFY(newline);
 
     size_t offset = newline - start;
@@ -69,7 +72,7 @@ String TLSv12::read_line(size_t max_size)
         return {};
 
     auto buffer = ByteBuffer::copy(start, offset);
-    m_context.application_buffer = m_context.application_buffer.slice(offset + 1, m_context.application_buffer.size() - offset - 1);
+    m_context.application_buffer.consume(offset + 1);
 
     return String::copy(buffer, Chomp);
 }
@@ -169,7 +172,15 @@ void TLSv12::read_from_socket()
     if (!check_connection_state(true))
         return;
 
-    consume(Core::Socket::read(4096));
+    // Read straight into the record buffer, and as much as the socket has, so that a busy
+    // connection gets several records handled per wakeup instead of a few KiB at a time.
+    auto free_space = m_context.message_buffer.free_space(receive_buffer_minimum_space);
+    auto nread = Core::Socket::read(free_space.data(), free_space.size());
+    if (nread <= 0)
+        return;
+    m_context.message_buffer.commit(nread);
+
+    consume();
 }
 
 void TLSv12::write_into_socket()
@@ -230,7 +241,7 @@ bool TLSv12::check_connection_state(bool read)
 
 bool TLSv12::flush()
 {
-    auto out_buffer = write_buffer().data();
+    auto out_buffer = write_buffer().bytes().data();
     size_t out_buffer_index { 0 };
     size_t out_buffer_length = write_buffer().size();
 
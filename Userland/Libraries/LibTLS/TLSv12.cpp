@@ -539,36 +539,32 @@ ssize_t TLSv12::handle_certificate(ReadonlyBytes buffer)
     return res;
 }
 
-void TLSv12::consume(ReadonlyBytes record)
+void TLSv12::consume()
 {
     if (m_context.critical_error) {
         dbgln("There has been a critical error ({}), refusing to continue", (i8)m_context.critical_error);
         return;
     }
 
-    if (record.size() == 0) {
+    auto& buffer = m_context.message_buffer;
+    if (buffer.is_empty()) {
         return;
     }
 
-    dbgln_if(TLS_DEBUG, "Consuming {} bytes", record.size());
-
-    m_context.message_buffer.append(record.data(), record.size());
-
-    size_t index { 0 };
-    size_t buffer_length = m_context.message_buffer.size();
-
     size_t size_offset { 3 }; // read the common record header
     size_t header_size { 5 };
 
-    dbgln_if(TLS_DEBUG, "message buffer length {}", buffer_length);
+    dbgln_if(TLS_DEBUG, "message buffer length {}", buffer.size());
 
-    while (buffer_length >= 5) {
-        auto length = AK::convert_between_host_and_network_endian(*(u16*)m_context.message_buffer.offset_pointer(index + size_offset)) + header_size;
-        if (length > buffer_length) {
-            dbgln_if(TLS_DEBUG, "Need more data: {} > {}", length, buffer_length);
+    // Handle every complete record we have; each is decrypted where it sits in the buffer.
+    while (buffer.size() >= 5) {
+        auto records = buffer.bytes();
+        auto length = AK::convert_between_host_and_network_endian(*(const u16*)records.offset(size_offset)) + header_size;
+        if (length > records.size()) {
+            dbgln_if(TLS_DEBUG, "Need more data: {} > {}", length, records.size());
             break;
         }
-        auto consumed = handle_message(m_context.message_buffer.bytes().slice(index, length));
+        auto consumed = handle_message(records.slice(0, length));
 
         if constexpr (TLS_DEBUG) {
             if (consumed > 0)
@@ -589,8 +585,7 @@ void TLSv12::consume(ReadonlyBytes record)
             continue;
         }
 
-        index += length;
-        buffer_length -= length;
+        buffer.consume(length);
         if (m_context.critical_error) {
             dbgln("Broken connection");
             m_context.error_code = Error::BrokenConnection;
@@ -599,13 +594,9 @@ void TLSv12::consume(ReadonlyBytes record)
     }
     if (m_context.error_code != Error::NoError && m_context.error_code != Error::NeedMoreData) {
         dbgln("consume error: {}", (i8)m_context.error_code);
-        m_context.message_buffer.clear();
+        buffer.clear();
         return;
     }
-
-    if (index) {
-        m_context.message_buffer = m_context.message_buffer.slice(index, m_context.message_buffer.size() - index);
-    }
 }
 
 void TLSv12::ensure_hmac(size_t digest_size, bool local)
@@ -818,7 +809,6 @@ TLSv12::TLSv12(Core::Object* parent, Version version)
 {
     m_context.version = version;
     m_context.is_server = false;
-    m_context.tls_buffer = ByteBuffer::create_uninitialized(0);
 #ifdef SOCK_NONBLOCK
     int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
 #else
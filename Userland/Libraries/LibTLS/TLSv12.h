@@ -37,6 +37,7 @@
 #include <LibCrypto/Cipher/AES.h>
 #include <LibCrypto/Hash/HashManager.h>
 #include <LibCrypto/PK/RSA.h>
+#include <LibTLS/ReusableBuffer.h>
 #include <LibTLS/TLSPacketBuilder.h>
 
 namespace TLS {
@@ -228,7 +229,8 @@ struct Context {
 
     Crypto::Hash::Manager handshake_hash;
 
-    ByteBuffer message_buffer;
+    // Records are read into this and decrypted in place.
+    ReusableBuffer message_buffer;
     u64 remote_sequence_number { 0 };
     u64 local_sequence_number { 0 };
 
@@ -236,9 +238,9 @@ struct Context {
     u8 critical_error { 0 };
     Error error_code { Error::NoError };
 
-    ByteBuffer tls_buffer;
+    ReusableBuffer tls_buffer;
 
-    ByteBuffer application_buffer;
+    ReusableBuffer application_buffer;
 
     bool is_child { false };
 
@@ -268,7 +270,7 @@ struct Context {
 class TLSv12 : public Core::Socket {
     C_OBJECT(TLSv12)
 public:
-    ByteBuffer& write_buffer() { return m_context.tls_buffer; }
+    ReusableBuffer& write_buffer() { return m_context.tls_buffer; }
     bool is_established() const { return m_context.connection_status == ConnectionStatus::Established; }
     virtual bool connect(const String&, int) override;
 
@@ -320,7 +322,7 @@ public:
     bool write(ReadonlyBytes);
     void alert(AlertLevel, AlertDescription);
 
-    bool can_read_line() const { return m_context.application_buffer.size() && memchr(m_context.application_buffer.data(), '\n', m_context.application_buffer.size()); }
+    bool can_read_line() const { return m_context.application_buffer.size() && memchr(m_context.application_buffer.bytes().data(), '\n', m_context.application_buffer.size()); }
     bool can_read() const { return m_context.application_buffer.size() > 0; }
     String read_line(size_t max_size);
 
@@ -336,9 +338,9 @@ private:
 
     virtual bool common_connect(const struct sockaddr*, socklen_t) override;
 
-    void consume(ReadonlyBytes record);
+    void consume();
 
-    ByteBuffer hmac_message(const ReadonlyBytes& buf, const Optional<ReadonlyBytes> buf2, size_t mac_length, bool local = false);
+    Crypto::Authentication::HMAC<Crypto::Hash::Manager>::TagType hmac_message(const ReadonlyBytes& buf, const Optional<ReadonlyBytes> buf2, size_t mac_length, bool local = false);
     void ensure_hmac(size_t digest_size, bool local);
 
     void update_packet(ByteBuffer& packet);
@@ -371,7 +373,7 @@ private:
     ssize_t handle_server_hello_done(ReadonlyBytes);
     ssize_t handle_verify(ReadonlyBytes);
     ssize_t handle_payload(ReadonlyBytes);
-    ssize_t handle_message(ReadonlyBytes);
+    ssize_t handle_message(Bytes);
     ssize_t handle_random(ReadonlyBytes);
 
     size_t asn1_length(ReadonlyBytes, size_t* octets);
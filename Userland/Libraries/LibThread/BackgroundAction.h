@@ -29,69 +29,60 @@
 #include <AK/Function.h>
 #include <AK/NonnullRefPtr.h>
 #include <AK/Optional.h>
-#include <AK/Queue.h>
 #include <LibCore/Event.h>
 #include <LibCore/EventLoop.h>
 #include <LibCore/Object.h>
-#include <LibThread/Lock.h>
-#include <LibThread/Thread.h>
+#include <LibThread/ThreadPool.h>
 
 namespace LibThread {
 
 template<typename Result>
-class BackgroundAction;
-
-class BackgroundActionBase {
-    template<typename Result>
-    friend class BackgroundAction;
-
-private:
-    BackgroundActionBase() { }
-
-    static Lockable<Queue<Function<void()>>>& all_actions();
-    static Thread& background_thread();
-};
-
-template<typename Result>
-class BackgroundAction final : public Core::Object
-    , private BackgroundActionBase {
+class BackgroundAction final : public Core::Object {
     C_OBJECT(BackgroundAction);
 
 public:
     static NonnullRefPtr<BackgroundAction<Result>> create(
         Function<Result()> action,
-        Function<void(Result)> on_complete = nullptr)
+        Function<void(Result)> on_complete = nullptr,
+        ThreadPool::Priority priority = ThreadPool::Priority::Normal)
     {
-        return adopt(*new BackgroundAction(move(action), move(on_complete)));
+        auto background_action = adopt(*new BackgroundAction(move(action), move(on_complete)));
+        background_action->start(priority);
+        return background_action;
     }
 
     virtual ~BackgroundAction() { }
 
+    // Returns false if the action has already started running, in which case
+    // on_complete will still be called.
+    bool cancel() { return m_job->cancel(); }
+
 private:
     BackgroundAction(Function<Result()> action, Function<void(Result)> on_complete)
-        : Core::Object(&background_thread())
-        , m_action(move(action))
+        : m_action(move(action))
         , m_on_complete(move(on_complete))
     {
-        LOCKER(all_actions().lock());
+    }
 
-        all_actions().resource().enqueue([this] {
+    void start(ThreadPool::Priority priority)
+    {
+        // The job keeps us alive until the result has been delivered on the event loop's
+        // thread, which is also where we get destroyed.
+        m_job = ThreadPool::the().submit([this, protector = NonnullRefPtr(*this)]() mutable {
             m_result = m_action();
-            if (m_on_complete) {
-                Core::EventLoop::current().post_event(*this, make<Core::DeferredInvocationEvent>([this](auto&) {
+            Core::EventLoop::current().post_event(*this, make<Core::DeferredInvocationEvent>([this, protector = move(protector)](auto&) {
+                if (m_on_complete)
                     m_on_complete(m_result.release_value());
-                    this->remove_from_parent();
-                }));
-                Core::EventLoop::wake();
-            } else {
-                this->remove_from_parent();
-            }
-        });
+            }));
+            Core::EventLoop::wake();
+        },
+            priority);
     }
 
     Function<Result()> m_action;
     Function<void(Result)> m_on_complete;
     Optional<Result> m_result;
+    RefPtr<ThreadPool::Job> m_job;
 };
 
 }
@@ -31,6 +31,8 @@
 #    include <AK/Assertions.h>
 #    include <AK/Atomic.h>
 #    include <AK/Types.h>
+#    include <bits/pthread_integration.h>
+#    include <sys/types.h>
 #    include <unistd.h>
 
 namespace LibThread {
@@ -44,6 +46,8 @@ public:
     void unlock();
 
 private:
+    // A zero-initialized Lock must be usable, as malloc() sets up its lock that way.
+    pthread_mutex_t m_mutex __PTHREAD_MUTEX_INITIALIZER;
     Atomic<pid_t> m_holder { 0 };
     u32 m_level { 0 };
 };
@@ -70,24 +74,22 @@ ALWAYS_INLINE void Lock::lock()
         ++m_level;
         return;
     }
-    for (;;) {
-        int expected = 0;
-        if (m_holder.compare_exchange_strong(expected, tid, AK::memory_order_acq_rel)) {
-            m_level = 1;
-            return;
-        }
-        donate(expected);
-    }
+    __pthread_mutex_lock(&m_mutex);
+    m_holder.store(tid, AK::memory_order_relaxed);
+    m_level = 1;
 }
 
 inline void Lock::unlock()
 {
     VERIFY(m_holder == gettid());
     VERIFY(m_level);
-    if (m_level == 1)
-        m_holder.store(0, AK::memory_order_release);
-    else
+    if (m_level == 1) {
+        m_holder.store(0, AK::memory_order_relaxed);
+        m_level = 0;
+        __pthread_mutex_unlock(&m_mutex);
+    } else {
         --m_level;
+    }
 }
 
 #    define LOCKER(lock) LibThread::Locker locker(lock)
@@ -0,0 +1,239 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <LibThread/ThreadPool.h>
+#include <unistd.h>
+
+namespace LibThread {
+
+// The pool and worker that the current thread belongs to, if any.
+static __thread ThreadPool* s_current_pool;
+static __thread size_t s_current_worker_index;
+
+bool ThreadPool::Job::cancel()
+{
+    auto expected = State::Pending;
+    if (!m_state.compare_exchange_strong(expected, State::Cancelled))
+        return false;
+    // The job will never start now, so whatever the action captured can go right away.
+    m_action = nullptr;
+    return true;
+}
+
+bool ThreadPool::Job::try_start()
+{
+    auto expected = State::Pending;
+    return m_state.compare_exchange_strong(expected, State::Running);
+}
+
+void ThreadPool::Job::finish()
+{
+    m_action = nullptr;
+    m_state.store(State::Finished);
+}
+
+void ThreadPool::JobQueue::enqueue(NonnullRefPtr<Job> job)
+{
+    // Reclaim the slots that have been taken from the front before growing the vector.
+    if (m_head != 0 && m_jobs.size() == m_jobs.capacity()) {
+        m_jobs.remove(0, m_head);
+        m_head = 0;
+    }
+    m_jobs.append(move(job));
+}
+
+RefPtr<ThreadPool::Job> ThreadPool::JobQueue::take_front()
+{
+    if (is_empty())
+        return nullptr;
+    auto job = move(m_jobs[m_head++]);
+    if (is_empty()) {
+        m_jobs.clear_with_capacity();
+        m_head = 0;
+    }
+    return job;
+}
+
+RefPtr<ThreadPool::Job> ThreadPool::JobQueue::take_back()
+{
+    if (is_empty())
+        return nullptr;
+    auto job = m_jobs.take_last();
+    if (is_empty()) {
+        m_jobs.clear_with_capacity();
+        m_head = 0;
+    }
+    return job;
+}
+
+ThreadPool& ThreadPool::the()
+{
+    static ThreadPool* s_the;
+    static pthread_once_t s_once = PTHREAD_ONCE_INIT;
+    pthread_once(&s_once, [] {
+        auto cpu_count = sysconf(_SC_NPROCESSORS_ONLN);
+        s_the = new ThreadPool(cpu_count > 0 ? cpu_count : 1, "Background thread");
+    });
+    return *s_the;
+}
+
+ThreadPool::ThreadPool(size_t worker_count, StringView worker_name)
+{
+    VERIFY(worker_count > 0);
+    pthread_mutex_init(&m_sleep_mutex, nullptr);
+    pthread_cond_init(&m_work_available, nullptr);
+    pthread_cond_init(&m_idle, nullptr);
+
+    m_workers.ensure_capacity(worker_count);
+    for (size_t i = 0; i < worker_count; ++i) {
+        auto worker = make<Worker>();
+        worker->index = i;
+        m_workers.append(move(worker));
+    }
+    // Workers steal from each other, so every worker must exist before any of them runs.
+    for (auto& worker : m_workers) {
+        worker.thread = Thread::construct([this, &worker] { return run_worker(worker); }, worker_name);
+        worker.thread->start();
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    // Thread forgets its tid as soon as its action returns, so grab them while the workers
+    // are still guaranteed to be running.
+    Vector<pthread_t> worker_tids;
+    for (auto& worker : m_workers)
+        worker_tids.append(worker.thread->tid());
+
+    pthread_mutex_lock(&m_sleep_mutex);
+    m_should_exit = true;
+    pthread_cond_broadcast(&m_work_available);
+    pthread_mutex_unlock(&m_sleep_mutex);
+
+    for (auto tid : worker_tids)
+        pthread_join(tid, nullptr);
+
+    pthread_cond_destroy(&m_idle);
+    pthread_cond_destroy(&m_work_available);
+    pthread_mutex_destroy(&m_sleep_mutex);
+}
+
+NonnullRefPtr<ThreadPool::Job> ThreadPool::submit(Function<void()> action, Priority priority)
+{
+    auto job = adopt(*new Job(move(action), priority));
+
+    // Jobs submitted from inside the pool stay on the submitting worker, where they are
+    // likely to find their data still in cache. Everything else is spread round-robin.
+    auto worker_index = s_current_pool == this ? s_current_worker_index : m_next_worker++ % m_workers.size();
+    auto& worker = m_workers[worker_index];
+
+    ++m_unfinished_jobs;
+    // This is bumped before the job becomes visible, so the count may briefly be ahead of
+    // the queues but never behind them; a sleeping worker can't miss the job this way.
+    ++m_queued_jobs;
+    {
+        Locker locker(worker.lock);
+        worker.queues[static_cast<size_t>(priority)].enqueue(job);
+    }
+
+    if (m_sleeping_workers.load() != 0) {
+        pthread_mutex_lock(&m_sleep_mutex);
+        pthread_cond_signal(&m_work_available);
+        pthread_mutex_unlock(&m_sleep_mutex);
+    }
+    return job;
+}
+
+void ThreadPool::wait_until_idle()
+{
+    VERIFY(s_current_pool != this);
+    pthread_mutex_lock(&m_sleep_mutex);
+    while (m_unfinished_jobs.load() != 0)
+        pthread_cond_wait(&m_idle, &m_sleep_mutex);
+    pthread_mutex_unlock(&m_sleep_mutex);
+}
+
+RefPtr<ThreadPool::Job> ThreadPool::take_job_from(Worker& worker, Priority priority, bool steal)
+{
+    auto& queue = worker.queues[static_cast<size_t>(priority)];
+    Locker locker(worker.lock);
+    return steal ? queue.take_back() : queue.take_front();
+}
+
+RefPtr<ThreadPool::Job> ThreadPool::take_job(Worker& worker)
+{
+    // Higher priority work anywhere in the pool goes before lower priority work at home.
+    for (ssize_t priority = priority_count - 1; priority >= 0; --priority) {
+        if (auto job = take_job_from(worker, static_cast<Priority>(priority), false))
+            return job;
+        for (size_t i = 1; i < m_workers.size(); ++i) {
+            auto& victim = m_workers[(worker.index + i) % m_workers.size()];
+            if (auto job = take_job_from(victim, static_cast<Priority>(priority), true))
+                return job;
+        }
+    }
+    return nullptr;
+}
+
+void ThreadPool::did_finish_job()
+{
+    if (--m_unfinished_jobs != 0)
+        return;
+    pthread_mutex_lock(&m_sleep_mutex);
+    pthread_cond_broadcast(&m_idle);
+    pthread_mutex_unlock(&m_sleep_mutex);
+}
+
+int ThreadPool::run_worker(Worker& worker)
+{
+    s_current_pool = this;
+    s_current_worker_index = worker.index;
+
+    while (!m_should_exit.load()) {
+        if (auto job = take_job(worker)) {
+            --m_queued_jobs;
+            // Cancelled jobs are simply dropped here.
+            if (job->try_start()) {
+                job->m_action();
+                job->finish();
+            }
+            did_finish_job();
+            continue;
+        }
+
+        pthread_mutex_lock(&m_sleep_mutex);
+        ++m_sleeping_workers;
+        while (m_queued_jobs.load() == 0 && !m_should_exit.load())
+            pthread_cond_wait(&m_work_available, &m_sleep_mutex);
+        --m_sleeping_workers;
+        pthread_mutex_unlock(&m_sleep_mutex);
+    }
+
+    s_current_pool = nullptr;
+    return 0;
+}
+
+}
@@ -0,0 +1,147 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/Atomic.h>
+#include <AK/Function.h>
+#include <AK/NonnullOwnPtrVector.h>
+#include <AK/NonnullRefPtr.h>
+#include <AK/RefCounted.h>
+#include <AK/StringView.h>
+#include <AK/Vector.h>
+#include <LibThread/Lock.h>
+#include <LibThread/Thread.h>
+#include <pthread.h>
+
+namespace LibThread {
+
+// A pool of worker threads, each with its own job queues. Workers take jobs from
+// their own queues first and steal from the other workers when those run dry, so
+// that independent jobs don't all have to go through a single shared queue.
+class ThreadPool {
+    AK_MAKE_NONCOPYABLE(ThreadPool);
+    AK_MAKE_NONMOVABLE(ThreadPool);
+
+public:
+    enum class Priority {
+        Low,
+        Normal,
+        High,
+    };
+    static constexpr size_t priority_count = 3;
+
+    class Job : public RefCounted<Job> {
+        friend class ThreadPool;
+
+    public:
+        // Returns false if the job has already started running.
+        bool cancel();
+
+        bool is_cancelled() const { return m_state.load() == State::Cancelled; }
+        bool is_finished() const { return m_state.load() == State::Finished; }
+        Priority priority() const { return m_priority; }
+
+    private:
+        enum class State {
+            Pending,
+            Running,
+            Finished,
+            Cancelled,
+        };
+
+        Job(Function<void()> action, Priority priority)
+            : m_action(move(action))
+            , m_priority(priority)
+        {
+        }
+
+        bool try_start();
+        void finish();
+
+        Function<void()> m_action;
+        const Priority m_priority;
+        Atomic<State> m_state { State::Pending };
+    };
+
+    // The process-wide pool that BackgroundAction uses, with one worker per CPU.
+    static ThreadPool& the();
+
+    explicit ThreadPool(size_t worker_count, StringView worker_name = "Worker");
+    ~ThreadPool();
+
+    NonnullRefPtr<Job> submit(Function<void()>, Priority = Priority::Normal);
+
+    // Blocks until every job submitted so far has either finished or been cancelled.
+    // This must not be called from one of the pool's own workers.
+    void wait_until_idle();
+
+    size_t worker_count() const { return m_workers.size(); }
+
+private:
+    // Workers take jobs from the front of their own queue, and steal from the back of
+    // the others' queues, so a worker and its thieves rarely go for the same job.
+    class JobQueue {
+    public:
+        bool is_empty() const { return m_head == m_jobs.size(); }
+        void enqueue(NonnullRefPtr<Job>);
+        RefPtr<Job> take_front();
+        RefPtr<Job> take_back();
+
+    private:
+        Vector<RefPtr<Job>> m_jobs;
+        size_t m_head { 0 };
+    };
+
+    struct Worker {
+        size_t index { 0 };
+        Lock lock;
+        JobQueue queues[priority_count];
+        RefPtr<Thread> thread;
+    };
+
+    int run_worker(Worker&);
+    RefPtr<Job> take_job(Worker&);
+    RefPtr<Job> take_job_from(Worker&, Priority, bool steal);
+    void did_finish_job();
+
+    NonnullOwnPtrVector<Worker> m_workers;
+    Atomic<size_t> m_next_worker { 0 };
+
+    // Jobs that are sitting in some queue, including cancelled ones that haven't been
+    // dropped yet. Idle workers sleep while this is zero.
+    Atomic<size_t> m_queued_jobs { 0 };
+    // Jobs that are either queued or running.
+    Atomic<size_t> m_unfinished_jobs { 0 };
+    Atomic<size_t> m_sleeping_workers { 0 };
+    Atomic<bool> m_should_exit { false };
+
+    pthread_mutex_t m_sleep_mutex;
+    pthread_cond_t m_work_available;
+    pthread_cond_t m_idle;
+};
+
+}
@@ -26,21 +26,23 @@
 
 #pragma once
 
-#include <AK/HashMap.h>
-#include <LibWeb/CSS/StyleResolver.h>
-#include <LibWeb/DOM/Document.h>
-#include <LibWeb/DOM/Element.h>
+#include <AK/FlyString.h>
+#include <AK/String.h>
+#include <LibWeb/Forward.h>
 
 namespace Web::CSS {
 
+// Marks the elements whose style may be affected by a change to one attribute of an element, based on the ids, classes and
+// attribute names that the document's selectors actually use.
 class StyleInvalidator {
 public:
-    explicit StyleInvalidator(DOM::Document&);
+    StyleInvalidator(DOM::Element&, const FlyString& attribute_name);
     ~StyleInvalidator();
 
 private:
-    DOM::Document& m_document;
-    HashMap<DOM::Element*, Vector<MatchingRule>> m_elements_and_matching_rules_before;
+    DOM::Element& m_element;
+    FlyString m_attribute_name;
+    String m_old_value;
 };
 
 }
@@ -25,6 +25,7 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <AK/HashFunctions.h>
 #include <AK/QuickSort.h>
 #include <LibWeb/CSS/CSSStyleRule.h>
 #include <LibWeb/CSS/Parser/DeprecatedCSSParser.h>
@@ -34,6 +35,7 @@
 #include <LibWeb/DOM/Document.h>
 #include <LibWeb/DOM/Element.h>
 #include <LibWeb/Dump.h>
+#include <LibWeb/HTML/AttributeNames.h>
 #include <ctype.h>
 #include <stdio.h>
 
@@ -81,9 +83,115 @@ void StyleResolver::for_each_stylesheet(Callback callback) const
     }
 }
 
-Vector<MatchingRule> StyleResolver::collect_matching_rules(const DOM::Element& element) const
+static u32 ancestor_hash(CSS::Selector::SimpleSelector::Type type, u32 name_hash)
 {
-    Vector<MatchingRule> matching_rules;
+    return pair_int_hash(name_hash, static_cast<u32>(type));
+}
+
+// A Bloom filter over the tag names, ids and classes of an element's ancestors.
+// This lets us reject most selectors with descendant or child combinators without walking up the tree.
+class AncestorFilter {
+public:
+    explicit AncestorFilter(const DOM::Element& element)
+    {
+        for (auto* ancestor = element.parent_element(); ancestor; ancestor = ancestor->parent_element()) {
+            add(ancestor_hash(CSS::Selector::SimpleSelector::Type::TagName, ancestor->local_name().hash()));
+            if (auto id = ancestor->attribute(HTML::AttributeNames::id); !id.is_empty())
+                add(ancestor_hash(CSS::Selector::SimpleSelector::Type::Id, id.hash()));
+            for (auto& class_name : ancestor->class_names())
+                add(ancestor_hash(CSS::Selector::SimpleSelector::Type::Class, class_name.hash()));
+        }
+    }
+
+    bool may_contain_all(const Vector<u32, 4>& hashes) const
+    {
+        for (auto hash : hashes) {
+            if (!has_bit(hash % bit_count) || !has_bit((hash >> 16) % bit_count))
+                return false;
+        }
+        return true;
+    }
+
+private:
+    static constexpr size_t bit_count = 1024;
+
+    void add(u32 hash)
+    {
+        set_bit(hash % bit_count);
+        set_bit((hash >> 16) % bit_count);
+    }
+
+    void set_bit(size_t bit) { m_bits[bit / 64] |= 1ull << (bit % 64); }
+    bool has_bit(size_t bit) const { return m_bits[bit / 64] & (1ull << (bit % 64)); }
+
+    u64 m_bits[bit_count / 64] {};
+};
+
+static constexpr size_t max_ancestor_hashes_per_selector = 4;
+
+static Vector<u32, 4> ancestor_hashes_for_selector(const CSS::Selector& selector)
+{
+    Vector<u32, 4> hashes;
+    auto& complex_selectors = selector.complex_selectors();
+    for (size_t i = complex_selectors.size() - 1; i > 0; --i) {
+        auto relation = complex_selectors[i].relation;
+        if (relation != CSS::Selector::ComplexSelector::Relation::Descendant && relation != CSS::Selector::ComplexSelector::Relation::ImmediateChild)
+            break;
+        for (auto& simple_selector : complex_selectors[i - 1].compound_selector) {
+            switch (simple_selector.type) {
+            case CSS::Selector::SimpleSelector::Type::TagName:
+            case CSS::Selector::SimpleSelector::Type::Id:
+            case CSS::Selector::SimpleSelector::Type::Class:
+                hashes.append(ancestor_hash(simple_selector.type, simple_selector.value.hash()));
+                break;
+            default:
+                break;
+            }
+            if (hashes.size() == max_ancestor_hashes_per_selector)
+                return hashes;
+        }
+    }
+    return hashes;
+}
+
+void StyleResolver::add_invalidation_scopes_for_selector(const CSS::Selector& selector) const
+{
+    auto& complex_selectors = selector.complex_selectors();
+    for (size_t i = 0; i < complex_selectors.size(); ++i) {
+        // The combinator right after a compound selector decides where the elements that it constrains are, relative to the ones matched by
+        // the whole selector. Anything further right only narrows that down: a sibling of a descendant is still a descendant.
+        InvalidationScope scope;
+        if (i == complex_selectors.size() - 1) {
+            scope.element = true;
+        } else {
+            auto relation = complex_selectors[i + 1].relation;
+            if (relation == CSS::Selector::ComplexSelector::Relation::AdjacentSibling || relation == CSS::Selector::ComplexSelector::Relation::GeneralSibling)
+                scope.following_siblings = true;
+            else
+                scope.descendants = true;
+        }
+
+        for (auto& simple_selector : complex_selectors[i].compound_selector) {
+            if (simple_selector.type == CSS::Selector::SimpleSelector::Type::Id)
+                m_rule_cache->invalidation_scopes_by_id.ensure(simple_selector.value).merge(scope);
+            else if (simple_selector.type == CSS::Selector::SimpleSelector::Type::Class)
+                m_rule_cache->invalidation_scopes_by_class.ensure(simple_selector.value).merge(scope);
+            if (simple_selector.attribute_match_type != CSS::Selector::SimpleSelector::AttributeMatchType::None)
+                m_rule_cache->invalidation_scopes_by_attribute_name.ensure(simple_selector.attribute_name).merge(scope);
+            if (simple_selector.pseudo_class == CSS::Selector::SimpleSelector::PseudoClass::Link) {
+                // Everything inside an <a href> is a link, so the href of an ancestor matters as well.
+                auto link_scope = scope;
+                link_scope.descendants = true;
+                m_rule_cache->invalidation_scopes_by_attribute_name.ensure(HTML::AttributeNames::href).merge(link_scope);
+            }
+        }
+    }
+}
+
+void StyleResolver::build_rule_cache() const
+{
+    m_rule_cache = make<RuleCache>();
+    m_rule_cache->built_in_quirks_mode = document().in_quirks_mode();
 
     size_t style_sheet_index = 0;
     for_each_stylesheet([&](auto& sheet) {
@@ -93,18 +201,115 @@ Vector<MatchingRule> StyleResolver::collect_matching_rules(const DOM::Element& e
         static_cast<const CSSStyleSheet&>(sheet).for_each_effective_style_rule([&](auto& rule) {
             size_t selector_index = 0;
             for (auto& selector : rule.selectors()) {
-                if (SelectorEngine::matches(selector, element)) {
-                    matching_rules.append({ rule, style_sheet_index, rule_index, selector_index });
-                    break;
+                add_invalidation_scopes_for_selector(selector);
+                RuleToMatch rule_to_match { { rule, style_sheet_index, rule_index, selector_index }, ancestor_hashes_for_selector(selector) };
+
+                const CSS::Selector::SimpleSelector* id_selector = nullptr;
+                const CSS::Selector::SimpleSelector* class_selector = nullptr;
+                const CSS::Selector::SimpleSelector* tag_name_selector = nullptr;
+                for (auto& simple_selector : selector.complex_selectors().last().compound_selector) {
+                    if (simple_selector.type == CSS::Selector::SimpleSelector::Type::Id && !id_selector)
+                        id_selector = &simple_selector;
+                    else if (simple_selector.type == CSS::Selector::SimpleSelector::Type::Class && !class_selector)
+                        class_selector = &simple_selector;
+                    else if (simple_selector.type == CSS::Selector::SimpleSelector::Type::TagName && !tag_name_selector)
+                        tag_name_selector = &simple_selector;
                 }
+
+                if (id_selector)
+                    m_rule_cache->rules_by_id.ensure(id_selector->value).append(move(rule_to_match));
+                else if (class_selector)
+                    m_rule_cache->rules_by_class.ensure(class_selector->value).append(move(rule_to_match));
+                else if (tag_name_selector)
+                    m_rule_cache->rules_by_tag_name.ensure(tag_name_selector->value).append(move(rule_to_match));
+                else
+                    m_rule_cache->other_rules.append(move(rule_to_match));
                 ++selector_index;
             }
             ++rule_index;
         });
         ++style_sheet_index;
     });
+}
+
+const StyleResolver::RuleCache& StyleResolver::rule_cache() const
+{
+    if (!m_rule_cache || m_rule_cache->built_in_quirks_mode != document().in_quirks_mode())
+        build_rule_cache();
+    return *m_rule_cache;
+}
+
+void StyleResolver::invalidate_rule_cache()
+{
+    m_rule_cache = nullptr;
+}
+
+StyleResolver::InvalidationScope StyleResolver::invalidation_scope_for_id(const FlyString& id) const
+{
+    return rule_cache().invalidation_scopes_by_id.get(id).value_or({});
+}
+
+StyleResolver::InvalidationScope StyleResolver::invalidation_scope_for_class(const FlyString& class_name) const
+{
+    return rule_cache().invalidation_scopes_by_class.get(class_name).value_or({});
+}
+
+StyleResolver::InvalidationScope StyleResolver::invalidation_scope_for_attribute(const FlyString& attribute_name) const
+{
+    return rule_cache().invalidation_scopes_by_attribute_name.get(attribute_name).value_or({});
+}
 
-    return matching_rules;
+Vector<MatchingRule> StyleResolver::collect_matching_rules(const DOM::Element& element) const
+{
+    auto& rule_cache = this->rule_cache();
+    Optional<AncestorFilter> ancestor_filter;
+
+    Vector<MatchingRule> matching_rules;
+    auto collect_from = [&](const Vector<RuleToMatch>& rules_to_match) {
+        for (auto& rule_to_match : rules_to_match) {
+            if (!rule_to_match.ancestor_hashes.is_empty()) {
+                if (!ancestor_filter.has_value())
+                    ancestor_filter = AncestorFilter(element);
+                if (!ancestor_filter->may_contain_all(rule_to_match.ancestor_hashes))
+                    continue;
+            }
+            auto& matching_rule = rule_to_match.matching_rule;
+            if (SelectorEngine::matches(matching_rule.rule->selectors()[matching_rule.selector_index], element))
+                matching_rules.append(matching_rule);
+        }
+    };
+
+    if (auto id = element.attribute(HTML::AttributeNames::id); !id.is_empty()) {
+        if (auto it = rule_cache.rules_by_id.find(id); it != rule_cache.rules_by_id.end())
+            collect_from(it->value);
+    }
+    for (auto& class_name : element.class_names()) {
+        if (auto it = rule_cache.rules_by_class.find(class_name); it != rule_cache.rules_by_class.end())
+            collect_from(it->value);
+    }
+    if (auto it = rule_cache.rules_by_tag_name.find(element.local_name()); it != rule_cache.rules_by_tag_name.end())
+        collect_from(it->value);
+    collect_from(rule_cache.other_rules);
+
+    // A rule only applies once, with the first of its selectors that matched.
+    quick_sort(matching_rules, [](auto& a, auto& b) {
+        if (a.style_sheet_index != b.style_sheet_index)
+            return a.style_sheet_index < b.style_sheet_index;
+        if (a.rule_index != b.rule_index)
+            return a.rule_index < b.rule_index;
+        return a.selector_index < b.selector_index;
+    });
+    Vector<MatchingRule> unique_matching_rules;
+    unique_matching_rules.ensure_capacity(matching_rules.size());
+    for (auto& matching_rule : matching_rules) {
+        if (!unique_matching_rules.is_empty()) {
+            auto& previous = unique_matching_rules.last();
+            if (previous.style_sheet_index == matching_rule.style_sheet_index && previous.rule_index == matching_rule.rule_index)
+                continue;
+        }
+        unique_matching_rules.unchecked_append(move(matching_rule));
+    }
+    return unique_matching_rules;
 }
 
 void StyleResolver::sort_matching_rules(Vector<MatchingRule>& matching_rules) const
@@ -26,6 +26,8 @@
 
 #pragma once
 
+#include <AK/FlyString.h>
+#include <AK/HashMap.h>
 #include <AK/NonnullRefPtrVector.h>
 #include <AK/OwnPtr.h>
 #include <LibWeb/CSS/StyleProperties.h>
@@ -55,11 +57,60 @@ public:
 
     static bool is_inherited_property(CSS::PropertyID);
 
+    // Must be called whenever the set of style rules in the document changes.
+    void invalidate_rule_cache();
+
+    // The elements, relative to an element whose id, class or attribute changed, that may now match a different set of rules.
+    struct InvalidationScope {
+        bool element { false };
+        bool descendants { false };
+        // Following sibling elements, and everything below them.
+        bool following_siblings { false };
+
+        bool is_empty() const { return !element && !descendants && !following_siblings; }
+        void merge(const InvalidationScope& other)
+        {
+            element |= other.element;
+            descendants |= other.descendants;
+            following_siblings |= other.following_siblings;
+        }
+    };
+
+    InvalidationScope invalidation_scope_for_id(const FlyString&) const;
+    InvalidationScope invalidation_scope_for_class(const FlyString&) const;
+    InvalidationScope invalidation_scope_for_attribute(const FlyString&) const;
+
 private:
     template<typename Callback>
     void for_each_stylesheet(Callback) const;
 
+    struct RuleToMatch {
+        MatchingRule matching_rule;
+        // Tag names, ids and classes that ancestors of a matching element must have, hashed for AncestorFilter.
+        Vector<u32, 4> ancestor_hashes;
+    };
+
+    // Every selector is put into one bucket, based on the rightmost compound selector, so that an element only has to be matched
+    // against the selectors that could apply to it.
+    struct RuleCache {
+        bool built_in_quirks_mode { false };
+        HashMap<FlyString, Vector<RuleToMatch>> rules_by_id;
+        HashMap<FlyString, Vector<RuleToMatch>> rules_by_class;
+        HashMap<FlyString, Vector<RuleToMatch>> rules_by_tag_name;
+        Vector<RuleToMatch> other_rules;
+
+        // Every id, class and attribute name that appears in some selector, and which elements depend on it.
+        HashMap<FlyString, InvalidationScope> invalidation_scopes_by_id;
+        HashMap<FlyString, InvalidationScope> invalidation_scopes_by_class;
+        HashMap<FlyString, InvalidationScope> invalidation_scopes_by_attribute_name;
+    };
+
+    const RuleCache& rule_cache() const;
+    void build_rule_cache() const;
+    void add_invalidation_scopes_for_selector(const Selector&) const;
+
     DOM::Document& m_document;
+    mutable OwnPtr<RuleCache> m_rule_cache;
 };
 
 }
@@ -24,13 +24,16 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <LibWeb/CSS/StyleResolver.h>
 #include <LibWeb/CSS/StyleSheetList.h>
+#include <LibWeb/DOM/Document.h>
 
 namespace Web::CSS {
 
 void StyleSheetList::add_sheet(NonnullRefPtr<CSSStyleSheet> sheet)
 {
     m_sheets.append(move(sheet));
+    m_document.style_resolver().invalidate_rule_cache();
 }
 
 StyleSheetList::StyleSheetList(DOM::Document& document)
@@ -26,6 +26,7 @@
 
 #include <LibWeb/DOM/CharacterData.h>
 #include <LibWeb/DOM/Document.h>
+#include <LibWeb/Layout/Node.h>
 
 namespace Web::DOM {
 
@@ -44,8 +45,11 @@ void CharacterData::set_data(String data)
     if (m_data == data)
         return;
     m_data = move(data);
-    // FIXME: This is definitely too aggressive.
-    document().schedule_forced_layout();
+    // The layout tree reads the text straight from us, so only the lines around this node need to be laid out again.
+    if (auto* layout_node = this->layout_node()) {
+        layout_node->set_needs_layout(true);
+        document().schedule_layout_update();
+    }
 }
 
 }
@@ -81,6 +81,10 @@ Document::Document(const URL& url)
     m_forced_layout_timer = Core::Timer::create_single_shot(0, [this] {
         force_layout();
     });
+
+    m_layout_update_timer = Core::Timer::create_single_shot(0, [this] {
+        update_layout();
+    });
 }
 
 Document::~Document()
@@ -166,6 +170,13 @@ void Document::schedule_forced_layout()
     m_forced_layout_timer->start();
 }
 
+void Document::schedule_layout_update()
+{
+    if (m_layout_update_timer->is_active())
+        return;
+    m_layout_update_timer->start();
+}
+
 bool Document::is_child_allowed(const Node& node) const
 {
     switch (node.type()) {
@@ -378,6 +389,17 @@ void Document::force_layout()
     update_layout();
 }
 
+static void clear_needs_layout_recursively(Layout::Node& node)
+{
+    node.set_needs_layout(false);
+    if (!node.child_needs_layout())
+        return;
+    node.set_child_needs_layout(false);
+    node.for_each_child([&](auto& child) {
+        clear_needs_layout_recursively(child);
+    });
+}
+
 void Document::update_layout()
 {
     if (!frame())
@@ -391,6 +413,9 @@ void Document::update_layout()
     Layout::BlockFormattingContext root_formatting_context(*m_layout_root, nullptr);
     root_formatting_context.run(*m_layout_root, Layout::LayoutMode::Default);
 
+    // Everything that was marked for layout has been laid out now, so only the marked parts of the tree have to be visited.
+    clear_needs_layout_recursively(*m_layout_root);
+
     m_layout_root->set_needs_display();
 
     if (frame()->is_main_frame()) {
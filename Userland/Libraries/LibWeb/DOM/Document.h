@@ -152,6 +152,7 @@ public:
 
     void schedule_style_update();
     void schedule_forced_layout();
+    void schedule_layout_update();
 
     NonnullRefPtrVector<Element> get_elements_by_name(const String&) const;
     NonnullRefPtrVector<Element> get_elements_by_tag_name(const FlyString&) const;
@@ -298,6 +299,7 @@ private:
 
     RefPtr<Core::Timer> m_style_update_timer;
     RefPtr<Core::Timer> m_forced_layout_timer;
+    RefPtr<Core::Timer> m_layout_update_timer;
 
     String m_source;
 
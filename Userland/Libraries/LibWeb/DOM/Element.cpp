@@ -90,7 +90,7 @@ ExceptionOr<void> Element::set_attribute(const FlyString& name, const String& va
     if (name.is_empty())
         return InvalidCharacterError::create("Attribute name must not be empty");
 
-    CSS::StyleInvalidator style_invalidator(document());
+    CSS::StyleInvalidator style_invalidator(*this, name);
 
     if (auto* attribute = find_attribute(name))
         attribute->set_value(value);
@@ -98,14 +98,21 @@ ExceptionOr<void> Element::set_attribute(const FlyString& name, const String& va
         m_attributes.empend(name, value);
 
     parse_attribute(name, value);
+
+    // Presentational attributes like width and height feed into layout without going through style.
+    if (layout_node())
+        layout_node()->set_needs_layout(true);
     return {};
 }
 
 void Element::remove_attribute(const FlyString& name)
 {
-    CSS::StyleInvalidator style_invalidator(document());
+    CSS::StyleInvalidator style_invalidator(*this, name);
 
     m_attributes.remove_first_matching([&](auto& attribute) { return attribute.name() == name; });
+
+    if (layout_node())
+        layout_node()->set_needs_layout(true);
 }
 
 bool Element::has_class(const FlyString& class_name, CaseSensitivity case_sensitivity) const
@@ -89,11 +89,12 @@ void Node::set_text_content(const String& content)
 {
     if (is_text()) {
         downcast<Text>(this)->set_data(content);
-    } else {
-        remove_all_children();
-        append_child(document().create_text_node(content));
+        return;
     }
 
+    remove_all_children();
+    append_child(document().create_text_node(content));
+
     set_needs_style_update(true);
     document().invalidate_layout();
 }
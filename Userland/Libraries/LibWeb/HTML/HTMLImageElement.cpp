@@ -40,12 +40,16 @@ HTMLImageElement::HTMLImageElement(DOM::Document& document, QualifiedName qualif
     : HTMLElement(document, move(qualified_name))
 {
     m_image_loader.on_load = [this] {
+        if (layout_node())
+            layout_node()->set_needs_layout(true);
         this->document().update_layout();
         dispatch_event(DOM::Event::create(EventNames::load));
     };
 
     m_image_loader.on_fail = [this] {
         dbgln("HTMLImageElement: Resource did fail: {}", src());
+        if (layout_node())
+            layout_node()->set_needs_layout(true);
         this->document().update_layout();
         dispatch_event(DOM::Event::create(EventNames::error));
     };
@@ -201,4 +201,9 @@ float Box::width_of_logical_containing_block() const
     return containing_block->width();
 }
 
+Box::LayoutConstraints Box::current_layout_constraints() const
+{
+    return { size(), frame().size() };
+}
+
 }
@@ -26,6 +26,7 @@
 
 #pragma once
 
+#include <AK/Optional.h>
 #include <AK/OwnPtr.h>
 #include <LibGfx/Rect.h>
 #include <LibWeb/Layout/LineBox.h>
@@ -140,6 +141,21 @@ public:
 
     virtual float width_of_logical_containing_block() const;
 
+    // Everything from outside of this box that the layout of its contents depends on.
+    struct LayoutConstraints {
+        Gfx::FloatSize size;
+        Gfx::IntSize viewport_size;
+
+        bool operator==(const LayoutConstraints& other) const { return size == other.size && viewport_size == other.viewport_size; }
+        bool operator!=(const LayoutConstraints& other) const { return !(*this == other); }
+    };
+
+    LayoutConstraints current_layout_constraints() const;
+
+    // The constraints that the contents of this box were last laid out against in LayoutMode::Default, if they are still valid.
+    const Optional<LayoutConstraints>& last_layout_constraints() const { return m_last_layout_constraints; }
+    void set_last_layout_constraints(Optional<LayoutConstraints> constraints) { m_last_layout_constraints = move(constraints); }
+
 protected:
     Box(DOM::Document& document, DOM::Node* node, NonnullRefPtr<CSS::StyleProperties> style)
         : NodeWithStyleAndBoxModelMetrics(document, node, move(style))
@@ -165,6 +181,8 @@ private:
     WeakPtr<LineBoxFragment> m_containing_line_box_fragment;
 
     OwnPtr<StackingContext> m_stacking_context;
+
+    Optional<LayoutConstraints> m_last_layout_constraints;
 };
 
 template<>
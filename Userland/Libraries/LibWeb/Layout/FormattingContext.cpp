@@ -78,7 +78,62 @@ bool FormattingContext::creates_block_formatting_context(const Box& box)
     return false;
 }
 
+// Floats inside a box that doesn't establish a block formatting context of its own belong to the enclosing one,
+// and only get registered with it while that box is being laid out.
+static bool has_floating_descendant_in_same_block_formatting_context(const Node& node)
+{
+    bool found = false;
+    node.for_each_child([&](auto& child) {
+        if (found)
+            return;
+        if (child.is_floating()) {
+            found = true;
+            return;
+        }
+        if (is<Box>(child) && FormattingContext::creates_block_formatting_context(downcast<Box>(child)))
+            return;
+        found = has_floating_descendant_in_same_block_formatting_context(child);
+    });
+    return found;
+}
+
+bool FormattingContext::can_reuse_previous_layout(const Box& box, const Box::LayoutConstraints& constraints) const
+{
+    if (box.needs_layout() || box.child_needs_layout())
+        return false;
+    if (!box.last_layout_constraints().has_value() || box.last_layout_constraints().value() != constraints)
+        return false;
+
+    // A percentage height is only resolved once the box has been laid out, against a containing block that may have changed since.
+    if (box.computed_values().height().is_percentage())
+        return false;
+
+    // Inline content that doesn't get a block formatting context of its own flows around the floats of ours,
+    // and any floats inside it have to be placed among ours so that later siblings can flow around and clear them.
+    if (is_block_formatting_context() && !creates_block_formatting_context(box)) {
+        auto& block_formatting_context = static_cast<const BlockFormattingContext&>(*this);
+        if (!block_formatting_context.left_floating_boxes().is_empty() || !block_formatting_context.right_floating_boxes().is_empty())
+            return false;
+        if (has_floating_descendant_in_same_block_formatting_context(box))
+            return false;
+    }
+    return true;
+}
+
 void FormattingContext::layout_inside(Box& box, LayoutMode layout_mode)
+{
+    auto constraints = box.current_layout_constraints();
+    if (layout_mode == LayoutMode::Default && can_reuse_previous_layout(box, constraints))
+        return;
+
+    // Laying out in any other mode is only done to measure the box, and leaves geometry behind that can't be reused.
+    box.set_last_layout_constraints({});
+    layout_inside_without_reuse(box, layout_mode);
+    if (layout_mode == LayoutMode::Default)
+        box.set_last_layout_constraints(constraints);
+}
+
+void FormattingContext::layout_inside_without_reuse(Box& box, LayoutMode layout_mode)
 {
     if (creates_block_formatting_context(box)) {
         BlockFormattingContext context(box, this);
@@ -27,6 +27,7 @@
 #pragma once
 
 #include <LibWeb/Forward.h>
+#include <LibWeb/Layout/Box.h>
 
 namespace Web::Layout {
 
@@ -51,6 +52,7 @@ protected:
     FormattingContext(Box&, FormattingContext* parent = nullptr);
     virtual ~FormattingContext();
 
+    // Lays out the contents of a box, unless nothing inside it has changed since it was last laid out against the same constraints.
     void layout_inside(Box&, LayoutMode);
 
     struct ShrinkToFitResult {
@@ -73,6 +75,10 @@ protected:
 
     FormattingContext* m_parent { nullptr };
     Box* m_context_box { nullptr };
+
+private:
+    bool can_reuse_previous_layout(const Box&, const Box::LayoutConstraints&) const;
+    void layout_inside_without_reuse(Box&, LayoutMode);
 };
 
 }
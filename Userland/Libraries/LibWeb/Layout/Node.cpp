@@ -53,6 +53,27 @@ Node::~Node()
         m_dom_node->set_layout_node({}, nullptr);
 }
 
+void Node::inserted_into(Node&)
+{
+    set_needs_layout(true);
+}
+
+void Node::removed_from(Node& parent)
+{
+    parent.set_needs_layout(true);
+}
+
+void Node::set_needs_layout(bool value)
+{
+    m_needs_layout = value;
+    if (!m_needs_layout)
+        return;
+
+    // NOTE: This is done even if we were already marked, since we may have been moved to a new parent since then.
+    for (auto* ancestor = parent(); ancestor && !ancestor->m_child_needs_layout; ancestor = ancestor->parent())
+        ancestor->m_child_needs_layout = true;
+}
+
 bool Node::can_contain_boxes_with_position_absolute() const
 {
     return computed_values().position() != CSS::Position::Static || is<InitialContainingBlockBox>(*this);
@@ -140,10 +140,16 @@ public:
     NodeWithStyle* parent();
     const NodeWithStyle* parent() const;
 
-    void inserted_into(Node&) { }
-    void removed_from(Node&) { }
+    void inserted_into(Node&);
+    void removed_from(Node&);
     void children_changed() { }
 
+    bool needs_layout() const { return m_needs_layout; }
+    void set_needs_layout(bool);
+
+    bool child_needs_layout() const { return m_child_needs_layout; }
+    void set_child_needs_layout(bool b) { m_child_needs_layout = b; }
+
     virtual void split_into_lines(InlineFormattingContext&, LayoutMode);
 
     bool is_visible() const { return m_visible; }
@@ -199,6 +205,8 @@ private:
     bool m_has_style { false };
     bool m_visible { true };
     bool m_children_are_inline { false };
+    bool m_needs_layout { false };
+    bool m_child_needs_layout { false };
     SelectionState m_selection_state { SelectionState::None };
 };
 
@@ -28,7 +28,9 @@
 #include <AK/URL.h>
 #include <LibWeb/CSS/CSSImportRule.h>
 #include <LibWeb/CSS/Parser/DeprecatedCSSParser.h>
+#include <LibWeb/CSS/StyleResolver.h>
 #include <LibWeb/CSS/StyleSheet.h>
+#include <LibWeb/DOM/Document.h>
 #include <LibWeb/DOM/Element.h>
 #include <LibWeb/Loader/CSSLoader.h>
 #include <LibWeb/Loader/ResourceLoader.h>
@@ -86,6 +88,8 @@ void CSSLoader::resource_did_load()
         m_style_sheet->rules() = sheet->rules();
     }
 
+    m_owner_element.document().style_resolver().invalidate_rule_cache();
+
     if (on_load)
         on_load();
 
@@ -48,6 +48,7 @@ void EditEventHandler::handle_delete(DOM::Range& range)
         builder.append(end->data().substring_view(range.end_offset()));
 
         start->set_data(builder.to_string());
+        m_frame.document()->update_layout();
     } else {
         // Remove all the nodes that are fully enclosed in the range.
         HashTable<DOM::Node*> queued_for_deletion;
@@ -87,12 +88,12 @@ void EditEventHandler::handle_delete(DOM::Range& range)
 
         start->set_data(builder.to_string());
         start->parent()->remove_child(*end);
-    }
 
-    // FIXME: When nodes are removed from the DOM, the associated layout nodes become stale and still
-    //        remain in the layout tree. This has to be fixed, this just causes everything to be recomputed
-    //        which really hurts performance.
-    m_frame.document()->force_layout();
+        // FIXME: When nodes are removed from the DOM, the associated layout nodes become stale and still
+        //        remain in the layout tree. This has to be fixed, this just causes everything to be recomputed
+        //        which really hurts performance.
+        m_frame.document()->force_layout();
+    }
 
     m_frame.did_edit({});
 }
@@ -111,10 +112,8 @@ void EditEventHandler::handle_insert(DOM::Position position, u32 code_point)
         node.invalidate_style();
     }
 
-    // FIXME: When nodes are removed from the DOM, the associated layout nodes become stale and still
-    //        remain in the layout tree. This has to be fixed, this just causes everything to be recomputed
-    //        which really hurts performance.
-    m_frame.document()->force_layout();
+    // Only the text changed, so the layout tree is still intact and just the edited node needs to be laid out again.
+    m_frame.document()->update_layout();
 
     m_frame.did_edit({});
 }
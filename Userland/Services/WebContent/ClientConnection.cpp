@@ -205,6 +205,10 @@ void ClientConnection::handle(const Messages::WebContentServer::DebugRequest& me
         Web::Bindings::main_thread_vm().heap().collect_garbage(JS::Heap::CollectionType::CollectGarbage, true);
     }
 
+    if (message.request() == "dump-gc-statistics") {
+        Web::Bindings::main_thread_vm().heap().dump_statistics();
+    }
+
     if (message.request() == "set-line-box-borders") {
         bool state = message.argument() == "on";
         m_page_host->set_should_show_line_box_borders(state);
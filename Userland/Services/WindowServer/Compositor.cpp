@@ -633,12 +633,18 @@ bool Compositor::set_wallpaper_mode(const String& mode)
 
 bool Compositor::set_wallpaper(const String& path, Function<void(bool)>&& callback)
 {
+    // Background actions may finish out of order, so only the most recently requested wallpaper gets installed.
+    auto generation = ++m_wallpaper_generation;
     LibThread::BackgroundAction<RefPtr<Gfx::Bitmap>>::create(
         [path] {
             return Gfx::Bitmap::load_from_file(path);
         },
 
-        [this, path, callback = move(callback)](RefPtr<Gfx::Bitmap> bitmap) {
+        [this, path, generation, callback = move(callback)](RefPtr<Gfx::Bitmap> bitmap) {
+            if (generation != m_wallpaper_generation) {
+                callback(false);
+                return;
+            }
             m_wallpaper_path = path;
             m_wallpaper = move(bitmap);
             invalidate_screen();
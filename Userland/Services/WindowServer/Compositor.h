@@ -121,6 +121,7 @@ private:
     String m_wallpaper_path { "" };
     WallpaperMode m_wallpaper_mode { WallpaperMode::Unchecked };
     RefPtr<Gfx::Bitmap> m_wallpaper;
+    u64 m_wallpaper_generation { 0 };
 
     const Cursor* m_current_cursor { nullptr };
     unsigned m_current_cursor_frame { 0 };
@@ -0,0 +1,146 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <AK/Vector.h>
+#include <LibCore/ArgsParser.h>
+#include <LibCore/ElapsedTimer.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/epoll.h>
+#include <sys/select.h>
+#include <unistd.h>
+
+// Keeps a large number of idle pipes open, like a server with many idle
+// clients, and measures how long it takes to be woken up for the one pipe
+// that actually has data, using select() and using epoll.
+
+struct Connection {
+    int read_fd { -1 };
+    int write_fd { -1 };
+};
+
+static void print_result(const char* name, int count, int elapsed_ms)
+{
+    printf("%-8s %d wakeups in %dms (%.2f us/wakeup)\n", name, count, elapsed_ms, elapsed_ms * 1000.0 / count);
+}
+
+static bool wake_one(const Connection& connection)
+{
+    char byte = 0;
+    return write(connection.write_fd, &byte, 1) == 1;
+}
+
+static bool consume(int fd)
+{
+    char byte;
+    return read(fd, &byte, 1) == 1;
+}
+
+int main(int argc, char** argv)
+{
+    int connection_count = 400;
+    int wakeup_count = 10000;
+
+    Core::ArgsParser args_parser;
+    args_parser.add_option(connection_count, "Number of idle connections", "connections", 'c', "number");
+    args_parser.add_option(wakeup_count, "Number of wakeups to measure", "wakeups", 'w', "number");
+    args_parser.parse(argc, argv);
+
+    if (connection_count <= 0 || wakeup_count <= 0) {
+        fprintf(stderr, "Connections and wakeups must be positive\n");
+        return EXIT_FAILURE;
+    }
+
+    Vector<Connection> connections;
+    int max_fd = 0;
+    for (int i = 0; i < connection_count; ++i) {
+        int fds[2];
+        if (pipe(fds) < 0) {
+            perror("pipe");
+            return EXIT_FAILURE;
+        }
+        connections.append({ fds[0], fds[1] });
+        max_fd = max(max_fd, fds[0]);
+    }
+
+    if (max_fd < FD_SETSIZE) {
+        Core::ElapsedTimer timer;
+        timer.start();
+        for (int i = 0; i < wakeup_count; ++i) {
+            auto& connection = connections[arc4random_uniform(connection_count)];
+            if (!wake_one(connection)) {
+                perror("write");
+                return EXIT_FAILURE;
+            }
+            fd_set read_fds;
+            FD_ZERO(&read_fds);
+            for (auto& it : connections)
+                FD_SET(it.read_fd, &read_fds);
+            if (select(max_fd + 1, &read_fds, nullptr, nullptr, nullptr) != 1 || !FD_ISSET(connection.read_fd, &read_fds)) {
+                fprintf(stderr, "select didn't report the right fd\n");
+                return EXIT_FAILURE;
+            }
+            consume(connection.read_fd);
+        }
+        print_result("select", wakeup_count, timer.elapsed());
+    } else {
+        printf("select   skipped, fds don't fit into an fd_set\n");
+    }
+
+    int epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd < 0) {
+        perror("epoll_create1");
+        return EXIT_FAILURE;
+    }
+    for (auto& connection : connections) {
+        epoll_event event {};
+        event.events = EPOLLIN;
+        event.data.fd = connection.read_fd;
+        if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, connection.read_fd, &event) < 0) {
+            perror("epoll_ctl");
+            return EXIT_FAILURE;
+        }
+    }
+
+    Core::ElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < wakeup_count; ++i) {
+        auto& connection = connections[arc4random_uniform(connection_count)];
+        if (!wake_one(connection)) {
+            perror("write");
+            return EXIT_FAILURE;
+        }
+        epoll_event event;
+        if (epoll_wait(epoll_fd, &event, 1, -1) != 1 || event.data.fd != connection.read_fd) {
+            fprintf(stderr, "epoll_wait didn't report the right fd\n");
+            return EXIT_FAILURE;
+        }
+        consume(connection.read_fd);
+    }
+    print_result("epoll", wakeup_count, timer.elapsed());
+
+    return EXIT_SUCCESS;
+}
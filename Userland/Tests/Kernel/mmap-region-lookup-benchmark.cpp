@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <AK/Vector.h>
+#include <LibCore/ArgsParser.h>
+#include <LibCore/ElapsedTimer.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+// Maps a large number of small regions, so that the process ends up with many regions in
+// its address space, and measures how long mapping them, faulting them in and unmapping
+// them takes. Every one of those operations has to look up regions by address.
+
+static void print_result(const char* name, int count, int elapsed_ms)
+{
+    printf("%-8s %d operations in %dms (%.2f us/op)\n", name, count, elapsed_ms, elapsed_ms * 1000.0 / count);
+}
+
+int main(int argc, char** argv)
+{
+    int count = 10000;
+    int pages_per_region = 1;
+
+    Core::ArgsParser args_parser;
+    args_parser.add_option(count, "Number of regions to map", "count", 'n', "number");
+    args_parser.add_option(pages_per_region, "Number of pages in each region", "pages", 'p', "number");
+    args_parser.parse(argc, argv);
+
+    if (count <= 0 || pages_per_region <= 0) {
+        fprintf(stderr, "Count and pages must be positive\n");
+        return EXIT_FAILURE;
+    }
+
+    size_t region_size = pages_per_region * PAGE_SIZE;
+    Vector<u8*> regions;
+    regions.ensure_capacity(count);
+
+    Core::ElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < count; ++i) {
+        auto* region = (u8*)mmap(nullptr, region_size, PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE, 0, 0);
+        if (region == MAP_FAILED) {
+            perror("mmap");
+            return EXIT_FAILURE;
+        }
+        regions.unchecked_append(region);
+    }
+    print_result("mmap", count, timer.elapsed());
+
+    // Touch the regions in random order so that the faults don't just hit the region lookup cache.
+    for (int i = count - 1; i > 0; --i)
+        swap(regions[i], regions[arc4random_uniform(i + 1)]);
+
+    timer.start();
+    for (auto* region : regions) {
+        for (size_t offset = 0; offset < region_size; offset += PAGE_SIZE)
+            region[offset] = 1;
+    }
+    print_result("fault", count * pages_per_region, timer.elapsed());
+
+    timer.start();
+    for (auto* region : regions) {
+        if (munmap(region, region_size) < 0) {
+            perror("munmap");
+            return EXIT_FAILURE;
+        }
+    }
+    print_result("munmap", count, timer.elapsed());
+
+    return EXIT_SUCCESS;
+}
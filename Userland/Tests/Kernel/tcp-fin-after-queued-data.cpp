@@ -0,0 +1,166 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <AK/Types.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// Sends more data over a loopback connection than the receiver has room for, so most of it has to wait
+// for the window to open up, and then shuts down the sending side right away. The receiver must get
+// every byte, in order, followed by end-of-file, i.e. the FIN mustn't overtake the data queued before it.
+
+static constexpr size_t data_size = 1024 * 1024;
+
+static unsigned char byte_at(size_t offset)
+{
+    return (offset * 7 + offset / 4096) & 0xff;
+}
+
+static int run_sender(u16 port)
+{
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+        perror("socket");
+        return 1;
+    }
+    sockaddr_in address {};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (connect(fd, (const sockaddr*)&address, sizeof(address)) < 0) {
+        perror("connect");
+        return 1;
+    }
+
+    static unsigned char buffer[data_size];
+    for (size_t i = 0; i < data_size; ++i)
+        buffer[i] = byte_at(i);
+    size_t nwritten_total = 0;
+    while (nwritten_total < data_size) {
+        ssize_t nwritten = write(fd, buffer + nwritten_total, data_size - nwritten_total);
+        if (nwritten < 0) {
+            perror("write");
+            return 1;
+        }
+        nwritten_total += nwritten;
+    }
+    if (shutdown(fd, SHUT_WR) < 0) {
+        perror("shutdown");
+        return 1;
+    }
+    // Keep the connection around until the receiver has seen everything.
+    char byte;
+    read(fd, &byte, 1);
+    close(fd);
+    return 0;
+}
+
+int main(int, char**)
+{
+    int listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (listen_fd < 0) {
+        perror("socket");
+        return 1;
+    }
+    sockaddr_in address {};
+    address.sin_family = AF_INET;
+    address.sin_port = 0;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (bind(listen_fd, (const sockaddr*)&address, sizeof(address)) < 0) {
+        perror("bind");
+        return 1;
+    }
+    socklen_t address_size = sizeof(address);
+    if (getsockname(listen_fd, (sockaddr*)&address, &address_size) < 0) {
+        perror("getsockname");
+        return 1;
+    }
+    if (listen(listen_fd, 1) < 0) {
+        perror("listen");
+        return 1;
+    }
+
+    pid_t sender_pid = fork();
+    if (sender_pid < 0) {
+        perror("fork");
+        return 1;
+    }
+    if (sender_pid == 0)
+        _exit(run_sender(ntohs(address.sin_port)));
+
+    // Don't wait forever if the FIN gets lost.
+    alarm(30);
+
+    int fd = accept(listen_fd, nullptr, nullptr);
+    if (fd < 0) {
+        perror("accept");
+        return 1;
+    }
+
+    // Let the window fill up and the rest of the data pile up behind it.
+    sleep(1);
+
+    static unsigned char buffer[64 * 1024];
+    size_t nread_total = 0;
+    for (;;) {
+        ssize_t nread = read(fd, buffer, sizeof(buffer));
+        if (nread < 0) {
+            perror("read");
+            return 1;
+        }
+        if (nread == 0)
+            break;
+        for (ssize_t i = 0; i < nread; ++i) {
+            if (buffer[i] != byte_at(nread_total + i)) {
+                printf("FAIL, wrong data at offset %zu\n", nread_total + i);
+                return 1;
+            }
+        }
+        nread_total += nread;
+    }
+    close(fd);
+
+    int status;
+    waitpid(sender_pid, &status, 0);
+
+    if (nread_total != data_size) {
+        printf("FAIL, got end-of-file after %zu of %zu bytes\n", nread_total, data_size);
+        return 1;
+    }
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        printf("FAIL, sender failed\n");
+        return 1;
+    }
+
+    printf("PASS\n");
+    return 0;
+}
@@ -34,7 +34,9 @@
 #include <getopt.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <sys/stat.h>
+#include <sys/wait.h>
 #include <unistd.h>
 
 struct Result {
@@ -42,6 +44,12 @@ struct Result {
     u64 read_bps {};
 };
 
+enum class AccessPattern {
+    Sequential,
+    Random,
+    Mixed,
+};
+
 static Result average_result(const Vector<Result>& results)
 {
     Result average;
@@ -59,11 +67,12 @@ static Result average_result(const Vector<Result>& results)
 
 static void exit_with_usage(int rc)
 {
-    warnln("Usage: disk_benchmark [-h] [-d directory] [-t time_per_benchmark] [-f file_size1,file_size2,...] [-b block_size1,block_size2,...]");
+    warnln("Usage: disk_benchmark [-h] [-c] [-d directory] [-t time_per_benchmark] [-f file_size1,file_size2,...] [-b block_size1,block_size2,...] [-p processes] [-a sequential|random|mixed]");
     exit(rc);
 }
 
-static Optional<Result> benchmark(const String& filename, int file_size, int block_size, ByteBuffer& buffer, bool allow_cache);
+static Optional<Result> benchmark(const String& filename, int file_size, int block_size, ByteBuffer& buffer, bool allow_cache, bool random);
+static Optional<Result> run_benchmarks(const String& filename, int file_size, int block_size, bool allow_cache, bool random, int time_per_benchmark, bool show_progress);
 
 int main(int argc, char** argv)
 {
@@ -72,9 +81,11 @@ int main(int argc, char** argv)
     Vector<size_t> file_sizes;
     Vector<size_t> block_sizes;
     bool allow_cache = false;
+    int process_count = 1;
+    AccessPattern access_pattern = AccessPattern::Sequential;
 
     int opt;
-    while ((opt = getopt(argc, argv, "chd:t:f:b:")) != -1) {
+    while ((opt = getopt(argc, argv, "chd:t:f:b:p:a:")) != -1) {
         switch (opt) {
         case 'h':
             exit_with_usage(0);
@@ -96,6 +107,21 @@ int main(int argc, char** argv)
             for (const auto& size : String(optarg).split(','))
                 block_sizes.append(atoi(size.characters()));
             break;
+        case 'p':
+            process_count = atoi(optarg);
+            if (process_count < 1)
+                exit_with_usage(1);
+            break;
+        case 'a':
+            if (!strcmp(optarg, "sequential"))
+                access_pattern = AccessPattern::Sequential;
+            else if (!strcmp(optarg, "random"))
+                access_pattern = AccessPattern::Random;
+            else if (!strcmp(optarg, "mixed"))
+                access_pattern = AccessPattern::Mixed;
+            else
+                exit_with_usage(1);
+            break;
         }
     }
 
@@ -115,23 +141,61 @@ int main(int argc, char** argv)
             if (block_size > file_size)
                 continue;
 
-            auto buffer = ByteBuffer::create_uninitialized(block_size);
-            Vector<Result> results;
-
-            outln("Running: file_size={} block_size={}", file_size, block_size);
-            Core::ElapsedTimer timer;
-            timer.start();
-            while (timer.elapsed() < time_per_benchmark * 1000) {
-                out(".");
-                fflush(stdout);
-                auto result = benchmark(filename, file_size, block_size, buffer, allow_cache);
+            if (process_count == 1) {
+                outln("Running: file_size={} block_size={}", file_size, block_size);
+                auto result = run_benchmarks(filename, file_size, block_size, allow_cache, access_pattern == AccessPattern::Random, time_per_benchmark, true);
                 if (!result.has_value())
                     return 1;
-                results.append(result.release_value());
-                usleep(100);
+                sleep(1);
+                continue;
             }
-            auto average = average_result(results);
-            outln("Finished: runs={} time={}ms write_bps={} read_bps={}", results.size(), timer.elapsed(), average.write_bps, average.read_bps);
+
+            // Every process works on a file of its own, so the disk sees all of their requests interleaved.
+            outln("Running: file_size={} block_size={} processes={}", file_size, block_size, process_count);
+            Vector<pid_t> children;
+            Vector<int> result_fds;
+            for (int i = 0; i < process_count; ++i) {
+                // In the mixed workload, every other process reads and writes at random offsets.
+                bool random = access_pattern == AccessPattern::Random || (access_pattern == AccessPattern::Mixed && i % 2 == 1);
+                int pipe_fds[2];
+                if (pipe(pipe_fds) < 0) {
+                    perror("pipe");
+                    return 1;
+                }
+                pid_t pid = fork();
+                if (pid < 0) {
+                    perror("fork");
+                    return 1;
+                }
+                if (pid == 0) {
+                    close(pipe_fds[0]);
+                    auto result = run_benchmarks(String::formatted("{}.{}", filename, i), file_size, block_size, allow_cache, random, time_per_benchmark, false);
+                    if (!result.has_value())
+                        _exit(1);
+                    if (write(pipe_fds[1], &result.value(), sizeof(Result)) != sizeof(Result))
+                        _exit(1);
+                    _exit(0);
+                }
+                close(pipe_fds[1]);
+                children.append(pid);
+                result_fds.append(pipe_fds[0]);
+            }
+
+            Result total;
+            for (int i = 0; i < process_count; ++i) {
+                Result result;
+                if (read(result_fds[i], &result, sizeof(Result)) != sizeof(Result)) {
+                    warnln("Process {} failed", children[i]);
+                    return 1;
+                }
+                close(result_fds[i]);
+                waitpid(children[i], nullptr, 0);
+                bool random = access_pattern == AccessPattern::Random || (access_pattern == AccessPattern::Mixed && i % 2 == 1);
+                outln("Process {}: access={} write_bps={} read_bps={}", i, random ? "random" : "sequential", result.write_bps, result.read_bps);
+                total.write_bps += result.write_bps;
+                total.read_bps += result.read_bps;
+            }
+            outln("Finished: processes={} total_write_bps={} total_read_bps={}", process_count, total.write_bps, total.read_bps);
 
             sleep(1);
         }
@@ -140,7 +204,31 @@ int main(int argc, char** argv)
     return 0;
 }
 
-Optional<Result> benchmark(const String& filename, int file_size, int block_size, ByteBuffer& buffer, bool allow_cache)
+Optional<Result> run_benchmarks(const String& filename, int file_size, int block_size, bool allow_cache, bool random, int time_per_benchmark, bool show_progress)
+{
+    auto buffer = ByteBuffer::create_uninitialized(block_size);
+    Vector<Result> results;
+
+    Core::ElapsedTimer timer;
+    timer.start();
+    while (timer.elapsed() < time_per_benchmark * 1000) {
+        if (show_progress) {
+            out(".");
+            fflush(stdout);
+        }
+        auto result = benchmark(filename, file_size, block_size, buffer, allow_cache, random);
+        if (!result.has_value())
+            return {};
+        results.append(result.release_value());
+        usleep(100);
+    }
+    auto average = average_result(results);
+    if (show_progress)
+        outln("Finished: runs={} time={}ms write_bps={} read_bps={}", results.size(), timer.elapsed(), average.write_bps, average.read_bps);
+    return average;
+}
+
+Optional<Result> benchmark(const String& filename, int file_size, int block_size, ByteBuffer& buffer, bool allow_cache, bool random)
 {
     int flags = O_CREAT | O_TRUNC | O_RDWR;
     if (!allow_cache)
@@ -161,11 +249,27 @@ Optional<Result> benchmark(const String& filename, int file_size, int block_size
 
     Result result;
 
+    int block_count = file_size / block_size;
+    auto seek_to_random_block = [&] {
+        if (lseek(fd, (off_t)arc4random_uniform(block_count) * block_size, SEEK_SET) < 0) {
+            perror("lseek");
+            return false;
+        }
+        return true;
+    };
+
+    if (random && ftruncate(fd, file_size) < 0) {
+        perror("ftruncate");
+        return {};
+    }
+
     Core::ElapsedTimer timer;
     timer.start();
 
     ssize_t total_written = 0;
     for (ssize_t j = 0; j < file_size; j += block_size) {
+        if (random && !seek_to_random_block())
+            return {};
         auto nwritten = write(fd, buffer.data(), block_size);
         if (nwritten < 0) {
             perror("write");
@@ -184,6 +288,8 @@ Optional<Result> benchmark(const String& filename, int file_size, int block_size
     timer.start();
     ssize_t total_read = 0;
     while (total_read < file_size) {
+        if (random && !seek_to_random_block())
+            return {};
         auto nread = read(fd, buffer.data(), block_size);
         if (nread < 0) {
             perror("read");
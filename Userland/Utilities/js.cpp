@@ -672,6 +672,9 @@ int main(int argc, char** argv)
 {
     bool gc_on_every_allocation = false;
     bool disable_syntax_highlight = false;
+    bool disable_bytecode = false;
+    bool print_property_cache_statistics = false;
+    bool print_gc_statistics = false;
     const char* script_path = nullptr;
 
     Core::ArgsParser args_parser;
@@ -680,12 +683,16 @@ int main(int argc, char** argv)
     args_parser.add_option(s_print_last_result, "Print last result", "print-last-result", 'l');
     args_parser.add_option(gc_on_every_allocation, "GC on every allocation", "gc-on-every-allocation", 'g');
     args_parser.add_option(disable_syntax_highlight, "Disable live syntax highlighting", "no-syntax-highlight", 's');
+    args_parser.add_option(disable_bytecode, "Run all functions on the AST interpreter", "no-bytecode", 'b');
+    args_parser.add_option(print_property_cache_statistics, "Print property cache hits and misses on exit", "property-cache-stats", 'p');
+    args_parser.add_option(print_gc_statistics, "Print garbage collection pause times on exit", "gc-stats", 'G');
     args_parser.add_positional_argument(script_path, "Path to script file", "script", Core::ArgsParser::Required::No);
     args_parser.parse(argc, argv);
 
     bool syntax_highlight = !disable_syntax_highlight;
 
     vm = JS::VM::create();
+    vm->set_bytecode_enabled(!disable_bytecode);
     OwnPtr<JS::Interpreter> interpreter;
 
     interrupt_interpreter = [&] {
@@ -924,5 +931,18 @@ int main(int argc, char** argv)
             return 1;
     }
 
+    if (print_property_cache_statistics) {
+        auto& statistics = vm->property_cache_statistics();
+        auto print_statistics = [](const char* kind, u64 hits, u64 misses) {
+            auto total = hits + misses;
+            outln("Property cache {}: {} hit(s), {} miss(es), {:.1}% hit rate", kind, hits, misses, total ? 100.0 * hits / total : 0.0);
+        };
+        print_statistics("get", statistics.get_hits, statistics.get_misses);
+        print_statistics("put", statistics.put_hits, statistics.put_misses);
+    }
+
+    if (print_gc_statistics)
+        vm->heap().dump_statistics();
+
     return 0;
 }
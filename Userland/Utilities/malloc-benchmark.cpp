@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <AK/NonnullRefPtrVector.h>
+#include <LibCore/ArgsParser.h>
+#include <LibCore/ElapsedTimer.h>
+#include <LibThread/Thread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+extern "C" void serenity_dump_malloc_stats();
+
+int main(int argc, char** argv)
+{
+    int threads_count = 4;
+    int iterations = 1000;
+    int chunk_size = 64;
+    int batch_size = 64;
+    bool dump_stats = false;
+
+    Core::ArgsParser args_parser;
+    args_parser.set_general_help("Measure malloc/free throughput from several threads at once.");
+    args_parser.add_option(threads_count, "Number of threads", "threads", 't', "count");
+    args_parser.add_option(iterations, "Iterations per thread", "iterations", 'i', "count");
+    args_parser.add_option(chunk_size, "Allocation size in bytes", "size", 's', "bytes");
+    args_parser.add_option(batch_size, "Allocations live at once per thread", "batch", 'b', "count");
+    args_parser.add_option(dump_stats, "Dump malloc statistics when done", "stats", 'S');
+    args_parser.parse(argc, argv);
+
+    if (threads_count <= 0 || iterations <= 0 || chunk_size <= 0 || batch_size <= 0) {
+        args_parser.print_usage(stderr, argv[0]);
+        return 1;
+    }
+
+    NonnullRefPtrVector<LibThread::Thread> threads;
+    Core::ElapsedTimer timer;
+    timer.start();
+
+    for (int i = 0; i < threads_count; ++i) {
+        threads.append(LibThread::Thread::construct([=] {
+            Vector<void*> chunks;
+            chunks.resize(batch_size);
+            for (int iteration = 0; iteration < iterations; ++iteration) {
+                for (auto& chunk : chunks) {
+                    chunk = malloc(chunk_size);
+                    VERIFY(chunk);
+                    memset(chunk, iteration, chunk_size);
+                }
+                for (auto* chunk : chunks)
+                    free(chunk);
+            }
+            return 0;
+        }));
+        threads.last().start();
+    }
+    for (auto& thread : threads)
+        [[maybe_unused]] auto result = thread.join();
+
+    auto elapsed_ms = max(timer.elapsed(), 1);
+    u64 operations = (u64)threads_count * iterations * batch_size * 2;
+    printf("%d threads, %llu malloc/free calls of %d bytes in %d ms (%llu calls/s)\n",
+        threads_count, operations, chunk_size, elapsed_ms, operations * 1000 / elapsed_ms);
+
+    if (dump_stats)
+        serenity_dump_malloc_stats();
+    return 0;
+}
@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <AK/Format.h>
+#include <AK/NonnullRefPtrVector.h>
+#include <LibCore/ArgsParser.h>
+#include <LibCore/ElapsedTimer.h>
+#include <LibThread/Lock.h>
+#include <LibThread/Thread.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+// Hammers a single lock from several threads and reports how much wall-clock and CPU
+// time that takes. With a spinning lock, the CPU time grows much faster than the
+// wall-clock time as threads are added.
+
+template<typename Callback>
+static void run_benchmark(const char* name, int threads_count, int iterations, Callback critical_section)
+{
+    NonnullRefPtrVector<LibThread::Thread> threads;
+    Core::ElapsedTimer timer;
+    clock_t cpu_time_before = clock();
+    timer.start();
+
+    for (int i = 0; i < threads_count; ++i) {
+        threads.append(LibThread::Thread::construct([=] {
+            for (int iteration = 0; iteration < iterations; ++iteration)
+                critical_section();
+            return 0;
+        }));
+        threads.last().start();
+    }
+    for (auto& thread : threads)
+        [[maybe_unused]] auto result = thread.join();
+
+    auto elapsed_ms = max(timer.elapsed(), 1);
+    auto cpu_ms = (clock() - cpu_time_before) * 1000 / CLOCKS_PER_SEC;
+    u64 operations = (u64)threads_count * iterations;
+    outln("{:16} {} lock/unlock pairs in {} ms, {} ms CPU ({} pairs/s)", name, operations, elapsed_ms, cpu_ms, operations * 1000 / elapsed_ms);
+}
+
+int main(int argc, char** argv)
+{
+    int threads_count = 4;
+    int iterations = 100000;
+    int work = 10;
+
+    Core::ArgsParser args_parser;
+    args_parser.set_general_help("Measure lock throughput when many threads contend for the same lock.");
+    args_parser.add_option(threads_count, "Number of threads", "threads", 't', "count");
+    args_parser.add_option(iterations, "Lock/unlock pairs per thread", "iterations", 'i', "count");
+    args_parser.add_option(work, "Units of work done while holding the lock", "work", 'w', "count");
+    args_parser.parse(argc, argv);
+
+    if (threads_count <= 0 || iterations <= 0 || work < 0) {
+        args_parser.print_usage(stderr, argv[0]);
+        return 1;
+    }
+
+    static volatile u32 shared_counter;
+    auto do_work = [=] {
+        for (int i = 0; i < work; ++i)
+            shared_counter = shared_counter + 1;
+    };
+
+    static pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+    run_benchmark("pthread_mutex", threads_count, iterations, [=] {
+        pthread_mutex_lock(&mutex);
+        do_work();
+        pthread_mutex_unlock(&mutex);
+    });
+
+    static LibThread::Lock lock;
+    run_benchmark("LibThread::Lock", threads_count, iterations, [=] {
+        LOCKER(lock);
+        do_work();
+    });
+
+    return 0;
+}
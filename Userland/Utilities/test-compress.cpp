@@ -32,6 +32,7 @@
 #include <LibCompress/Deflate.h>
 #include <LibCompress/Gzip.h>
 #include <LibCompress/Zlib.h>
+#include <LibCore/ElapsedTimer.h>
 #include <string.h>
 
 TEST_CASE(canonical_code_simple)
@@ -76,6 +77,30 @@ TEST_CASE(canonical_code_complex)
         EXPECT_EQ(huffman.read_symbol(bit_stream), output[idx]);
 }
 
+TEST_CASE(canonical_code_long_codes)
+{
+    // Code lengths of 1, 2, ..., 14, 15, 15 require codes that do not fit into a single table lookup.
+    Array<u8, 16> code;
+    for (size_t idx = 0; idx < 15; ++idx)
+        code[idx] = idx + 1;
+    code[15] = 15;
+
+    const auto huffman = Compress::CanonicalCode::from_bytes(code).value();
+
+    DuplexMemoryStream output_memory_stream;
+    OutputBitStream output_bit_stream { output_memory_stream };
+    for (u32 symbol = 0; symbol < 16; ++symbol)
+        huffman.write_symbol(output_bit_stream, 15 - symbol);
+    output_bit_stream.align_to_byte_boundary();
+
+    const auto encoded = output_memory_stream.copy_into_contiguous_buffer();
+    auto memory_stream = InputMemoryStream { encoded };
+    auto bit_stream = InputBitStream { memory_stream };
+
+    for (u32 symbol = 0; symbol < 16; ++symbol)
+        EXPECT_EQ(huffman.read_symbol(bit_stream), 15 - symbol);
+}
+
 TEST_CASE(deflate_decompress_compressed_block)
 {
     const Array<u8, 28> compressed {
@@ -279,4 +304,34 @@ TEST_CASE(gzip_round_trip)
     EXPECT(uncompressed.value() == original);
 }
 
+BENCHMARK_CASE(deflate_decompress_throughput)
+{
+    // Random letters interleaved with repeated runs, so both literals and back references are exercised.
+    constexpr size_t size = 8 * MiB;
+    auto original = ByteBuffer::create_uninitialized(size);
+    u32 state = 0x12345678;
+    for (size_t idx = 0; idx < size; ++idx) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        original[idx] = 'a' + state % 26;
+    }
+    for (size_t offset = 0; offset < size; offset += 16 * KiB) {
+        memset(original.offset_pointer(offset), offset / KiB, 4 * KiB);
+        memcpy(original.offset_pointer(offset + 8 * KiB), original.offset_pointer(offset + 2 * KiB), 4 * KiB);
+    }
+
+    auto compressed = Compress::DeflateCompressor::compress_all(original, Compress::DeflateCompressor::CompressionLevel::FAST);
+    EXPECT(compressed.has_value());
+
+    Core::ElapsedTimer timer;
+    timer.start();
+    auto uncompressed = Compress::DeflateDecompressor::decompress_all(compressed.value());
+    auto elapsed_ms = max(timer.elapsed(), 1);
+
+    EXPECT(uncompressed.has_value());
+    EXPECT(uncompressed.value() == original);
+    outln("Decompressed {} KiB into {} KiB in {}ms ({} MB/s)", compressed.value().size() / KiB, size / KiB, elapsed_ms, size / 1000 / elapsed_ms);
+}
+
 TEST_MAIN(Compress)
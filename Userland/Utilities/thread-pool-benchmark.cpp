@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <AK/Format.h>
+#include <AK/QuickSort.h>
+#include <AK/Vector.h>
+#include <LibCore/ArgsParser.h>
+#include <LibCore/ElapsedTimer.h>
+#include <LibThread/ThreadPool.h>
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+
+// Runs the same total amount of work through a thread pool, once split into many small
+// jobs and once into a few large ones, and reports the throughput and how long jobs sat
+// in a queue before a worker picked them up.
+
+static u64 now_in_microseconds()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (u64)ts.tv_sec * 1'000'000 + ts.tv_nsec / 1000;
+}
+
+static void do_work(int units)
+{
+    static volatile u32 sink;
+    for (int i = 0; i < units; ++i)
+        sink = sink + i;
+}
+
+static void run_benchmark(LibThread::ThreadPool& pool, const char* name, int jobs_count, int units_per_job)
+{
+    Vector<u64> latencies;
+    latencies.resize(jobs_count);
+
+    Core::ElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < jobs_count; ++i) {
+        pool.submit([&latencies, i, units_per_job, submitted_at = now_in_microseconds()] {
+            latencies[i] = now_in_microseconds() - submitted_at;
+            do_work(units_per_job);
+        });
+    }
+    pool.wait_until_idle();
+    auto elapsed_ms = max(timer.elapsed(), 1);
+
+    quick_sort(latencies);
+    u64 total_latency = 0;
+    for (auto latency : latencies)
+        total_latency += latency;
+
+    outln("{:>2} worker(s), {:5}: {} jobs in {} ms ({} jobs/s), latency avg {} us, median {} us, max {} us",
+        pool.worker_count(), name, jobs_count, elapsed_ms, (u64)jobs_count * 1000 / elapsed_ms,
+        total_latency / jobs_count, latencies[jobs_count / 2], latencies.last());
+}
+
+int main(int argc, char** argv)
+{
+    int workers_count = sysconf(_SC_NPROCESSORS_ONLN);
+    int small_jobs_count = 100000;
+    int large_jobs_count = 0;
+    int total_units = 100000000;
+
+    Core::ArgsParser args_parser;
+    args_parser.set_general_help("Measure thread pool throughput and latency for many small jobs versus a few large ones.");
+    args_parser.add_option(workers_count, "Number of worker threads (default: one per CPU)", "workers", 'w', "count");
+    args_parser.add_option(small_jobs_count, "Number of jobs in the small job run", "small", 's', "count");
+    args_parser.add_option(large_jobs_count, "Number of jobs in the large job run (default: twice the workers)", "large", 'l', "count");
+    args_parser.add_option(total_units, "Units of work in each run", "units", 'u', "count");
+    args_parser.parse(argc, argv);
+
+    if (workers_count <= 0)
+        workers_count = 1;
+    if (large_jobs_count <= 0)
+        large_jobs_count = workers_count * 2;
+    if (small_jobs_count <= 0 || total_units <= 0) {
+        args_parser.print_usage(stderr, argv[0]);
+        return 1;
+    }
+
+    // A single worker is what BackgroundAction used to run everything on.
+    Vector<int, 2> pool_sizes { 1 };
+    if (workers_count != 1)
+        pool_sizes.append(workers_count);
+
+    for (auto pool_size : pool_sizes) {
+        LibThread::ThreadPool pool(pool_size, "Benchmark");
+        run_benchmark(pool, "small", small_jobs_count, max(total_units / small_jobs_count, 1));
+        run_benchmark(pool, "large", large_jobs_count, max(total_units / large_jobs_count, 1));
+    }
+
+    return 0;
+}